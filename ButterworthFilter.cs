@@ -1,9 +1,18 @@
-using System;
-
 namespace DataFilter
 {
     public class ButterworthFilter
     {
+        // Define 5th order Butterworth filter w/ cut-off frequency
+        // of 0.15 where 1.0 corresponds to half the sample rate.
+        private static readonly ButterworthPlan mPlan = new ButterworthPlan(
+            0.15,
+            new[] {1.0, -3.4789, 5.0098, -3.6995, 1.3942, -0.2138},
+            new[] {0.0004, 0.0018, 0.0037, 0.0037, 0.0018, 0.0004});
+
+        /// <summary>
+        /// When true, runs of exact zeros are skipped once the filter state has decayed to 0; the results are unchanged
+        /// </summary>
+        public bool SkipZeroRuns { get; set; }
 
         /// <summary>
         /// Butterworth Filter
@@ -18,101 +27,120 @@ namespace DataFilter
         /// </remarks>
         public bool FilterData(float[] zeroBased1DArray, int indexStart, int indexEnd)
         {
-            bool processingDataSubset;
-
-            double[] tmpFilter;
-
-            // Define 5th order Butterworth filter w/ cut-off frequency
-            // of 0.15 where 1.0 corresponds to half the sample rate.
-
-            const int FILTER_SIZE = 6;
-            var a = new[] {1.0, -3.4789, 5.0098, -3.6995, 1.3942, -0.2138};
-            var b = new[] {0.0004, 0.0018, 0.0037, 0.0037, 0.0018, 0.0004};
-
             if (zeroBased1DArray == null || zeroBased1DArray.Length <= 0)
                 return false;
 
-            // Copy data from zeroBased1DArray to tmpFilter, only copying a certain range if indexStart and indexEnd are >= 0
+            // Filter the whole array unless indexStart and indexEnd define a valid range
             if (indexStart < 0 ||
                 indexEnd < 0 ||
                 indexEnd < indexStart)
             {
-                processingDataSubset = false;
-                tmpFilter = new double[zeroBased1DArray.Length];
-                zeroBased1DArray.CopyTo(tmpFilter, 0);
-            }
-            else
-            {
-                processingDataSubset = true;
-                tmpFilter = new double[indexEnd - indexStart + 1];
-                for (var i = indexStart; i <= indexEnd; i++)
-                {
-                    tmpFilter[i - indexStart] = zeroBased1DArray[i];
-                }
+                indexStart = 0;
+                indexEnd = zeroBased1DArray.Length - 1;
             }
 
-            var dataCount = tmpFilter.Length;
+            FilterInPlace(zeroBased1DArray, indexStart, indexEnd, mPlan, SkipZeroRuns);
+
+            return true;
+
+        }
+
+        /// <summary>
+        /// Zero-phase 5th order IIR filter of points indexStart through indexEnd, in place
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="plan"></param>
+        /// <param name="skipZeroRuns">When true, zero input with the filter at rest is passed over, since its output is 0</param>
+        /// <remarks>
+        /// Same recurrence as the double filters, with the previous 5 inputs and outputs held in
+        /// double locals. The forward pass is kept in double, so only the final output is rounded
+        /// to float, then the reverse pass runs from indexEnd back to indexStart,
+        /// which is the same as reversing, filtering, and reversing again.
+        /// </remarks>
+        internal static void FilterInPlace(float[] zeroBased1DArray, int indexStart, int indexEnd, ButterworthPlan plan, bool skipZeroRuns)
+        {
+            var a = plan.FeedbackCoefficients;
+            var b = plan.FeedforwardCoefficients;
+            double a1 = a[1], a2 = a[2], a3 = a[3], a4 = a[4], a5 = a[5];
+            double b0 = b[0], b1 = b[1], b2 = b[2], b3 = b[3], b4 = b[4], b5 = b[5];
 
             // Pass MS profile through IIR low pass filter:
             // y(n) = b(1)*x(n) + b(2)*x(n-1) + ... + b(nb+1)*x(n-nb) -
             //        a(2)*y(n-1) - ... - a(na+1)*y(n-na)
+            // Points before the start are taken as 0, as in the double filters
 
-            var filteredData = new double[dataCount];
-            for (var i = 0; i < dataCount; i++)
+            var forward = new double[indexEnd - indexStart + 1];
+
+            double x1 = 0, x2 = 0, x3 = 0, x4 = 0, x5 = 0;
+            double y1 = 0, y2 = 0, y3 = 0, y4 = 0, y5 = 0;
+
+            for (var i = indexStart; i <= indexEnd; i++)
             {
-                filteredData[i] = b[0] * tmpFilter[i];
+                double x0 = zeroBased1DArray[i];
 
-                for (var j = 1; j < FILTER_SIZE; j++)
+                if (skipZeroRuns && x0 == 0 && IsAtRest(x1, x2, x3, x4, x5, y1, y2, y3, y4, y5))
                 {
-                    if (i - j >= 0)
+                    // Zero in gives zero out until the next non-zero point; forward is already 0
+                    while (i + 1 <= indexEnd && zeroBased1DArray[i + 1] == 0)
                     {
-                        filteredData[i] += b[j] * tmpFilter[i - j];
-                        filteredData[i] -= a[j] * filteredData[i - j];
+                        i++;
                     }
+
+                    continue;
                 }
+                var y0 = b0 * x0;
+                y0 += b1 * x1; y0 -= a1 * y1;
+                y0 += b2 * x2; y0 -= a2 * y2;
+                y0 += b3 * x3; y0 -= a3 * y3;
+                y0 += b4 * x4; y0 -= a4 * y4;
+                y0 += b5 * x5; y0 -= a5 * y5;
+
+                x5 = x4; x4 = x3; x3 = x2; x2 = x1; x1 = x0;
+                y5 = y4; y4 = y3; y3 = y2; y2 = y1; y1 = y0;
+
+                forward[i - indexStart] = y0;
             }
 
-            // Filtered data is reversed and re-filtered resulting
+            // Filtered data is re-filtered in reverse order resulting
             // in zero-phase distortion and double the filter order.
 
-            Array.Reverse(filteredData);
-            filteredData.CopyTo(tmpFilter, 0);
+            x1 = x2 = x3 = x4 = x5 = 0;
+            y1 = y2 = y3 = y4 = y5 = 0;
 
-            filteredData = new double[dataCount];
-            for (var i = 0; i < dataCount; i++)
+            for (var i = indexEnd; i >= indexStart; i--)
             {
-                filteredData[i] = b[0] * tmpFilter[i];
-                for (var j = 1; j < FILTER_SIZE; j++)
+                var x0 = forward[i - indexStart];
+
+                if (skipZeroRuns && x0 == 0 && IsAtRest(x1, x2, x3, x4, x5, y1, y2, y3, y4, y5))
                 {
-                    if (i - j >= 0)
+                    while (i >= indexStart && forward[i - indexStart] == 0)
                     {
-                        filteredData[i] += b[j] * tmpFilter[i - j];
-                        filteredData[i] -= a[j] * filteredData[i - j];
+                        zeroBased1DArray[i--] = 0;
                     }
+
+                    i++;
+                    continue;
                 }
-            }
+                var y0 = b0 * x0;
+                y0 += b1 * x1; y0 -= a1 * y1;
+                y0 += b2 * x2; y0 -= a2 * y2;
+                y0 += b3 * x3; y0 -= a3 * y3;
+                y0 += b4 * x4; y0 -= a4 * y4;
+                y0 += b5 * x5; y0 -= a5 * y5;
 
-            // Filtered data is reversed again
-            Array.Reverse(filteredData);
+                x5 = x4; x4 = x3; x3 = x2; x2 = x1; x1 = x0;
+                y5 = y4; y4 = y3; y3 = y2; y2 = y1; y1 = y0;
 
-            // Update zeroBased1DArray with the filtered data
-            if (processingDataSubset)
-            {
-                for (var i = 0; i < dataCount; i++)
-                {
-                    zeroBased1DArray[i + indexStart] = (float)filteredData[i];
-                }
+                zeroBased1DArray[i] = (float)y0;
             }
-            else
-            {
-                for (var i = 0; i < dataCount; i++)
-                {
-                    zeroBased1DArray[i] = (float)filteredData[i];
-                }
-            }
-
-            return true;
+        }
 
+        private static bool IsAtRest(double x1, double x2, double x3, double x4, double x5, double y1, double y2, double y3, double y4, double y5)
+        {
+            return x1 == 0 && x2 == 0 && x3 == 0 && x4 == 0 && x5 == 0 &&
+                   y1 == 0 && y2 == 0 && y3 == 0 && y4 == 0 && y5 == 0;
         }
 
         // /*
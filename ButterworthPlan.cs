@@ -0,0 +1,315 @@
+using System.Collections.Generic;
+using System.Collections.ObjectModel;
+
+namespace DataFilter
+{
+    /// <summary>
+    /// Immutable coefficients for a 5th order Butterworth low pass filter
+    /// </summary>
+    /// <remarks>
+    /// The tables below are constant data, and the plan for each cut-off frequency is created by the
+    /// type initializer, which the runtime runs exactly once before the first use; after that a lookup
+    /// only indexes an array, so plans can be read from any number of threads without locking
+    ///
+    /// Coefficients for various sampling rates obtained using MatLab (courtesy of Deep Jaitly, PNNL)
+    /// </remarks>
+    public sealed class ButterworthPlan
+    {
+        /// <summary>
+        /// Filter order; each plan has FILTER_ORDER + 1 coefficients of each kind
+        /// </summary>
+        public const int FILTER_ORDER = 5;
+
+        // The following define the filter coefficients for sample rates of 0.01 to 0.99, in steps of 0.01
+
+        private static readonly double[][] mTableA =
+        {
+            new[] { 1, -4.8983, 9.5985, -9.4053, 4.6085, -0.90333 },
+            new[] { 1, -4.7967, 9.2072, -8.8404, 4.2458, -0.81598 },
+            new[] { 1, -4.695, 8.8261, -8.304, 3.9099, -0.73703 },
+            new[] { 1, -4.5934, 8.4551, -7.7949, 3.5989, -0.66565 },
+            new[] { 1, -4.4918, 8.0941, -7.3121, 3.311, -0.60112 },
+            new[] { 1, -4.3903, 7.7429, -6.8543, 3.0447, -0.54275 },
+            new[] { 1, -4.2888, 7.4015, -6.4207, 2.7983, -0.48996 },
+            new[] { 1, -4.1873, 7.0697, -6.01, 2.5704, -0.44221 },
+            new[] { 1, -4.0859, 6.7476, -5.6213, 2.3598, -0.39901 },
+            new[] { 1, -3.9845, 6.4349, -5.2536, 2.1651, -0.35993 },
+            new[] { 1, -3.8833, 6.1315, -4.9061, 1.9853, -0.32457 },
+            new[] { 1, -3.7821, 5.8375, -4.5777, 1.8193, -0.29258 },
+            new[] { 1, -3.6809, 5.5526, -4.2678, 1.666, -0.26365 },
+            new[] { 1, -3.5799, 5.2767, -3.9753, 1.5246, -0.23747 },
+            new[] { 1, -3.4789, 5.0098, -3.6995, 1.3942, -0.2138 },
+            new[] { 1, -3.378, 4.7518, -3.4397, 1.274, -0.19239 },
+            new[] { 1, -3.2772, 4.5025, -3.1951, 1.1633, -0.17303 },
+            new[] { 1, -3.1765, 4.2618, -2.9649, 1.0613, -0.15553 },
+            new[] { 1, -3.0759, 4.0297, -2.7485, 0.96744, -0.13972 },
+            new[] { 1, -2.9754, 3.806, -2.5453, 0.88113, -0.12543 },
+            new[] { 1, -2.875, 3.5907, -2.3544, 0.80179, -0.11253 },
+            new[] { 1, -2.7747, 3.3836, -2.1755, 0.72892, -0.10087 },
+            new[] { 1, -2.6745, 3.1847, -2.0078, 0.66202, -0.090358 },
+            new[] { 1, -2.5744, 2.9939, -1.8507, 0.60067, -0.080871 },
+            new[] { 1, -2.4744, 2.811, -1.7038, 0.54443, -0.072316 },
+            new[] { 1, -2.3745, 2.636, -1.5664, 0.49294, -0.064605 },
+            new[] { 1, -2.2747, 2.4689, -1.4381, 0.44583, -0.057658 },
+            new[] { 1, -2.175, 2.3095, -1.3184, 0.40277, -0.051402 },
+            new[] { 1, -2.0754, 2.1577, -1.2067, 0.36346, -0.045773 },
+            new[] { 1, -1.9759, 2.0135, -1.1026, 0.32762, -0.040709 },
+            new[] { 1, -1.8765, 1.8768, -1.0057, 0.29498, -0.036157 },
+            new[] { 1, -1.7772, 1.7475, -0.91547, 0.2653, -0.032066 },
+            new[] { 1, -1.6779, 1.6256, -0.83154, 0.23836, -0.028392 },
+            new[] { 1, -1.5788, 1.511, -0.75347, 0.21395, -0.025092 },
+            new[] { 1, -1.4797, 1.4037, -0.68086, 0.19188, -0.02213 },
+            new[] { 1, -1.3807, 1.3035, -0.61332, 0.17199, -0.01947 },
+            new[] { 1, -1.2817, 1.2105, -0.55047, 0.15411, -0.017082 },
+            new[] { 1, -1.1829, 1.1246, -0.49193, 0.1381, -0.014935 },
+            new[] { 1, -1.0841, 1.0457, -0.43735, 0.12382, -0.013004 },
+            new[] { 1, -0.98533, 0.97385, -0.38636, 0.11116, -0.011264 },
+            new[] { 1, -0.88664, 0.90893, -0.33861, 0.10002, -0.0096912 },
+            new[] { 1, -0.788, 0.85095, -0.29377, 0.090295, -0.0082657 },
+            new[] { 1, -0.6894, 0.79985, -0.25149, 0.081905, -0.0069673 },
+            new[] { 1, -0.59084, 0.75563, -0.21145, 0.074777, -0.0057777 },
+            new[] { 1, -0.49232, 0.71825, -0.17331, 0.068849, -0.0046793 },
+            new[] { 1, -0.39382, 0.6877, -0.13676, 0.06407, -0.0036557 },
+            new[] { 1, -0.29534, 0.66395, -0.10147, 0.060396, -0.0026909 },
+            new[] { 1, -0.19689, 0.64699, -0.067122, 0.057795, -0.0017699 },
+            new[] { 1, -0.098441, 0.63683, -0.033404, 0.056244, -0.00087777 },
+            new[] { 1, -0.00000000000000046491, 0.63344, -0.00000000000000020438, 0.055728, -3.0935E-18 },
+            new[] { 1, 0.098441, 0.63683, 0.033404, 0.056244, 0.00087777 },
+            new[] { 1, 0.19689, 0.64699, 0.067122, 0.057795, 0.0017699 },
+            new[] { 1, 0.29534, 0.66395, 0.10147, 0.060396, 0.0026909 },
+            new[] { 1, 0.39382, 0.6877, 0.13676, 0.06407, 0.0036557 },
+            new[] { 1, 0.49232, 0.71825, 0.17331, 0.068849, 0.0046793 },
+            new[] { 1, 0.59084, 0.75563, 0.21145, 0.074777, 0.0057777 },
+            new[] { 1, 0.6894, 0.79985, 0.25149, 0.081905, 0.0069673 },
+            new[] { 1, 0.788, 0.85095, 0.29377, 0.090295, 0.0082657 },
+            new[] { 1, 0.88664, 0.90893, 0.33861, 0.10002, 0.0096912 },
+            new[] { 1, 0.98533, 0.97385, 0.38636, 0.11116, 0.011264 },
+            new[] { 1, 1.0841, 1.0457, 0.43735, 0.12382, 0.013004 },
+            new[] { 1, 1.1829, 1.1246, 0.49193, 0.1381, 0.014935 },
+            new[] { 1, 1.2817, 1.2105, 0.55047, 0.15411, 0.017082 },
+            new[] { 1, 1.3807, 1.3035, 0.61332, 0.17199, 0.01947 },
+            new[] { 1, 1.4797, 1.4037, 0.68086, 0.19188, 0.02213 },
+            new[] { 1, 1.5788, 1.511, 0.75347, 0.21395, 0.025092 },
+            new[] { 1, 1.6779, 1.6256, 0.83154, 0.23836, 0.028392 },
+            new[] { 1, 1.7772, 1.7475, 0.91547, 0.2653, 0.032066 },
+            new[] { 1, 1.8765, 1.8768, 1.0057, 0.29498, 0.036157 },
+            new[] { 1, 1.9759, 2.0135, 1.1026, 0.32762, 0.040709 },
+            new[] { 1, 2.0754, 2.1577, 1.2067, 0.36346, 0.045773 },
+            new[] { 1, 2.175, 2.3095, 1.3184, 0.40277, 0.051402 },
+            new[] { 1, 2.2747, 2.4689, 1.4381, 0.44583, 0.057658 },
+            new[] { 1, 2.3745, 2.636, 1.5664, 0.49294, 0.064605 },
+            new[] { 1, 2.4744, 2.811, 1.7038, 0.54443, 0.072316 },
+            new[] { 1, 2.5744, 2.9939, 1.8507, 0.60067, 0.080871 },
+            new[] { 1, 2.6745, 3.1847, 2.0078, 0.66202, 0.090358 },
+            new[] { 1, 2.7747, 3.3836, 2.1755, 0.72892, 0.10087 },
+            new[] { 1, 2.875, 3.5907, 2.3544, 0.80179, 0.11253 },
+            new[] { 1, 2.9754, 3.806, 2.5453, 0.88113, 0.12543 },
+            new[] { 1, 3.0759, 4.0297, 2.7485, 0.96744, 0.13972 },
+            new[] { 1, 3.1765, 4.2618, 2.9649, 1.0613, 0.15553 },
+            new[] { 1, 3.2772, 4.5025, 3.1951, 1.1633, 0.17303 },
+            new[] { 1, 3.378, 4.7518, 3.4397, 1.274, 0.19239 },
+            new[] { 1, 3.4789, 5.0098, 3.6995, 1.3942, 0.2138 },
+            new[] { 1, 3.5799, 5.2767, 3.9753, 1.5246, 0.23747 },
+            new[] { 1, 3.6809, 5.5526, 4.2678, 1.666, 0.26365 },
+            new[] { 1, 3.7821, 5.8375, 4.5777, 1.8193, 0.29258 },
+            new[] { 1, 3.8833, 6.1315, 4.9061, 1.9853, 0.32457 },
+            new[] { 1, 3.9845, 6.4349, 5.2536, 2.1651, 0.35993 },
+            new[] { 1, 4.0859, 6.7476, 5.6213, 2.3598, 0.39901 },
+            new[] { 1, 4.1873, 7.0697, 6.01, 2.5704, 0.44221 },
+            new[] { 1, 4.2888, 7.4015, 6.4207, 2.7983, 0.48996 },
+            new[] { 1, 4.3903, 7.7429, 6.8543, 3.0447, 0.54275 },
+            new[] { 1, 4.4918, 8.0941, 7.3121, 3.311, 0.60112 },
+            new[] { 1, 4.5934, 8.4551, 7.7949, 3.5989, 0.66565 },
+            new[] { 1, 4.695, 8.8261, 8.304, 3.9099, 0.73703 },
+            new[] { 1, 4.7967, 9.2072, 8.8404, 4.2458, 0.81598 },
+            new[] { 1, 4.8983, 9.5985, 9.4053, 4.6085, 0.90333 }
+        };
+
+        private static readonly double[][] mTableB =
+        {
+            new[] { 0.00000000090929, 0.0000000045464, 0.0000000090929, 0.0000000090929, 0.0000000045464, 0.00000000090929 },
+            new[] { 0.000000027689, 0.00000013844, 0.00000027689, 0.00000027689, 0.00000013844, 0.000000027689 },
+            new[] { 0.00000020024, 0.0000010012, 0.0000020024, 0.0000020024, 0.0000010012, 0.00000020024 },
+            new[] { 0.00000080424, 0.0000040212, 0.0000080424, 0.0000080424, 0.0000040212, 0.00000080424 },
+            new[] { 0.000002341, 0.000011705, 0.00002341, 0.00002341, 0.000011705, 0.000002341 },
+            new[] { 0.0000055603, 0.000027802, 0.000055603, 0.000055603, 0.000027802, 0.0000055603 },
+            new[] { 0.00001148, 0.000057401, 0.0001148, 0.0001148, 0.000057401, 0.00001148 },
+            new[] { 0.000021396, 0.00010698, 0.00021396, 0.00021396, 0.00010698, 0.000021396 },
+            new[] { 0.000036884, 0.00018442, 0.00036884, 0.00036884, 0.00018442, 0.000036884 },
+            new[] { 0.000059796, 0.00029898, 0.00059796, 0.00059796, 0.00029898, 0.000059796 },
+            new[] { 0.000092253, 0.00046126, 0.00092253, 0.00092253, 0.00046126, 0.000092253 },
+            new[] { 0.00013664, 0.00068318, 0.0013664, 0.0013664, 0.00068318, 0.00013664 },
+            new[] { 0.00019557, 0.00097786, 0.0019557, 0.0019557, 0.00097786, 0.00019557 },
+            new[] { 0.00027193, 0.0013596, 0.0027193, 0.0027193, 0.0013596, 0.00027193 },
+            new[] { 0.00036878, 0.0018439, 0.0036878, 0.0036878, 0.0018439, 0.00036878 },
+            new[] { 0.00048944, 0.0024472, 0.0048944, 0.0048944, 0.0024472, 0.00048944 },
+            new[] { 0.00063738, 0.0031869, 0.0063738, 0.0063738, 0.0031869, 0.00063738 },
+            new[] { 0.00081629, 0.0040814, 0.0081629, 0.0081629, 0.0040814, 0.00081629 },
+            new[] { 0.00103, 0.0051501, 0.0103, 0.0103, 0.0051501, 0.00103 },
+            new[] { 0.0012826, 0.0064129, 0.012826, 0.012826, 0.0064129, 0.0012826 },
+            new[] { 0.0015782, 0.0078908, 0.015782, 0.015782, 0.0078908, 0.0015782 },
+            new[] { 0.0019211, 0.0096054, 0.019211, 0.019211, 0.0096054, 0.0019211 },
+            new[] { 0.0023158, 0.011579, 0.023158, 0.023158, 0.011579, 0.0023158 },
+            new[] { 0.0027669, 0.013835, 0.027669, 0.027669, 0.013835, 0.0027669 },
+            new[] { 0.0032792, 0.016396, 0.032792, 0.032792, 0.016396, 0.0032792 },
+            new[] { 0.0038575, 0.019288, 0.038575, 0.038575, 0.019288, 0.0038575 },
+            new[] { 0.0045069, 0.022534, 0.045069, 0.045069, 0.022534, 0.0045069 },
+            new[] { 0.0052324, 0.026162, 0.052324, 0.052324, 0.026162, 0.0052324 },
+            new[] { 0.0060394, 0.030197, 0.060394, 0.060394, 0.030197, 0.0060394 },
+            new[] { 0.0069332, 0.034666, 0.069332, 0.069332, 0.034666, 0.0069332 },
+            new[] { 0.0079194, 0.039597, 0.079194, 0.079194, 0.039597, 0.0079194 },
+            new[] { 0.0090036, 0.045018, 0.090036, 0.090036, 0.045018, 0.0090036 },
+            new[] { 0.010192, 0.050959, 0.10192, 0.10192, 0.050959, 0.010192 },
+            new[] { 0.01149, 0.057449, 0.1149, 0.1149, 0.057449, 0.01149 },
+            new[] { 0.012904, 0.064518, 0.12904, 0.12904, 0.064518, 0.012904 },
+            new[] { 0.01444, 0.0722, 0.1444, 0.1444, 0.0722, 0.01444 },
+            new[] { 0.016105, 0.080524, 0.16105, 0.16105, 0.080524, 0.016105 },
+            new[] { 0.017905, 0.089526, 0.17905, 0.17905, 0.089526, 0.017905 },
+            new[] { 0.019848, 0.099239, 0.19848, 0.19848, 0.099239, 0.019848 },
+            new[] { 0.02194, 0.1097, 0.2194, 0.2194, 0.1097, 0.02194 },
+            new[] { 0.024188, 0.12094, 0.24188, 0.24188, 0.12094, 0.024188 },
+            new[] { 0.0266, 0.133, 0.266, 0.266, 0.133, 0.0266 },
+            new[] { 0.029184, 0.14592, 0.29184, 0.29184, 0.14592, 0.029184 },
+            new[] { 0.031948, 0.15974, 0.31948, 0.31948, 0.15974, 0.031948 },
+            new[] { 0.0349, 0.1745, 0.349, 0.349, 0.1745, 0.0349 },
+            new[] { 0.038048, 0.19024, 0.38048, 0.38048, 0.19024, 0.038048 },
+            new[] { 0.041401, 0.20701, 0.41401, 0.41401, 0.20701, 0.041401 },
+            new[] { 0.044969, 0.22485, 0.44969, 0.44969, 0.22485, 0.044969 },
+            new[] { 0.048761, 0.2438, 0.48761, 0.48761, 0.2438, 0.048761 },
+            new[] { 0.052786, 0.26393, 0.52786, 0.52786, 0.26393, 0.052786 },
+            new[] { 0.057056, 0.28528, 0.57056, 0.57056, 0.28528, 0.057056 },
+            new[] { 0.06158, 0.3079, 0.6158, 0.6158, 0.3079, 0.06158 },
+            new[] { 0.06637, 0.33185, 0.6637, 0.6637, 0.33185, 0.06637 },
+            new[] { 0.071437, 0.35719, 0.71437, 0.71437, 0.35719, 0.071437 },
+            new[] { 0.076794, 0.38397, 0.76794, 0.76794, 0.38397, 0.076794 },
+            new[] { 0.082452, 0.41226, 0.82452, 0.82452, 0.41226, 0.082452 },
+            new[] { 0.088426, 0.44213, 0.88426, 0.88426, 0.44213, 0.088426 },
+            new[] { 0.094727, 0.47364, 0.94727, 0.94727, 0.47364, 0.094727 },
+            new[] { 0.10137, 0.50686, 1.0137, 1.0137, 0.50686, 0.10137 },
+            new[] { 0.10837, 0.54187, 1.0837, 1.0837, 0.54187, 0.10837 },
+            new[] { 0.11575, 0.57874, 1.1575, 1.1575, 0.57874, 0.11575 },
+            new[] { 0.12351, 0.61757, 1.2351, 1.2351, 0.61757, 0.12351 },
+            new[] { 0.13169, 0.65843, 1.3169, 1.3169, 0.65843, 0.13169 },
+            new[] { 0.14028, 0.7014, 1.4028, 1.4028, 0.7014, 0.14028 },
+            new[] { 0.14932, 0.7466, 1.4932, 1.4932, 0.7466, 0.14932 },
+            new[] { 0.15882, 0.79411, 1.5882, 1.5882, 0.79411, 0.15882 },
+            new[] { 0.16881, 0.84403, 1.6881, 1.6881, 0.84403, 0.16881 },
+            new[] { 0.1793, 0.89649, 1.793, 1.793, 0.89649, 0.1793 },
+            new[] { 0.19032, 0.95158, 1.9032, 1.9032, 0.95158, 0.19032 },
+            new[] { 0.20189, 1.0094, 2.0189, 2.0189, 1.0094, 0.20189 },
+            new[] { 0.21403, 1.0702, 2.1403, 2.1403, 1.0702, 0.21403 },
+            new[] { 0.22678, 1.1339, 2.2678, 2.2678, 1.1339, 0.22678 },
+            new[] { 0.24016, 1.2008, 2.4016, 2.4016, 1.2008, 0.24016 },
+            new[] { 0.2542, 1.271, 2.542, 2.542, 1.271, 0.2542 },
+            new[] { 0.26894, 1.3447, 2.6894, 2.6894, 1.3447, 0.26894 },
+            new[] { 0.28439, 1.422, 2.8439, 2.8439, 1.422, 0.28439 },
+            new[] { 0.30061, 1.503, 3.0061, 3.0061, 1.503, 0.30061 },
+            new[] { 0.31761, 1.5881, 3.1761, 3.1761, 1.5881, 0.31761 },
+            new[] { 0.33545, 1.6773, 3.3545, 3.3545, 1.6773, 0.33545 },
+            new[] { 0.35416, 1.7708, 3.5416, 3.5416, 1.7708, 0.35416 },
+            new[] { 0.37379, 1.869, 3.7379, 3.7379, 1.869, 0.37379 },
+            new[] { 0.39438, 1.9719, 3.9438, 3.9438, 1.9719, 0.39438 },
+            new[] { 0.41597, 2.0799, 4.1597, 4.1597, 2.0799, 0.41597 },
+            new[] { 0.43862, 2.1931, 4.3862, 4.3862, 2.1931, 0.43862 },
+            new[] { 0.46238, 2.3119, 4.6238, 4.6238, 2.3119, 0.46238 },
+            new[] { 0.48731, 2.4366, 4.8731, 4.8731, 2.4366, 0.48731 },
+            new[] { 0.51347, 2.5673, 5.1347, 5.1347, 2.5673, 0.51347 },
+            new[] { 0.54091, 2.7046, 5.4091, 5.4091, 2.7046, 0.54091 },
+            new[] { 0.56971, 2.8486, 5.6971, 5.6971, 2.8486, 0.56971 },
+            new[] { 0.59994, 2.9997, 5.9994, 5.9994, 2.9997, 0.59994 },
+            new[] { 0.63167, 3.1584, 6.3167, 6.3167, 3.1584, 0.63167 },
+            new[] { 0.66499, 3.3249, 6.6499, 6.6499, 3.3249, 0.66499 },
+            new[] { 0.69997, 3.4999, 6.9997, 6.9997, 3.4999, 0.69997 },
+            new[] { 0.73672, 3.6836, 7.3672, 7.3672, 3.6836, 0.73672 },
+            new[] { 0.77532, 3.8766, 7.7532, 7.7532, 3.8766, 0.77532 },
+            new[] { 0.81588, 4.0794, 8.1588, 8.1588, 4.0794, 0.81588 },
+            new[] { 0.8585, 4.2925, 8.585, 8.585, 4.2925, 0.8585 },
+            new[] { 0.90331, 4.5166, 9.0331, 9.0331, 4.5166, 0.90331 },
+            new[] { 0.95044, 4.7522, 9.5044, 9.5044, 4.7522, 0.95044 }
+        };
+
+        private static readonly ButterworthPlan[] mPlans = CreatePlans();
+
+        private readonly double[] mA;
+        private readonly double[] mB;
+
+        /// <summary>
+        /// Cut-off frequency, where 1.0 corresponds to half the sample rate
+        /// </summary>
+        public double SamplingFrequency { get; }
+
+        /// <summary>
+        /// Feedback (denominator) coefficients; A[0] is 1
+        /// </summary>
+        public IReadOnlyList<double> A { get; }
+
+        /// <summary>
+        /// Feedforward (numerator) coefficients
+        /// </summary>
+        public IReadOnlyList<double> B { get; }
+
+        /// <summary>
+        /// The array behind A, so that the filter loops index a double[] rather than an interface; never written
+        /// </summary>
+        internal double[] FeedbackCoefficients => mA;
+
+        /// <summary>
+        /// The array behind B; never written
+        /// </summary>
+        internal double[] FeedforwardCoefficients => mB;
+
+        /// <summary>
+        /// Constructor
+        /// </summary>
+        /// <param name="samplingFrequency"></param>
+        /// <param name="a">Copied, so the plan cannot be changed through it</param>
+        /// <param name="b">Copied, so the plan cannot be changed through it</param>
+        internal ButterworthPlan(double samplingFrequency, IReadOnlyList<double> a, IReadOnlyList<double> b)
+        {
+            SamplingFrequency = samplingFrequency;
+
+            mA = new double[FILTER_ORDER + 1];
+            mB = new double[FILTER_ORDER + 1];
+            for (var i = 0; i <= FILTER_ORDER; i++)
+            {
+                mA[i] = a[i];
+                mB[i] = b[i];
+            }
+
+            A = new ReadOnlyCollection<double>(mA);
+            B = new ReadOnlyCollection<double>(mB);
+        }
+
+        private static ButterworthPlan[] CreatePlans()
+        {
+            var plans = new ButterworthPlan[mTableA.Length];
+            for (var i = 0; i < plans.Length; i++)
+            {
+                plans[i] = new ButterworthPlan((i + 1) / 100.0, mTableA[i], mTableB[i]);
+            }
+
+            return plans;
+        }
+
+        /// <summary>
+        /// Plan for a cut-off frequency
+        /// </summary>
+        /// <param name="samplingFrequency">
+        /// Defines the cut-off frequency where 1.0 corresponds to half the sample rate
+        /// Can be between 0.01 and 0.99; it is truncated to a multiple of 0.01
+        /// </param>
+        /// <returns></returns>
+        /// <remarks>Frequencies below 0.01 give the plan for 0.05, and above 0.99 the plan for 0.95</remarks>
+        public static ButterworthPlan GetPlan(double samplingFrequency)
+        {
+            var coeffIndex = (int)(samplingFrequency * 100) - 1;
+            if (coeffIndex < 0)
+                coeffIndex = 4;
+
+            if (coeffIndex > 98)
+                coeffIndex = 94;
+
+            return mPlans[coeffIndex];
+        }
+    }
+}
@@ -0,0 +1,636 @@
+using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+
+namespace DataFilter
+{
+    /// <summary>
+    /// Immutable, losslessly compressed array of float intensities with random access by block
+    /// </summary>
+    /// <remarks>
+    /// The points are split into blocks of BLOCK_POINTS, each compressed on its own, and a block index
+    /// gives the start of each block, so any range can be read without decompressing the rest.
+    /// Within a block, runs of +0 are stored as a count; each run of other values stores the bits of
+    /// its first value followed by the differences between the bits of consecutive values, zigzag
+    /// encoded and bit packed at the width of the largest difference. Exact zeros cost almost nothing,
+    /// and smooth or low noise data packs well below 32 bits per point.
+    ///
+    /// Every value, including -0 and NaN, reads back with the same bits it was written with.
+    /// </remarks>
+    public sealed class CompressedSpectrum
+    {
+        /// <summary>
+        /// Points per block
+        /// </summary>
+        public const int BLOCK_POINTS = 4096;
+
+        /// <summary>
+        /// How Decimate reduces each group of points to one value; the values match the DECIM_ modes of hugeview.h
+        /// </summary>
+        public enum DecimationMode
+        {
+            /// <summary>First point of each group</summary>
+            Comb = 0,
+
+            /// <summary>Largest value of each group</summary>
+            Max = 1,
+
+            /// <summary>Smallest value of each group</summary>
+            Min = 2,
+
+            /// <summary>Largest value of the first group, smallest of the second, and so on</summary>
+            MaxMin = 3
+        }
+
+        private readonly byte[] mData;
+        private readonly int[] mBlockOffsets;
+        private readonly bool[] mZeroBlocks;
+
+        /// <summary>
+        /// Number of points
+        /// </summary>
+        public int Count { get; }
+
+        /// <summary>
+        /// Number of blocks
+        /// </summary>
+        public int BlockCount => mZeroBlocks.Length;
+
+        /// <summary>
+        /// Bytes used by the compressed data and the block index
+        /// </summary>
+        public long CompressedBytes => mData.Length + (long)mBlockOffsets.Length * sizeof(int) + mZeroBlocks.Length;
+
+        private CompressedSpectrum(IReadOnlyList<byte[]> blocks, IReadOnlyList<bool> zeroBlocks, int count)
+        {
+            Count = count;
+
+            mBlockOffsets = new int[blocks.Count + 1];
+            mZeroBlocks = new bool[blocks.Count];
+
+            var totalBytes = 0;
+            for (var i = 0; i < blocks.Count; i++)
+            {
+                mBlockOffsets[i] = totalBytes;
+                mZeroBlocks[i] = zeroBlocks[i];
+                totalBytes += blocks[i].Length;
+            }
+
+            mBlockOffsets[blocks.Count] = totalBytes;
+
+            mData = new byte[totalBytes];
+            for (var i = 0; i < blocks.Count; i++)
+            {
+                Buffer.BlockCopy(blocks[i], 0, mData, mBlockOffsets[i], blocks[i].Length);
+            }
+        }
+
+        /// <summary>
+        /// Compress an array
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <returns></returns>
+        public static CompressedSpectrum FromArray(float[] zeroBased1DArray)
+        {
+            var builder = new Builder();
+            builder.Append(zeroBased1DArray, 0, zeroBased1DArray.Length);
+            return builder.ToSpectrum();
+        }
+
+        /// <summary>
+        /// Compress an array of doubles, which are rounded to float
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <returns></returns>
+        public static CompressedSpectrum FromArray(double[] zeroBased1DArray)
+        {
+            var builder = new Builder();
+            var buffer = new float[BLOCK_POINTS];
+
+            for (var start = 0; start < zeroBased1DArray.Length; start += BLOCK_POINTS)
+            {
+                var count = Math.Min(BLOCK_POINTS, zeroBased1DArray.Length - start);
+                for (var i = 0; i < count; i++)
+                {
+                    buffer[i] = (float)zeroBased1DArray[start + i];
+                }
+
+                builder.Append(buffer, 0, count);
+            }
+
+            return builder.ToSpectrum();
+        }
+
+        /// <summary>
+        /// Decompress every point
+        /// </summary>
+        /// <returns></returns>
+        public float[] ToArray()
+        {
+            var values = new float[Count];
+            Read(0, Count, values, 0);
+            return values;
+        }
+
+        /// <summary>
+        /// Decompress points start through start + count - 1 into buffer, starting at bufferIndex
+        /// </summary>
+        /// <param name="start"></param>
+        /// <param name="count"></param>
+        /// <param name="buffer"></param>
+        /// <param name="bufferIndex"></param>
+        /// <remarks>Only the blocks that hold the range are decompressed</remarks>
+        public void Read(int start, int count, float[] buffer, int bufferIndex)
+        {
+            if (start < 0 || count < 0 || start + count > Count)
+                throw new ArgumentOutOfRangeException(nameof(start), "start and count should be within the spectrum");
+
+            float[] blockBuffer = null;
+
+            while (count > 0)
+            {
+                var block = start / BLOCK_POINTS;
+                var offset = start - block * BLOCK_POINTS;
+                var blockCount = GetBlockPointCount(block);
+                var copyCount = Math.Min(blockCount - offset, count);
+
+                if (mZeroBlocks[block])
+                {
+                    Array.Clear(buffer, bufferIndex, copyCount);
+                }
+                else if (offset == 0 && copyCount == blockCount)
+                {
+                    DecodeBlock(block, buffer, bufferIndex);
+                }
+                else
+                {
+                    if (blockBuffer == null)
+                        blockBuffer = new float[BLOCK_POINTS];
+
+                    DecodeBlock(block, blockBuffer, 0);
+                    Array.Copy(blockBuffer, offset, buffer, bufferIndex, copyCount);
+                }
+
+                start += copyCount;
+                bufferIndex += copyCount;
+                count -= copyCount;
+            }
+        }
+
+        /// <summary>
+        /// True if points start through end, clipped to the spectrum, are all +0
+        /// </summary>
+        /// <remarks>Only looks at the block index</remarks>
+        public bool IsZero(int start, int end)
+        {
+            start = Math.Max(start, 0);
+            end = Math.Min(end, Count - 1);
+
+            for (var block = start / BLOCK_POINTS; block <= end / BLOCK_POINTS && block < BlockCount; block++)
+            {
+                if (!mZeroBlocks[block])
+                    return false;
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Reduce each group of skip points, from start through start + count - 1, to one value
+        /// </summary>
+        /// <param name="start"></param>
+        /// <param name="count"></param>
+        /// <param name="skip">Points per group</param>
+        /// <param name="mode"></param>
+        /// <param name="output">Receives one value per group; the last group may be short</param>
+        /// <returns>Number of values written</returns>
+        /// <remarks>Same groups and modes as ViewDecimate in hugeview.c, which HugeExtract uses for real data</remarks>
+        public int Decimate(int start, int count, int skip, DecimationMode mode, float[] output)
+        {
+            if (start < 0 || count < 0 || start + count > Count)
+                throw new ArgumentOutOfRangeException(nameof(start), "start and count should be within the spectrum");
+
+            if (skip < 1)
+                skip = 1;
+
+            var blockBuffer = new float[BLOCK_POINTS];
+            var decodedBlock = -1;
+            var n = 0;
+            var lastMax = true;
+
+            for (var groupStart = start; groupStart < start + count; groupStart += skip)
+            {
+                var groupEnd = Math.Min(groupStart + skip, start + count);
+                var groupMax = float.NaN;
+                var groupMin = float.NaN;
+
+                for (var i = groupStart; i < groupEnd; i = (i / BLOCK_POINTS + 1) * BLOCK_POINTS)
+                {
+                    var block = i / BLOCK_POINTS;
+
+                    // Comb only needs the first point of the group
+                    var last = mode == DecimationMode.Comb ? i : Math.Min(groupEnd, (block + 1) * BLOCK_POINTS) - 1;
+
+                    if (mZeroBlocks[block])
+                    {
+                        UpdateExtremes(0, ref groupMax, ref groupMin, i == groupStart);
+                    }
+                    else
+                    {
+                        if (decodedBlock != block)
+                        {
+                            DecodeBlock(block, blockBuffer, 0);
+                            decodedBlock = block;
+                        }
+
+                        for (var j = i; j <= last; j++)
+                        {
+                            UpdateExtremes(blockBuffer[j - block * BLOCK_POINTS], ref groupMax, ref groupMin, j == groupStart);
+                        }
+                    }
+
+                    if (mode == DecimationMode.Comb)
+                        break;
+                }
+
+                switch (mode)
+                {
+                    case DecimationMode.Min:
+                        output[n] = groupMin;
+                        break;
+                    case DecimationMode.MaxMin:
+                        output[n] = lastMax ? groupMax : groupMin;
+                        lastMax = !lastMax;
+                        break;
+                    default:
+                        output[n] = groupMax;
+                        break;
+                }
+
+                n++;
+            }
+
+            return n;
+        }
+
+        /// <summary>
+        /// Point by point sum of spectra with the same number of points
+        /// </summary>
+        /// <param name="spectra"></param>
+        /// <returns></returns>
+        /// <remarks>
+        /// Works one block at a time; blocks that are zero in every spectrum are not decompressed.
+        /// Values are added in float, in list order
+        /// </remarks>
+        public static CompressedSpectrum CoAdd(IReadOnlyList<CompressedSpectrum> spectra)
+        {
+            if (spectra == null || spectra.Count == 0)
+                throw new ArgumentException("spectra should not be empty", nameof(spectra));
+
+            var count = spectra[0].Count;
+            foreach (var spectrum in spectra)
+            {
+                if (spectrum.Count != count)
+                    throw new ArgumentException("Every spectrum should have the same number of points", nameof(spectra));
+            }
+
+            var builder = new Builder();
+            var sum = new float[BLOCK_POINTS];
+            var values = new float[BLOCK_POINTS];
+
+            for (var block = 0; block < spectra[0].BlockCount; block++)
+            {
+                var blockCount = spectra[0].GetBlockPointCount(block);
+                Array.Clear(sum, 0, blockCount);
+
+                foreach (var spectrum in spectra)
+                {
+                    if (spectrum.mZeroBlocks[block])
+                        continue;
+
+                    spectrum.DecodeBlock(block, values, 0);
+                    for (var i = 0; i < blockCount; i++)
+                    {
+                        sum[i] += values[i];
+                    }
+                }
+
+                builder.Append(sum, 0, blockCount);
+            }
+
+            return builder.ToSpectrum();
+        }
+
+        /// <summary>
+        /// Build a spectrum of count points from blocks supplied by produceBlocks
+        /// </summary>
+        /// <param name="count"></param>
+        /// <param name="produceBlocks">
+        /// Receives a callback that compresses block b from values, starting at valuesIndex;
+        /// the callback must be called once per block and may be called from several threads at once
+        /// </param>
+        internal static CompressedSpectrum FromBlocks(int count, Action<Action<int, float[], int>> produceBlocks)
+        {
+            var blockCount = (count + BLOCK_POINTS - 1) / BLOCK_POINTS;
+            var blocks = new byte[blockCount][];
+            var zeroBlocks = new bool[blockCount];
+
+            produceBlocks((block, values, valuesIndex) =>
+            {
+                var blockPoints = Math.Min(BLOCK_POINTS, count - block * BLOCK_POINTS);
+                blocks[block] = EncodeBlock(values, valuesIndex, blockPoints, out zeroBlocks[block]);
+            });
+
+            return new CompressedSpectrum(blocks, zeroBlocks, count);
+        }
+
+        /// <summary>
+        /// Number of points in a block; only the last block can be short
+        /// </summary>
+        internal int GetBlockPointCount(int block)
+        {
+            return Math.Min(BLOCK_POINTS, Count - block * BLOCK_POINTS);
+        }
+
+        private static void UpdateExtremes(float value, ref float groupMax, ref float groupMin, bool first)
+        {
+            if (first)
+            {
+                groupMax = groupMin = value;
+                return;
+            }
+
+            if (value > groupMax)
+                groupMax = value;
+
+            if (value < groupMin)
+                groupMin = value;
+        }
+
+        /// <summary>
+        /// Decompress every point of a block into buffer, starting at bufferIndex
+        /// </summary>
+        private void DecodeBlock(int block, float[] buffer, int bufferIndex)
+        {
+            var position = mBlockOffsets[block];
+            var end = bufferIndex + GetBlockPointCount(block);
+            var i = bufferIndex;
+
+            while (i < end)
+            {
+                var zeros = (int)ReadVarint(mData, ref position);
+                Array.Clear(buffer, i, zeros);
+                i += zeros;
+
+                var runLength = (int)ReadVarint(mData, ref position);
+                if (runLength == 0)
+                    continue;
+
+                var bits = mData[position] | mData[position + 1] << 8 | mData[position + 2] << 16 | mData[position + 3] << 24;
+                position += 4;
+                buffer[i++] = Int32BitsToSingle(bits);
+
+                if (runLength == 1)
+                    continue;
+
+                var width = mData[position++];
+                var mask = (1UL << width) - 1;
+                ulong accumulator = 0;
+                var available = 0;
+
+                for (var k = 1; k < runLength; k++)
+                {
+                    while (available < width)
+                    {
+                        accumulator |= (ulong)mData[position++] << available;
+                        available += 8;
+                    }
+
+                    var zigzag = accumulator & mask;
+                    accumulator >>= width;
+                    available -= width;
+
+                    var delta = (long)(zigzag >> 1) ^ -(long)(zigzag & 1);
+                    bits = (int)(bits + delta);
+                    buffer[i++] = Int32BitsToSingle(bits);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Compress values start through start + count - 1 as one block
+        /// </summary>
+        private static byte[] EncodeBlock(float[] values, int start, int count, out bool isZero)
+        {
+            // A run of n values takes at most 2 + 2 + 4 + 1 + 4.125 * (n - 1) bytes, and every run but the
+            // first follows at least one zero, so 8 bytes per point is always enough
+            var output = new byte[8 * count + 16];
+            var position = 0;
+            var end = start + count;
+            var i = start;
+            isZero = true;
+
+            while (i < end)
+            {
+                var zeroStart = i;
+                while (i < end && SingleToInt32Bits(values[i]) == 0)
+                {
+                    i++;
+                }
+
+                var runStart = i;
+                while (i < end && SingleToInt32Bits(values[i]) != 0)
+                {
+                    i++;
+                }
+
+                WriteVarint(output, ref position, (uint)(runStart - zeroStart));
+                WriteVarint(output, ref position, (uint)(i - runStart));
+
+                if (i == runStart)
+                    continue;
+
+                isZero = false;
+
+                var first = SingleToInt32Bits(values[runStart]);
+                output[position++] = (byte)first;
+                output[position++] = (byte)(first >> 8);
+                output[position++] = (byte)(first >> 16);
+                output[position++] = (byte)(first >> 24);
+
+                if (i - runStart == 1)
+                    continue;
+
+                // The differences are packed at the width of the largest one; a difference of
+                // two ints needs at most 33 bits, so the packing never overflows 64 bits
+                ulong largest = 0;
+                var previous = first;
+                for (var k = runStart + 1; k < i; k++)
+                {
+                    var bits = SingleToInt32Bits(values[k]);
+                    largest |= ZigZag((long)bits - previous);
+                    previous = bits;
+                }
+
+                byte width = 1;
+                while (largest >> width != 0)
+                {
+                    width++;
+                }
+
+                output[position++] = width;
+
+                ulong accumulator = 0;
+                var used = 0;
+                previous = first;
+                for (var k = runStart + 1; k < i; k++)
+                {
+                    var bits = SingleToInt32Bits(values[k]);
+                    accumulator |= ZigZag((long)bits - previous) << used;
+                    previous = bits;
+                    used += width;
+
+                    while (used >= 8)
+                    {
+                        output[position++] = (byte)accumulator;
+                        accumulator >>= 8;
+                        used -= 8;
+                    }
+                }
+
+                if (used > 0)
+                    output[position++] = (byte)accumulator;
+            }
+
+            Array.Resize(ref output, position);
+            return output;
+        }
+
+        private static ulong ZigZag(long value)
+        {
+            return (ulong)((value << 1) ^ (value >> 63));
+        }
+
+        private static void WriteVarint(byte[] output, ref int position, uint value)
+        {
+            while (value >= 0x80)
+            {
+                output[position++] = (byte)(value | 0x80);
+                value >>= 7;
+            }
+
+            output[position++] = (byte)value;
+        }
+
+        private static uint ReadVarint(byte[] data, ref int position)
+        {
+            uint value = 0;
+            var shift = 0;
+
+            while (true)
+            {
+                var b = data[position++];
+                value |= (uint)(b & 0x7F) << shift;
+                if (b < 0x80)
+                    return value;
+
+                shift += 7;
+            }
+        }
+
+        private static int SingleToInt32Bits(float value)
+        {
+            return new SingleBits { Single = value }.Int32;
+        }
+
+        private static float Int32BitsToSingle(int value)
+        {
+            return new SingleBits { Int32 = value }.Single;
+        }
+
+        /// <summary>
+        /// Reinterprets the bits of a float, which BitConverter cannot do without an array on .NET Framework
+        /// </summary>
+        [StructLayout(LayoutKind.Explicit)]
+        private struct SingleBits
+        {
+            [FieldOffset(0)]
+            public float Single;
+
+            [FieldOffset(0)]
+            public int Int32;
+        }
+
+        /// <summary>
+        /// Compresses points as they are appended, one block at a time
+        /// </summary>
+        public sealed class Builder
+        {
+            private readonly List<byte[]> mBlocks = new List<byte[]>();
+            private readonly List<bool> mZeroBlocks = new List<bool>();
+            private readonly float[] mPending = new float[BLOCK_POINTS];
+            private int mPendingCount;
+            private int mCount;
+
+            /// <summary>
+            /// Append values start through start + count - 1
+            /// </summary>
+            /// <param name="values"></param>
+            /// <param name="start"></param>
+            /// <param name="count"></param>
+            public void Append(float[] values, int start, int count)
+            {
+                while (count > 0)
+                {
+                    // Whole blocks are encoded straight from the caller's array
+                    if (mPendingCount == 0 && count >= BLOCK_POINTS)
+                    {
+                        AddBlock(values, start, BLOCK_POINTS);
+                        start += BLOCK_POINTS;
+                        count -= BLOCK_POINTS;
+                        continue;
+                    }
+
+                    var copyCount = Math.Min(BLOCK_POINTS - mPendingCount, count);
+                    Array.Copy(values, start, mPending, mPendingCount, copyCount);
+                    mPendingCount += copyCount;
+                    start += copyCount;
+                    count -= copyCount;
+
+                    if (mPendingCount == BLOCK_POINTS)
+                    {
+                        AddBlock(mPending, 0, BLOCK_POINTS);
+                        mPendingCount = 0;
+                    }
+                }
+            }
+
+            /// <summary>
+            /// Spectrum of every point appended so far
+            /// </summary>
+            /// <returns></returns>
+            public CompressedSpectrum ToSpectrum()
+            {
+                var blocks = new List<byte[]>(mBlocks);
+                var zeroBlocks = new List<bool>(mZeroBlocks);
+                var count = mCount;
+
+                if (mPendingCount > 0)
+                {
+                    blocks.Add(EncodeBlock(mPending, 0, mPendingCount, out var isZero));
+                    zeroBlocks.Add(isZero);
+                    count += mPendingCount;
+                }
+
+                return new CompressedSpectrum(blocks, zeroBlocks, count);
+            }
+
+            private void AddBlock(float[] values, int start, int count)
+            {
+                mBlocks.Add(EncodeBlock(values, start, count, out var isZero));
+                mZeroBlocks.Add(isZero);
+                mCount += count;
+            }
+        }
+    }
+}
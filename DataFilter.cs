@@ -1,5 +1,6 @@
 using System;
 using System.Collections.Generic;
+using System.Threading.Tasks;
 
 namespace DataFilter
 {
@@ -18,24 +19,56 @@ namespace DataFilter
     /// Also uses a .NET managed C++ wrapper written by Deep Jaitly to call the savgol function in the icr2ls32.dll file
     ///
     /// Matthew Monroe ported the C code to C# in September 2011, removing the need to use SAVGOL.dll or icr2ls32.dll
+    ///
+    /// Every filter also has a float[] overload that works on the data without widening it to double.
+    /// Accuracy of the float overloads versus the double versions, for the same input rounded to float:
+    ///   Savitzky Golay and moving average sum each window in float, so a point differs by at most
+    ///   about (window width + 1) * 6e-8 times the sum of |coefficient * value| over its window
+    ///   Butterworth keeps the filter state and the forward pass in double, so a point is the double result rounded to float
+    ///
+    /// Savitzky Golay and moving average also have overloads that take the x value of each point,
+    /// for spectra whose points are not evenly spaced
+    ///
+    /// Savitzky Golay plans and moving average also take a CompressedSpectrum, which they filter a block at a time
     /// </remarks>
     public class DataFilter
     {
-        const int BUTTERWORTH_FILTER_ORDER = 5;
+        /// <summary>
+        /// Points per tile when a filter is split across threads
+        /// </summary>
+        private const int PARALLEL_TILE_POINTS = 16384;
 
-        static double[,] AC;
-        static double[,] BC;
-        static bool mArraysInitialized;
+        /// <summary>
+        /// Filters go parallel once points times window width reaches this many multiply-adds
+        /// </summary>
+        private const long PARALLEL_MIN_WORK = 1L << 21;
 
-        // This function is a static function since GetButterworthCoefficientsFifthOrder is static
-        private static void AddCoeffs(int coeffIndex, int filterOrder, IReadOnlyList<double> newA, IReadOnlyList<double> newB)
-        {
-            for (var i = 0; i <= filterOrder; i++)
-            {
-                AC[coeffIndex, i] = newA[i];
-                BC[coeffIndex, i] = newB[i];
-            }
-        }
+        /// <summary>
+        /// Most threads a single filter call may use; 0 means one per processor, 1 forces the serial path
+        /// </summary>
+        public int MaxDegreeOfParallelism { get; set; }
+
+        /// <summary>
+        /// When true, filters skip the points whose window holds only exact zeros, as in thresholded profile data,
+        /// and write 0 for them; the results are the same as with the flag off
+        /// </summary>
+        /// <remarks>
+        /// The moving average and Savitzky Golay filters work in place, copying only the points near non-zero data.
+        /// With UseFFTConvolution, every FFT block that holds a non-zero window is convolved in full, since the FFT
+        /// rounds a point according to its whole block. The Butterworth filters skip a zero run once the filter
+        /// state has decayed to exactly 0, which is always true for leading zeros
+        /// </remarks>
+        public bool SkipZeroRuns { get; set; }
+
+        /// <summary>
+        /// When true, Savitzky Golay windows of 32 points or more are convolved by FFT on ranges long enough
+        /// for it to be faster; the default, false, keeps every filter on direct convolution
+        /// </summary>
+        /// <remarks>
+        /// The FFT results differ from direct convolution by rounding, about 1e-13 of the largest value in a window.
+        /// A range holding a NaN or infinity is always convolved directly, since the FFT would spread it through a whole block
+        /// </remarks>
+        public bool UseFFTConvolution { get; set; }
 
         /// <summary>
         /// Butterworth filter
@@ -59,7 +92,9 @@ namespace DataFilter
             // Define 5th order Butterworth filter
             //
 
-            GetButterworthCoefficientsFifthOrder(samplingFrequency, out var a, out var b);
+            var plan = ButterworthPlan.GetPlan(samplingFrequency);
+            var a = plan.FeedbackCoefficients;
+            var b = plan.FeedforwardCoefficients;
 
             if (zeroBased1DArray == null || zeroBased1DArray.Length <= 0)
                 return false;
@@ -93,9 +128,20 @@ namespace DataFilter
             var filteredData = new double[dataCount];
             for (var i = 0; i < dataCount; i++)
             {
+                if (SkipZeroRuns && tmpFilter[i] == 0 && IsFilterAtRest(tmpFilter, filteredData, i))
+                {
+                    // Zero in gives zero out until the next non-zero point; filteredData is already 0
+                    while (i + 1 < dataCount && tmpFilter[i + 1] == 0)
+                    {
+                        i++;
+                    }
+
+                    continue;
+                }
+
                 filteredData[i] = b[0] * tmpFilter[i];
 
-                for (var j = 1; j <= BUTTERWORTH_FILTER_ORDER; j++)
+                for (var j = 1; j <= ButterworthPlan.FILTER_ORDER; j++)
                 {
                     if (i - j >= 0)
                     {
@@ -114,8 +160,19 @@ namespace DataFilter
             filteredData = new double[dataCount];
             for (var i = 0; i < dataCount; i++)
             {
+                if (SkipZeroRuns && tmpFilter[i] == 0 && IsFilterAtRest(tmpFilter, filteredData, i))
+                {
+                    // Zero in gives zero out until the next non-zero point; filteredData is already 0
+                    while (i + 1 < dataCount && tmpFilter[i + 1] == 0)
+                    {
+                        i++;
+                    }
+
+                    continue;
+                }
+
                 filteredData[i] = b[0] * tmpFilter[i];
-                for (var j = 1; j <= BUTTERWORTH_FILTER_ORDER; j++)
+                for (var j = 1; j <= ButterworthPlan.FILTER_ORDER; j++)
                 {
                     if (i - j >= 0)
                     {
@@ -149,156 +206,50 @@ namespace DataFilter
         }
 
         /// <summary>
-        /// Store the Butterworth coefficients for a 5th order filter
+        /// True if the previous inputs and outputs of the Butterworth recurrence at point i are all 0
+        /// </summary>
+        private static bool IsFilterAtRest(double[] input, double[] output, int i)
+        {
+            for (var j = 1; j <= ButterworthPlan.FILTER_ORDER && i - j >= 0; j++)
+            {
+                if (input[i - j] != 0 || output[i - j] != 0)
+                    return false;
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Butterworth filter, float32 version
         /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
         /// <param name="samplingFrequency">
-        ///defines the cut-off frequency where 1.0 corresponds to half the sample rate
-        /// can be between 0.01 and 0.99
+        /// Defines the cut-off frequency where 1.0 corresponds to half the sample rate
+        /// Can be between 0.01 and 0.99
         /// </param>
-        /// <param name="a"></param>
-        /// <param name="b"></param>
         /// <returns></returns>
-        private static bool GetButterworthCoefficientsFifthOrder(double samplingFrequency, out double[] a, out double[] b)
-        {
-
-            const int FREQ_LEVEL_COUNT = 99;
-
-            a = new double[BUTTERWORTH_FILTER_ORDER + 1];
-            b = new double[BUTTERWORTH_FILTER_ORDER + 1];
-
-            if (!mArraysInitialized)
-            {
-                AC = new double[FREQ_LEVEL_COUNT, BUTTERWORTH_FILTER_ORDER + 1];
-                BC = new double[FREQ_LEVEL_COUNT, BUTTERWORTH_FILTER_ORDER + 1];
-
-                // The following define the filter coefficients for sample rates of 0.01 tfo 0.99, in steps of 0.01
-
-                AddCoeffs(0, BUTTERWORTH_FILTER_ORDER, new[] { 1, -4.8983, 9.5985, -9.4053, 4.6085, -0.90333 }, new[] { 0.00000000090929, 0.0000000045464, 0.0000000090929, 0.0000000090929, 0.0000000045464, 0.00000000090929 });
-                AddCoeffs(1, BUTTERWORTH_FILTER_ORDER, new[] { 1, -4.7967, 9.2072, -8.8404, 4.2458, -0.81598 }, new[] { 0.000000027689, 0.00000013844, 0.00000027689, 0.00000027689, 0.00000013844, 0.000000027689 });
-                AddCoeffs(2, BUTTERWORTH_FILTER_ORDER, new[] { 1, -4.695, 8.8261, -8.304, 3.9099, -0.73703 }, new[] { 0.00000020024, 0.0000010012, 0.0000020024, 0.0000020024, 0.0000010012, 0.00000020024 });
-                AddCoeffs(3, BUTTERWORTH_FILTER_ORDER, new[] { 1, -4.5934, 8.4551, -7.7949, 3.5989, -0.66565 }, new[] { 0.00000080424, 0.0000040212, 0.0000080424, 0.0000080424, 0.0000040212, 0.00000080424 });
-                AddCoeffs(4, BUTTERWORTH_FILTER_ORDER, new[] { 1, -4.4918, 8.0941, -7.3121, 3.311, -0.60112 }, new[] { 0.000002341, 0.000011705, 0.00002341, 0.00002341, 0.000011705, 0.000002341 });
-                AddCoeffs(5, BUTTERWORTH_FILTER_ORDER, new[] { 1, -4.3903, 7.7429, -6.8543, 3.0447, -0.54275 }, new[] { 0.0000055603, 0.000027802, 0.000055603, 0.000055603, 0.000027802, 0.0000055603 });
-                AddCoeffs(6, BUTTERWORTH_FILTER_ORDER, new[] { 1, -4.2888, 7.4015, -6.4207, 2.7983, -0.48996 }, new[] { 0.00001148, 0.000057401, 0.0001148, 0.0001148, 0.000057401, 0.00001148 });
-                AddCoeffs(7, BUTTERWORTH_FILTER_ORDER, new[] { 1, -4.1873, 7.0697, -6.01, 2.5704, -0.44221 }, new[] { 0.000021396, 0.00010698, 0.00021396, 0.00021396, 0.00010698, 0.000021396 });
-                AddCoeffs(8, BUTTERWORTH_FILTER_ORDER, new[] { 1, -4.0859, 6.7476, -5.6213, 2.3598, -0.39901 }, new[] { 0.000036884, 0.00018442, 0.00036884, 0.00036884, 0.00018442, 0.000036884 });
-                AddCoeffs(9, BUTTERWORTH_FILTER_ORDER, new[] { 1, -3.9845, 6.4349, -5.2536, 2.1651, -0.35993 }, new[] { 0.000059796, 0.00029898, 0.00059796, 0.00059796, 0.00029898, 0.000059796 });
-                AddCoeffs(10, BUTTERWORTH_FILTER_ORDER, new[] { 1, -3.8833, 6.1315, -4.9061, 1.9853, -0.32457 }, new[] { 0.000092253, 0.00046126, 0.00092253, 0.00092253, 0.00046126, 0.000092253 });
-                AddCoeffs(11, BUTTERWORTH_FILTER_ORDER, new[] { 1, -3.7821, 5.8375, -4.5777, 1.8193, -0.29258 }, new[] { 0.00013664, 0.00068318, 0.0013664, 0.0013664, 0.00068318, 0.00013664 });
-                AddCoeffs(12, BUTTERWORTH_FILTER_ORDER, new[] { 1, -3.6809, 5.5526, -4.2678, 1.666, -0.26365 }, new[] { 0.00019557, 0.00097786, 0.0019557, 0.0019557, 0.00097786, 0.00019557 });
-                AddCoeffs(13, BUTTERWORTH_FILTER_ORDER, new[] { 1, -3.5799, 5.2767, -3.9753, 1.5246, -0.23747 }, new[] { 0.00027193, 0.0013596, 0.0027193, 0.0027193, 0.0013596, 0.00027193 });
-                AddCoeffs(14, BUTTERWORTH_FILTER_ORDER, new[] { 1, -3.4789, 5.0098, -3.6995, 1.3942, -0.2138 }, new[] { 0.00036878, 0.0018439, 0.0036878, 0.0036878, 0.0018439, 0.00036878 });
-                AddCoeffs(15, BUTTERWORTH_FILTER_ORDER, new[] { 1, -3.378, 4.7518, -3.4397, 1.274, -0.19239 }, new[] { 0.00048944, 0.0024472, 0.0048944, 0.0048944, 0.0024472, 0.00048944 });
-                AddCoeffs(16, BUTTERWORTH_FILTER_ORDER, new[] { 1, -3.2772, 4.5025, -3.1951, 1.1633, -0.17303 }, new[] { 0.00063738, 0.0031869, 0.0063738, 0.0063738, 0.0031869, 0.00063738 });
-                AddCoeffs(17, BUTTERWORTH_FILTER_ORDER, new[] { 1, -3.1765, 4.2618, -2.9649, 1.0613, -0.15553 }, new[] { 0.00081629, 0.0040814, 0.0081629, 0.0081629, 0.0040814, 0.00081629 });
-                AddCoeffs(18, BUTTERWORTH_FILTER_ORDER, new[] { 1, -3.0759, 4.0297, -2.7485, 0.96744, -0.13972 }, new[] { 0.00103, 0.0051501, 0.0103, 0.0103, 0.0051501, 0.00103 });
-                AddCoeffs(19, BUTTERWORTH_FILTER_ORDER, new[] { 1, -2.9754, 3.806, -2.5453, 0.88113, -0.12543 }, new[] { 0.0012826, 0.0064129, 0.012826, 0.012826, 0.0064129, 0.0012826 });
-                AddCoeffs(20, BUTTERWORTH_FILTER_ORDER, new[] { 1, -2.875, 3.5907, -2.3544, 0.80179, -0.11253 }, new[] { 0.0015782, 0.0078908, 0.015782, 0.015782, 0.0078908, 0.0015782 });
-                AddCoeffs(21, BUTTERWORTH_FILTER_ORDER, new[] { 1, -2.7747, 3.3836, -2.1755, 0.72892, -0.10087 }, new[] { 0.0019211, 0.0096054, 0.019211, 0.019211, 0.0096054, 0.0019211 });
-                AddCoeffs(22, BUTTERWORTH_FILTER_ORDER, new[] { 1, -2.6745, 3.1847, -2.0078, 0.66202, -0.090358 }, new[] { 0.0023158, 0.011579, 0.023158, 0.023158, 0.011579, 0.0023158 });
-                AddCoeffs(23, BUTTERWORTH_FILTER_ORDER, new[] { 1, -2.5744, 2.9939, -1.8507, 0.60067, -0.080871 }, new[] { 0.0027669, 0.013835, 0.027669, 0.027669, 0.013835, 0.0027669 });
-                AddCoeffs(24, BUTTERWORTH_FILTER_ORDER, new[] { 1, -2.4744, 2.811, -1.7038, 0.54443, -0.072316 }, new[] { 0.0032792, 0.016396, 0.032792, 0.032792, 0.016396, 0.0032792 });
-                AddCoeffs(25, BUTTERWORTH_FILTER_ORDER, new[] { 1, -2.3745, 2.636, -1.5664, 0.49294, -0.064605 }, new[] { 0.0038575, 0.019288, 0.038575, 0.038575, 0.019288, 0.0038575 });
-                AddCoeffs(26, BUTTERWORTH_FILTER_ORDER, new[] { 1, -2.2747, 2.4689, -1.4381, 0.44583, -0.057658 }, new[] { 0.0045069, 0.022534, 0.045069, 0.045069, 0.022534, 0.0045069 });
-                AddCoeffs(27, BUTTERWORTH_FILTER_ORDER, new[] { 1, -2.175, 2.3095, -1.3184, 0.40277, -0.051402 }, new[] { 0.0052324, 0.026162, 0.052324, 0.052324, 0.026162, 0.0052324 });
-                AddCoeffs(28, BUTTERWORTH_FILTER_ORDER, new[] { 1, -2.0754, 2.1577, -1.2067, 0.36346, -0.045773 }, new[] { 0.0060394, 0.030197, 0.060394, 0.060394, 0.030197, 0.0060394 });
-                AddCoeffs(29, BUTTERWORTH_FILTER_ORDER, new[] { 1, -1.9759, 2.0135, -1.1026, 0.32762, -0.040709 }, new[] { 0.0069332, 0.034666, 0.069332, 0.069332, 0.034666, 0.0069332 });
-                AddCoeffs(30, BUTTERWORTH_FILTER_ORDER, new[] { 1, -1.8765, 1.8768, -1.0057, 0.29498, -0.036157 }, new[] { 0.0079194, 0.039597, 0.079194, 0.079194, 0.039597, 0.0079194 });
-                AddCoeffs(31, BUTTERWORTH_FILTER_ORDER, new[] { 1, -1.7772, 1.7475, -0.91547, 0.2653, -0.032066 }, new[] { 0.0090036, 0.045018, 0.090036, 0.090036, 0.045018, 0.0090036 });
-                AddCoeffs(32, BUTTERWORTH_FILTER_ORDER, new[] { 1, -1.6779, 1.6256, -0.83154, 0.23836, -0.028392 }, new[] { 0.010192, 0.050959, 0.10192, 0.10192, 0.050959, 0.010192 });
-                AddCoeffs(33, BUTTERWORTH_FILTER_ORDER, new[] { 1, -1.5788, 1.511, -0.75347, 0.21395, -0.025092 }, new[] { 0.01149, 0.057449, 0.1149, 0.1149, 0.057449, 0.01149 });
-                AddCoeffs(34, BUTTERWORTH_FILTER_ORDER, new[] { 1, -1.4797, 1.4037, -0.68086, 0.19188, -0.02213 }, new[] { 0.012904, 0.064518, 0.12904, 0.12904, 0.064518, 0.012904 });
-                AddCoeffs(35, BUTTERWORTH_FILTER_ORDER, new[] { 1, -1.3807, 1.3035, -0.61332, 0.17199, -0.01947 }, new[] { 0.01444, 0.0722, 0.1444, 0.1444, 0.0722, 0.01444 });
-                AddCoeffs(36, BUTTERWORTH_FILTER_ORDER, new[] { 1, -1.2817, 1.2105, -0.55047, 0.15411, -0.017082 }, new[] { 0.016105, 0.080524, 0.16105, 0.16105, 0.080524, 0.016105 });
-                AddCoeffs(37, BUTTERWORTH_FILTER_ORDER, new[] { 1, -1.1829, 1.1246, -0.49193, 0.1381, -0.014935 }, new[] { 0.017905, 0.089526, 0.17905, 0.17905, 0.089526, 0.017905 });
-                AddCoeffs(38, BUTTERWORTH_FILTER_ORDER, new[] { 1, -1.0841, 1.0457, -0.43735, 0.12382, -0.013004 }, new[] { 0.019848, 0.099239, 0.19848, 0.19848, 0.099239, 0.019848 });
-                AddCoeffs(39, BUTTERWORTH_FILTER_ORDER, new[] { 1, -0.98533, 0.97385, -0.38636, 0.11116, -0.011264 }, new[] { 0.02194, 0.1097, 0.2194, 0.2194, 0.1097, 0.02194 });
-                AddCoeffs(40, BUTTERWORTH_FILTER_ORDER, new[] { 1, -0.88664, 0.90893, -0.33861, 0.10002, -0.0096912 }, new[] { 0.024188, 0.12094, 0.24188, 0.24188, 0.12094, 0.024188 });
-                AddCoeffs(41, BUTTERWORTH_FILTER_ORDER, new[] { 1, -0.788, 0.85095, -0.29377, 0.090295, -0.0082657 }, new[] { 0.0266, 0.133, 0.266, 0.266, 0.133, 0.0266 });
-                AddCoeffs(42, BUTTERWORTH_FILTER_ORDER, new[] { 1, -0.6894, 0.79985, -0.25149, 0.081905, -0.0069673 }, new[] { 0.029184, 0.14592, 0.29184, 0.29184, 0.14592, 0.029184 });
-                AddCoeffs(43, BUTTERWORTH_FILTER_ORDER, new[] { 1, -0.59084, 0.75563, -0.21145, 0.074777, -0.0057777 }, new[] { 0.031948, 0.15974, 0.31948, 0.31948, 0.15974, 0.031948 });
-                AddCoeffs(44, BUTTERWORTH_FILTER_ORDER, new[] { 1, -0.49232, 0.71825, -0.17331, 0.068849, -0.0046793 }, new[] { 0.0349, 0.1745, 0.349, 0.349, 0.1745, 0.0349 });
-                AddCoeffs(45, BUTTERWORTH_FILTER_ORDER, new[] { 1, -0.39382, 0.6877, -0.13676, 0.06407, -0.0036557 }, new[] { 0.038048, 0.19024, 0.38048, 0.38048, 0.19024, 0.038048 });
-                AddCoeffs(46, BUTTERWORTH_FILTER_ORDER, new[] { 1, -0.29534, 0.66395, -0.10147, 0.060396, -0.0026909 }, new[] { 0.041401, 0.20701, 0.41401, 0.41401, 0.20701, 0.041401 });
-                AddCoeffs(47, BUTTERWORTH_FILTER_ORDER, new[] { 1, -0.19689, 0.64699, -0.067122, 0.057795, -0.0017699 }, new[] { 0.044969, 0.22485, 0.44969, 0.44969, 0.22485, 0.044969 });
-                AddCoeffs(48, BUTTERWORTH_FILTER_ORDER, new[] { 1, -0.098441, 0.63683, -0.033404, 0.056244, -0.00087777 }, new[] { 0.048761, 0.2438, 0.48761, 0.48761, 0.2438, 0.048761 });
-                AddCoeffs(49, BUTTERWORTH_FILTER_ORDER, new[] { 1, -0.00000000000000046491, 0.63344, -0.00000000000000020438, 0.055728, -3.0935E-18 }, new[] { 0.052786, 0.26393, 0.52786, 0.52786, 0.26393, 0.052786 });
-                AddCoeffs(50, BUTTERWORTH_FILTER_ORDER, new[] { 1, 0.098441, 0.63683, 0.033404, 0.056244, 0.00087777 }, new[] { 0.057056, 0.28528, 0.57056, 0.57056, 0.28528, 0.057056 });
-                AddCoeffs(51, BUTTERWORTH_FILTER_ORDER, new[] { 1, 0.19689, 0.64699, 0.067122, 0.057795, 0.0017699 }, new[] { 0.06158, 0.3079, 0.6158, 0.6158, 0.3079, 0.06158 });
-                AddCoeffs(52, BUTTERWORTH_FILTER_ORDER, new[] { 1, 0.29534, 0.66395, 0.10147, 0.060396, 0.0026909 }, new[] { 0.06637, 0.33185, 0.6637, 0.6637, 0.33185, 0.06637 });
-                AddCoeffs(53, BUTTERWORTH_FILTER_ORDER, new[] { 1, 0.39382, 0.6877, 0.13676, 0.06407, 0.0036557 }, new[] { 0.071437, 0.35719, 0.71437, 0.71437, 0.35719, 0.071437 });
-                AddCoeffs(54, BUTTERWORTH_FILTER_ORDER, new[] { 1, 0.49232, 0.71825, 0.17331, 0.068849, 0.0046793 }, new[] { 0.076794, 0.38397, 0.76794, 0.76794, 0.38397, 0.076794 });
-                AddCoeffs(55, BUTTERWORTH_FILTER_ORDER, new[] { 1, 0.59084, 0.75563, 0.21145, 0.074777, 0.0057777 }, new[] { 0.082452, 0.41226, 0.82452, 0.82452, 0.41226, 0.082452 });
-                AddCoeffs(56, BUTTERWORTH_FILTER_ORDER, new[] { 1, 0.6894, 0.79985, 0.25149, 0.081905, 0.0069673 }, new[] { 0.088426, 0.44213, 0.88426, 0.88426, 0.44213, 0.088426 });
-                AddCoeffs(57, BUTTERWORTH_FILTER_ORDER, new[] { 1, 0.788, 0.85095, 0.29377, 0.090295, 0.0082657 }, new[] { 0.094727, 0.47364, 0.94727, 0.94727, 0.47364, 0.094727 });
-                AddCoeffs(58, BUTTERWORTH_FILTER_ORDER, new[] { 1, 0.88664, 0.90893, 0.33861, 0.10002, 0.0096912 }, new[] { 0.10137, 0.50686, 1.0137, 1.0137, 0.50686, 0.10137 });
-                AddCoeffs(59, BUTTERWORTH_FILTER_ORDER, new[] { 1, 0.98533, 0.97385, 0.38636, 0.11116, 0.011264 }, new[] { 0.10837, 0.54187, 1.0837, 1.0837, 0.54187, 0.10837 });
-                AddCoeffs(60, BUTTERWORTH_FILTER_ORDER, new[] { 1, 1.0841, 1.0457, 0.43735, 0.12382, 0.013004 }, new[] { 0.11575, 0.57874, 1.1575, 1.1575, 0.57874, 0.11575 });
-                AddCoeffs(61, BUTTERWORTH_FILTER_ORDER, new[] { 1, 1.1829, 1.1246, 0.49193, 0.1381, 0.014935 }, new[] { 0.12351, 0.61757, 1.2351, 1.2351, 0.61757, 0.12351 });
-                AddCoeffs(62, BUTTERWORTH_FILTER_ORDER, new[] { 1, 1.2817, 1.2105, 0.55047, 0.15411, 0.017082 }, new[] { 0.13169, 0.65843, 1.3169, 1.3169, 0.65843, 0.13169 });
-                AddCoeffs(63, BUTTERWORTH_FILTER_ORDER, new[] { 1, 1.3807, 1.3035, 0.61332, 0.17199, 0.01947 }, new[] { 0.14028, 0.7014, 1.4028, 1.4028, 0.7014, 0.14028 });
-                AddCoeffs(64, BUTTERWORTH_FILTER_ORDER, new[] { 1, 1.4797, 1.4037, 0.68086, 0.19188, 0.02213 }, new[] { 0.14932, 0.7466, 1.4932, 1.4932, 0.7466, 0.14932 });
-                AddCoeffs(65, BUTTERWORTH_FILTER_ORDER, new[] { 1, 1.5788, 1.511, 0.75347, 0.21395, 0.025092 }, new[] { 0.15882, 0.79411, 1.5882, 1.5882, 0.79411, 0.15882 });
-                AddCoeffs(66, BUTTERWORTH_FILTER_ORDER, new[] { 1, 1.6779, 1.6256, 0.83154, 0.23836, 0.028392 }, new[] { 0.16881, 0.84403, 1.6881, 1.6881, 0.84403, 0.16881 });
-                AddCoeffs(67, BUTTERWORTH_FILTER_ORDER, new[] { 1, 1.7772, 1.7475, 0.91547, 0.2653, 0.032066 }, new[] { 0.1793, 0.89649, 1.793, 1.793, 0.89649, 0.1793 });
-                AddCoeffs(68, BUTTERWORTH_FILTER_ORDER, new[] { 1, 1.8765, 1.8768, 1.0057, 0.29498, 0.036157 }, new[] { 0.19032, 0.95158, 1.9032, 1.9032, 0.95158, 0.19032 });
-                AddCoeffs(69, BUTTERWORTH_FILTER_ORDER, new[] { 1, 1.9759, 2.0135, 1.1026, 0.32762, 0.040709 }, new[] { 0.20189, 1.0094, 2.0189, 2.0189, 1.0094, 0.20189 });
-                AddCoeffs(70, BUTTERWORTH_FILTER_ORDER, new[] { 1, 2.0754, 2.1577, 1.2067, 0.36346, 0.045773 }, new[] { 0.21403, 1.0702, 2.1403, 2.1403, 1.0702, 0.21403 });
-                AddCoeffs(71, BUTTERWORTH_FILTER_ORDER, new[] { 1, 2.175, 2.3095, 1.3184, 0.40277, 0.051402 }, new[] { 0.22678, 1.1339, 2.2678, 2.2678, 1.1339, 0.22678 });
-                AddCoeffs(72, BUTTERWORTH_FILTER_ORDER, new[] { 1, 2.2747, 2.4689, 1.4381, 0.44583, 0.057658 }, new[] { 0.24016, 1.2008, 2.4016, 2.4016, 1.2008, 0.24016 });
-                AddCoeffs(73, BUTTERWORTH_FILTER_ORDER, new[] { 1, 2.3745, 2.636, 1.5664, 0.49294, 0.064605 }, new[] { 0.2542, 1.271, 2.542, 2.542, 1.271, 0.2542 });
-                AddCoeffs(74, BUTTERWORTH_FILTER_ORDER, new[] { 1, 2.4744, 2.811, 1.7038, 0.54443, 0.072316 }, new[] { 0.26894, 1.3447, 2.6894, 2.6894, 1.3447, 0.26894 });
-                AddCoeffs(75, BUTTERWORTH_FILTER_ORDER, new[] { 1, 2.5744, 2.9939, 1.8507, 0.60067, 0.080871 }, new[] { 0.28439, 1.422, 2.8439, 2.8439, 1.422, 0.28439 });
-                AddCoeffs(76, BUTTERWORTH_FILTER_ORDER, new[] { 1, 2.6745, 3.1847, 2.0078, 0.66202, 0.090358 }, new[] { 0.30061, 1.503, 3.0061, 3.0061, 1.503, 0.30061 });
-                AddCoeffs(77, BUTTERWORTH_FILTER_ORDER, new[] { 1, 2.7747, 3.3836, 2.1755, 0.72892, 0.10087 }, new[] { 0.31761, 1.5881, 3.1761, 3.1761, 1.5881, 0.31761 });
-                AddCoeffs(78, BUTTERWORTH_FILTER_ORDER, new[] { 1, 2.875, 3.5907, 2.3544, 0.80179, 0.11253 }, new[] { 0.33545, 1.6773, 3.3545, 3.3545, 1.6773, 0.33545 });
-                AddCoeffs(79, BUTTERWORTH_FILTER_ORDER, new[] { 1, 2.9754, 3.806, 2.5453, 0.88113, 0.12543 }, new[] { 0.35416, 1.7708, 3.5416, 3.5416, 1.7708, 0.35416 });
-                AddCoeffs(80, BUTTERWORTH_FILTER_ORDER, new[] { 1, 3.0759, 4.0297, 2.7485, 0.96744, 0.13972 }, new[] { 0.37379, 1.869, 3.7379, 3.7379, 1.869, 0.37379 });
-                AddCoeffs(81, BUTTERWORTH_FILTER_ORDER, new[] { 1, 3.1765, 4.2618, 2.9649, 1.0613, 0.15553 }, new[] { 0.39438, 1.9719, 3.9438, 3.9438, 1.9719, 0.39438 });
-                AddCoeffs(82, BUTTERWORTH_FILTER_ORDER, new[] { 1, 3.2772, 4.5025, 3.1951, 1.1633, 0.17303 }, new[] { 0.41597, 2.0799, 4.1597, 4.1597, 2.0799, 0.41597 });
-                AddCoeffs(83, BUTTERWORTH_FILTER_ORDER, new[] { 1, 3.378, 4.7518, 3.4397, 1.274, 0.19239 }, new[] { 0.43862, 2.1931, 4.3862, 4.3862, 2.1931, 0.43862 });
-                AddCoeffs(84, BUTTERWORTH_FILTER_ORDER, new[] { 1, 3.4789, 5.0098, 3.6995, 1.3942, 0.2138 }, new[] { 0.46238, 2.3119, 4.6238, 4.6238, 2.3119, 0.46238 });
-                AddCoeffs(85, BUTTERWORTH_FILTER_ORDER, new[] { 1, 3.5799, 5.2767, 3.9753, 1.5246, 0.23747 }, new[] { 0.48731, 2.4366, 4.8731, 4.8731, 2.4366, 0.48731 });
-                AddCoeffs(86, BUTTERWORTH_FILTER_ORDER, new[] { 1, 3.6809, 5.5526, 4.2678, 1.666, 0.26365 }, new[] { 0.51347, 2.5673, 5.1347, 5.1347, 2.5673, 0.51347 });
-                AddCoeffs(87, BUTTERWORTH_FILTER_ORDER, new[] { 1, 3.7821, 5.8375, 4.5777, 1.8193, 0.29258 }, new[] { 0.54091, 2.7046, 5.4091, 5.4091, 2.7046, 0.54091 });
-                AddCoeffs(88, BUTTERWORTH_FILTER_ORDER, new[] { 1, 3.8833, 6.1315, 4.9061, 1.9853, 0.32457 }, new[] { 0.56971, 2.8486, 5.6971, 5.6971, 2.8486, 0.56971 });
-                AddCoeffs(89, BUTTERWORTH_FILTER_ORDER, new[] { 1, 3.9845, 6.4349, 5.2536, 2.1651, 0.35993 }, new[] { 0.59994, 2.9997, 5.9994, 5.9994, 2.9997, 0.59994 });
-                AddCoeffs(90, BUTTERWORTH_FILTER_ORDER, new[] { 1, 4.0859, 6.7476, 5.6213, 2.3598, 0.39901 }, new[] { 0.63167, 3.1584, 6.3167, 6.3167, 3.1584, 0.63167 });
-                AddCoeffs(91, BUTTERWORTH_FILTER_ORDER, new[] { 1, 4.1873, 7.0697, 6.01, 2.5704, 0.44221 }, new[] { 0.66499, 3.3249, 6.6499, 6.6499, 3.3249, 0.66499 });
-                AddCoeffs(92, BUTTERWORTH_FILTER_ORDER, new[] { 1, 4.2888, 7.4015, 6.4207, 2.7983, 0.48996 }, new[] { 0.69997, 3.4999, 6.9997, 6.9997, 3.4999, 0.69997 });
-                AddCoeffs(93, BUTTERWORTH_FILTER_ORDER, new[] { 1, 4.3903, 7.7429, 6.8543, 3.0447, 0.54275 }, new[] { 0.73672, 3.6836, 7.3672, 7.3672, 3.6836, 0.73672 });
-                AddCoeffs(94, BUTTERWORTH_FILTER_ORDER, new[] { 1, 4.4918, 8.0941, 7.3121, 3.311, 0.60112 }, new[] { 0.77532, 3.8766, 7.7532, 7.7532, 3.8766, 0.77532 });
-                AddCoeffs(95, BUTTERWORTH_FILTER_ORDER, new[] { 1, 4.5934, 8.4551, 7.7949, 3.5989, 0.66565 }, new[] { 0.81588, 4.0794, 8.1588, 8.1588, 4.0794, 0.81588 });
-                AddCoeffs(96, BUTTERWORTH_FILTER_ORDER, new[] { 1, 4.695, 8.8261, 8.304, 3.9099, 0.73703 }, new[] { 0.8585, 4.2925, 8.585, 8.585, 4.2925, 0.8585 });
-                AddCoeffs(97, BUTTERWORTH_FILTER_ORDER, new[] { 1, 4.7967, 9.2072, 8.8404, 4.2458, 0.81598 }, new[] { 0.90331, 4.5166, 9.0331, 9.0331, 4.5166, 0.90331 });
-                AddCoeffs(98, BUTTERWORTH_FILTER_ORDER, new[] { 1, 4.8983, 9.5985, 9.4053, 4.6085, 0.90333 }, new[] { 0.95044, 4.7522, 9.5044, 9.5044, 4.7522, 0.95044 });
-
-                mArraysInitialized = true;
-            }
-
-            var coeffIndex = (int)(samplingFrequency * 100) - 1;
-            if (coeffIndex < 0)
-                coeffIndex = 4;
-
-            if (coeffIndex > 98)
-                coeffIndex = 94;
+        /// <remarks>Filters in place, buffering only the forward pass in double; see the class remarks for the accuracy versus the double version</remarks>
+        public bool ButterworthFilter(float[] zeroBased1DArray, int indexStart, int indexEnd, double samplingFrequency = 0.25)
+        {
+            var plan = ButterworthPlan.GetPlan(samplingFrequency);
 
-            try
-            {
-                for (var i = 0; i <= BUTTERWORTH_FILTER_ORDER; i++)
-                {
-                    a[i] = AC[coeffIndex, i];
-                    b[i] = BC[coeffIndex, i];
-                }
+            if (zeroBased1DArray == null || zeroBased1DArray.Length <= 0)
+                return false;
 
-                return true;
-            }
-            catch (Exception ex)
+            // Filter the whole array unless indexStart and indexEnd define a valid range
+            if (indexStart < 0 ||
+                indexEnd < 0 ||
+                indexEnd < indexStart)
             {
-                Console.WriteLine("Error in GetButterworthCoefficientsFifthOrder: " + ex.Message);
-                return false;
+                indexStart = 0;
+                indexEnd = zeroBased1DArray.Length - 1;
             }
 
+            global::DataFilter.ButterworthFilter.FilterInPlace(zeroBased1DArray, indexStart, indexEnd, plan, SkipZeroRuns);
+
+            return true;
         }
 
         /// <summary>
@@ -317,25 +268,7 @@ namespace DataFilter
             int windowWidthPoints,
             out string errorMessage)
         {
-            int numPointsLeft;
-            int numPointsRight;
-
-            // Define the distance to examine left and right of each point
-            if (windowWidthPoints < 3)
-                windowWidthPoints = 3;
-
-            if (windowWidthPoints % 2 == 0)
-            {
-                // Even number of points
-                numPointsLeft = windowWidthPoints / 2;
-                numPointsRight = numPointsLeft - 1;
-            }
-            else
-            {
-                // Odd Number of points
-                numPointsLeft = (int)(Math.Floor(windowWidthPoints / 2.0));
-                numPointsRight = numPointsLeft;
-            }
+            GetMovingWindowExtent(windowWidthPoints, out var numPointsLeft, out var numPointsRight);
 
             // const bool USE_SAVITZKY_GOLAY = false;
             // if (USE_SAVITZKY_GOLAY)
@@ -347,28 +280,74 @@ namespace DataFilter
 
             try
             {
+                // Points with a full window go through the kernel for this width;
+                // the window is cut off at indexStart and indexEnd for the rest
+                var windowWidth = numPointsLeft + numPointsRight + 1;
+                var firstFull = indexStart + numPointsLeft;
+                var lastFull = indexEnd - numPointsRight;
+                var kernel = SmoothingKernels.GetMovingAverageKernel(windowWidth);
+
+                if (SkipZeroRuns)
+                {
+                    // Filter in place, copying only the non-zero neighbourhoods; the cut-off windows are averaged first
+                    var headEnd = Math.Min(firstFull - 1, indexEnd);
+                    var tailStart = Math.Max(lastFull + 1, headEnd + 1);
+                    var head = GetCutOffAverages(zeroBased1DArray, indexStart, indexEnd, numPointsLeft, numPointsRight, indexStart, headEnd);
+                    var tail = GetCutOffAverages(zeroBased1DArray, indexStart, indexEnd, numPointsLeft, numPointsRight, tailStart, indexEnd);
+
+                    if (firstFull <= lastFull)
+                    {
+                        ZeroRuns.FilterNonZeroWindows(
+                            zeroBased1DArray, zeroBased1DArray, firstFull, lastFull, numPointsLeft, windowWidth, 1,
+                            processTile => ProcessTiles(firstFull, lastFull, windowWidth, processTile),
+                            (input, output, rangeFirst, rangeLast) => kernel(input, output, rangeFirst, rangeLast, numPointsLeft, windowWidth));
+                    }
+
+                    head.CopyTo(zeroBased1DArray, indexStart);
+                    tail.CopyTo(zeroBased1DArray, tailStart);
+
+                    errorMessage = string.Empty;
+                    return true;
+                }
+
                 var smoothedData = new double[zeroBased1DArray.Length];
                 zeroBased1DArray.CopyTo(smoothedData, 0);
 
-                for (var currentIndex = indexStart; currentIndex <= indexEnd; currentIndex++)
+                ProcessTiles(indexStart, indexEnd, windowWidth, (tileStart, tileEnd) =>
                 {
-                    var start = currentIndex - numPointsLeft;
-                    var end = currentIndex + numPointsRight;
-                    if (start < indexStart)
-                        start = indexStart;
-
-                    if (end > indexEnd)
-                        end = indexEnd;
-
-                    double total = 0;
-                    for (var i = start; i <= end; i++)
+                    var fullStart = Math.Max(tileStart, firstFull);
+                    var fullEnd = Math.Min(tileEnd, lastFull);
+                    if (fullStart <= fullEnd)
                     {
-                        total += zeroBased1DArray[i];
+                        kernel(zeroBased1DArray, smoothedData, fullStart, fullEnd, numPointsLeft, windowWidth);
                     }
 
-                    smoothedData[currentIndex] = total / (end - start + 1);
+                    for (var currentIndex = tileStart; currentIndex <= tileEnd; currentIndex++)
+                    {
+                        if (currentIndex >= firstFull && currentIndex <= lastFull)
+                        {
+                            currentIndex = fullEnd;
+                            continue;
+                        }
 
-                }
+                        var start = currentIndex - numPointsLeft;
+                        var end = currentIndex + numPointsRight;
+                        if (start < indexStart)
+                            start = indexStart;
+
+                        if (end > indexEnd)
+                            end = indexEnd;
+
+                        double total = 0;
+                        for (var i = start; i <= end; i++)
+                        {
+                            total += zeroBased1DArray[i];
+                        }
+
+                        smoothedData[currentIndex] = total / (end - start + 1);
+
+                    }
+                });
 
                 // Copy the smoothed data back into zeroBased1DArray
                 smoothedData.CopyTo(zeroBased1DArray, 0);
@@ -378,166 +357,1524 @@ namespace DataFilter
             }
             catch (Exception ex)
             {
-                errorMessage = "Error in MovingWindowAverage: " + ex.Message;
+                errorMessage = "Error in MovingWindowAverage: " + GetExceptionMessage(ex);
                 return false;
             }
         }
 
         /// <summary>
-        /// Savitzky Golay Filter
+        /// Moving window average filter, float32 version
         /// </summary>
         /// <param name="zeroBased1DArray"></param>
         /// <param name="indexStart"></param>
         /// <param name="indexEnd"></param>
-        /// <param name="numPointsLeft">Should normally be equivalent to numPointsRight, and is usually an odd number like 3, 5, 7, etc.</param>
-        /// <param name="numPointsRight"></param>
-        /// <param name="polynomialDegree">Normally 2 or 4; if polynomialDegree is odd, it is actually decremented by 1 to give an even number</param>
+        /// <param name="windowWidthPoints"></param>
         /// <param name="errorMessage"></param>
-        /// <param name="correctIntensityValues">When true, a correction factor of 1.6 is applied to the smoothed data points</param>
-        /// <returns>True if success, False if error</returns>
-        /// <remarks>
-        /// A Polynomial Degree of 0 will result in behavior identical to a moving average filter
-        ///
-        /// When using a polynomial degree above 0, the smoothed intensity values are lower than the input values
-        ///
-        /// Example call:
-        /// objFilter.SavitzkyGolayFilter(dblData, 0, dataCount-1, 3, 3, 4, out var errorMessage)
-        /// </remarks>
-        public bool SavitzkyGolayFilter(
-            double[] zeroBased1DArray,
+        /// <returns></returns>
+        /// <remarks>Window sums are accumulated in float; see the class remarks for the accuracy versus the double version</remarks>
+        public bool MovingWindowAverage(
+            float[] zeroBased1DArray,
             int indexStart,
             int indexEnd,
-            int numPointsLeft,
-            int numPointsRight,
-            short polynomialDegree,
-            out string errorMessage,
-            bool correctIntensityValues = true)
+            int windowWidthPoints,
+            out string errorMessage)
         {
+            GetMovingWindowExtent(windowWidthPoints, out var numPointsLeft, out var numPointsRight);
 
-            if (numPointsLeft < 1 || numPointsRight < 1)
+            try
             {
-                errorMessage = "numPointsLeft and numPointsRight should be >= 1";
-                return false;
-            }
+                // Points with a full window go through the kernel for this width;
+                // the window is cut off at indexStart and indexEnd for the rest
+                var windowWidth = numPointsLeft + numPointsRight + 1;
+                var firstFull = indexStart + numPointsLeft;
+                var lastFull = indexEnd - numPointsRight;
+                var kernel = SmoothingKernels.GetMovingAverageKernelFloat(windowWidth);
+
+                if (SkipZeroRuns)
+                {
+                    // Filter in place, copying only the non-zero neighbourhoods; the cut-off windows are averaged first
+                    var headEnd = Math.Min(firstFull - 1, indexEnd);
+                    var tailStart = Math.Max(lastFull + 1, headEnd + 1);
+                    var head = GetCutOffAverages(zeroBased1DArray, indexStart, indexEnd, numPointsLeft, numPointsRight, indexStart, headEnd);
+                    var tail = GetCutOffAverages(zeroBased1DArray, indexStart, indexEnd, numPointsLeft, numPointsRight, tailStart, indexEnd);
 
-            if (polynomialDegree % 2 == 1)
-            {
-                polynomialDegree -= 1;
-            }
+                    if (firstFull <= lastFull)
+                    {
+                        ZeroRuns.FilterNonZeroWindows(
+                            zeroBased1DArray, zeroBased1DArray, firstFull, lastFull, numPointsLeft, windowWidth, 1,
+                            processTile => ProcessTiles(firstFull, lastFull, windowWidth, processTile),
+                            (input, output, rangeFirst, rangeLast) => kernel(input, output, rangeFirst, rangeLast, numPointsLeft, windowWidth));
+                    }
 
-            if (polynomialDegree < 0)
-                polynomialDegree = 0;
+                    head.CopyTo(zeroBased1DArray, indexStart);
+                    tail.CopyTo(zeroBased1DArray, tailStart);
 
-            while (numPointsLeft + numPointsRight < polynomialDegree && polynomialDegree > 1)
-            {
-                // Decrement the polynomialDegree by 2
-                polynomialDegree -= 2;
-            }
+                    errorMessage = string.Empty;
+                    return true;
+                }
 
-            // if (numPointsLeft + numPointsRight < polynomialDegree)
-            // {
-            //     errorMessage = "numPointsLeft + numPointsRight should be >= polynomialDegree";
-            //     return false;
-            // }
+                var smoothedData = new float[zeroBased1DArray.Length];
+                zeroBased1DArray.CopyTo(smoothedData, 0);
 
-            var numPointsTotal = numPointsLeft + numPointsRight + 1;
-            var c = new double[numPointsTotal + 1];
+                ProcessTiles(indexStart, indexEnd, windowWidth, (tileStart, tileEnd) =>
+                {
+                    var fullStart = Math.Max(tileStart, firstFull);
+                    var fullEnd = Math.Min(tileEnd, lastFull);
+                    if (fullStart <= fullEnd)
+                    {
+                        kernel(zeroBased1DArray, smoothedData, fullStart, fullEnd, numPointsLeft, windowWidth);
+                    }
 
-            var objSavGol = new NRSavGol();
-            objSavGol.savgol(c, numPointsTotal, numPointsLeft, numPointsRight, 0, polynomialDegree);
+                    for (var currentIndex = tileStart; currentIndex <= tileEnd; currentIndex++)
+                    {
+                        if (currentIndex >= firstFull && currentIndex <= lastFull)
+                        {
+                            currentIndex = fullEnd;
+                            continue;
+                        }
 
-            // now un wrap the coefficients ...
-            var n = numPointsRight * 2;
-            if (numPointsLeft > numPointsRight)
+                        var start = currentIndex - numPointsLeft;
+                        var end = currentIndex + numPointsRight;
+                        if (start < indexStart)
+                            start = indexStart;
+
+                        if (end > indexEnd)
+                            end = indexEnd;
+
+                        float total = 0;
+                        for (var i = start; i <= end; i++)
+                        {
+                            total += zeroBased1DArray[i];
+                        }
+
+                        smoothedData[currentIndex] = total / (end - start + 1);
+
+                    }
+                });
+
+                smoothedData.CopyTo(zeroBased1DArray, 0);
+
+                errorMessage = string.Empty;
+                return true;
+            }
+            catch (Exception ex)
             {
-                n = numPointsLeft * 2;
+                errorMessage = "Error in MovingWindowAverage: " + GetExceptionMessage(ex);
+                return false;
             }
+        }
 
-            var CC = new double[n + 1];
-            for (var i = 0; i <= numPointsLeft; i++)
+        /// <summary>
+        /// Moving window average filter of a compressed spectrum
+        /// </summary>
+        /// <param name="spectrum"></param>
+        /// <param name="windowWidthPoints"></param>
+        /// <param name="smoothed">The smoothed spectrum, also compressed</param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if success, False if error</returns>
+        /// <remarks>
+        /// Works a block at a time and never decompresses the whole spectrum;
+        /// the result is identical to the float overload applied to the whole decompressed array
+        /// </remarks>
+        public bool MovingWindowAverage(
+            CompressedSpectrum spectrum,
+            int windowWidthPoints,
+            out CompressedSpectrum smoothed,
+            out string errorMessage)
+        {
+            smoothed = null;
+
+            if (spectrum == null)
             {
-                CC[(int)(Math.Floor(n / 2.0 - i))] = c[i + 1];
+                errorMessage = "spectrum should not be null";
+                return false;
             }
 
-            for (var i = 1; i <= numPointsRight; i++)
+            GetMovingWindowExtent(windowWidthPoints, out var numPointsLeft, out var numPointsRight);
+
+            try
             {
-                CC[(int)(Math.Floor(n / 2.0 + i))] = c[n - i];
-            }
+                var windowWidth = numPointsLeft + numPointsRight + 1;
+                string blockError = null;
 
-            SavitzkyGolayWork(zeroBased1DArray, indexStart, indexEnd, CC, polynomialDegree, correctIntensityValues);
+                smoothed = FilterCompressedBlocks(spectrum, windowWidth, neighbourhood =>
+                {
+                    if (!MovingWindowAverage(neighbourhood, 0, neighbourhood.Length - 1, windowWidthPoints, out var message))
+                        blockError = message;
 
-            errorMessage = string.Empty;
-            return true;
+                    return neighbourhood;
+                });
+
+                errorMessage = blockError ?? string.Empty;
+                return blockError == null;
+            }
+            catch (Exception ex)
+            {
+                errorMessage = "Error in MovingWindowAverage: " + GetExceptionMessage(ex);
+                return false;
+            }
         }
 
-        private void SavitzkyGolayWork(
+        /// <summary>
+        /// Moving window average filter for data whose x values are not evenly spaced
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="xValues">X value of each point; must be ascending from indexStart through indexEnd</param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="windowWidthX">Each point is replaced by the average of the points within windowWidthX / 2 of its x value</param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if success, False if error</returns>
+        /// <remarks>The window is cut off at indexStart and indexEnd</remarks>
+        public bool MovingWindowAverage(
             double[] zeroBased1DArray,
+            double[] xValues,
             int indexStart,
             int indexEnd,
-            IReadOnlyList<double> c,
-            short polynomialDegree,
-            bool correctIntensityValues)
+            double windowWidthX,
+            out string errorMessage)
         {
-            double correctionFactor;
-
-            if (polynomialDegree <= 1 || !correctIntensityValues)
-                correctionFactor = 1.0;
-            else
-                correctionFactor = 1.6;
-
-            var width = (int)(Math.Floor((c.Count - 1) / 2.0));
+            if (!ValidateNonUniformRange(zeroBased1DArray, xValues, ref indexStart, ref indexEnd, 1, out errorMessage))
+                return false;
 
-            if (indexStart > indexEnd)
+            if (windowWidthX <= 0)
             {
-                // Swap the indices
-                var temp = indexEnd;
-                indexEnd = indexStart;
-                indexStart = temp;
+                errorMessage = "windowWidthX should be > 0";
+                return false;
             }
 
-            // Reserve space for Y()
-            var Y = new double[width * 2 + 2];
+            var smoothedData = (double[])zeroBased1DArray.Clone();
 
-            // Reserve space for a temporary buffer to hold the results of the smooth
-            var tempBuffer = new double[zeroBased1DArray.Length];
+            ProcessTiles(indexStart, indexEnd, 1, (tileStart, tileEnd) =>
+                NonUniformSmoothing.MovingAverage(xValues, zeroBased1DArray, smoothedData, indexStart, indexEnd, windowWidthX / 2, tileStart, tileEnd));
 
-            // Copy data from input array to temporary buffer
-            zeroBased1DArray.CopyTo(tempBuffer, 0);
+            smoothedData.CopyTo(zeroBased1DArray, 0);
+            return true;
+        }
 
-            for (var i = indexStart; i < indexEnd; i++)
-            {
-                var copyStart = i - width;
-                var copyEnd = i + width + 1;
+        /// <summary>
+        /// Moving window average filter for data whose x values are not evenly spaced, float32 version
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="xValues"></param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="windowWidthX"></param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if success, False if error</returns>
+        /// <remarks>The window sums are carried in double</remarks>
+        public bool MovingWindowAverage(
+            float[] zeroBased1DArray,
+            float[] xValues,
+            int indexStart,
+            int indexEnd,
+            double windowWidthX,
+            out string errorMessage)
+        {
+            var data = ToDouble(zeroBased1DArray);
+            if (!MovingWindowAverage(data, ToDouble(xValues), indexStart, indexEnd, windowWidthX, out errorMessage))
+                return false;
 
-                if (copyStart < indexStart)
-                    copyStart = indexStart;
+            CopyRange(data, zeroBased1DArray, indexStart, indexEnd);
+            return true;
+        }
 
-                if (copyEnd >= indexEnd)
-                    copyEnd = indexEnd - 1;
+        /// <summary>
+        /// Define the distance to examine left and right of each point
+        /// </summary>
+        private static void GetMovingWindowExtent(int windowWidthPoints, out int numPointsLeft, out int numPointsRight)
+        {
+            if (windowWidthPoints < 3)
+                windowWidthPoints = 3;
 
-                for (var srcIndex = copyStart; srcIndex <= copyEnd; srcIndex++)
+            if (windowWidthPoints % 2 == 0)
+            {
+                // Even number of points
+                numPointsLeft = windowWidthPoints / 2;
+                numPointsRight = numPointsLeft - 1;
+            }
+            else
+            {
+                // Odd Number of points
+                numPointsLeft = (int)(Math.Floor(windowWidthPoints / 2.0));
+                numPointsRight = numPointsLeft;
+            }
+        }
+
+        /// <summary>
+        /// Moving averages of points from through to, with each window cut off at indexStart and indexEnd
+        /// </summary>
+        private static double[] GetCutOffAverages(double[] data, int indexStart, int indexEnd, int numPointsLeft, int numPointsRight, int from, int to)
+        {
+            var averages = new double[Math.Max(to - from + 1, 0)];
+            for (var currentIndex = from; currentIndex <= to; currentIndex++)
+            {
+                var start = Math.Max(currentIndex - numPointsLeft, indexStart);
+                var end = Math.Min(currentIndex + numPointsRight, indexEnd);
+
+                double total = 0;
+                for (var i = start; i <= end; i++)
+                {
+                    total += data[i];
+                }
+
+                averages[currentIndex - from] = total / (end - start + 1);
+            }
+
+            return averages;
+        }
+
+        /// <summary>
+        /// Float version of GetCutOffAverages
+        /// </summary>
+        private static float[] GetCutOffAverages(float[] data, int indexStart, int indexEnd, int numPointsLeft, int numPointsRight, int from, int to)
+        {
+            var averages = new float[Math.Max(to - from + 1, 0)];
+            for (var currentIndex = from; currentIndex <= to; currentIndex++)
+            {
+                var start = Math.Max(currentIndex - numPointsLeft, indexStart);
+                var end = Math.Min(currentIndex + numPointsRight, indexEnd);
+
+                float total = 0;
+                for (var i = start; i <= end; i++)
+                {
+                    total += data[i];
+                }
+
+                averages[currentIndex - from] = total / (end - start + 1);
+            }
+
+            return averages;
+        }
+
+        /// <summary>
+        /// Savitzky Golay Filter
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="numPointsLeft">Should normally be equivalent to numPointsRight, and is usually an odd number like 3, 5, 7, etc.</param>
+        /// <param name="numPointsRight"></param>
+        /// <param name="polynomialDegree">Normally 2 or 4; if polynomialDegree is odd, it is actually decremented by 1 to give an even number</param>
+        /// <param name="errorMessage"></param>
+        /// <param name="correctIntensityValues">When true, a correction factor of 1.6 is applied to the smoothed data points</param>
+        /// <returns>True if success, False if error</returns>
+        /// <remarks>
+        /// A Polynomial Degree of 0 will result in behavior identical to a moving average filter
+        ///
+        /// When using a polynomial degree above 0, the smoothed intensity values are lower than the input values
+        ///
+        /// Points without a full window are left unchanged; the overload that takes a SavitzkyGolayPlan smooths every point
+        ///
+        /// Example call:
+        /// objFilter.SavitzkyGolayFilter(dblData, 0, dataCount-1, 3, 3, 4, out var errorMessage)
+        /// </remarks>
+        public bool SavitzkyGolayFilter(
+            double[] zeroBased1DArray,
+            int indexStart,
+            int indexEnd,
+            int numPointsLeft,
+            int numPointsRight,
+            short polynomialDegree,
+            out string errorMessage,
+            bool correctIntensityValues = true)
+        {
+            if (!GetSavitzkyGolayFilterCoefficients(numPointsLeft, numPointsRight, ref polynomialDegree, out var CC, out errorMessage))
+                return false;
+
+            SavitzkyGolayWork(zeroBased1DArray, indexStart, indexEnd, CC, polynomialDegree, correctIntensityValues);
+
+            errorMessage = string.Empty;
+            return true;
+        }
+
+        /// <summary>
+        /// Savitzky Golay Filter, float32 version
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="numPointsLeft"></param>
+        /// <param name="numPointsRight"></param>
+        /// <param name="polynomialDegree"></param>
+        /// <param name="errorMessage"></param>
+        /// <param name="correctIntensityValues"></param>
+        /// <returns>True if success, False if error</returns>
+        /// <remarks>
+        /// Uses the same coefficients as the double version, rounded to float;
+        /// see the class remarks for the accuracy versus the double version
+        /// </remarks>
+        public bool SavitzkyGolayFilter(
+            float[] zeroBased1DArray,
+            int indexStart,
+            int indexEnd,
+            int numPointsLeft,
+            int numPointsRight,
+            short polynomialDegree,
+            out string errorMessage,
+            bool correctIntensityValues = true)
+        {
+            if (!GetSavitzkyGolayFilterCoefficients(numPointsLeft, numPointsRight, ref polynomialDegree, out var CC, out errorMessage))
+                return false;
+
+            SavitzkyGolayWork(zeroBased1DArray, indexStart, indexEnd, CC, polynomialDegree, correctIntensityValues);
+
+            errorMessage = string.Empty;
+            return true;
+        }
+
+        /// <summary>
+        /// Savitzky Golay Filter using a plan, which smooths every point from indexStart through indexEnd
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="plan">
+        /// Plans are immutable, so one can be reused for any number of calls. The SavitzkyGolayPlan constructor throws
+        /// ArgumentOutOfRangeException for an invalid window; SavitzkyGolayPlan.TryCreate returns False and an error message
+        /// </param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if success, False if error</returns>
+        /// <remarks>
+        /// Points near indexStart and indexEnd use the plan's edge sets; no intensity correction factor is applied.
+        /// A derivative plan replaces the data with the derivative
+        /// </remarks>
+        public bool SavitzkyGolayFilter(
+            double[] zeroBased1DArray,
+            int indexStart,
+            int indexEnd,
+            SavitzkyGolayPlan plan,
+            out string errorMessage)
+        {
+            if (!ValidateSavitzkyGolayPlanRange(zeroBased1DArray, ref indexStart, ref indexEnd, plan, out errorMessage))
+                return false;
+
+            // Skipping zero runs filters in place, copying only the non-zero neighbourhoods
+            var data = SkipZeroRuns ? zeroBased1DArray : (double[])zeroBased1DArray.Clone();
+            SavitzkyGolayMultiWork(data, indexStart, indexEnd, new[] { plan }, new[] { zeroBased1DArray });
+
+            return true;
+        }
+
+        /// <summary>
+        /// Savitzky Golay Filter using a plan, float32 version
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="plan">From the SavitzkyGolayPlan constructor, which throws for an invalid window, or SavitzkyGolayPlan.TryCreate</param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if success, False if error</returns>
+        public bool SavitzkyGolayFilter(
+            float[] zeroBased1DArray,
+            int indexStart,
+            int indexEnd,
+            SavitzkyGolayPlan plan,
+            out string errorMessage)
+        {
+            if (!ValidateSavitzkyGolayPlanRange(zeroBased1DArray, ref indexStart, ref indexEnd, plan, out errorMessage))
+                return false;
+
+            // Skipping zero runs filters in place, copying only the non-zero neighbourhoods
+            var data = SkipZeroRuns ? zeroBased1DArray : (float[])zeroBased1DArray.Clone();
+            SavitzkyGolayMultiWork(data, indexStart, indexEnd, new[] { plan }, new[] { zeroBased1DArray });
+
+            return true;
+        }
+
+        /// <summary>
+        /// Savitzky Golay Filter of a compressed spectrum using a plan
+        /// </summary>
+        /// <param name="spectrum">Must have at least plan.WindowWidth points</param>
+        /// <param name="plan">From the SavitzkyGolayPlan constructor, which throws for an invalid window, or SavitzkyGolayPlan.TryCreate</param>
+        /// <param name="smoothed">The filtered spectrum, also compressed</param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if success, False if error</returns>
+        /// <remarks>
+        /// Works a block at a time and never decompresses the whole spectrum. The result is identical to the
+        /// float plan overload applied to the whole decompressed array, except with UseFFTConvolution for windows
+        /// wide enough to use the FFT, which rounds differently on a block than on the whole array
+        /// </remarks>
+        public bool SavitzkyGolayFilter(
+            CompressedSpectrum spectrum,
+            SavitzkyGolayPlan plan,
+            out CompressedSpectrum smoothed,
+            out string errorMessage)
+        {
+            smoothed = null;
+
+            if (spectrum == null)
+            {
+                errorMessage = "spectrum should not be null";
+                return false;
+            }
+
+            if (plan == null)
+            {
+                errorMessage = "plan should not be null";
+                return false;
+            }
+
+            if (spectrum.Count < plan.WindowWidth)
+            {
+                errorMessage = "The spectrum should have at least " + plan.WindowWidth + " points";
+                return false;
+            }
+
+            smoothed = FilterCompressedBlocks(spectrum, plan.WindowWidth, neighbourhood =>
+            {
+                var output = new float[neighbourhood.Length];
+                SavitzkyGolayMultiWork(neighbourhood, 0, neighbourhood.Length - 1, new[] { plan }, new[] { output });
+                return output;
+            });
+
+            errorMessage = string.Empty;
+            return true;
+        }
+
+        /// <summary>
+        /// Savitzky Golay Filter for data whose x values are not evenly spaced
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="xValues">X value of each point; must be ascending from indexStart through indexEnd</param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="numPointsLeft"></param>
+        /// <param name="numPointsRight"></param>
+        /// <param name="polynomialDegree">Must be less than numPointsLeft + numPointsRight + 1; odd degrees are used as-is</param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if success, False if error</returns>
+        /// <remarks>
+        /// Each point is replaced by the least squares polynomial through the x and y values of its window,
+        /// evaluated at its own x value, so the data does not need to be resampled to even spacing first.
+        /// Points near indexStart and indexEnd use the first or last window of the range, as with a SavitzkyGolayPlan,
+        /// and for evenly spaced x the result matches a SavitzkyGolayPlan to rounding.
+        /// No intensity correction factor is applied
+        /// </remarks>
+        public bool SavitzkyGolayFilter(
+            double[] zeroBased1DArray,
+            double[] xValues,
+            int indexStart,
+            int indexEnd,
+            int numPointsLeft,
+            int numPointsRight,
+            short polynomialDegree,
+            out string errorMessage)
+        {
+            if (numPointsLeft < 0 || numPointsRight < 0)
+            {
+                errorMessage = "numPointsLeft and numPointsRight should be >= 0";
+                return false;
+            }
+
+            var windowWidth = numPointsLeft + numPointsRight + 1;
+            if (polynomialDegree < 0 || polynomialDegree >= windowWidth)
+            {
+                errorMessage = "polynomialDegree should be >= 0 and less than numPointsLeft + numPointsRight + 1";
+                return false;
+            }
+
+            if (!ValidateNonUniformRange(zeroBased1DArray, xValues, ref indexStart, ref indexEnd, windowWidth, out errorMessage))
+                return false;
+
+            var smoothedData = (double[])zeroBased1DArray.Clone();
+
+            ProcessTiles(indexStart, indexEnd, polynomialDegree * polynomialDegree + 1, (tileStart, tileEnd) =>
+                NonUniformSmoothing.SavitzkyGolay(
+                    xValues, zeroBased1DArray, smoothedData, indexStart, indexEnd,
+                    numPointsLeft, numPointsRight, polynomialDegree, tileStart, tileEnd));
+
+            smoothedData.CopyTo(zeroBased1DArray, 0);
+            return true;
+        }
+
+        /// <summary>
+        /// Savitzky Golay Filter for data whose x values are not evenly spaced, float32 version
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="xValues"></param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="numPointsLeft"></param>
+        /// <param name="numPointsRight"></param>
+        /// <param name="polynomialDegree"></param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if success, False if error</returns>
+        /// <remarks>The fits are done in double, since the power sums need more precision than float has</remarks>
+        public bool SavitzkyGolayFilter(
+            float[] zeroBased1DArray,
+            float[] xValues,
+            int indexStart,
+            int indexEnd,
+            int numPointsLeft,
+            int numPointsRight,
+            short polynomialDegree,
+            out string errorMessage)
+        {
+            var data = ToDouble(zeroBased1DArray);
+            if (!SavitzkyGolayFilter(data, ToDouble(xValues), indexStart, indexEnd, numPointsLeft, numPointsRight, polynomialDegree, out errorMessage))
+                return false;
+
+            CopyRange(data, zeroBased1DArray, indexStart, indexEnd);
+            return true;
+        }
+
+        private static bool ValidateNonUniformRange(double[] zeroBased1DArray, double[] xValues, ref int indexStart, ref int indexEnd, int minimumPoints, out string errorMessage)
+        {
+            if (zeroBased1DArray == null || zeroBased1DArray.Length == 0)
+            {
+                errorMessage = "zeroBased1DArray is empty";
+                return false;
+            }
+
+            if (xValues == null || xValues.Length != zeroBased1DArray.Length)
+            {
+                errorMessage = "xValues should be the same length as zeroBased1DArray";
+                return false;
+            }
+
+            if (indexStart > indexEnd)
+            {
+                var temp = indexEnd;
+                indexEnd = indexStart;
+                indexStart = temp;
+            }
+
+            if (indexStart < 0 || indexEnd >= zeroBased1DArray.Length)
+            {
+                errorMessage = "indexStart and indexEnd should be within zeroBased1DArray";
+                return false;
+            }
+
+            if (indexEnd - indexStart + 1 < minimumPoints)
+            {
+                errorMessage = "indexStart through indexEnd should hold at least one full window";
+                return false;
+            }
+
+            for (var i = indexStart + 1; i <= indexEnd; i++)
+            {
+                // Written so that NaN fails too
+                if (!(xValues[i] >= xValues[i - 1]))
+                {
+                    errorMessage = "xValues should be ascending";
+                    return false;
+                }
+            }
+
+            errorMessage = string.Empty;
+            return true;
+        }
+
+        private static double[] ToDouble(float[] values)
+        {
+            if (values == null)
+                return null;
+
+            var result = new double[values.Length];
+            for (var i = 0; i < values.Length; i++)
+            {
+                result[i] = values[i];
+            }
+
+            return result;
+        }
+
+        /// <summary>
+        /// Copy points indexStart through indexEnd, in either order, rounding to float
+        /// </summary>
+        private static void CopyRange(double[] source, float[] target, int indexStart, int indexEnd)
+        {
+            for (var i = Math.Min(indexStart, indexEnd); i <= Math.Max(indexStart, indexEnd); i++)
+            {
+                target[i] = (float)source[i];
+            }
+        }
+
+        private static bool ValidateSavitzkyGolayPlanRange(Array zeroBased1DArray, ref int indexStart, ref int indexEnd, SavitzkyGolayPlan plan, out string errorMessage)
+        {
+            if (zeroBased1DArray == null || zeroBased1DArray.Length == 0)
+            {
+                errorMessage = "zeroBased1DArray is empty";
+                return false;
+            }
+
+            if (plan == null)
+            {
+                errorMessage = "plan is null";
+                return false;
+            }
+
+            if (indexStart > indexEnd)
+            {
+                var temp = indexEnd;
+                indexEnd = indexStart;
+                indexStart = temp;
+            }
+
+            if (indexStart < 0 || indexEnd >= zeroBased1DArray.Length)
+            {
+                errorMessage = "indexStart and indexEnd should be within zeroBased1DArray";
+                return false;
+            }
+
+            if (indexEnd - indexStart + 1 < plan.WindowWidth)
+            {
+                errorMessage = "indexStart through indexEnd should hold at least plan.WindowWidth points";
+                return false;
+            }
+
+            errorMessage = string.Empty;
+            return true;
+        }
+
+        private static bool GetSavitzkyGolayFilterCoefficients(
+            int numPointsLeft,
+            int numPointsRight,
+            ref short polynomialDegree,
+            out double[] CC,
+            out string errorMessage)
+        {
+            CC = null;
+
+            if (numPointsLeft < 1 || numPointsRight < 1)
+            {
+                errorMessage = "numPointsLeft and numPointsRight should be >= 1";
+                return false;
+            }
+
+            if (polynomialDegree % 2 == 1)
+            {
+                polynomialDegree -= 1;
+            }
+
+            if (polynomialDegree < 0)
+                polynomialDegree = 0;
+
+            while (numPointsLeft + numPointsRight < polynomialDegree && polynomialDegree > 1)
+            {
+                // Decrement the polynomialDegree by 2
+                polynomialDegree -= 2;
+            }
+
+            // if (numPointsLeft + numPointsRight < polynomialDegree)
+            // {
+            //     errorMessage = "numPointsLeft + numPointsRight should be >= polynomialDegree";
+            //     return false;
+            // }
+
+            var numPointsTotal = numPointsLeft + numPointsRight + 1;
+            var c = new double[numPointsTotal + 1];
+
+            // Lay the coefficients out as NRSavGol.savgol does: offset 0 in c[1], offsets -1 to -numPointsLeft
+            // in c[2] onward, and offsets numPointsRight to 1 at the end of the array
+            var coefficients = SavitzkyGolayCoefficients.GetCoefficients(numPointsLeft, numPointsRight, polynomialDegree);
+            for (var offset = -numPointsLeft; offset <= numPointsRight; offset++)
+            {
+                c[(numPointsTotal - offset) % numPointsTotal + 1] = coefficients[offset + numPointsLeft];
+            }
+
+            // now un wrap the coefficients ...
+            var n = numPointsRight * 2;
+            if (numPointsLeft > numPointsRight)
+            {
+                n = numPointsLeft * 2;
+            }
+
+            CC = new double[n + 1];
+            for (var i = 0; i <= numPointsLeft; i++)
+            {
+                CC[(int)(Math.Floor(n / 2.0 - i))] = c[i + 1];
+            }
+
+            for (var i = 1; i <= numPointsRight; i++)
+            {
+                CC[(int)(Math.Floor(n / 2.0 + i))] = c[n - i];
+            }
+
+            errorMessage = string.Empty;
+            return true;
+        }
+
+        private void SavitzkyGolayWork(
+            double[] zeroBased1DArray,
+            int indexStart,
+            int indexEnd,
+            double[] c,
+            short polynomialDegree,
+            bool correctIntensityValues)
+        {
+            double correctionFactor;
+
+            if (polynomialDegree <= 1 || !correctIntensityValues)
+                correctionFactor = 1.0;
+            else
+                correctionFactor = 1.6;
+
+            var width = (int)(Math.Floor((c.Length - 1) / 2.0));
+
+            if (indexStart > indexEnd)
+            {
+                // Swap the indices
+                var temp = indexEnd;
+                indexEnd = indexStart;
+                indexStart = temp;
+            }
+
+            // A point is only smoothed when its window, clipped to indexEnd - 1, holds c.Length + 1 points
+            var firstFull = indexStart + width;
+            var lastFull = indexEnd - width - 2;
+            if (lastFull < firstFull)
+                return;
+
+            if (SkipZeroRuns)
+            {
+                // Only the non-zero neighbourhoods are copied
+                SavitzkyGolayConvolve(zeroBased1DArray, zeroBased1DArray, firstFull, lastFull, width, c, correctionFactor);
+                return;
+            }
+
+            // Reserve space for a temporary buffer to hold the results of the smooth
+            var tempBuffer = new double[zeroBased1DArray.Length];
+
+            // Copy data from input array to temporary buffer
+            zeroBased1DArray.CopyTo(tempBuffer, 0);
+
+            SavitzkyGolayConvolve(zeroBased1DArray, tempBuffer, firstFull, lastFull, width, c, correctionFactor);
+
+            // Copy data from temporary buffer back to input array
+            tempBuffer.CopyTo(zeroBased1DArray, 0);
+
+        }
+
+        private void SavitzkyGolayWork(
+            float[] zeroBased1DArray,
+            int indexStart,
+            int indexEnd,
+            double[] c,
+            short polynomialDegree,
+            bool correctIntensityValues)
+        {
+            float correctionFactor;
+
+            if (polynomialDegree <= 1 || !correctIntensityValues)
+                correctionFactor = 1.0f;
+            else
+                correctionFactor = 1.6f;
+
+            var coefficients = new float[c.Length];
+            for (var j = 0; j < c.Length; j++)
+            {
+                coefficients[j] = (float)c[j];
+            }
+
+            var width = (int)(Math.Floor((c.Length - 1) / 2.0));
+
+            if (indexStart > indexEnd)
+            {
+                // Swap the indices
+                var temp = indexEnd;
+                indexEnd = indexStart;
+                indexStart = temp;
+            }
+
+            // Same window rules as the double version: a point is only smoothed
+            // when its window, clipped to indexEnd - 1, holds c.Length + 1 points
+            var firstFull = indexStart + width;
+            var lastFull = indexEnd - width - 2;
+            if (lastFull < firstFull)
+                return;
+
+            if (SkipZeroRuns)
+            {
+                SavitzkyGolayConvolve(zeroBased1DArray, zeroBased1DArray, firstFull, lastFull, width, c, coefficients, correctionFactor);
+                return;
+            }
+
+            var tempBuffer = new float[zeroBased1DArray.Length];
+            zeroBased1DArray.CopyTo(tempBuffer, 0);
+
+            SavitzkyGolayConvolve(zeroBased1DArray, tempBuffer, firstFull, lastFull, width, c, coefficients, correctionFactor);
+
+            tempBuffer.CopyTo(zeroBased1DArray, 0);
+
+        }
+
+        /// <summary>
+        /// output[i] = scale * Σ c[j] * data[i - windowOffset + j], for i = first through last
+        /// </summary>
+        /// <remarks>With SkipZeroRuns, output may be data itself</remarks>
+        private void SavitzkyGolayConvolve(double[] data, double[] output, int first, int last, int windowOffset, double[] c, double scale)
+        {
+            // Wide windows on long ranges are faster by FFT, but a NaN or infinity would spread through a whole FFT block
+            if (UseFFTConvolution &&
+                OverlapSaveConvolution.IsFasterThanDirect(last - first + 1, c.Length) &&
+                IsFinite(data, first - windowOffset, last - windowOffset + c.Length - 1))
+            {
+                var convolution = new OverlapSaveConvolution(c, scale);
+                if (SkipZeroRuns)
+                {
+                    // Whole pairs of blocks are convolved, so each point has the same rounding as when the range is filtered in full
+                    ZeroRuns.FilterNonZeroWindows(
+                        data, output, first, last, windowOffset, c.Length, convolution.PairLength,
+                        processTile => ProcessTiles(first, last, c.Length, processTile),
+                        (input, rangeOutput, rangeFirst, rangeLast) =>
+                            convolution.Correlate(input, rangeFirst, rangeLast, windowOffset, rangeOutput, rangeFirst, rangeLast));
+                    return;
+                }
+
+                ProcessTiles(first, last, c.Length, (tileStart, tileEnd) =>
+                    convolution.Correlate(data, first, last, windowOffset, output, tileStart, tileEnd));
+                return;
+            }
+
+            // The window widths we use most have unrolled kernels
+            var kernel = SmoothingKernels.GetConvolutionKernel(c.Length);
+            if (SkipZeroRuns)
+            {
+                ZeroRuns.FilterNonZeroWindows(
+                    data, output, first, last, windowOffset, c.Length, 1,
+                    processTile => ProcessTiles(first, last, c.Length, processTile),
+                    (input, rangeOutput, rangeFirst, rangeLast) => kernel(input, rangeOutput, rangeFirst, rangeLast, windowOffset, c, scale));
+                return;
+            }
+
+            ProcessTiles(first, last, c.Length, (tileStart, tileEnd) =>
+                kernel(data, output, tileStart, tileEnd, windowOffset, c, scale));
+        }
+
+        /// <summary>
+        /// Float version of SavitzkyGolayConvolve; the FFT uses the double coefficients c, the kernels use cFloat
+        /// </summary>
+        private void SavitzkyGolayConvolve(float[] data, float[] output, int first, int last, int windowOffset, double[] c, float[] cFloat, float scale)
+        {
+            if (UseFFTConvolution &&
+                OverlapSaveConvolution.IsFasterThanDirect(last - first + 1, c.Length) &&
+                IsFinite(data, first - windowOffset, last - windowOffset + c.Length - 1))
+            {
+                var convolution = new OverlapSaveConvolution(c, scale);
+                if (SkipZeroRuns)
+                {
+                    ZeroRuns.FilterNonZeroWindows(
+                        data, output, first, last, windowOffset, c.Length, convolution.PairLength,
+                        processTile => ProcessTiles(first, last, c.Length, processTile),
+                        (input, rangeOutput, rangeFirst, rangeLast) =>
+                            convolution.Correlate(input, rangeFirst, rangeLast, windowOffset, rangeOutput, rangeFirst, rangeLast));
+                    return;
+                }
+
+                ProcessTiles(first, last, c.Length, (tileStart, tileEnd) =>
+                    convolution.Correlate(data, first, last, windowOffset, output, tileStart, tileEnd));
+                return;
+            }
+
+            var kernel = SmoothingKernels.GetConvolutionKernelFloat(cFloat.Length);
+            if (SkipZeroRuns)
+            {
+                ZeroRuns.FilterNonZeroWindows(
+                    data, output, first, last, windowOffset, cFloat.Length, 1,
+                    processTile => ProcessTiles(first, last, cFloat.Length, processTile),
+                    (input, rangeOutput, rangeFirst, rangeLast) => kernel(input, rangeOutput, rangeFirst, rangeLast, windowOffset, cFloat, scale));
+                return;
+            }
+
+            ProcessTiles(first, last, cFloat.Length, (tileStart, tileEnd) =>
+                kernel(data, output, tileStart, tileEnd, windowOffset, cFloat, scale));
+        }
+
+        /// <summary>
+        /// True if data[start] through data[end] are neither NaN nor infinite
+        /// </summary>
+        private static bool IsFinite(double[] data, int start, int end)
+        {
+            for (var i = start; i <= end; i++)
+            {
+                if (double.IsNaN(data[i]) || double.IsInfinity(data[i]))
+                    return false;
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Float version of IsFinite
+        /// </summary>
+        private static bool IsFinite(float[] data, int start, int end)
+        {
+            for (var i = start; i <= end; i++)
+            {
+                if (float.IsNaN(data[i]) || float.IsInfinity(data[i]))
+                    return false;
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Savitzky Golay smoothing plus first and second derivatives, computed in a single pass
+        /// </summary>
+        /// <param name="zeroBased1DArray">Input data; not modified unless it is also passed as an output array</param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="numPointsLeft"></param>
+        /// <param name="numPointsRight"></param>
+        /// <param name="polynomialDegree">Must be at least 2 when secondDerivative is requested; odd degrees are used as-is</param>
+        /// <param name="smoothedData">Receives the smoothed data; null to skip</param>
+        /// <param name="firstDerivative">Receives dy/dx; null to skip</param>
+        /// <param name="secondDerivative">Receives d2y/dx2; null to skip</param>
+        /// <param name="errorMessage"></param>
+        /// <param name="pointSpacing">X distance between adjacent points, used to scale the derivatives</param>
+        /// <returns>True if success, False if error</returns>
+        /// <remarks>
+        /// Each window is read once and multiplied by every requested coefficient set,
+        /// rather than sweeping the data once per output
+        ///
+        /// Only points indexStart through indexEnd are written to the output arrays.
+        /// Points within numPointsLeft of indexStart or numPointsRight of indexEnd are fit to the first
+        /// or last window of the range (see SavitzkyGolayPlan), so every point is smoothed.
+        /// If the range is narrower than one window, smoothedData gets the input values and the derivatives get 0
+        ///
+        /// No intensity correction factor is applied
+        /// </remarks>
+        public bool SavitzkyGolayDerivatives(
+            double[] zeroBased1DArray,
+            int indexStart,
+            int indexEnd,
+            int numPointsLeft,
+            int numPointsRight,
+            short polynomialDegree,
+            double[] smoothedData,
+            double[] firstDerivative,
+            double[] secondDerivative,
+            out string errorMessage,
+            double pointSpacing = 1.0)
+        {
+            var derivativeOutputs = new[] { smoothedData, firstDerivative, secondDerivative };
+
+            if (!GetSavitzkyGolayDerivativePlans(
+                zeroBased1DArray, ref indexStart, ref indexEnd, numPointsLeft, numPointsRight, polynomialDegree,
+                derivativeOutputs, pointSpacing, out var plans, out errorMessage))
+            {
+                return false;
+            }
+
+            var outputs = new List<double[]>();
+            foreach (var output in derivativeOutputs)
+            {
+                if (output != null)
+                    outputs.Add(output);
+            }
+
+            if (outputs.Count == 0)
+                return true;
+
+            // Writing in place would overwrite points still needed by later windows
+            var data = zeroBased1DArray;
+            if (outputs.Contains(zeroBased1DArray))
+                data = (double[])zeroBased1DArray.Clone();
+
+            SavitzkyGolayMultiWork(data, indexStart, indexEnd, plans, outputs);
+
+            return true;
+        }
+
+        /// <summary>
+        /// Savitzky Golay smoothing plus first and second derivatives, float32 version
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="numPointsLeft"></param>
+        /// <param name="numPointsRight"></param>
+        /// <param name="polynomialDegree"></param>
+        /// <param name="smoothedData"></param>
+        /// <param name="firstDerivative"></param>
+        /// <param name="secondDerivative"></param>
+        /// <param name="errorMessage"></param>
+        /// <param name="pointSpacing"></param>
+        /// <returns>True if success, False if error</returns>
+        /// <remarks>See the class remarks for the accuracy versus the double version</remarks>
+        public bool SavitzkyGolayDerivatives(
+            float[] zeroBased1DArray,
+            int indexStart,
+            int indexEnd,
+            int numPointsLeft,
+            int numPointsRight,
+            short polynomialDegree,
+            float[] smoothedData,
+            float[] firstDerivative,
+            float[] secondDerivative,
+            out string errorMessage,
+            double pointSpacing = 1.0)
+        {
+            var derivativeOutputs = new[] { smoothedData, firstDerivative, secondDerivative };
+
+            if (!GetSavitzkyGolayDerivativePlans(
+                zeroBased1DArray, ref indexStart, ref indexEnd, numPointsLeft, numPointsRight, polynomialDegree,
+                derivativeOutputs, pointSpacing, out var plans, out errorMessage))
+            {
+                return false;
+            }
+
+            var outputs = new List<float[]>();
+            foreach (var output in derivativeOutputs)
+            {
+                if (output != null)
+                    outputs.Add(output);
+            }
+
+            if (outputs.Count == 0)
+                return true;
+
+            var data = zeroBased1DArray;
+            if (outputs.Contains(zeroBased1DArray))
+                data = (float[])zeroBased1DArray.Clone();
+
+            SavitzkyGolayMultiWork(data, indexStart, indexEnd, plans, outputs);
+
+            return true;
+        }
+
+        /// <summary>
+        /// Validate the arguments of SavitzkyGolayDerivatives and create a plan for each non-null output
+        /// </summary>
+        /// <param name="zeroBased1DArray"></param>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="numPointsLeft"></param>
+        /// <param name="numPointsRight"></param>
+        /// <param name="polynomialDegree"></param>
+        /// <param name="derivativeOutputs">Output array for derivative orders 0, 1, and 2, each of which may be null</param>
+        /// <param name="pointSpacing"></param>
+        /// <param name="plans"></param>
+        /// <param name="errorMessage"></param>
+        /// <returns></returns>
+        private static bool GetSavitzkyGolayDerivativePlans(
+            Array zeroBased1DArray,
+            ref int indexStart,
+            ref int indexEnd,
+            int numPointsLeft,
+            int numPointsRight,
+            short polynomialDegree,
+            IReadOnlyList<Array> derivativeOutputs,
+            double pointSpacing,
+            out List<SavitzkyGolayPlan> plans,
+            out string errorMessage)
+        {
+            plans = new List<SavitzkyGolayPlan>();
+
+            if (zeroBased1DArray == null || zeroBased1DArray.Length == 0)
+            {
+                errorMessage = "zeroBased1DArray is empty";
+                return false;
+            }
+
+            if (numPointsLeft < 0 || numPointsRight < 0 || numPointsLeft + numPointsRight < polynomialDegree)
+            {
+                errorMessage = "numPointsLeft + numPointsRight should be >= polynomialDegree";
+                return false;
+            }
+
+            var maxOrder = derivativeOutputs[2] != null ? 2 : derivativeOutputs[1] != null ? 1 : 0;
+            if (polynomialDegree < maxOrder)
+            {
+                errorMessage = "polynomialDegree should be >= the highest derivative requested";
+                return false;
+            }
+
+            if (!(pointSpacing > 0) || double.IsInfinity(pointSpacing))
+            {
+                errorMessage = "pointSpacing should be a finite number > 0";
+                return false;
+            }
+
+            if (indexStart > indexEnd)
+            {
+                var temp = indexEnd;
+                indexEnd = indexStart;
+                indexStart = temp;
+            }
+
+            if (indexStart < 0 || indexEnd >= zeroBased1DArray.Length)
+            {
+                errorMessage = "indexStart and indexEnd should be within zeroBased1DArray";
+                return false;
+            }
+
+            for (var order = 0; order <= 2; order++)
+            {
+                var output = derivativeOutputs[order];
+                if (output == null)
+                    continue;
+
+                if (output.Length < zeroBased1DArray.Length)
+                {
+                    errorMessage = "Output arrays should be at least as long as zeroBased1DArray";
+                    return false;
+                }
+
+                plans.Add(new SavitzkyGolayPlan(numPointsLeft, numPointsRight, polynomialDegree, order, pointSpacing));
+            }
+
+            errorMessage = string.Empty;
+            return true;
+        }
+
+        /// <summary>
+        /// Apply each plan to points indexStart through indexEnd of data, writing to the matching output
+        /// </summary>
+        private void SavitzkyGolayMultiWork(
+            double[] data,
+            int indexStart,
+            int indexEnd,
+            IReadOnlyList<SavitzkyGolayPlan> plans,
+            IReadOnlyList<double[]> outputs)
+        {
+            var numPointsLeft = plans[0].NumPointsLeft;
+            var numPointsRight = plans[0].NumPointsRight;
+            var width = plans[0].WindowWidth;
+
+            if (indexEnd - indexStart + 1 < width)
+            {
+                for (var k = 0; k < outputs.Count; k++)
                 {
-                    Y[srcIndex - copyStart] = zeroBased1DArray[srcIndex];
+                    for (var i = indexStart; i <= indexEnd; i++)
+                    {
+                        outputs[k][i] = plans[k].DerivativeOrder == 0 ? data[i] : 0;
+                    }
+                }
+                return;
+            }
+
+            var firstFull = indexStart + numPointsLeft;
+            var lastFull = indexEnd - numPointsRight;
+            var tailStart = indexEnd - width + 1;
+
+            // Points near the ends are fit to the first or last window of the range,
+            // which leaves the interior loop without any range checks. They are written
+            // once the interior is done, since with SkipZeroRuns data may also be outputs[0]
+            var edges = new double[outputs.Count][];
+            for (var k = 0; k < outputs.Count; k++)
+            {
+                edges[k] = new double[numPointsLeft + numPointsRight];
+                for (var i = indexStart; i < firstFull; i++)
+                {
+                    edges[k][i - indexStart] = WindowSum(data, indexStart, plans[k].GetSet(i - indexStart));
+                }
+
+                for (var i = lastFull + 1; i <= indexEnd; i++)
+                {
+                    edges[k][i - lastFull - 1 + numPointsLeft] = WindowSum(data, tailStart, plans[k].GetSet(i - tailStart));
+                }
+            }
+
+            if (outputs.Count == 1)
+            {
+                SavitzkyGolayConvolve(data, outputs[0], firstFull, lastFull, numPointsLeft, plans[0].GetSet(numPointsLeft), 1.0);
+                WriteEdges(edges, outputs, indexStart, lastFull + 1, numPointsLeft);
+                return;
+            }
+
+            var c0 = plans[0].GetSet(numPointsLeft);
+            var c1 = plans[1].GetSet(numPointsLeft);
+            var c2 = plans.Count > 2 ? plans[2].GetSet(numPointsLeft) : null;
+
+            Action<int, int> processRange = (rangeStart, rangeEnd) =>
+            {
+                for (var i = rangeStart; i <= rangeEnd; i++)
+                {
+                    var windowStart = i - numPointsLeft;
+                    double sum0 = 0, sum1 = 0, sum2 = 0;
+
+                    // Each point of the window is loaded once for all of the coefficient sets
+                    if (c2 != null)
+                    {
+                        for (var j = 0; j < width; j++)
+                        {
+                            var y = data[windowStart + j];
+                            sum0 += c0[j] * y;
+                            sum1 += c1[j] * y;
+                            sum2 += c2[j] * y;
+                        }
+                    }
+                    else
+                    {
+                        for (var j = 0; j < width; j++)
+                        {
+                            var y = data[windowStart + j];
+                            sum0 += c0[j] * y;
+                            sum1 += c1[j] * y;
+                        }
+                    }
+
+                    outputs[0][i] = sum0;
+                    outputs[1][i] = sum1;
+                    if (c2 != null)
+                        outputs[2][i] = sum2;
+                }
+            };
+
+            Action<int, int> zeroRange = (rangeStart, rangeEnd) =>
+            {
+                foreach (var output in outputs)
+                {
+                    Array.Clear(output, rangeStart, rangeEnd - rangeStart + 1);
                 }
+            };
+
+            ProcessTiles(firstFull, lastFull, width, (tileStart, tileEnd) =>
+            {
+                if (SkipZeroRuns)
+                    ZeroRuns.ForEachNonZeroWindow(data, tileStart, tileEnd, numPointsLeft, width, processRange, zeroRange);
+                else
+                    processRange(tileStart, tileEnd);
+            });
 
-                var n = copyEnd - copyStart;
+            WriteEdges(edges, outputs, indexStart, lastFull + 1, numPointsLeft);
+        }
 
+        private void SavitzkyGolayMultiWork(
+            float[] data,
+            int indexStart,
+            int indexEnd,
+            IReadOnlyList<SavitzkyGolayPlan> plans,
+            IReadOnlyList<float[]> outputs)
+        {
+            var numPointsLeft = plans[0].NumPointsLeft;
+            var numPointsRight = plans[0].NumPointsRight;
+            var width = plans[0].WindowWidth;
 
-                if (n == c.Count)
+            if (indexEnd - indexStart + 1 < width)
+            {
+                for (var k = 0; k < outputs.Count; k++)
                 {
-                    var total = 0.0;
-                    for (var j = 0; j < n; j++)
+                    for (var i = indexStart; i <= indexEnd; i++)
                     {
-                        total += Y[j] * c[j];
+                        outputs[k][i] = plans[k].DerivativeOrder == 0 ? data[i] : 0;
                     }
+                }
+                return;
+            }
+
+            var firstFull = indexStart + numPointsLeft;
+            var lastFull = indexEnd - numPointsRight;
+            var tailStart = indexEnd - width + 1;
 
-                    tempBuffer[i] = total * correctionFactor;
+            // Points near the ends are fit to the first or last window of the range,
+            // which leaves the interior loop without any range checks. They are written
+            // once the interior is done, since with SkipZeroRuns data may also be outputs[0]
+            var edges = new float[outputs.Count][];
+            for (var k = 0; k < outputs.Count; k++)
+            {
+                edges[k] = new float[numPointsLeft + numPointsRight];
+                for (var i = indexStart; i < firstFull; i++)
+                {
+                    edges[k][i - indexStart] = WindowSum(data, indexStart, plans[k].GetSetFloat(i - indexStart));
+                }
+
+                for (var i = lastFull + 1; i <= indexEnd; i++)
+                {
+                    edges[k][i - lastFull - 1 + numPointsLeft] = WindowSum(data, tailStart, plans[k].GetSetFloat(i - tailStart));
                 }
             }
 
-            // Copy data from temporary buffer back to input array
-            tempBuffer.CopyTo(zeroBased1DArray, 0);
+            if (outputs.Count == 1)
+            {
+                SavitzkyGolayConvolve(data, outputs[0], firstFull, lastFull, numPointsLeft, plans[0].GetSet(numPointsLeft), plans[0].GetSetFloat(numPointsLeft), 1.0f);
+                WriteEdges(edges, outputs, indexStart, lastFull + 1, numPointsLeft);
+                return;
+            }
+
+            var c0 = plans[0].GetSetFloat(numPointsLeft);
+            var c1 = plans[1].GetSetFloat(numPointsLeft);
+            var c2 = plans.Count > 2 ? plans[2].GetSetFloat(numPointsLeft) : null;
+
+            Action<int, int> processRange = (rangeStart, rangeEnd) =>
+            {
+                for (var i = rangeStart; i <= rangeEnd; i++)
+                {
+                    var windowStart = i - numPointsLeft;
+                    float sum0 = 0, sum1 = 0, sum2 = 0;
+
+                    if (c2 != null)
+                    {
+                        for (var j = 0; j < width; j++)
+                        {
+                            var y = data[windowStart + j];
+                            sum0 += c0[j] * y;
+                            sum1 += c1[j] * y;
+                            sum2 += c2[j] * y;
+                        }
+                    }
+                    else
+                    {
+                        for (var j = 0; j < width; j++)
+                        {
+                            var y = data[windowStart + j];
+                            sum0 += c0[j] * y;
+                            sum1 += c1[j] * y;
+                        }
+                    }
+
+                    outputs[0][i] = sum0;
+                    outputs[1][i] = sum1;
+                    if (c2 != null)
+                        outputs[2][i] = sum2;
+                }
+            };
+
+            Action<int, int> zeroRange = (rangeStart, rangeEnd) =>
+            {
+                foreach (var output in outputs)
+                {
+                    Array.Clear(output, rangeStart, rangeEnd - rangeStart + 1);
+                }
+            };
 
+            ProcessTiles(firstFull, lastFull, width, (tileStart, tileEnd) =>
+            {
+                if (SkipZeroRuns)
+                    ZeroRuns.ForEachNonZeroWindow(data, tileStart, tileEnd, numPointsLeft, width, processRange, zeroRange);
+                else
+                    processRange(tileStart, tileEnd);
+            });
+
+            WriteEdges(edges, outputs, indexStart, lastFull + 1, numPointsLeft);
+        }
+
+        /// <summary>
+        /// Copy each output's edge values, numPointsLeft from headStart on and the rest from tailStart on
+        /// </summary>
+        private static void WriteEdges<T>(T[][] edges, IReadOnlyList<T[]> outputs, int headStart, int tailStart, int numPointsLeft)
+        {
+            for (var k = 0; k < outputs.Count; k++)
+            {
+                Array.Copy(edges[k], 0, outputs[k], headStart, numPointsLeft);
+                Array.Copy(edges[k], numPointsLeft, outputs[k], tailStart, edges[k].Length - numPointsLeft);
+            }
+        }
+
+        /// <summary>
+        /// Σ c[j] * data[windowStart + j]
+        /// </summary>
+        private static double WindowSum(double[] data, int windowStart, double[] c)
+        {
+            var sum = 0.0;
+            for (var j = 0; j < c.Length; j++)
+            {
+                sum += c[j] * data[windowStart + j];
+            }
+
+            return sum;
+        }
+
+        /// <summary>
+        /// Float version of WindowSum
+        /// </summary>
+        private static float WindowSum(float[] data, int windowStart, float[] c)
+        {
+            var sum = 0.0f;
+            for (var j = 0; j < c.Length; j++)
+            {
+                sum += c[j] * data[windowStart + j];
+            }
+
+            return sum;
+        }
+
+        /// <summary>
+        /// Filter a compressed spectrum one block at a time
+        /// </summary>
+        /// <param name="spectrum"></param>
+        /// <param name="windowWidth">Points in the filter window</param>
+        /// <param name="filter">Filters the points of a block and windowWidth points on either side, clipped to the spectrum</param>
+        /// <returns></returns>
+        /// <remarks>
+        /// A point of the block is at least windowWidth points from any end of its neighbourhood that is not an
+        /// end of the spectrum, so it sees the same window and edge handling as when the whole array is filtered.
+        /// Blocks whose neighbourhood is all zero are stored as zero without being decompressed
+        /// </remarks>
+        private CompressedSpectrum FilterCompressedBlocks(CompressedSpectrum spectrum, int windowWidth, Func<float[], float[]> filter)
+        {
+            var blockPoints = CompressedSpectrum.BLOCK_POINTS;
+            var zeros = new float[blockPoints];
+
+            return CompressedSpectrum.FromBlocks(spectrum.Count, storeBlock =>
+                ProcessTiles(0, spectrum.Count - 1, windowWidth, (tileStart, tileEnd) =>
+                {
+                    // Each block is filtered by the tile that holds its first point
+                    for (var block = (tileStart + blockPoints - 1) / blockPoints; block <= tileEnd / blockPoints; block++)
+                    {
+                        var blockStart = block * blockPoints;
+                        var blockEnd = blockStart + spectrum.GetBlockPointCount(block) - 1;
+
+                        if (spectrum.IsZero(blockStart - windowWidth, blockEnd + windowWidth))
+                        {
+                            storeBlock(block, zeros, 0);
+                            continue;
+                        }
+
+                        var readStart = Math.Max(blockStart - windowWidth, 0);
+                        var readEnd = Math.Min(blockEnd + windowWidth, spectrum.Count - 1);
+                        var neighbourhood = new float[readEnd - readStart + 1];
+                        spectrum.Read(readStart, neighbourhood.Length, neighbourhood, 0);
+
+                        storeBlock(block, filter(neighbourhood), blockStart - readStart);
+                    }
+                }));
+        }
+
+        /// <summary>
+        /// Message of an exception, looking through the AggregateException that Parallel.For wraps around it
+        /// </summary>
+        /// <param name="ex"></param>
+        private static string GetExceptionMessage(Exception ex)
+        {
+            if (ex is AggregateException aggregate)
+            {
+                var inner = aggregate.Flatten().InnerExceptions;
+                if (inner.Count > 0)
+                    return inner[0].Message;
+            }
+
+            return ex.Message;
+        }
+
+        /// <summary>
+        /// Call processTile for consecutive tiles that cover indexStart through indexEnd
+        /// </summary>
+        /// <param name="indexStart"></param>
+        /// <param name="indexEnd"></param>
+        /// <param name="windowWidth">Points read per output point, for deciding whether to go parallel</param>
+        /// <param name="processTile">Receives the first and last index of a tile</param>
+        /// <remarks>
+        /// The filters read from an array that is not written until every tile is done,
+        /// so a tile reads the halo of points it needs from its neighbours directly
+        /// and the output is identical to the serial loop
+        /// </remarks>
+        private void ProcessTiles(int indexStart, int indexEnd, int windowWidth, Action<int, int> processTile)
+        {
+            var pointCount = indexEnd - indexStart + 1;
+            if (pointCount <= 0)
+                return;
+
+            var maxThreads = MaxDegreeOfParallelism > 0 ? MaxDegreeOfParallelism : Environment.ProcessorCount;
+
+            if (maxThreads <= 1 ||
+                pointCount < 2 * PARALLEL_TILE_POINTS ||
+                (long)pointCount * Math.Max(windowWidth, 1) < PARALLEL_MIN_WORK)
+            {
+                processTile(indexStart, indexEnd);
+                return;
+            }
+
+            var tileCount = (pointCount + PARALLEL_TILE_POINTS - 1) / PARALLEL_TILE_POINTS;
+
+            Parallel.For(0, tileCount, new ParallelOptions { MaxDegreeOfParallelism = maxThreads }, tile =>
+            {
+                var tileStart = indexStart + tile * PARALLEL_TILE_POINTS;
+                processTile(tileStart, Math.Min(tileStart + PARALLEL_TILE_POINTS - 1, indexEnd));
+            });
         }
 
     }
@@ -0,0 +1,162 @@
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.Linq;
+
+namespace DataFilterBenchmark
+{
+    /// <summary>
+    /// Command line options
+    /// </summary>
+    internal class BenchmarkOptions
+    {
+        /// <summary>
+        /// Points per array; 50,000,000 is supported but needs several GB of memory for the double filters
+        /// </summary>
+        public List<int> Sizes { get; } = new List<int> { 1000, 10000, 100000, 1000000, 10000000 };
+
+        /// <summary>
+        /// Values for DataFilter.MaxDegreeOfParallelism; 0 means one thread per processor
+        /// </summary>
+        public List<int> Threads { get; } = new List<int> { 1, 0 };
+
+        /// <summary>
+        /// Only benchmarks whose name contains this text are run; empty to run all
+        /// </summary>
+        public string NameFilter { get; private set; } = string.Empty;
+
+        /// <summary>
+        /// Each measurement repeats until it has run this long, and at least MinIterations times
+        /// </summary>
+        public double MinMilliseconds { get; private set; } = 200;
+
+        public int MinIterations { get; private set; } = 3;
+
+        /// <summary>
+        /// Processor clock rate, for converting bytes per nanosecond to bytes per cycle; 0 if unknown
+        /// </summary>
+        public double CpuGHz { get; private set; }
+
+        /// <summary>
+        /// JSON output file; empty to write to the console
+        /// </summary>
+        public string OutputPath { get; private set; } = string.Empty;
+
+        /// <summary>
+        /// True to also time the exported functions of icr2ls32.dll
+        /// </summary>
+        public bool Native { get; private set; } = true;
+
+        public static string GetUsage()
+        {
+            return
+                "Times the DataFilter filters and the icr2ls32.dll huge array functions, writing the results as JSON" + Environment.NewLine +
+                Environment.NewLine +
+                "DataFilterBenchmark.exe [/Sizes:1000,10000,100000,1000000,10000000] [/Threads:1,0] [/Name:Savitzky]" + Environment.NewLine +
+                "  [/MinMs:200] [/MinIterations:3] [/CpuGHz:3.0] [/O:results.json] [/NoNative]" + Environment.NewLine +
+                Environment.NewLine +
+                "/Sizes          Points per array; up to 50000000" + Environment.NewLine +
+                "/Threads        MaxDegreeOfParallelism values to sweep; 0 for one per processor" + Environment.NewLine +
+                "/Name           Only run benchmarks whose name contains this text" + Environment.NewLine +
+                "/MinMs          Time to spend on each measurement" + Environment.NewLine +
+                "/CpuGHz         Clock rate used to report bytes per cycle" + Environment.NewLine +
+                "/O              JSON output file; default is the console" + Environment.NewLine +
+                "/NoNative       Skip the icr2ls32.dll functions, which need Windows and a 32-bit process";
+        }
+
+        /// <summary>
+        /// Parse the command line
+        /// </summary>
+        /// <returns>True if success, False if error</returns>
+        public static bool TryParse(string[] args, out BenchmarkOptions options, out string errorMessage)
+        {
+            options = new BenchmarkOptions();
+
+            foreach (var arg in args)
+            {
+                var colon = arg.IndexOf(':');
+                var name = (colon < 0 ? arg.TrimStart('/', '-') : arg.Substring(0, colon).TrimStart('/', '-')).ToLowerInvariant();
+                var value = colon < 0 ? string.Empty : arg.Substring(colon + 1);
+
+                switch (name)
+                {
+                    case "sizes":
+                        if (!TryParseList(arg, value, 1, options.Sizes, out errorMessage))
+                            return false;
+                        break;
+                    case "threads":
+                        if (!TryParseList(arg, value, 0, options.Threads, out errorMessage))
+                            return false;
+                        break;
+                    case "name":
+                        options.NameFilter = value;
+                        break;
+                    case "minms":
+                        if (!TryParseDouble(arg, value, out var minMilliseconds, out errorMessage))
+                            return false;
+
+                        options.MinMilliseconds = minMilliseconds;
+                        break;
+                    case "miniterations":
+                        if (!int.TryParse(value, NumberStyles.Integer, CultureInfo.InvariantCulture, out var minIterations) || minIterations < 1)
+                        {
+                            errorMessage = "Expected an integer >= 1: " + arg;
+                            return false;
+                        }
+
+                        options.MinIterations = minIterations;
+                        break;
+                    case "cpughz":
+                        if (!TryParseDouble(arg, value, out var cpuGHz, out errorMessage))
+                            return false;
+
+                        options.CpuGHz = cpuGHz;
+                        break;
+                    case "o":
+                        options.OutputPath = value;
+                        break;
+                    case "nonative":
+                        options.Native = false;
+                        break;
+                    default:
+                        errorMessage = "Unknown switch: " + arg;
+                        return false;
+                }
+            }
+
+            errorMessage = string.Empty;
+            return true;
+        }
+
+        private static bool TryParseList(string arg, string value, int minimum, List<int> list, out string errorMessage)
+        {
+            list.Clear();
+
+            foreach (var item in value.Split(','))
+            {
+                if (!int.TryParse(item.Trim(), NumberStyles.Integer, CultureInfo.InvariantCulture, out var number) || number < minimum)
+                {
+                    errorMessage = "Expected a list of integers >= " + minimum + ": " + arg;
+                    return false;
+                }
+
+                list.Add(number);
+            }
+
+            errorMessage = string.Empty;
+            return list.Any();
+        }
+
+        private static bool TryParseDouble(string arg, string value, out double result, out string errorMessage)
+        {
+            if (!double.TryParse(value, NumberStyles.Float, CultureInfo.InvariantCulture, out result) || result <= 0)
+            {
+                errorMessage = "Expected a number > 0: " + arg;
+                return false;
+            }
+
+            errorMessage = string.Empty;
+            return true;
+        }
+    }
+}
@@ -0,0 +1,284 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Text;
+
+namespace DataFilterBenchmark
+{
+    /// <summary>
+    /// One measurement
+    /// </summary>
+    internal class BenchmarkResult
+    {
+        public string Name { get; set; }
+
+        /// <summary>
+        /// double, float, or the native type of the function
+        /// </summary>
+        public string DataType { get; set; }
+
+        public int Points { get; set; }
+
+        /// <summary>
+        /// Settings of the run, such as the window width and degree, in a fixed order
+        /// </summary>
+        public List<KeyValuePair<string, object>> Parameters { get; } = new List<KeyValuePair<string, object>>();
+
+        public int Threads { get; set; }
+
+        public int Iterations { get; set; }
+
+        public double MedianNanosecondsPerPoint { get; set; }
+
+        public double MinNanosecondsPerPoint { get; set; }
+
+        /// <summary>
+        /// Bytes read and written per point
+        /// </summary>
+        public int BytesPerPoint { get; set; }
+
+        /// <summary>
+        /// Set instead of the timings when the benchmark could not run
+        /// </summary>
+        public string Skipped { get; set; }
+
+        /// <summary>
+        /// Describe a run
+        /// </summary>
+        /// <param name="name"></param>
+        /// <param name="dataType"></param>
+        /// <param name="points"></param>
+        /// <param name="threads"></param>
+        /// <param name="bytesPerPoint"></param>
+        /// <param name="parameters">Alternating parameter names and values</param>
+        public static BenchmarkResult Create(string name, string dataType, int points, int threads, int bytesPerPoint, params object[] parameters)
+        {
+            var result = new BenchmarkResult
+            {
+                Name = name,
+                DataType = dataType,
+                Points = points,
+                Threads = threads,
+                BytesPerPoint = bytesPerPoint
+            };
+
+            for (var i = 0; i + 1 < parameters.Length; i += 2)
+            {
+                result.Parameters.Add(new KeyValuePair<string, object>((string)parameters[i], parameters[i + 1]));
+            }
+
+            return result;
+        }
+    }
+
+    /// <summary>
+    /// Times benchmarks and collects the results
+    /// </summary>
+    /// <remarks>
+    /// Each iteration runs the untimed setup, typically copying the input so that in-place filters start
+    /// from the same data, then the timed body. Iterations repeat until MinMilliseconds have been timed and
+    /// MinIterations have run; the median is reported as the result and the minimum as the best case
+    /// </remarks>
+    internal class BenchmarkRunner
+    {
+        private readonly BenchmarkOptions mOptions;
+
+        public List<BenchmarkResult> Results { get; } = new List<BenchmarkResult>();
+
+        public BenchmarkRunner(BenchmarkOptions options)
+        {
+            mOptions = options;
+        }
+
+        /// <summary>
+        /// True if the benchmark passes the name filter
+        /// </summary>
+        public bool IsSelected(string name)
+        {
+            return string.IsNullOrEmpty(mOptions.NameFilter) ||
+                   name.IndexOf(mOptions.NameFilter, StringComparison.OrdinalIgnoreCase) >= 0;
+        }
+
+        /// <summary>
+        /// A call that returns False and an error message when it fails
+        /// </summary>
+        public delegate bool CheckedCall(out string errorMessage);
+
+        /// <summary>
+        /// Time body, running setup before each iteration
+        /// </summary>
+        /// <param name="result">Describes the run; the timings are filled in</param>
+        /// <param name="setup">Untimed; may be null</param>
+        /// <param name="body"></param>
+        public void Measure(BenchmarkResult result, Action setup, Action body)
+        {
+            Measure(result, setup, (out string errorMessage) =>
+            {
+                body();
+                errorMessage = string.Empty;
+                return true;
+            });
+        }
+
+        /// <summary>
+        /// Time body, running setup before each iteration; if body fails, the run is recorded as skipped instead
+        /// </summary>
+        /// <param name="result">Describes the run; the timings are filled in</param>
+        /// <param name="setup">Untimed; may be null</param>
+        /// <param name="body"></param>
+        public void Measure(BenchmarkResult result, Action setup, CheckedCall body)
+        {
+            // Warm up, which also compiles the code paths
+            setup?.Invoke();
+            if (!body(out var errorMessage))
+            {
+                Skip(result, GetFailureReason(errorMessage));
+                return;
+            }
+
+            var times = new List<double>();
+            var total = 0.0;
+            var stopwatch = new Stopwatch();
+
+            while (times.Count < mOptions.MinIterations || total < mOptions.MinMilliseconds)
+            {
+                setup?.Invoke();
+
+                stopwatch.Restart();
+                var success = body(out errorMessage);
+                stopwatch.Stop();
+
+                if (!success)
+                {
+                    Skip(result, GetFailureReason(errorMessage));
+                    return;
+                }
+
+                var milliseconds = stopwatch.Elapsed.TotalMilliseconds;
+                times.Add(milliseconds);
+                total += milliseconds;
+            }
+
+            times.Sort();
+            result.Iterations = times.Count;
+            result.MedianNanosecondsPerPoint = times[times.Count / 2] * 1e6 / result.Points;
+            result.MinNanosecondsPerPoint = times[0] * 1e6 / result.Points;
+
+            Add(result);
+        }
+
+        private static string GetFailureReason(string errorMessage)
+        {
+            return string.IsNullOrEmpty(errorMessage) ? "The call returned False" : "The call failed: " + errorMessage;
+        }
+
+        /// <summary>
+        /// Record a benchmark that could not run
+        /// </summary>
+        public void Skip(BenchmarkResult result, string reason)
+        {
+            result.Skipped = reason;
+            Add(result);
+        }
+
+        /// <summary>
+        /// Write the results as JSON
+        /// </summary>
+        public void WriteJson(TextWriter writer)
+        {
+            var json = new StringBuilder();
+            json.Append("{\n");
+            json.Append("  \"machine\": ").Append(Quote(Environment.MachineName)).Append(",\n");
+            json.Append("  \"processorCount\": ").Append(Environment.ProcessorCount).Append(",\n");
+            json.Append("  \"is64BitProcess\": ").Append(Environment.Is64BitProcess ? "true" : "false").Append(",\n");
+            json.Append("  \"runtime\": ").Append(Quote(Environment.Version.ToString())).Append(",\n");
+            json.Append("  \"timestamp\": ").Append(Quote(DateTime.UtcNow.ToString("o", CultureInfo.InvariantCulture))).Append(",\n");
+            json.Append("  \"cpuGHz\": ").Append(mOptions.CpuGHz > 0 ? Number(mOptions.CpuGHz) : "null").Append(",\n");
+            json.Append("  \"results\": [");
+
+            for (var i = 0; i < Results.Count; i++)
+            {
+                var result = Results[i];
+                json.Append(i == 0 ? "\n" : ",\n");
+                json.Append("    { \"name\": ").Append(Quote(result.Name));
+                json.Append(", \"type\": ").Append(Quote(result.DataType));
+                json.Append(", \"points\": ").Append(result.Points);
+                json.Append(", \"threads\": ").Append(result.Threads);
+
+                foreach (var parameter in result.Parameters)
+                {
+                    json.Append(", ").Append(Quote(parameter.Key)).Append(": ");
+                    json.Append(parameter.Value is string text ? Quote(text) : Number(Convert.ToDouble(parameter.Value, CultureInfo.InvariantCulture)));
+                }
+
+                if (result.Skipped != null)
+                {
+                    json.Append(", \"skipped\": ").Append(Quote(result.Skipped)).Append(" }");
+                    continue;
+                }
+
+                var bytesPerNanosecond = result.BytesPerPoint / result.MedianNanosecondsPerPoint;
+
+                json.Append(", \"iterations\": ").Append(result.Iterations);
+                json.Append(", \"nsPerPoint\": ").Append(Number(result.MedianNanosecondsPerPoint));
+                json.Append(", \"minNsPerPoint\": ").Append(Number(result.MinNanosecondsPerPoint));
+                json.Append(", \"bytesPerPoint\": ").Append(result.BytesPerPoint);
+                json.Append(", \"bytesPerNs\": ").Append(Number(bytesPerNanosecond));
+                json.Append(", \"bytesPerCycle\": ").Append(mOptions.CpuGHz > 0 ? Number(bytesPerNanosecond / mOptions.CpuGHz) : "null");
+                json.Append(" }");
+            }
+
+            json.Append("\n  ]\n}\n");
+            writer.Write(json.ToString());
+        }
+
+        private void Add(BenchmarkResult result)
+        {
+            Results.Add(result);
+
+            var parameters = string.Join(" ", result.Parameters.Select(p => p.Key + "=" + p.Value));
+            var timing = result.Skipped != null
+                ? "skipped: " + result.Skipped
+                : string.Format(CultureInfo.InvariantCulture, "{0:F2} ns/point", result.MedianNanosecondsPerPoint);
+
+            Console.Error.WriteLine("{0,-34} {1,-7} {2,10:N0} pts  threads={3,-3} {4,-28} {5}",
+                result.Name, result.DataType, result.Points, result.Threads, parameters, timing);
+        }
+
+        private static string Number(double value)
+        {
+            if (double.IsNaN(value) || double.IsInfinity(value))
+                return "null";
+
+            return value.ToString("G6", CultureInfo.InvariantCulture);
+        }
+
+        private static string Quote(string text)
+        {
+            var quoted = new StringBuilder("\"");
+            foreach (var c in text)
+            {
+                switch (c)
+                {
+                    case '"':
+                        quoted.Append("\\\"");
+                        break;
+                    case '\\':
+                        quoted.Append("\\\\");
+                        break;
+                    default:
+                        if (c < ' ')
+                            quoted.AppendFormat("\\u{0:x4}", (int)c);
+                        else
+                            quoted.Append(c);
+                        break;
+                }
+            }
+
+            return quoted.Append('"').ToString();
+        }
+    }
+}
@@ -0,0 +1,89 @@
+using System;
+
+namespace DataFilterBenchmark
+{
+    /// <summary>
+    /// Synthetic spectra for the benchmarks, the same for every run
+    /// </summary>
+    internal static class DataGenerator
+    {
+        private const int RANDOM_SEED = 1234;
+
+        /// <summary>
+        /// Profile data: Gaussian peaks about 20 points wide on a noisy baseline
+        /// </summary>
+        public static double[] Profile(int pointCount)
+        {
+            var rand = new Random(RANDOM_SEED);
+            var data = new double[pointCount];
+
+            for (var i = 0; i < pointCount; i++)
+            {
+                data[i] = 50 + 10 * rand.NextDouble();
+            }
+
+            for (var peak = rand.Next(100); peak < pointCount; peak += 50 + rand.Next(200))
+            {
+                var height = 1000 + 100000 * rand.NextDouble();
+                for (var i = Math.Max(peak - 30, 0); i < Math.Min(peak + 30, pointCount); i++)
+                {
+                    var u = (i - peak) / 6.0;
+                    data[i] += height * Math.Exp(-u * u / 2);
+                }
+            }
+
+            return data;
+        }
+
+        /// <summary>
+        /// Thresholded profile data: short peaks separated by runs of exact zeros, about 90% of the points
+        /// </summary>
+        public static double[] Thresholded(int pointCount)
+        {
+            var rand = new Random(RANDOM_SEED);
+            var data = new double[pointCount];
+
+            for (var i = 0; i < pointCount; i++)
+            {
+                if (rand.NextDouble() >= 0.01)
+                    continue;
+
+                for (var k = 0; k < 10 && i < pointCount; k++, i++)
+                {
+                    data[i] = 1000 * rand.NextDouble();
+                }
+            }
+
+            return data;
+        }
+
+        /// <summary>
+        /// m/z values whose spacing grows along the spectrum, as on a TOF axis, with some jitter
+        /// </summary>
+        public static double[] NonUniformX(int pointCount)
+        {
+            var rand = new Random(RANDOM_SEED);
+            var x = new double[pointCount];
+            var mz = 400.0;
+
+            for (var i = 0; i < pointCount; i++)
+            {
+                mz += 0.002 + 1e-8 * i + 0.001 * rand.NextDouble();
+                x[i] = mz;
+            }
+
+            return x;
+        }
+
+        public static float[] ToFloat(double[] data)
+        {
+            var result = new float[data.Length];
+            for (var i = 0; i < data.Length; i++)
+            {
+                result[i] = (float)data[i];
+            }
+
+            return result;
+        }
+    }
+}
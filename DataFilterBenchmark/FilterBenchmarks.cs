@@ -0,0 +1,319 @@
+using System;
+using DataFilter;
+
+namespace DataFilterBenchmark
+{
+    /// <summary>
+    /// Times the DataFilter filters over the sizes and thread counts of the options
+    /// </summary>
+    /// <remarks>
+    /// Unless noted, a point is read and written once, so BytesPerPoint is twice the value size
+    /// </remarks>
+    internal class FilterBenchmarks
+    {
+        private static readonly int[] mNumPointsLeftRight = { 3, 5, 12, 25, 50 };
+        private static readonly short[] mPolynomialDegrees = { 2, 4 };
+        private static readonly int[] mWindowWidths = { 5, 9, 25, 101 };
+
+        /// <summary>
+        /// Points Decimate reduces a spectrum to, as when drawing it
+        /// </summary>
+        private const int DECIMATED_POINTS = 2000;
+
+        private readonly BenchmarkOptions mOptions;
+        private readonly BenchmarkRunner mRunner;
+
+        public FilterBenchmarks(BenchmarkOptions options, BenchmarkRunner runner)
+        {
+            mOptions = options;
+            mRunner = runner;
+        }
+
+        public void Run()
+        {
+            foreach (var size in mOptions.Sizes)
+            {
+                var profile = DataGenerator.Profile(size);
+                var profileFloat = DataGenerator.ToFloat(profile);
+                var thresholded = DataGenerator.Thresholded(size);
+
+                foreach (var threads in mOptions.Threads)
+                {
+                    var filter = new DataFilter.DataFilter { MaxDegreeOfParallelism = threads };
+
+                    RunSavitzkyGolay(filter, profile, profileFloat, threads);
+                    RunMovingWindowAverage(filter, profile, profileFloat, threads);
+                    RunDerivatives(filter, profile, profileFloat, threads);
+                    RunNonUniform(filter, profile, threads);
+                    RunSkipZeroRuns(threads, thresholded);
+                    RunCompressedSpectrum(filter, DataGenerator.ToFloat(thresholded), threads);
+
+                    // The recursion runs front to back, so it does not use the other threads
+                    if (threads == 1)
+                        RunButterworth(filter, profile, profileFloat);
+                }
+            }
+        }
+
+        private void RunSavitzkyGolay(DataFilter.DataFilter filter, double[] profile, float[] profileFloat, int threads)
+        {
+            var size = profile.Length;
+            var work = new double[size];
+            var workFloat = new float[size];
+
+            foreach (var numPointsLeftRight in mNumPointsLeftRight)
+            {
+                foreach (var polynomialDegree in mPolynomialDegrees)
+                {
+                    if (mRunner.IsSelected("SavitzkyGolayFilter"))
+                    {
+                        mRunner.Measure(
+                            BenchmarkResult.Create("SavitzkyGolayFilter", "double", size, threads, 2 * sizeof(double),
+                                "numPointsLeftRight", numPointsLeftRight, "polynomialDegree", polynomialDegree),
+                            () => Array.Copy(profile, work, size),
+                            (out string errorMessage) => filter.SavitzkyGolayFilter(work, 0, size - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage));
+
+                        mRunner.Measure(
+                            BenchmarkResult.Create("SavitzkyGolayFilter", "float", size, threads, 2 * sizeof(float),
+                                "numPointsLeftRight", numPointsLeftRight, "polynomialDegree", polynomialDegree),
+                            () => Array.Copy(profileFloat, workFloat, size),
+                            (out string errorMessage) => filter.SavitzkyGolayFilter(workFloat, 0, size - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage));
+                    }
+
+                    if (!mRunner.IsSelected("SavitzkyGolayPlan") || 2 * numPointsLeftRight + 1 > size)
+                        continue;
+
+                    var plan = new SavitzkyGolayPlan(numPointsLeftRight, numPointsLeftRight, polynomialDegree);
+
+                    mRunner.Measure(
+                        BenchmarkResult.Create("SavitzkyGolayPlan", "double", size, threads, 2 * sizeof(double),
+                            "numPointsLeftRight", numPointsLeftRight, "polynomialDegree", polynomialDegree),
+                        () => Array.Copy(profile, work, size),
+                        (out string errorMessage) => filter.SavitzkyGolayFilter(work, 0, size - 1, plan, out errorMessage));
+
+                    mRunner.Measure(
+                        BenchmarkResult.Create("SavitzkyGolayPlan", "float", size, threads, 2 * sizeof(float),
+                            "numPointsLeftRight", numPointsLeftRight, "polynomialDegree", polynomialDegree),
+                        () => Array.Copy(profileFloat, workFloat, size),
+                        (out string errorMessage) => filter.SavitzkyGolayFilter(workFloat, 0, size - 1, plan, out errorMessage));
+                }
+            }
+        }
+
+        private void RunMovingWindowAverage(DataFilter.DataFilter filter, double[] profile, float[] profileFloat, int threads)
+        {
+            if (!mRunner.IsSelected("MovingWindowAverage"))
+                return;
+
+            var size = profile.Length;
+            var work = new double[size];
+            var workFloat = new float[size];
+
+            foreach (var windowWidth in mWindowWidths)
+            {
+                mRunner.Measure(
+                    BenchmarkResult.Create("MovingWindowAverage", "double", size, threads, 2 * sizeof(double), "windowWidth", windowWidth),
+                    () => Array.Copy(profile, work, size),
+                    (out string errorMessage) => filter.MovingWindowAverage(work, 0, size - 1, windowWidth, out errorMessage));
+
+                mRunner.Measure(
+                    BenchmarkResult.Create("MovingWindowAverage", "float", size, threads, 2 * sizeof(float), "windowWidth", windowWidth),
+                    () => Array.Copy(profileFloat, workFloat, size),
+                    (out string errorMessage) => filter.MovingWindowAverage(workFloat, 0, size - 1, windowWidth, out errorMessage));
+            }
+        }
+
+        private void RunButterworth(DataFilter.DataFilter filter, double[] profile, float[] profileFloat)
+        {
+            if (!mRunner.IsSelected("ButterworthFilter"))
+                return;
+
+            var size = profile.Length;
+            var work = new double[size];
+            var workFloat = new float[size];
+
+            mRunner.Measure(
+                BenchmarkResult.Create("ButterworthFilter", "double", size, 1, 2 * sizeof(double), "samplingFrequency", 0.25),
+                () => Array.Copy(profile, work, size),
+                (out string errorMessage) =>
+                {
+                    errorMessage = string.Empty;
+                    return filter.ButterworthFilter(work, 0, size - 1);
+                });
+
+            mRunner.Measure(
+                BenchmarkResult.Create("ButterworthFilter", "float", size, 1, 2 * sizeof(float), "samplingFrequency", 0.25),
+                () => Array.Copy(profileFloat, workFloat, size),
+                (out string errorMessage) =>
+                {
+                    errorMessage = string.Empty;
+                    return filter.ButterworthFilter(workFloat, 0, size - 1);
+                });
+        }
+
+        private void RunDerivatives(DataFilter.DataFilter filter, double[] profile, float[] profileFloat, int threads)
+        {
+            const int NUM_POINTS_LEFT_RIGHT = 5;
+            const short POLYNOMIAL_DEGREE = 3;
+
+            var size = profile.Length;
+            if (!mRunner.IsSelected("SavitzkyGolayDerivatives") || 2 * NUM_POINTS_LEFT_RIGHT + 1 > size)
+                return;
+
+            // The data is read and the smoothed data and both derivatives are written
+            var smoothed = new double[size];
+            var first = new double[size];
+            var second = new double[size];
+
+            mRunner.Measure(
+                BenchmarkResult.Create("SavitzkyGolayDerivatives", "double", size, threads, 4 * sizeof(double),
+                    "numPointsLeftRight", NUM_POINTS_LEFT_RIGHT, "polynomialDegree", POLYNOMIAL_DEGREE),
+                null,
+                (out string errorMessage) => filter.SavitzkyGolayDerivatives(profile, 0, size - 1, NUM_POINTS_LEFT_RIGHT, NUM_POINTS_LEFT_RIGHT, POLYNOMIAL_DEGREE,
+                                                                             smoothed, first, second, out errorMessage));
+
+            var smoothedFloat = new float[size];
+            var firstFloat = new float[size];
+            var secondFloat = new float[size];
+
+            mRunner.Measure(
+                BenchmarkResult.Create("SavitzkyGolayDerivatives", "float", size, threads, 4 * sizeof(float),
+                    "numPointsLeftRight", NUM_POINTS_LEFT_RIGHT, "polynomialDegree", POLYNOMIAL_DEGREE),
+                null,
+                (out string errorMessage) => filter.SavitzkyGolayDerivatives(profileFloat, 0, size - 1, NUM_POINTS_LEFT_RIGHT, NUM_POINTS_LEFT_RIGHT, POLYNOMIAL_DEGREE,
+                                                                             smoothedFloat, firstFloat, secondFloat, out errorMessage));
+        }
+
+        private void RunNonUniform(DataFilter.DataFilter filter, double[] profile, int threads)
+        {
+            const int NUM_POINTS_LEFT_RIGHT = 4;
+            const short POLYNOMIAL_DEGREE = 2;
+
+            var size = profile.Length;
+            if (2 * NUM_POINTS_LEFT_RIGHT + 1 > size)
+                return;
+
+            var xValues = DataGenerator.NonUniformX(size);
+            var work = new double[size];
+
+            // x is read as well as the data
+            if (mRunner.IsSelected("NonUniformSavitzkyGolay"))
+            {
+                mRunner.Measure(
+                    BenchmarkResult.Create("NonUniformSavitzkyGolay", "double", size, threads, 3 * sizeof(double),
+                        "numPointsLeftRight", NUM_POINTS_LEFT_RIGHT, "polynomialDegree", POLYNOMIAL_DEGREE),
+                    () => Array.Copy(profile, work, size),
+                    (out string errorMessage) => filter.SavitzkyGolayFilter(work, xValues, 0, size - 1, NUM_POINTS_LEFT_RIGHT, NUM_POINTS_LEFT_RIGHT, POLYNOMIAL_DEGREE, out errorMessage));
+            }
+
+            if (mRunner.IsSelected("NonUniformMovingWindowAverage"))
+            {
+                // About nine points wide
+                const double WINDOW_WIDTH_X = 0.03;
+
+                mRunner.Measure(
+                    BenchmarkResult.Create("NonUniformMovingWindowAverage", "double", size, threads, 3 * sizeof(double), "windowWidthX", WINDOW_WIDTH_X),
+                    () => Array.Copy(profile, work, size),
+                    (out string errorMessage) => filter.MovingWindowAverage(work, xValues, 0, size - 1, WINDOW_WIDTH_X, out errorMessage));
+            }
+        }
+
+        private void RunSkipZeroRuns(int threads, double[] thresholded)
+        {
+            const int NUM_POINTS_LEFT_RIGHT = 5;
+            const short POLYNOMIAL_DEGREE = 2;
+            const int WINDOW_WIDTH = 9;
+
+            var size = thresholded.Length;
+            var work = new double[size];
+
+            foreach (var skipZeroRuns in new[] { false, true })
+            {
+                var filter = new DataFilter.DataFilter { MaxDegreeOfParallelism = threads, SkipZeroRuns = skipZeroRuns };
+                var setting = skipZeroRuns ? "on" : "off";
+
+                if (mRunner.IsSelected("SkipZeroRunsSavitzkyGolay"))
+                {
+                    mRunner.Measure(
+                        BenchmarkResult.Create("SkipZeroRunsSavitzkyGolay", "double", size, threads, 2 * sizeof(double),
+                            "skipZeroRuns", setting, "numPointsLeftRight", NUM_POINTS_LEFT_RIGHT, "polynomialDegree", POLYNOMIAL_DEGREE),
+                        () => Array.Copy(thresholded, work, size),
+                        (out string errorMessage) => filter.SavitzkyGolayFilter(work, 0, size - 1, NUM_POINTS_LEFT_RIGHT, NUM_POINTS_LEFT_RIGHT, POLYNOMIAL_DEGREE, out errorMessage));
+                }
+
+                if (mRunner.IsSelected("SkipZeroRunsMovingWindowAverage"))
+                {
+                    mRunner.Measure(
+                        BenchmarkResult.Create("SkipZeroRunsMovingWindowAverage", "double", size, threads, 2 * sizeof(double),
+                            "skipZeroRuns", setting, "windowWidth", WINDOW_WIDTH),
+                        () => Array.Copy(thresholded, work, size),
+                        (out string errorMessage) => filter.MovingWindowAverage(work, 0, size - 1, WINDOW_WIDTH, out errorMessage));
+                }
+            }
+        }
+
+        /// <summary>
+        /// Time the CompressedSpectrum conversions, Decimate, CoAdd and smoothing; BytesPerPoint counts the uncompressed values
+        /// </summary>
+        private void RunCompressedSpectrum(DataFilter.DataFilter filter, float[] thresholded, int threads)
+        {
+            const int NUM_POINTS_LEFT_RIGHT = 5;
+            const short POLYNOMIAL_DEGREE = 2;
+
+            var size = thresholded.Length;
+            var spectrum = CompressedSpectrum.FromArray(thresholded);
+
+            // Conversion and decimation run on one thread whatever the setting, so they are timed once
+            if (threads == 1)
+            {
+                if (mRunner.IsSelected("CompressedSpectrumFromArray"))
+                {
+                    mRunner.Measure(
+                        BenchmarkResult.Create("CompressedSpectrumFromArray", "float", size, 1, sizeof(float)),
+                        null,
+                        () => CompressedSpectrum.FromArray(thresholded));
+                }
+
+                if (mRunner.IsSelected("CompressedSpectrumToArray"))
+                {
+                    mRunner.Measure(
+                        BenchmarkResult.Create("CompressedSpectrumToArray", "float", size, 1, sizeof(float)),
+                        null,
+                        () => spectrum.ToArray());
+                }
+
+                if (mRunner.IsSelected("CompressedSpectrumDecimate"))
+                {
+                    var output = new float[DECIMATED_POINTS + 1];
+                    var skip = size / DECIMATED_POINTS + 1;
+
+                    mRunner.Measure(
+                        BenchmarkResult.Create("CompressedSpectrumDecimate", "float", size, 1, sizeof(float), "mode", "Max", "maxN", DECIMATED_POINTS),
+                        null,
+                        () => spectrum.Decimate(0, size, skip, CompressedSpectrum.DecimationMode.Max, output));
+                }
+
+                if (mRunner.IsSelected("CompressedSpectrumCoAdd"))
+                {
+                    var spectra = new[] { spectrum, spectrum, spectrum, spectrum };
+
+                    mRunner.Measure(
+                        BenchmarkResult.Create("CompressedSpectrumCoAdd", "float", size, 1, (spectra.Length + 1) * sizeof(float), "spectra", spectra.Length),
+                        null,
+                        () => CompressedSpectrum.CoAdd(spectra));
+                }
+            }
+
+            if (mRunner.IsSelected("CompressedSpectrumSavitzkyGolay") && 2 * NUM_POINTS_LEFT_RIGHT + 1 <= size)
+            {
+                var plan = new SavitzkyGolayPlan(NUM_POINTS_LEFT_RIGHT, NUM_POINTS_LEFT_RIGHT, POLYNOMIAL_DEGREE);
+
+                mRunner.Measure(
+                    BenchmarkResult.Create("CompressedSpectrumSavitzkyGolay", "float", size, threads, 2 * sizeof(float),
+                        "numPointsLeftRight", NUM_POINTS_LEFT_RIGHT, "polynomialDegree", POLYNOMIAL_DEGREE),
+                    null,
+                    (out string errorMessage) => filter.SavitzkyGolayFilter(spectrum, plan, out _, out errorMessage));
+            }
+        }
+    }
+}
@@ -0,0 +1,259 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Runtime.InteropServices;
+
+namespace DataFilterBenchmark
+{
+    /// <summary>
+    /// Times the huge array functions exported by icr2ls32.dll
+    /// </summary>
+    /// <remarks>
+    /// The DLL is 32-bit Windows only; elsewhere every native benchmark is reported as skipped.
+    /// The copy of the DLL in VB6_Source is an older build than the C sources next to it, and lacks
+    /// HugeSetThreads, so it is timed at its default thread count; rebuild it to time the current code
+    /// </remarks>
+    internal class NativeBenchmarks
+    {
+        /// <summary>
+        /// Points HugeExtract reduces each array to, as when drawing a spectrum
+        /// </summary>
+        private const int EXTRACT_POINTS = 2000;
+
+        /// <summary>
+        /// Largest array CurvReg is timed on
+        /// </summary>
+        /// <remarks>
+        /// CurvReg builds several full-length matrices, with a separate allocation for each row of the n by 1 ones,
+        /// leaks the intermediate products, and does not check most of the allocations for NULL; at a few million
+        /// points that is around 1 GB, more than a 32-bit process can be sure of getting
+        /// </remarks>
+        private const int MAX_CURVREG_POINTS = 1000000;
+
+        /// <summary>
+        /// _lopen read-only mode
+        /// </summary>
+        private const int OF_READ = 0;
+
+        private static readonly string[] mNames =
+        {
+            "HugeExtract", "HugeLoadFloat", "HugeLoadInt", "HugeLoadLong", "CurvReg", "SearchMW"
+        };
+
+        private readonly BenchmarkOptions mOptions;
+        private readonly BenchmarkRunner mRunner;
+
+        public NativeBenchmarks(BenchmarkOptions options, BenchmarkRunner runner)
+        {
+            mOptions = options;
+            mRunner = runner;
+        }
+
+        public void Run()
+        {
+            var unavailable = GetUnavailableReason();
+            if (unavailable != null)
+            {
+                foreach (var name in mNames)
+                {
+                    if (mRunner.IsSelected(name))
+                        mRunner.Skip(BenchmarkResult.Create(name, "native", 0, 0, 0), unavailable);
+                }
+
+                return;
+            }
+
+            foreach (var threads in GetThreadCounts())
+            {
+                foreach (var size in mOptions.Sizes)
+                {
+                    RunArrayBenchmarks(size, threads);
+                }
+
+                if (mRunner.IsSelected("SearchMW"))
+                    RunSearchMW(threads);
+            }
+        }
+
+        /// <summary>
+        /// Thread counts to sweep; only the default if the DLL cannot set them
+        /// </summary>
+        private IEnumerable<int> GetThreadCounts()
+        {
+            try
+            {
+                NativeMethods.HugeSetThreads(0);
+                return mOptions.Threads;
+            }
+            catch (EntryPointNotFoundException)
+            {
+                return new[] { 0 };
+            }
+        }
+
+        private static string GetUnavailableReason()
+        {
+            if (Environment.OSVersion.Platform != PlatformID.Win32NT)
+                return "icr2ls32.dll needs Windows";
+
+            if (Environment.Is64BitProcess)
+                return "icr2ls32.dll needs a 32-bit process";
+
+            try
+            {
+                var handle = 0;
+                if (NativeMethods.HugeDim(ref handle, sizeof(float), 1) != 0)
+                    return "HugeDim failed";
+
+                NativeMethods.HugeErase(handle);
+                return null;
+            }
+            catch (Exception ex) when (ex is DllNotFoundException || ex is BadImageFormatException || ex is EntryPointNotFoundException)
+            {
+                return ex.GetType().Name + ": " + ex.Message;
+            }
+        }
+
+        private void RunArrayBenchmarks(int size, int threads)
+        {
+            var handle = 0;
+            if (NativeMethods.HugeDim(ref handle, sizeof(float), size) != 0)
+            {
+                mRunner.Skip(BenchmarkResult.Create("HugeDim", "float", size, threads, 0), "HugeDim could not allocate the array");
+                return;
+            }
+
+            try
+            {
+                SetThreads(threads);
+
+                var profile = DataGenerator.ToFloat(DataGenerator.Profile(size));
+                Marshal.Copy(profile, 0, new IntPtr(handle), size);
+
+                if (mRunner.IsSelected("HugeExtract"))
+                {
+                    var values = new float[EXTRACT_POINTS + 1];
+
+                    // Comb, alternating max/min, and max
+                    foreach (var option in new[] { 1, 2, 5 })
+                    {
+                        var result = BenchmarkResult.Create("HugeExtract", "float", size, threads, sizeof(float), "option", option, "maxN", EXTRACT_POINTS);
+                        mRunner.Measure(result, null, () =>
+                        {
+                            float max = 0, min = 0;
+                            NativeMethods.HugeExtract(ref handle, values, ref max, ref min, 0, size - 1, EXTRACT_POINTS, option);
+                        });
+                    }
+                }
+
+                RunLoadBenchmark("HugeLoadFloat", size, threads, sizeof(float), ref handle,
+                    (ref int lpdata, int hFile) => NativeMethods.HugeLoadFloat(ref lpdata, size, hFile, 0));
+
+                RunLoadBenchmark("HugeLoadInt", size, threads, sizeof(short), ref handle,
+                    (ref int lpdata, int hFile) => NativeMethods.HugeLoadInt(ref lpdata, size, hFile, 0, 0));
+
+                RunLoadBenchmark("HugeLoadLong", size, threads, sizeof(int), ref handle,
+                    (ref int lpdata, int hFile) => NativeMethods.HugeLoadLong(ref lpdata, size, hFile, 0, 0));
+
+                if (mRunner.IsSelected("CurvReg") && size > MAX_CURVREG_POINTS)
+                {
+                    mRunner.Skip(BenchmarkResult.Create("CurvReg", "double", size, threads, 2 * sizeof(double), "nterms", 3),
+                        "CurvReg is only timed up to " + MAX_CURVREG_POINTS + " points, since it does not check its allocations");
+                }
+                else if (mRunner.IsSelected("CurvReg"))
+                {
+                    var x = new double[size];
+                    var y = new double[size];
+                    for (var i = 0; i < size; i++)
+                    {
+                        x[i] = i / (double)size;
+                        y[i] = profile[i];
+                    }
+
+                    var terms = new double[4];
+                    var result = BenchmarkResult.Create("CurvReg", "double", size, threads, 2 * sizeof(double), "nterms", 3);
+                    mRunner.Measure(result, null, (out string errorMessage) =>
+                    {
+                        double mse = 0;
+                        errorMessage = "CurvReg could not allocate its weights";
+                        return NativeMethods.CurvReg(x, y, (uint)size, terms, 3, ref mse) == 0;
+                    });
+                }
+            }
+            finally
+            {
+                NativeMethods.HugeErase(handle);
+            }
+        }
+
+        private delegate int LoadFunction(ref int lpdata, int hFile);
+
+        /// <summary>
+        /// Time loading size values of valueBytes each from a file the OS has cached
+        /// </summary>
+        private void RunLoadBenchmark(string name, int size, int threads, int valueBytes, ref int handle, LoadFunction load)
+        {
+            if (!mRunner.IsSelected(name))
+                return;
+
+            var path = Path.GetTempFileName();
+            try
+            {
+                File.WriteAllBytes(path, new byte[(long)size * valueBytes]);
+
+                var hFile = NativeMethods._lopen(path, OF_READ);
+                if (hFile == -1)
+                {
+                    mRunner.Skip(BenchmarkResult.Create(name, "native", size, threads, 0), "_lopen failed");
+                    return;
+                }
+
+                try
+                {
+                    var lpdata = handle;
+                    var result = BenchmarkResult.Create(name, "float", size, threads, valueBytes + sizeof(float));
+                    mRunner.Measure(result, null, () => load(ref lpdata, hFile));
+                }
+                finally
+                {
+                    NativeMethods._lclose(hFile);
+                }
+            }
+            finally
+            {
+                File.Delete(path);
+            }
+        }
+
+        /// <summary>
+        /// Time one search, reported per search rather than per point
+        /// </summary>
+        private void RunSearchMW(int threads)
+        {
+            SetThreads(threads);
+
+            // Average and monoisotopic masses of C50H80N14O15S
+            const double MASS = 1165.33;
+            const double MONO_MASS = 1164.56;
+
+            var result = BenchmarkResult.Create("SearchMW", "native", 1, threads, 0, "mass", MASS);
+            mRunner.Measure(result, null, () =>
+            {
+                int c = 50, h = 80, n = 14, o = 15, s = 1;
+                NativeMethods.SearchMW(ref c, ref h, ref n, ref o, ref s, MASS, MONO_MASS);
+            });
+        }
+
+        private static void SetThreads(int threads)
+        {
+            try
+            {
+                NativeMethods.HugeSetThreads(threads);
+            }
+            catch (EntryPointNotFoundException)
+            {
+                // Older builds of the DLL are single threaded
+            }
+        }
+    }
+}
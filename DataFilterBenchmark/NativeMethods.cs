@@ -0,0 +1,52 @@
+using System.Runtime.InteropServices;
+
+namespace DataFilterBenchmark
+{
+    /// <summary>
+    /// Exports of icr2ls32.dll (VB6_Source), which is a 32-bit Windows DLL
+    /// </summary>
+    /// <remarks>
+    /// A huge array is an int holding the address of memory allocated by HugeDim;
+    /// the functions take a pointer to that int, and HugeErase takes the int itself
+    /// </remarks>
+    internal static class NativeMethods
+    {
+        private const string ICR2LS_DLL = "icr2ls32.dll";
+
+        [DllImport(ICR2LS_DLL, CallingConvention = CallingConvention.StdCall)]
+        public static extern int HugeDim(ref int lpdata, int recsize, int ubound);
+
+        [DllImport(ICR2LS_DLL, CallingConvention = CallingConvention.StdCall)]
+        public static extern int HugeErase(int lpdata);
+
+        [DllImport(ICR2LS_DLL, CallingConvention = CallingConvention.StdCall)]
+        public static extern int HugeExtract(ref int lpdata, float[] fVals, ref float max, ref float min, int start, int stop, int maxN, int option);
+
+        [DllImport(ICR2LS_DLL, CallingConvention = CallingConvention.StdCall)]
+        public static extern int HugeLoadInt(ref int lpdata, int num, int hLoadFile, int pos, int byteOrder);
+
+        [DllImport(ICR2LS_DLL, CallingConvention = CallingConvention.StdCall)]
+        public static extern int HugeLoadLong(ref int lpdata, int num, int hLoadFile, int pos, int byteOrder);
+
+        [DllImport(ICR2LS_DLL, CallingConvention = CallingConvention.StdCall)]
+        public static extern int HugeLoadFloat(ref int lpdata, int num, int hLoadFile, int pos);
+
+        [DllImport(ICR2LS_DLL, CallingConvention = CallingConvention.StdCall)]
+        public static extern int HugeSetThreads(int num);
+
+        [DllImport(ICR2LS_DLL, CallingConvention = CallingConvention.StdCall)]
+        public static extern int SearchMW(ref int c, ref int h, ref int n, ref int o, ref int s, double mass, double monoMass);
+
+        [DllImport(ICR2LS_DLL, CallingConvention = CallingConvention.StdCall)]
+        public static extern int CurvReg(double[] x, double[] y, uint n, double[] terms, uint nterms, ref double mse);
+
+        /// <summary>
+        /// Open a file for the HugeLoad functions, which read with _lread
+        /// </summary>
+        [DllImport("kernel32.dll", CharSet = CharSet.Ansi, BestFitMapping = false)]
+        public static extern int _lopen(string lpPathName, int iReadWrite);
+
+        [DllImport("kernel32.dll")]
+        public static extern int _lclose(int hFile);
+    }
+}
@@ -0,0 +1,66 @@
+using System;
+using System.IO;
+
+namespace DataFilterBenchmark
+{
+    /// <summary>
+    /// Times the filters over a range of array sizes and thread counts, writing the results as JSON
+    /// so that runs can be compared across builds and machines
+    /// </summary>
+    class Program
+    {
+        static int Main(string[] args)
+        {
+            if (!BenchmarkOptions.TryParse(args, out var options, out var errorMessage))
+            {
+                Console.WriteLine(errorMessage);
+                Console.WriteLine();
+                Console.WriteLine(BenchmarkOptions.GetUsage());
+                return 1;
+            }
+
+            var runner = new BenchmarkRunner(options);
+
+            try
+            {
+                new FilterBenchmarks(options, runner).Run();
+
+                if (options.Native)
+                    new NativeBenchmarks(options, runner).Run();
+            }
+            catch (OutOfMemoryException)
+            {
+                Console.Error.WriteLine("Out of memory; try smaller /Sizes");
+                WriteResults(runner, options);
+                return 2;
+            }
+
+            return WriteResults(runner, options) ? 0 : 2;
+        }
+
+        private static bool WriteResults(BenchmarkRunner runner, BenchmarkOptions options)
+        {
+            if (string.IsNullOrEmpty(options.OutputPath))
+            {
+                runner.WriteJson(Console.Out);
+                return true;
+            }
+
+            try
+            {
+                using (var writer = new StreamWriter(options.OutputPath))
+                {
+                    runner.WriteJson(writer);
+                }
+
+                Console.Error.WriteLine("Results written to " + options.OutputPath);
+                return true;
+            }
+            catch (IOException ex)
+            {
+                Console.Error.WriteLine("Error writing " + options.OutputPath + ": " + ex.Message);
+                return false;
+            }
+        }
+    }
+}
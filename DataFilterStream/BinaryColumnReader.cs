@@ -0,0 +1,98 @@
+using System;
+using System.IO;
+
+namespace DataFilterStream
+{
+    /// <summary>
+    /// Reads rows of little-endian float32 or float64 values
+    /// </summary>
+    internal class BinaryColumnReader : ColumnReader
+    {
+        private readonly Stream mStream;
+        private readonly BinaryFormat mFormat;
+        private readonly int mMaxRows;
+        private readonly int mValueBytes;
+        private byte[] mBuffer;
+
+        /// <summary>
+        /// Rows read so far
+        /// </summary>
+        private long mRowsRead;
+
+        /// <summary>
+        /// Constructor
+        /// </summary>
+        /// <param name="path"></param>
+        /// <param name="format"></param>
+        /// <param name="columnCount">Values per row</param>
+        /// <param name="maxRows">Most rows per chunk</param>
+        public BinaryColumnReader(string path, BinaryFormat format, int columnCount, int maxRows)
+        {
+            mStream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.Read, 1 << 16, FileOptions.SequentialScan);
+            mFormat = format;
+            mValueBytes = format == BinaryFormat.Float32 ? sizeof(float) : sizeof(double);
+            ColumnCount = columnCount;
+
+            // Chunks are capped at 256 MB of file data
+            mMaxRows = (int)Math.Max(1, Math.Min(maxRows, (256L << 20) / (mValueBytes * columnCount)));
+        }
+
+        /// <summary>
+        /// Read the next chunk of rows
+        /// </summary>
+        public override int ReadChunk(out double[][] columns)
+        {
+            var rowBytes = mValueBytes * ColumnCount;
+
+            if (mBuffer == null)
+                mBuffer = new byte[mMaxRows * rowBytes];
+
+            var bytesRead = 0;
+            while (bytesRead < mBuffer.Length)
+            {
+                var count = mStream.Read(mBuffer, bytesRead, mBuffer.Length - bytesRead);
+                if (count == 0)
+                    break;
+
+                bytesRead += count;
+            }
+
+            if (bytesRead % rowBytes != 0)
+                throw new InvalidDataException("The file ends part way through row " + (mRowsRead + bytesRead / rowBytes + 1));
+
+            var rowCount = bytesRead / rowBytes;
+            columns = new double[ColumnCount][];
+
+            for (var column = 0; column < ColumnCount; column++)
+            {
+                var values = new double[rowCount];
+                var offset = column * mValueBytes;
+
+                if (mFormat == BinaryFormat.Float32)
+                {
+                    for (var row = 0; row < rowCount; row++, offset += rowBytes)
+                    {
+                        values[row] = BitConverter.ToSingle(mBuffer, offset);
+                    }
+                }
+                else
+                {
+                    for (var row = 0; row < rowCount; row++, offset += rowBytes)
+                    {
+                        values[row] = BitConverter.ToDouble(mBuffer, offset);
+                    }
+                }
+
+                columns[column] = values;
+            }
+
+            mRowsRead += rowCount;
+            return rowCount;
+        }
+
+        public override void Dispose()
+        {
+            mStream.Dispose();
+        }
+    }
+}
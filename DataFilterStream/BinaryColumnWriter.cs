@@ -0,0 +1,73 @@
+using System;
+using System.IO;
+
+namespace DataFilterStream
+{
+    /// <summary>
+    /// Writes rows of little-endian float32 or float64 values
+    /// </summary>
+    internal class BinaryColumnWriter : ColumnWriter
+    {
+        private readonly Stream mStream;
+        private readonly BinaryFormat mFormat;
+
+        /// <summary>
+        /// Constructor
+        /// </summary>
+        /// <param name="path"></param>
+        /// <param name="format"></param>
+        public BinaryColumnWriter(string path, BinaryFormat format)
+        {
+            mStream = new FileStream(path, FileMode.Create, FileAccess.Write, FileShare.Read, 1 << 16);
+            mFormat = format;
+        }
+
+        /// <summary>
+        /// Write rows first through last of the columns
+        /// </summary>
+        public override void WriteRows(double[][] columns, int first, int last)
+        {
+            var rowCount = last - first + 1;
+            if (rowCount <= 0)
+                return;
+
+            byte[] buffer;
+
+            if (mFormat == BinaryFormat.Float32)
+            {
+                var values = new float[rowCount * columns.Length];
+                for (var column = 0; column < columns.Length; column++)
+                {
+                    for (var row = 0; row < rowCount; row++)
+                    {
+                        values[row * columns.Length + column] = (float)columns[column][first + row];
+                    }
+                }
+
+                buffer = new byte[values.Length * sizeof(float)];
+                Buffer.BlockCopy(values, 0, buffer, 0, buffer.Length);
+            }
+            else
+            {
+                var values = new double[rowCount * columns.Length];
+                for (var column = 0; column < columns.Length; column++)
+                {
+                    for (var row = 0; row < rowCount; row++)
+                    {
+                        values[row * columns.Length + column] = columns[column][first + row];
+                    }
+                }
+
+                buffer = new byte[values.Length * sizeof(double)];
+                Buffer.BlockCopy(values, 0, buffer, 0, buffer.Length);
+            }
+
+            mStream.Write(buffer, 0, buffer.Length);
+        }
+
+        public override void Dispose()
+        {
+            mStream.Dispose();
+        }
+    }
+}
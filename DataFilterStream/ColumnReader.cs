@@ -0,0 +1,36 @@
+using System;
+
+namespace DataFilterStream
+{
+    /// <summary>
+    /// Reads a column file a chunk of rows at a time
+    /// </summary>
+    internal abstract class ColumnReader : IDisposable
+    {
+        /// <summary>
+        /// Values per row
+        /// </summary>
+        public int ColumnCount { get; protected set; }
+
+        /// <summary>
+        /// Read the next rows into one array per column
+        /// </summary>
+        /// <param name="columns"></param>
+        /// <returns>Number of rows read; 0 at the end of the file</returns>
+        /// <remarks>Throws InvalidDataException for rows that cannot be read</remarks>
+        public abstract int ReadChunk(out double[][] columns);
+
+        public abstract void Dispose();
+
+        /// <summary>
+        /// Open a text or binary reader, as set by the options
+        /// </summary>
+        public static ColumnReader Create(string path, StreamingOptions options, int threads)
+        {
+            if (options.Binary == BinaryFormat.None)
+                return new TextColumnReader(path, options.HasHeader, options.ChunkRows, threads);
+
+            return new BinaryColumnReader(path, options.Binary, options.BinaryColumnCount, options.ChunkRows);
+        }
+    }
+}
@@ -0,0 +1,244 @@
+using System.Globalization;
+using System.IO;
+using System.Text;
+
+namespace DataFilterStream
+{
+    /// <summary>
+    /// Splits lines of delimited text into numbers, reading the bytes directly instead of building strings
+    /// </summary>
+    /// <remarks>
+    /// Numbers whose digits fit in 2^53 and whose power of ten is within 1e22, which covers nearly every
+    /// exported intensity and m/z value, are converted with one exact multiply or divide, so the result is
+    /// the correctly rounded double. Anything else, including NaN and Infinity, goes through double.Parse
+    /// </remarks>
+    internal static class ColumnTokenizer
+    {
+        /// <summary>
+        /// 10^0 through 10^22, all exactly representable as doubles
+        /// </summary>
+        private static readonly double[] mPowersOfTen =
+        {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        /// <summary>
+        /// Mantissas up to this value are exact doubles
+        /// </summary>
+        private const ulong MAX_EXACT_MANTISSA = 1UL << 53;
+
+        /// <summary>
+        /// Tab, comma, or space (meaning any run of spaces and tabs), whichever occurs first in the line
+        /// </summary>
+        public static byte DetectDelimiter(byte[] buffer, int start, int end)
+        {
+            for (var i = start; i < end; i++)
+            {
+                if (buffer[i] == '\t' || buffer[i] == ',')
+                    return buffer[i];
+            }
+
+            return (byte)' ';
+        }
+
+        /// <summary>
+        /// End of the line, without the line feed or a carriage return before it
+        /// </summary>
+        public static int TrimLineEnd(byte[] buffer, int start, int end)
+        {
+            while (end > start && (buffer[end - 1] == '\r' || buffer[end - 1] == '\n'))
+            {
+                end--;
+            }
+
+            return end;
+        }
+
+        /// <summary>
+        /// Number of fields in the line
+        /// </summary>
+        public static int CountFields(byte[] buffer, int start, int end, byte delimiter)
+        {
+            return ParseLine(buffer, start, end, delimiter, new double[0]);
+        }
+
+        /// <summary>
+        /// Parse the fields of bytes start through end - 1 into values
+        /// </summary>
+        /// <returns>Number of fields; values beyond values.Length are counted but not stored</returns>
+        /// <remarks>Empty fields are NaN</remarks>
+        public static int ParseLine(byte[] buffer, int start, int end, byte delimiter, double[] values)
+        {
+            var count = 0;
+            var i = start;
+
+            if (delimiter == ' ')
+            {
+                while (true)
+                {
+                    while (i < end && (buffer[i] == ' ' || buffer[i] == '\t'))
+                    {
+                        i++;
+                    }
+
+                    if (i >= end)
+                        return count;
+
+                    var fieldStart = i;
+                    while (i < end && buffer[i] != ' ' && buffer[i] != '\t')
+                    {
+                        i++;
+                    }
+
+                    if (count < values.Length)
+                        values[count] = ParseNumber(buffer, fieldStart, i);
+
+                    count++;
+                }
+            }
+
+            while (true)
+            {
+                var fieldStart = i;
+                while (i < end && buffer[i] != delimiter)
+                {
+                    i++;
+                }
+
+                if (count < values.Length)
+                    values[count] = ParseNumber(buffer, fieldStart, i);
+
+                count++;
+
+                if (i >= end)
+                    return count;
+
+                i++;
+            }
+        }
+
+        /// <summary>
+        /// Parse bytes start through end - 1 as a number; surrounding spaces are ignored
+        /// </summary>
+        public static double ParseNumber(byte[] buffer, int start, int end)
+        {
+            while (start < end && buffer[start] == ' ')
+            {
+                start++;
+            }
+
+            while (end > start && buffer[end - 1] == ' ')
+            {
+                end--;
+            }
+
+            if (start == end)
+                return double.NaN;
+
+            var i = start;
+            var negative = false;
+            if (buffer[i] == '-' || buffer[i] == '+')
+            {
+                negative = buffer[i] == '-';
+                i++;
+            }
+
+            ulong mantissa = 0;
+            var significantDigits = 0;
+            var exponent = 0;
+            var anyDigits = false;
+
+            for (; i < end && IsDigit(buffer[i]); i++)
+            {
+                anyDigits = true;
+                AddDigit(buffer[i], ref mantissa, ref significantDigits, ref exponent, false);
+            }
+
+            if (i < end && buffer[i] == '.')
+            {
+                for (i++; i < end && IsDigit(buffer[i]); i++)
+                {
+                    anyDigits = true;
+                    AddDigit(buffer[i], ref mantissa, ref significantDigits, ref exponent, true);
+                }
+            }
+
+            if (anyDigits && i < end && (buffer[i] == 'e' || buffer[i] == 'E'))
+            {
+                var j = i + 1;
+                var exponentNegative = false;
+                if (j < end && (buffer[j] == '-' || buffer[j] == '+'))
+                {
+                    exponentNegative = buffer[j] == '-';
+                    j++;
+                }
+
+                var explicitExponent = 0;
+                var exponentDigits = 0;
+                for (; j < end && IsDigit(buffer[j]) && explicitExponent < 100000; j++, exponentDigits++)
+                {
+                    explicitExponent = explicitExponent * 10 + (buffer[j] - '0');
+                }
+
+                if (exponentDigits > 0)
+                {
+                    exponent += exponentNegative ? -explicitExponent : explicitExponent;
+                    i = j;
+                }
+            }
+
+            if (anyDigits && i == end && significantDigits <= 19 && mantissa <= MAX_EXACT_MANTISSA &&
+                exponent >= -22 && exponent <= 22)
+            {
+                var value = exponent < 0 ? mantissa / mPowersOfTen[-exponent] : mantissa * mPowersOfTen[exponent];
+                return negative ? -value : value;
+            }
+
+            return ParseSlow(buffer, start, end);
+        }
+
+        private static bool IsDigit(byte value)
+        {
+            return value >= '0' && value <= '9';
+        }
+
+        /// <summary>
+        /// Add a digit to the mantissa; leading zeros are not significant, and digits past
+        /// the 19th are dropped, which sends the number to ParseSlow
+        /// </summary>
+        private static void AddDigit(byte digit, ref ulong mantissa, ref int significantDigits, ref int exponent, bool fraction)
+        {
+            if (mantissa == 0 && digit == '0')
+            {
+                if (fraction)
+                    exponent--;
+
+                return;
+            }
+
+            significantDigits++;
+            if (significantDigits > 19)
+            {
+                if (!fraction)
+                    exponent++;
+
+                return;
+            }
+
+            mantissa = mantissa * 10 + (ulong)(digit - '0');
+            if (fraction)
+                exponent--;
+        }
+
+        private static double ParseSlow(byte[] buffer, int start, int end)
+        {
+            var text = Encoding.ASCII.GetString(buffer, start, end - start);
+
+            if (double.TryParse(text, NumberStyles.Float, CultureInfo.InvariantCulture, out var value))
+                return value;
+
+            throw new InvalidDataException("Not a number: " + text);
+        }
+    }
+}
@@ -0,0 +1,28 @@
+using System;
+
+namespace DataFilterStream
+{
+    /// <summary>
+    /// Writes rows to a column file as they are filtered
+    /// </summary>
+    internal abstract class ColumnWriter : IDisposable
+    {
+        /// <summary>
+        /// Write rows first through last of the columns
+        /// </summary>
+        public abstract void WriteRows(double[][] columns, int first, int last);
+
+        public abstract void Dispose();
+
+        /// <summary>
+        /// Create a writer for the same format as the reader
+        /// </summary>
+        public static ColumnWriter Create(string path, StreamingOptions options, ColumnReader reader, int threads)
+        {
+            if (reader is TextColumnReader textReader)
+                return new TextColumnWriter(path, textReader.Header, textReader.Delimiter, threads);
+
+            return new BinaryColumnWriter(path, options.Binary);
+        }
+    }
+}
@@ -0,0 +1,88 @@
+using System;
+using System.Diagnostics;
+using System.IO;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace DataFilterStream
+{
+    /// <summary>
+    /// Smooths the columns of delimited text or binary files of any size, streaming them from disk
+    /// </summary>
+    class Program
+    {
+        private static readonly object mConsoleLock = new object();
+
+        static int Main(string[] args)
+        {
+            if (!StreamingOptions.TryParse(args, out var options, out var errorMessage))
+            {
+                Console.WriteLine(errorMessage);
+                Console.WriteLine();
+                Console.WriteLine(StreamingOptions.GetUsage());
+                return 1;
+            }
+
+            StreamingFilter filter;
+            try
+            {
+                filter = new StreamingFilter(options);
+            }
+            catch (ArgumentException ex)
+            {
+                Console.WriteLine("Invalid filter settings: " + ex.Message);
+                return 1;
+            }
+
+            var threads = options.Threads > 0 ? options.Threads : Environment.ProcessorCount;
+
+            // Files are processed side by side, sharing the threads
+            var fileThreads = Math.Min(options.InputFiles.Count, threads);
+            var threadsPerFile = Math.Max(threads / fileThreads, 1);
+            var failures = 0;
+
+            Parallel.ForEach(options.InputFiles, new ParallelOptions { MaxDegreeOfParallelism = fileThreads }, inputPath =>
+            {
+                var outputPath = GetOutputPath(inputPath, options);
+                if (string.Equals(Path.GetFullPath(outputPath), Path.GetFullPath(inputPath), StringComparison.OrdinalIgnoreCase))
+                {
+                    Report("Error processing " + inputPath + ": the output file would replace the input file");
+                    Interlocked.Increment(ref failures);
+                    return;
+                }
+
+                var stopwatch = Stopwatch.StartNew();
+
+                if (filter.ProcessFile(inputPath, outputPath, threadsPerFile, out var rowsWritten, out var message))
+                {
+                    Report(string.Format("{0} -> {1}: {2:N0} rows in {3:F1} seconds", inputPath, outputPath, rowsWritten, stopwatch.Elapsed.TotalSeconds));
+                }
+                else
+                {
+                    Report("Error processing " + inputPath + ": " + message);
+                    Interlocked.Increment(ref failures);
+                }
+            });
+
+            return failures == 0 ? 0 : 2;
+        }
+
+        private static string GetOutputPath(string inputPath, StreamingOptions options)
+        {
+            var directory = string.IsNullOrEmpty(options.OutputDirectory)
+                ? Path.GetDirectoryName(Path.GetFullPath(inputPath))
+                : options.OutputDirectory;
+
+            var fileName = Path.GetFileNameWithoutExtension(inputPath) + options.OutputSuffix + Path.GetExtension(inputPath);
+            return Path.Combine(directory ?? string.Empty, fileName);
+        }
+
+        private static void Report(string message)
+        {
+            lock (mConsoleLock)
+            {
+                Console.WriteLine(message);
+            }
+        }
+    }
+}
@@ -0,0 +1,293 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Threading.Tasks;
+using DataFilter;
+
+namespace DataFilterStream
+{
+    /// <summary>
+    /// Filters the columns of a file a chunk of rows at a time, writing each chunk as soon as it is done
+    /// </summary>
+    /// <remarks>
+    /// Each chunk is filtered together with OverlapRows rows on either side of it, carried over from the
+    /// previous chunk or read ahead from the next, so a row sees the same window as when the whole column
+    /// is filtered at once. Savitzky Golay and moving average give the same result as filtering the whole
+    /// column, since the filters convolve directly. Butterworth is an IIR filter run forwards then backwards, so its response to a point
+    /// never quite ends; the overlap lets it decay to well below the rounding error of the data.
+    /// The next chunk is read while the current one is filtered and the previous one written
+    /// </remarks>
+    internal class StreamingFilter
+    {
+        /// <summary>
+        /// Rows on either side of a chunk for the Butterworth filter
+        /// </summary>
+        private const int BUTTERWORTH_OVERLAP_ROWS = 4096;
+
+        private readonly StreamingOptions mOptions;
+        private readonly SavitzkyGolayPlan mPlan;
+
+        /// <summary>
+        /// Rows filtered on either side of each chunk
+        /// </summary>
+        public int OverlapRows { get; }
+
+        /// <summary>
+        /// Constructor
+        /// </summary>
+        /// <param name="options"></param>
+        /// <remarks>Throws ArgumentOutOfRangeException for an invalid Savitzky Golay window</remarks>
+        public StreamingFilter(StreamingOptions options)
+        {
+            mOptions = options;
+
+            switch (options.Filter)
+            {
+                case FilterMode.SavitzkyGolay:
+                    mPlan = new SavitzkyGolayPlan(options.NumPointsLeft, options.NumPointsRight, options.PolynomialDegree);
+                    OverlapRows = mPlan.WindowWidth;
+                    break;
+                case FilterMode.MovingAverage:
+                    OverlapRows = Math.Max(options.WindowWidthPoints, 3) + 1;
+                    break;
+                default:
+                    OverlapRows = BUTTERWORTH_OVERLAP_ROWS;
+                    break;
+            }
+        }
+
+        /// <summary>
+        /// Filter inputPath into outputPath
+        /// </summary>
+        /// <param name="inputPath"></param>
+        /// <param name="outputPath"></param>
+        /// <param name="threads">Threads to parse, filter, and format with</param>
+        /// <param name="rowsWritten"></param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if success, False if error</returns>
+        public bool ProcessFile(string inputPath, string outputPath, int threads, out long rowsWritten, out string errorMessage)
+        {
+            rowsWritten = 0;
+
+            try
+            {
+                using (var reader = ColumnReader.Create(inputPath, mOptions, threads))
+                using (var writer = ColumnWriter.Create(outputPath, mOptions, reader, threads))
+                {
+                    Task<Chunk> nextChunk = null;
+                    Task pendingWrite = null;
+
+                    try
+                    {
+                        var columnsToFilter = GetColumnsToFilter(reader.ColumnCount);
+
+                        // buffer holds the rows not yet written and the rows before them that the next chunk's windows need
+                        var buffer = new double[reader.ColumnCount][];
+                        for (var column = 0; column < buffer.Length; column++)
+                        {
+                            buffer[column] = new double[0];
+                        }
+
+                        var bufferRows = 0;
+                        var firstToWrite = 0;
+
+                        nextChunk = Task.Run(() => Chunk.Read(reader));
+
+                        while (true)
+                        {
+                            var chunk = nextChunk.Result;
+                            var endOfFile = chunk.Rows == 0;
+                            nextChunk = endOfFile ? null : Task.Run(() => Chunk.Read(reader));
+
+                            buffer = Append(buffer, bufferRows, chunk);
+                            bufferRows += chunk.Rows;
+
+                            var lastToWrite = endOfFile ? bufferRows - 1 : bufferRows - 1 - OverlapRows;
+
+                            if (lastToWrite >= firstToWrite)
+                            {
+                                var filtered = FilterColumns(buffer, bufferRows, columnsToFilter, threads);
+
+                                pendingWrite?.Wait();
+                                var first = firstToWrite;
+                                pendingWrite = Task.Run(() => writer.WriteRows(filtered, first, lastToWrite));
+                                rowsWritten += lastToWrite - firstToWrite + 1;
+
+                                var keepFrom = Math.Max(lastToWrite + 1 - OverlapRows, 0);
+                                buffer = Keep(buffer, keepFrom, bufferRows);
+                                bufferRows -= keepFrom;
+                                firstToWrite = lastToWrite + 1 - keepFrom;
+                            }
+
+                            if (endOfFile)
+                                break;
+                        }
+
+                        pendingWrite?.Wait();
+                    }
+                    finally
+                    {
+                        // After an error, a read or write may still be running; it must finish before the reader and writer are disposed
+                        WaitForPending(nextChunk);
+                        WaitForPending(pendingWrite);
+                    }
+                }
+
+                errorMessage = string.Empty;
+                return true;
+            }
+            catch (Exception ex)
+            {
+                var inner = ex is AggregateException aggregate ? aggregate.GetBaseException() : ex;
+                errorMessage = inner.Message;
+                return false;
+            }
+        }
+
+        /// <summary>
+        /// Wait for a read or write that may still be running, ignoring its exception
+        /// </summary>
+        /// <remarks>Only called in a finally block, where the first exception is already on its way out</remarks>
+        private static void WaitForPending(Task task)
+        {
+            try
+            {
+                task?.Wait();
+            }
+            catch (AggregateException)
+            {
+                // Already failing
+            }
+        }
+
+        /// <summary>
+        /// Zero-based columns to filter, checked against the column count of the file
+        /// </summary>
+        private List<int> GetColumnsToFilter(int columnCount)
+        {
+            var columns = new List<int>();
+
+            if (mOptions.Columns.Count == 0)
+            {
+                for (var column = 0; column < columnCount; column++)
+                {
+                    columns.Add(column);
+                }
+
+                return columns;
+            }
+
+            foreach (var column in mOptions.Columns)
+            {
+                if (column >= columnCount)
+                    throw new InvalidDataException("Column " + (column + 1) + " was requested but the file has " + columnCount + " columns");
+
+                if (!columns.Contains(column))
+                    columns.Add(column);
+            }
+
+            return columns;
+        }
+
+        /// <summary>
+        /// Filter the selected columns of the first rowCount rows; the other columns are passed through
+        /// </summary>
+        private double[][] FilterColumns(double[][] buffer, int rowCount, List<int> columnsToFilter, int threads)
+        {
+            var filtered = (double[][])buffer.Clone();
+            string errorMessage = null;
+
+            // A single column gets the threads; several columns are filtered side by side
+            var filterThreads = columnsToFilter.Count == 1 ? threads : 1;
+
+            Parallel.ForEach(columnsToFilter, new ParallelOptions { MaxDegreeOfParallelism = threads }, column =>
+            {
+                var data = (double[])buffer[column].Clone();
+                var filter = new DataFilter.DataFilter { MaxDegreeOfParallelism = filterThreads };
+                string message;
+
+                switch (mOptions.Filter)
+                {
+                    case FilterMode.SavitzkyGolay:
+                        if (rowCount < mPlan.WindowWidth)
+                        {
+                            message = "The file has " + rowCount + " rows, fewer than the Savitzky Golay window of " + mPlan.WindowWidth;
+                            break;
+                        }
+
+                        filter.SavitzkyGolayFilter(data, 0, rowCount - 1, mPlan, out message);
+                        break;
+                    case FilterMode.MovingAverage:
+                        filter.MovingWindowAverage(data, 0, rowCount - 1, mOptions.WindowWidthPoints, out message);
+                        break;
+                    default:
+                        message = filter.ButterworthFilter(data, 0, rowCount - 1, mOptions.SamplingFrequency)
+                            ? string.Empty
+                            : "Butterworth filter failed";
+                        break;
+                }
+
+                if (!string.IsNullOrEmpty(message))
+                    errorMessage = message;
+
+                filtered[column] = data;
+            });
+
+            if (errorMessage != null)
+                throw new InvalidDataException(errorMessage);
+
+            return filtered;
+        }
+
+        /// <summary>
+        /// New buffer holding the first bufferRows rows of buffer followed by the chunk
+        /// </summary>
+        private static double[][] Append(double[][] buffer, int bufferRows, Chunk chunk)
+        {
+            if (chunk.Rows == 0)
+                return buffer;
+
+            var result = new double[buffer.Length][];
+            for (var column = 0; column < buffer.Length; column++)
+            {
+                result[column] = new double[bufferRows + chunk.Rows];
+                Array.Copy(buffer[column], result[column], bufferRows);
+                Array.Copy(chunk.Columns[column], 0, result[column], bufferRows, chunk.Rows);
+            }
+
+            return result;
+        }
+
+        /// <summary>
+        /// New buffer holding rows keepFrom through bufferRows - 1
+        /// </summary>
+        /// <remarks>The old arrays are left untouched, since they may still be being written</remarks>
+        private static double[][] Keep(double[][] buffer, int keepFrom, int bufferRows)
+        {
+            var result = new double[buffer.Length][];
+            for (var column = 0; column < buffer.Length; column++)
+            {
+                result[column] = new double[bufferRows - keepFrom];
+                Array.Copy(buffer[column], keepFrom, result[column], 0, bufferRows - keepFrom);
+            }
+
+            return result;
+        }
+
+        /// <summary>
+        /// Rows read from a file
+        /// </summary>
+        private class Chunk
+        {
+            public int Rows { get; private set; }
+
+            public double[][] Columns { get; private set; }
+
+            public static Chunk Read(ColumnReader reader)
+            {
+                var rows = reader.ReadChunk(out var columns);
+                return new Chunk { Rows = rows, Columns = columns };
+            }
+        }
+    }
+}
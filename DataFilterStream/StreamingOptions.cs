@@ -0,0 +1,261 @@
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+
+namespace DataFilterStream
+{
+    /// <summary>
+    /// Filter applied to each selected column
+    /// </summary>
+    internal enum FilterMode
+    {
+        SavitzkyGolay,
+        MovingAverage,
+        Butterworth
+    }
+
+    /// <summary>
+    /// Layout of a binary column file: rows of ColumnCount little-endian values, one after another
+    /// </summary>
+    internal enum BinaryFormat
+    {
+        None,
+        Float32,
+        Float64
+    }
+
+    /// <summary>
+    /// Command line options
+    /// </summary>
+    internal class StreamingOptions
+    {
+        /// <summary>
+        /// Rows parsed, filtered, and written at a time
+        /// </summary>
+        public const int DEFAULT_CHUNK_ROWS = 1 << 20;
+
+        public List<string> InputFiles { get; } = new List<string>();
+
+        /// <summary>
+        /// Directory for the filtered files; empty to write them next to the input files
+        /// </summary>
+        public string OutputDirectory { get; private set; } = string.Empty;
+
+        /// <summary>
+        /// Appended to the input file name, before the extension, to name the output file
+        /// </summary>
+        public string OutputSuffix { get; private set; } = "_filtered";
+
+        public FilterMode Filter { get; private set; } = FilterMode.SavitzkyGolay;
+
+        public int NumPointsLeft { get; private set; } = 3;
+
+        public int NumPointsRight { get; private set; } = 3;
+
+        public int PolynomialDegree { get; private set; } = 2;
+
+        public int WindowWidthPoints { get; private set; } = 5;
+
+        public double SamplingFrequency { get; private set; } = 0.25;
+
+        /// <summary>
+        /// Zero-based columns to filter; empty to filter every column
+        /// </summary>
+        public List<int> Columns { get; } = new List<int>();
+
+        /// <summary>
+        /// True if the first line of a text file is a header, which is copied to the output as-is
+        /// </summary>
+        public bool HasHeader { get; private set; }
+
+        public BinaryFormat Binary { get; private set; } = BinaryFormat.None;
+
+        /// <summary>
+        /// Values per row of a binary file
+        /// </summary>
+        public int BinaryColumnCount { get; private set; } = 1;
+
+        /// <summary>
+        /// Most threads to use; 0 means one per processor
+        /// </summary>
+        public int Threads { get; private set; }
+
+        public int ChunkRows { get; private set; } = DEFAULT_CHUNK_ROWS;
+
+        public static string GetUsage()
+        {
+            return
+                "Smooths the columns of delimited text or binary files without loading them into memory" + Environment.NewLine +
+                Environment.NewLine +
+                "DataFilterStream.exe InputFile [InputFile2 ...] [/O:OutputDirectory] [/Suffix:_filtered]" + Environment.NewLine +
+                "  [/Filter:SG|MA|Butterworth] [/Left:3] [/Right:3] [/Degree:2] [/Width:5] [/Freq:0.25]" + Environment.NewLine +
+                "  [/Columns:2,3] [/Header] [/Binary:Float32|Float64] [/ColumnCount:1] [/Threads:0] [/ChunkRows:1048576]" + Environment.NewLine +
+                Environment.NewLine +
+                "/Filter      SG (Savitzky Golay, default), MA (moving window average), or Butterworth" + Environment.NewLine +
+                "/Left /Right /Degree  Savitzky Golay window and polynomial degree" + Environment.NewLine +
+                "/Width       Moving window average width, in points" + Environment.NewLine +
+                "/Freq        Butterworth cut-off, where 1.0 is half the sample rate" + Environment.NewLine +
+                "/Columns     One-based columns to filter; the others are copied. Default is every column" + Environment.NewLine +
+                "/Header      The first line of a text file is a header" + Environment.NewLine +
+                "/Binary      Read and write little-endian values instead of text; /ColumnCount gives the values per row" + Environment.NewLine +
+                "/Threads     Most threads to use; 0 for one per processor" + Environment.NewLine +
+                "/ChunkRows   Rows held in memory at a time, per file" + Environment.NewLine +
+                Environment.NewLine +
+                "Text files may be tab, comma, or space delimited; the delimiter of the first data line is used for the whole file";
+        }
+
+        /// <summary>
+        /// Parse the command line
+        /// </summary>
+        /// <param name="args"></param>
+        /// <param name="options"></param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if success, False if error</returns>
+        public static bool TryParse(string[] args, out StreamingOptions options, out string errorMessage)
+        {
+            options = new StreamingOptions();
+
+            foreach (var arg in args)
+            {
+                if (!arg.StartsWith("/") && !arg.StartsWith("-"))
+                {
+                    options.InputFiles.Add(arg);
+                    continue;
+                }
+
+                var colon = arg.IndexOf(':');
+                var name = (colon < 0 ? arg.Substring(1) : arg.Substring(1, colon - 1)).ToLowerInvariant();
+                var value = colon < 0 ? string.Empty : arg.Substring(colon + 1);
+
+                switch (name)
+                {
+                    case "o":
+                        options.OutputDirectory = value;
+                        break;
+                    case "suffix":
+                        options.OutputSuffix = value;
+                        break;
+                    case "filter":
+                        switch (value.ToLowerInvariant())
+                        {
+                            case "sg":
+                                options.Filter = FilterMode.SavitzkyGolay;
+                                break;
+                            case "ma":
+                                options.Filter = FilterMode.MovingAverage;
+                                break;
+                            case "butterworth":
+                                options.Filter = FilterMode.Butterworth;
+                                break;
+                            default:
+                                errorMessage = "Unknown filter: " + value;
+                                return false;
+                        }
+                        break;
+                    case "left":
+                        if (!TryParseInt(arg, value, 0, out var numPointsLeft, out errorMessage))
+                            return false;
+
+                        options.NumPointsLeft = numPointsLeft;
+                        break;
+                    case "right":
+                        if (!TryParseInt(arg, value, 0, out var numPointsRight, out errorMessage))
+                            return false;
+
+                        options.NumPointsRight = numPointsRight;
+                        break;
+                    case "degree":
+                        if (!TryParseInt(arg, value, 0, out var polynomialDegree, out errorMessage))
+                            return false;
+
+                        options.PolynomialDegree = polynomialDegree;
+                        break;
+                    case "width":
+                        if (!TryParseInt(arg, value, 1, out var windowWidthPoints, out errorMessage))
+                            return false;
+
+                        options.WindowWidthPoints = windowWidthPoints;
+                        break;
+                    case "freq":
+                        if (!double.TryParse(value, NumberStyles.Float, CultureInfo.InvariantCulture, out var samplingFrequency) ||
+                            samplingFrequency <= 0 || samplingFrequency >= 1)
+                        {
+                            errorMessage = "/Freq should be between 0 and 1: " + arg;
+                            return false;
+                        }
+
+                        options.SamplingFrequency = samplingFrequency;
+                        break;
+                    case "columns":
+                        foreach (var item in value.Split(','))
+                        {
+                            if (!TryParseInt(arg, item.Trim(), 1, out var column, out errorMessage))
+                                return false;
+
+                            options.Columns.Add(column - 1);
+                        }
+                        break;
+                    case "header":
+                        options.HasHeader = true;
+                        break;
+                    case "binary":
+                        switch (value.ToLowerInvariant())
+                        {
+                            case "float32":
+                                options.Binary = BinaryFormat.Float32;
+                                break;
+                            case "float64":
+                                options.Binary = BinaryFormat.Float64;
+                                break;
+                            default:
+                                errorMessage = "/Binary should be Float32 or Float64: " + arg;
+                                return false;
+                        }
+                        break;
+                    case "columncount":
+                        if (!TryParseInt(arg, value, 1, out var columnCount, out errorMessage))
+                            return false;
+
+                        options.BinaryColumnCount = columnCount;
+                        break;
+                    case "threads":
+                        if (!TryParseInt(arg, value, 0, out var threads, out errorMessage))
+                            return false;
+
+                        options.Threads = threads;
+                        break;
+                    case "chunkrows":
+                        if (!TryParseInt(arg, value, 1, out var chunkRows, out errorMessage))
+                            return false;
+
+                        options.ChunkRows = chunkRows;
+                        break;
+                    default:
+                        errorMessage = "Unknown switch: " + arg;
+                        return false;
+                }
+            }
+
+            if (options.InputFiles.Count == 0)
+            {
+                errorMessage = "No input files";
+                return false;
+            }
+
+            errorMessage = string.Empty;
+            return true;
+        }
+
+        private static bool TryParseInt(string arg, string value, int minimum, out int result, out string errorMessage)
+        {
+            if (!int.TryParse(value, NumberStyles.Integer, CultureInfo.InvariantCulture, out result) || result < minimum)
+            {
+                errorMessage = "Expected an integer >= " + minimum + ": " + arg;
+                return false;
+            }
+
+            errorMessage = string.Empty;
+            return true;
+        }
+    }
+}
@@ -0,0 +1,263 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Threading.Tasks;
+
+namespace DataFilterStream
+{
+    /// <summary>
+    /// Reads tab, comma, or space delimited numbers
+    /// </summary>
+    /// <remarks>
+    /// Each chunk is read as one block of bytes ending at a line break; the lines of the block
+    /// are then parsed on several threads straight from the bytes
+    /// </remarks>
+    internal class TextColumnReader : ColumnReader
+    {
+        /// <summary>
+        /// Bytes read per chunk, unless ChunkRows is reached first; grows for lines longer than this
+        /// </summary>
+        private const int BLOCK_BYTES = 1 << 23;
+
+        /// <summary>
+        /// Lines parsed per parallel task
+        /// </summary>
+        private const int LINES_PER_TASK = 8192;
+
+        private readonly Stream mStream;
+        private readonly int mMaxRows;
+        private readonly int mThreads;
+
+        private byte[] mBuffer = new byte[BLOCK_BYTES];
+
+        /// <summary>
+        /// Unread bytes are mBuffer[mBufferStart] through mBuffer[mBufferEnd - 1]
+        /// </summary>
+        private int mBufferStart;
+        private int mBufferEnd;
+        private bool mEndOfStream;
+
+        /// <summary>
+        /// Lines read so far, including the header and blank lines
+        /// </summary>
+        private long mLinesRead;
+
+        /// <summary>
+        /// The header line, without its line break; null if there is no header
+        /// </summary>
+        public byte[] Header { get; }
+
+        /// <summary>
+        /// Tab, comma, or space (any run of spaces and tabs)
+        /// </summary>
+        public byte Delimiter { get; }
+
+        /// <summary>
+        /// Constructor
+        /// </summary>
+        /// <param name="path"></param>
+        /// <param name="hasHeader">True if the first line is a header</param>
+        /// <param name="maxRows">Most rows per chunk</param>
+        /// <param name="threads">Threads to parse with</param>
+        /// <remarks>The delimiter and the column count come from the first data line</remarks>
+        public TextColumnReader(string path, bool hasHeader, int maxRows, int threads)
+        {
+            mStream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.Read, 1 << 16, FileOptions.SequentialScan);
+            mMaxRows = maxRows;
+            mThreads = threads;
+            Delimiter = (byte)'\t';
+
+            if (hasHeader)
+            {
+                var position = mBufferStart;
+                var lineBreak = FindLineBreak(ref position);
+                var lineEnd = ColumnTokenizer.TrimLineEnd(mBuffer, position, lineBreak < 0 ? mBufferEnd : lineBreak);
+
+                Header = new byte[lineEnd - position];
+                Array.Copy(mBuffer, position, Header, 0, Header.Length);
+                mBufferStart = lineBreak < 0 ? mBufferEnd : lineBreak + 1;
+                mLinesRead++;
+            }
+
+            // The first data line sets the layout; it is left in the buffer for the first chunk
+            var lineStart = mBufferStart;
+            while (lineStart < mBufferEnd || !mEndOfStream)
+            {
+                var lineBreak = FindLineBreak(ref lineStart);
+                var lineEnd = ColumnTokenizer.TrimLineEnd(mBuffer, lineStart, lineBreak < 0 ? mBufferEnd : lineBreak);
+
+                if (!IsBlank(lineStart, lineEnd))
+                {
+                    Delimiter = ColumnTokenizer.DetectDelimiter(mBuffer, lineStart, lineEnd);
+                    ColumnCount = ColumnTokenizer.CountFields(mBuffer, lineStart, lineEnd, Delimiter);
+                    break;
+                }
+
+                if (lineBreak < 0)
+                    break;
+
+                lineStart = lineBreak + 1;
+            }
+        }
+
+        /// <summary>
+        /// Read the next chunk of rows
+        /// </summary>
+        public override int ReadChunk(out double[][] columns)
+        {
+            // Lines are taken up to the last complete line in the buffer, or the end of the file
+            var lineStarts = new List<int>();
+            var lineEnds = new List<int>();
+            var lineNumbers = new List<long>();
+
+            while (lineStarts.Count == 0 && (mBufferStart < mBufferEnd || !mEndOfStream))
+            {
+                // Make sure the buffer holds at least one complete line, then top it up
+                var position = mBufferStart;
+                FindLineBreak(ref position);
+                Fill(false);
+                position = mBufferStart;
+
+                while (lineStarts.Count < mMaxRows && position < mBufferEnd)
+                {
+                    var lineBreak = Array.IndexOf(mBuffer, (byte)'\n', position, mBufferEnd - position);
+                    if (lineBreak < 0 && !mEndOfStream)
+                        break;
+
+                    var next = lineBreak < 0 ? mBufferEnd : lineBreak + 1;
+                    var lineEnd = ColumnTokenizer.TrimLineEnd(mBuffer, position, next);
+                    mLinesRead++;
+
+                    if (!IsBlank(position, lineEnd))
+                    {
+                        lineStarts.Add(position);
+                        lineEnds.Add(lineEnd);
+                        lineNumbers.Add(mLinesRead);
+                    }
+
+                    position = next;
+                }
+
+                mBufferStart = position;
+            }
+
+            var rowCount = lineStarts.Count;
+            var chunk = new double[ColumnCount][];
+            for (var column = 0; column < ColumnCount; column++)
+            {
+                chunk[column] = new double[rowCount];
+            }
+
+            var taskCount = (rowCount + LINES_PER_TASK - 1) / LINES_PER_TASK;
+            var badRow = int.MaxValue;
+            string badRowMessage = null;
+
+            Parallel.For(0, taskCount, new ParallelOptions { MaxDegreeOfParallelism = mThreads }, task =>
+            {
+                var values = new double[ColumnCount];
+                var lastRow = Math.Min((task + 1) * LINES_PER_TASK, rowCount);
+
+                for (var row = task * LINES_PER_TASK; row < lastRow; row++)
+                {
+                    string message = null;
+                    try
+                    {
+                        var fieldCount = ColumnTokenizer.ParseLine(mBuffer, lineStarts[row], lineEnds[row], Delimiter, values);
+                        if (fieldCount != ColumnCount)
+                            message = fieldCount + " columns; expected " + ColumnCount;
+                    }
+                    catch (InvalidDataException ex)
+                    {
+                        message = ex.Message;
+                    }
+
+                    if (message != null)
+                    {
+                        lock (chunk)
+                        {
+                            if (row < badRow)
+                            {
+                                badRow = row;
+                                badRowMessage = message;
+                            }
+                        }
+
+                        return;
+                    }
+
+                    for (var column = 0; column < ColumnCount; column++)
+                    {
+                        chunk[column][row] = values[column];
+                    }
+                }
+            });
+
+            if (badRowMessage != null)
+                throw new InvalidDataException("Line " + lineNumbers[badRow] + ": " + badRowMessage);
+
+            columns = chunk;
+            return rowCount;
+        }
+
+        public override void Dispose()
+        {
+            mStream.Dispose();
+        }
+
+        private bool IsBlank(int start, int end)
+        {
+            for (var i = start; i < end; i++)
+            {
+                if (mBuffer[i] != ' ' && mBuffer[i] != '\t')
+                    return false;
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Index of the next line feed at or after position, reading more of the file as needed
+        /// </summary>
+        /// <returns>-1 if the file ends first</returns>
+        /// <remarks>Reading may move the unread bytes to the start of the buffer; position is updated to match</remarks>
+        private int FindLineBreak(ref int position)
+        {
+            while (true)
+            {
+                var lineBreak = Array.IndexOf(mBuffer, (byte)'\n', position, mBufferEnd - position);
+                if (lineBreak >= 0 || mEndOfStream)
+                    return lineBreak;
+
+                position -= mBufferStart;
+                Fill(true);
+            }
+        }
+
+        /// <summary>
+        /// Move the unread bytes to the start of the buffer and read until it is full or the file ends
+        /// </summary>
+        /// <param name="grow">True to double the buffer if the unread bytes already fill it</param>
+        private void Fill(bool grow)
+        {
+            if (mBufferStart > 0)
+            {
+                Array.Copy(mBuffer, mBufferStart, mBuffer, 0, mBufferEnd - mBufferStart);
+                mBufferEnd -= mBufferStart;
+                mBufferStart = 0;
+            }
+            else if (grow && mBufferEnd == mBuffer.Length)
+            {
+                Array.Resize(ref mBuffer, mBuffer.Length * 2);
+            }
+
+            while (mBufferEnd < mBuffer.Length && !mEndOfStream)
+            {
+                var bytesRead = mStream.Read(mBuffer, mBufferEnd, mBuffer.Length - mBufferEnd);
+                if (bytesRead == 0)
+                    mEndOfStream = true;
+
+                mBufferEnd += bytesRead;
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+using System;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using System.Threading.Tasks;
+
+namespace DataFilterStream
+{
+    /// <summary>
+    /// Writes delimited text, formatting the rows on several threads
+    /// </summary>
+    /// <remarks>Values are written with the round-trip format, so re-reading them gives the same doubles</remarks>
+    internal class TextColumnWriter : ColumnWriter
+    {
+        /// <summary>
+        /// Rows formatted per parallel task
+        /// </summary>
+        private const int ROWS_PER_TASK = 8192;
+
+        private static readonly byte[] mNewLine = Encoding.ASCII.GetBytes(Environment.NewLine);
+
+        private readonly Stream mStream;
+        private readonly char mDelimiter;
+        private readonly int mThreads;
+
+        /// <summary>
+        /// Constructor
+        /// </summary>
+        /// <param name="path"></param>
+        /// <param name="header">Written as the first line; null for no header</param>
+        /// <param name="delimiter">Tab, comma, or space</param>
+        /// <param name="threads">Threads to format with</param>
+        public TextColumnWriter(string path, byte[] header, byte delimiter, int threads)
+        {
+            mStream = new FileStream(path, FileMode.Create, FileAccess.Write, FileShare.Read, 1 << 16);
+            mDelimiter = (char)delimiter;
+            mThreads = threads;
+
+            if (header == null)
+                return;
+
+            mStream.Write(header, 0, header.Length);
+            mStream.Write(mNewLine, 0, mNewLine.Length);
+        }
+
+        /// <summary>
+        /// Write rows first through last of the columns
+        /// </summary>
+        public override void WriteRows(double[][] columns, int first, int last)
+        {
+            var rowCount = last - first + 1;
+            if (rowCount <= 0)
+                return;
+
+            var taskCount = (rowCount + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+            var blocks = new byte[taskCount][];
+
+            Parallel.For(0, taskCount, new ParallelOptions { MaxDegreeOfParallelism = mThreads }, task =>
+            {
+                var text = new StringBuilder(ROWS_PER_TASK * columns.Length * 12);
+                var taskLast = Math.Min(first + (task + 1) * ROWS_PER_TASK - 1, last);
+
+                for (var row = first + task * ROWS_PER_TASK; row <= taskLast; row++)
+                {
+                    for (var column = 0; column < columns.Length; column++)
+                    {
+                        if (column > 0)
+                            text.Append(mDelimiter);
+
+                        text.Append(columns[column][row].ToString("R", CultureInfo.InvariantCulture));
+                    }
+
+                    text.Append(Environment.NewLine);
+                }
+
+                blocks[task] = Encoding.ASCII.GetBytes(text.ToString());
+            });
+
+            foreach (var block in blocks)
+            {
+                mStream.Write(block, 0, block.Length);
+            }
+        }
+
+        public override void Dispose()
+        {
+            mStream.Dispose();
+        }
+    }
+}
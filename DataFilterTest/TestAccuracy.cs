@@ -0,0 +1,905 @@
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using NUnit.Framework;
+
+namespace DataFilterTest
+{
+    /// <summary>
+    /// Differential accuracy tests: each fast path of DataFilter is run against a straightforward reference
+    /// on random and pathological data, and its error is checked against a budget for that path
+    /// </summary>
+    /// <remarks>
+    /// The references are direct double convolutions with NRSavGol coefficients, direct window sums, and the
+    /// double Butterworth recursion. Errors are measured in ulps, of the output type, of the magnitude of the terms
+    /// that make up a point, so that cancellation is not charged to a path: for direct convolution that is
+    /// Σ |c * y| over the window, for the FFT every point its block reads, and for the sliding sums and the
+    /// Butterworth recursion the points whose rounding error can still reach the output.
+    /// Where the reference is NaN or infinite, the path must give exactly the same value,
+    /// except that a least squares solve may give NaN for an infinity.
+    /// The worst point of every path is written to the console
+    /// </remarks>
+    public class TestAccuracy
+    {
+        public enum InputKind
+        {
+            /// <summary>
+            /// Profile data: noise, peaks, and runs of zeros
+            /// </summary>
+            Random,
+
+            /// <summary>
+            /// Values in or near the denormal range of the data type
+            /// </summary>
+            Denormal,
+
+            /// <summary>
+            /// Profile data with NaN, +infinity and -infinity scattered through it
+            /// </summary>
+            NonFinite,
+
+            /// <summary>
+            /// Values from 1e-30 to 1e30 side by side
+            /// </summary>
+            HugeDynamicRange
+        }
+
+        /// <summary>
+        /// Enough points for several parallel tiles and FFT blocks
+        /// </summary>
+        private const int DATA_POINT_COUNT = 60000;
+
+        private const double DOUBLE_EPSILON = 1.0 / (1L << 53);
+        private const double FLOAT_EPSILON = 1.0 / (1 << 24);
+
+        // Error budgets, in ulps of the magnitude of a point; float convolutions are allowed
+        // window width + 1 ulps, the bound given in the DataFilter class remarks
+
+        /// <summary>
+        /// Direct double convolution; the coefficients differ from NRSavGol in the last few bits
+        /// </summary>
+        private const double DIRECT_DOUBLE_ULPS = 128;
+
+        /// <summary>
+        /// Double convolution of the points at the ends of the range, which use one-sided windows;
+        /// NRSavGol solves their normal equations by LU decomposition, which loses about 5 digits at degree 4
+        /// </summary>
+        private const double END_DOUBLE_ULPS = 262144;
+
+        /// <summary>
+        /// FFT convolution, relative to the largest point its block reads
+        /// </summary>
+        private const double FFT_ULPS = 128;
+
+        /// <summary>
+        /// Non-uniform Savitzky Golay, which solves the normal equations of each window from sliding sums,
+        /// relative to the points entered since the sums were rebuilt
+        /// </summary>
+        private const double NON_UNIFORM_ULPS = 65536;
+
+        /// <summary>
+        /// Double window sums, direct or sliding
+        /// </summary>
+        private const double SUM_ULPS = 64;
+
+        /// <summary>
+        /// Butterworth, relative to the points the recursion still carries
+        /// </summary>
+        private const double BUTTERWORTH_ULPS = 8;
+
+        [Test]
+        [TestCase(InputKind.Random, 3, 2, 101)]
+        [TestCase(InputKind.Random, 5, 4, 102)]
+        [TestCase(InputKind.Random, 12, 2, 103)]
+        [TestCase(InputKind.Random, 25, 4, 104)]
+        [TestCase(InputKind.Denormal, 3, 4, 105)]
+        [TestCase(InputKind.Denormal, 25, 2, 106)]
+        [TestCase(InputKind.NonFinite, 5, 2, 107)]
+        [TestCase(InputKind.NonFinite, 25, 4, 108)]
+        [TestCase(InputKind.HugeDynamicRange, 5, 2, 109)]
+        [TestCase(InputKind.HugeDynamicRange, 12, 4, 110)]
+        [TestCase(InputKind.HugeDynamicRange, 25, 2, 111)]
+        public void TestSavitzkyGolayAccuracy(InputKind inputKind, int numPointsLeftRight, int polynomialDegree, int randomSeed)
+        {
+            var reports = new List<ErrorReport>();
+
+            var data = GetData(inputKind, DATA_POINT_COUNT, randomSeed, false);
+            var dataFloat = ToFloat(GetData(inputKind, DATA_POINT_COUNT, randomSeed, true));
+            var dataFloatWidened = ToDouble(dataFloat);
+
+            // Windows of 32 points or more are convolved by FFT when a filter asks for it
+            var fftLength = GetFFTLength(2 * numPointsLeftRight + 1);
+            var isFFT = 2 * numPointsLeftRight + 1 >= 32;
+
+            // Legacy filter: points with a full window only, times the intensity correction factor
+            var legacyCoefficients = GetLegacyCoefficients(numPointsLeftRight, polynomialDegree);
+            var scale = polynomialDegree > 1 ? 1.6 : 1.0;
+            var first = numPointsLeftRight;
+            var last = DATA_POINT_COUNT - 1 - numPointsLeftRight - 2;
+
+            foreach (var isFloat in new[] { false, true })
+            {
+                var input = isFloat ? dataFloatWidened : data;
+
+                var expected = (double[])input.Clone();
+                var magnitude = new double[input.Length];
+                for (var i = first; i <= last; i++)
+                {
+                    expected[i] = Convolve(input, i - numPointsLeftRight, legacyCoefficients, scale, out magnitude[i]);
+                }
+
+                var fftMagnitude = isFFT ? GetFFTMagnitude(input, legacyCoefficients, scale, fftLength) : magnitude;
+
+                foreach (var filter in GetFilters())
+                {
+                    var useFFT = isFFT && filter.UseFFTConvolution;
+                    var path = string.Format("SavitzkyGolayFilter {0} {1}/{1} degree {2}, {3}{4}",
+                                             isFloat ? "float" : "double", numPointsLeftRight, polynomialDegree, Describe(filter), useFFT ? ", FFT" : "");
+
+                    double[] actual;
+                    if (isFloat)
+                    {
+                        var work = (float[])dataFloat.Clone();
+                        filter.SavitzkyGolayFilter(work, 0, DATA_POINT_COUNT - 1, numPointsLeftRight, numPointsLeftRight, (short)polynomialDegree, out _);
+                        actual = ToDouble(work);
+                    }
+                    else
+                    {
+                        actual = (double[])data.Clone();
+                        filter.SavitzkyGolayFilter(actual, 0, DATA_POINT_COUNT - 1, numPointsLeftRight, numPointsLeftRight, (short)polynomialDegree, out _);
+                    }
+
+                    reports.Add(Compare(path, expected, actual, useFFT ? fftMagnitude : magnitude, isFloat, GetBudget(isFloat, useFFT, legacyCoefficients.Length),
+                                        legacyCoefficients.Length, AllPoints()));
+                }
+            }
+
+            // Plans, which smooth every point and fit the ends to the first and last full window
+            var plan = new DataFilter.SavitzkyGolayPlan(numPointsLeftRight, numPointsLeftRight, polynomialDegree);
+            var width = plan.WindowWidth;
+
+            foreach (var isFloat in new[] { false, true })
+            {
+                var input = isFloat ? dataFloatWidened : data;
+                GetPlanReference(input, numPointsLeftRight, polynomialDegree, 0, out var expected, out var magnitude);
+                var interiorMagnitude = isFFT ? GetFFTMagnitude(input, plan.Coefficients.ToArray(), 1, fftLength) : magnitude;
+
+                foreach (var filter in GetFilters())
+                {
+                    var useFFT = isFFT && filter.UseFFTConvolution;
+                    var path = string.Format("SavitzkyGolayPlan {0} {1}/{1} degree {2}, {3}{4}",
+                                             isFloat ? "float" : "double", numPointsLeftRight, polynomialDegree, Describe(filter), useFFT ? ", FFT" : "");
+
+                    double[] actual;
+                    if (isFloat)
+                    {
+                        var work = (float[])dataFloat.Clone();
+                        filter.SavitzkyGolayFilter(work, 0, DATA_POINT_COUNT - 1, plan, out _);
+                        actual = ToDouble(work);
+                    }
+                    else
+                    {
+                        actual = (double[])data.Clone();
+                        filter.SavitzkyGolayFilter(actual, 0, DATA_POINT_COUNT - 1, plan, out _);
+                    }
+
+                    AddPlanReports(reports, path, expected, actual, magnitude, useFFT ? interiorMagnitude : magnitude, isFloat, useFFT, numPointsLeftRight);
+                }
+
+                if (isFloat)
+                {
+                    var spectrum = DataFilter.CompressedSpectrum.FromArray(dataFloat);
+                    new DataFilter.DataFilter().SavitzkyGolayFilter(spectrum, plan, out var smoothed, out _);
+
+                    AddPlanReports(reports, string.Format("CompressedSpectrum {0}/{0} degree {1}", numPointsLeftRight, polynomialDegree),
+                                   expected, ToDouble(smoothed.ToArray()), magnitude, magnitude, true, false, numPointsLeftRight);
+                }
+
+                // Non-uniform x, evenly spaced, gives the same fit as the plan
+                var xValues = new double[DATA_POINT_COUNT];
+                for (var i = 0; i < DATA_POINT_COUNT; i++)
+                {
+                    xValues[i] = i;
+                }
+
+                var slidingMagnitude = GetNeighborhoodMagnitude(input, plan.Coefficients.Sum(Math.Abs), 2 * width);
+                foreach (var filter in GetFilters().Where(item => !item.SkipZeroRuns))
+                {
+                    var path = string.Format("Non-uniform Savitzky Golay {0} {1}/{1} degree {2}, {3}",
+                                             isFloat ? "float" : "double", numPointsLeftRight, polynomialDegree, Describe(filter));
+
+                    double[] actual;
+                    if (isFloat)
+                    {
+                        var work = (float[])dataFloat.Clone();
+                        filter.SavitzkyGolayFilter(work, ToFloat(xValues), 0, DATA_POINT_COUNT - 1, numPointsLeftRight, numPointsLeftRight, (short)polynomialDegree, out _);
+                        actual = ToDouble(work);
+                    }
+                    else
+                    {
+                        actual = (double[])data.Clone();
+                        filter.SavitzkyGolayFilter(actual, xValues, 0, DATA_POINT_COUNT - 1, numPointsLeftRight, numPointsLeftRight, (short)polynomialDegree, out _);
+                    }
+
+                    // The fit is done in double, and the float version rounds once at the end
+                    reports.Add(Compare(path, expected, actual, slidingMagnitude, false, NON_UNIFORM_ULPS, width, AllPoints(), isFloat, true));
+                }
+            }
+
+            // Smoothing plus first and second derivatives, from the multi-set kernel
+            if (polynomialDegree >= 2)
+            {
+                foreach (var isFloat in new[] { false, true })
+                {
+                    var input = isFloat ? dataFloatWidened : data;
+                    var count = DATA_POINT_COUNT;
+
+                    var expected = new double[3][];
+                    var magnitude = new double[3][];
+                    for (var derivativeOrder = 0; derivativeOrder <= 2; derivativeOrder++)
+                    {
+                        GetPlanReference(input, numPointsLeftRight, polynomialDegree, derivativeOrder, out expected[derivativeOrder], out magnitude[derivativeOrder]);
+                    }
+
+                    foreach (var filter in GetFilters())
+                    {
+                        double[][] outputs;
+                        if (isFloat)
+                        {
+                            var floatOutputs = new[] { new float[count], new float[count], new float[count] };
+                            filter.SavitzkyGolayDerivatives(dataFloat, 0, count - 1, numPointsLeftRight, numPointsLeftRight, (short)polynomialDegree,
+                                                            floatOutputs[0], floatOutputs[1], floatOutputs[2], out _);
+                            outputs = floatOutputs.Select(ToDouble).ToArray();
+                        }
+                        else
+                        {
+                            outputs = new[] { new double[count], new double[count], new double[count] };
+                            filter.SavitzkyGolayDerivatives(data, 0, count - 1, numPointsLeftRight, numPointsLeftRight, (short)polynomialDegree,
+                                                            outputs[0], outputs[1], outputs[2], out _);
+                        }
+
+                        for (var derivativeOrder = 0; derivativeOrder <= 2; derivativeOrder++)
+                        {
+                            var path = string.Format("SavitzkyGolayDerivatives {0} order {1} {2}/{2} degree {3}, {4}",
+                                                     isFloat ? "float" : "double", derivativeOrder, numPointsLeftRight, polynomialDegree, Describe(filter));
+
+                            AddPlanReports(reports, path, expected[derivativeOrder], outputs[derivativeOrder], magnitude[derivativeOrder], magnitude[derivativeOrder],
+                                           isFloat, false, numPointsLeftRight);
+                        }
+                    }
+                }
+            }
+
+            AssertWithinBudget(reports);
+        }
+
+        [Test]
+        [TestCase(InputKind.Random, 5, 201)]
+        [TestCase(InputKind.Random, 24, 202)]
+        [TestCase(InputKind.Denormal, 9, 203)]
+        [TestCase(InputKind.NonFinite, 9, 204)]
+        [TestCase(InputKind.NonFinite, 101, 205)]
+        [TestCase(InputKind.HugeDynamicRange, 7, 206)]
+        [TestCase(InputKind.HugeDynamicRange, 101, 207)]
+        public void TestMovingWindowAverageAccuracy(InputKind inputKind, int windowWidthPoints, int randomSeed)
+        {
+            var reports = new List<ErrorReport>();
+
+            var data = GetData(inputKind, DATA_POINT_COUNT, randomSeed, false);
+            var dataFloat = ToFloat(GetData(inputKind, DATA_POINT_COUNT, randomSeed, true));
+
+            var numPointsLeft = windowWidthPoints / 2;
+            var numPointsRight = windowWidthPoints - 1 - numPointsLeft;
+
+            foreach (var isFloat in new[] { false, true })
+            {
+                var input = isFloat ? ToDouble(dataFloat) : data;
+
+                // Direct window sums, cut off at the ends of the data
+                var expected = new double[DATA_POINT_COUNT];
+                var magnitude = new double[DATA_POINT_COUNT];
+                for (var i = 0; i < DATA_POINT_COUNT; i++)
+                {
+                    var start = Math.Max(i - numPointsLeft, 0);
+                    var end = Math.Min(i + numPointsRight, DATA_POINT_COUNT - 1);
+
+                    double total = 0, absoluteTotal = 0;
+                    for (var j = start; j <= end; j++)
+                    {
+                        total += input[j];
+                        absoluteTotal += Math.Abs(input[j]);
+                    }
+
+                    expected[i] = total / (end - start + 1);
+                    magnitude[i] = absoluteTotal / (end - start + 1);
+                }
+
+                foreach (var filter in GetFilters())
+                {
+                    double[] actual;
+                    if (isFloat)
+                    {
+                        var work = (float[])dataFloat.Clone();
+                        filter.MovingWindowAverage(work, 0, DATA_POINT_COUNT - 1, windowWidthPoints, out _);
+                        actual = ToDouble(work);
+                    }
+                    else
+                    {
+                        actual = (double[])data.Clone();
+                        filter.MovingWindowAverage(actual, 0, DATA_POINT_COUNT - 1, windowWidthPoints, out _);
+                    }
+
+                    var path = string.Format("MovingWindowAverage {0} width {1}, {2}", isFloat ? "float" : "double", windowWidthPoints, Describe(filter));
+                    reports.Add(Compare(path, expected, actual, magnitude, isFloat, isFloat ? windowWidthPoints + 1 : SUM_ULPS, windowWidthPoints, AllPoints()));
+                }
+
+                // The non-uniform average carries its window sum from point to point; odd widths only,
+                // since it averages the points within half the width on either side
+                if (windowWidthPoints % 2 == 0)
+                    continue;
+
+                var xValues = new double[DATA_POINT_COUNT];
+                for (var i = 0; i < DATA_POINT_COUNT; i++)
+                {
+                    xValues[i] = i;
+                }
+
+                // The sum is rebuilt at least every two windows of points, so a point's rounding error lasts at most two windows
+                var slidingMagnitude = GetNeighborhoodMagnitude(input, 1, 2 * windowWidthPoints);
+                foreach (var filter in GetFilters().Where(item => !item.SkipZeroRuns))
+                {
+                    double[] actual;
+                    if (isFloat)
+                    {
+                        var work = (float[])dataFloat.Clone();
+                        filter.MovingWindowAverage(work, ToFloat(xValues), 0, DATA_POINT_COUNT - 1, windowWidthPoints, out _);
+                        actual = ToDouble(work);
+                    }
+                    else
+                    {
+                        actual = (double[])data.Clone();
+                        filter.MovingWindowAverage(actual, xValues, 0, DATA_POINT_COUNT - 1, windowWidthPoints, out _);
+                    }
+
+                    var path = string.Format("Non-uniform moving average {0} width {1}, {2}", isFloat ? "float" : "double", windowWidthPoints, Describe(filter));
+                    reports.Add(Compare(path, expected, actual, slidingMagnitude, false, SUM_ULPS, windowWidthPoints, AllPoints(), isFloat));
+                }
+            }
+
+            AssertWithinBudget(reports);
+        }
+
+        [Test]
+        [TestCase(InputKind.Random, 0.25, 301)]
+        [TestCase(InputKind.Random, 0.05, 302)]
+        [TestCase(InputKind.Denormal, 0.25, 303)]
+        [TestCase(InputKind.NonFinite, 0.25, 304)]
+        [TestCase(InputKind.HugeDynamicRange, 0.25, 305)]
+        [TestCase(InputKind.HugeDynamicRange, 0.5, 306)]
+        public void TestButterworthAccuracy(InputKind inputKind, double samplingFrequency, int randomSeed)
+        {
+            var reports = new List<ErrorReport>();
+            var plan = DataFilter.ButterworthPlan.GetPlan(samplingFrequency);
+            var decay = GetButterworthDecay(plan);
+
+            foreach (var isFloat in new[] { false, true })
+            {
+                var data = GetData(inputKind, DATA_POINT_COUNT, randomSeed, isFloat);
+                var dataFloat = ToFloat(data);
+                if (isFloat)
+                    data = ToDouble(dataFloat);
+
+                var expected = ButterworthReference(data, plan);
+                var magnitude = GetDecayingMagnitude(data, decay);
+
+                foreach (var skipZeroRuns in new[] { false, true })
+                {
+                    var filter = new DataFilter.DataFilter { SkipZeroRuns = skipZeroRuns };
+                    var path = string.Format("ButterworthFilter {0} sampling frequency {1}, {2}",
+                                             isFloat ? "float" : "double", samplingFrequency, skipZeroRuns ? "skipping zero runs" : "dense");
+
+                    double[] actual;
+                    if (isFloat)
+                    {
+                        var work = (float[])dataFloat.Clone();
+                        filter.ButterworthFilter(work, 0, DATA_POINT_COUNT - 1, samplingFrequency);
+                        actual = ToDouble(work);
+                    }
+                    else
+                    {
+                        actual = (double[])data.Clone();
+                        filter.ButterworthFilter(actual, 0, DATA_POINT_COUNT - 1, samplingFrequency);
+                    }
+
+                    reports.Add(Compare(path, expected, actual, magnitude, isFloat, BUTTERWORTH_ULPS, DataFilter.ButterworthPlan.FILTER_ORDER + 1, AllPoints()));
+                }
+            }
+
+            AssertWithinBudget(reports);
+        }
+
+        /// <summary>
+        /// Worst error of one path
+        /// </summary>
+        private class ErrorReport
+        {
+            public string Path;
+            public double BudgetUlps;
+            public double WorstUlps;
+            public int WorstIndex = -1;
+            public double Expected;
+            public double Actual;
+            public int NonFiniteMismatches;
+            public int FirstMismatch = -1;
+
+            public bool WithinBudget => WorstUlps <= BudgetUlps && NonFiniteMismatches == 0;
+
+            public override string ToString()
+            {
+                var text = string.Format("{0,-8} {1,10:G4} ulps (budget {2,6})  {3}", WithinBudget ? "ok" : "FAILED", WorstUlps, BudgetUlps, Path);
+
+                if (WorstIndex >= 0)
+                    text += string.Format("; worst at {0}: expected {1:R}, got {2:R}", WorstIndex, Expected, Actual);
+
+                if (NonFiniteMismatches > 0)
+                    text += string.Format("; {0} NaN or infinity mismatches, first at {1}", NonFiniteMismatches, FirstMismatch);
+
+                return text;
+            }
+        }
+
+        /// <summary>
+        /// Compare actual with expected, in ulps of magnitude
+        /// </summary>
+        /// <param name="path"></param>
+        /// <param name="expected"></param>
+        /// <param name="actual"></param>
+        /// <param name="magnitude"></param>
+        /// <param name="isFloat">True to count in float ulps, and allow (terms) float denormal steps</param>
+        /// <param name="budgetUlps"></param>
+        /// <param name="terms">Number of terms in a point, for the denormal floor</param>
+        /// <param name="points">Indices to compare</param>
+        /// <param name="roundedToFloat">True if a double result is rounded to float at the end, which adds half a float ulp of the result</param>
+        /// <param name="anyNonFinite">True to accept any NaN or infinity where the reference is NaN or infinite</param>
+        private static ErrorReport Compare(
+            string path,
+            double[] expected,
+            double[] actual,
+            double[] magnitude,
+            bool isFloat,
+            double budgetUlps,
+            int terms,
+            IEnumerable<int> points,
+            bool roundedToFloat = false,
+            bool anyNonFinite = false)
+        {
+            var report = new ErrorReport { Path = path, BudgetUlps = budgetUlps };
+            var epsilon = isFloat ? FLOAT_EPSILON : DOUBLE_EPSILON;
+            var floor = terms * (isFloat ? float.Epsilon : double.Epsilon);
+
+            foreach (var i in points)
+            {
+                if (IsNonFinite(expected[i]) || IsNonFinite(actual[i]))
+                {
+                    if (IsNonFinite(expected[i]) != IsNonFinite(actual[i]) || !anyNonFinite && !expected[i].Equals(actual[i]))
+                    {
+                        if (report.NonFiniteMismatches++ == 0)
+                            report.FirstMismatch = i;
+                    }
+
+                    continue;
+                }
+
+                var error = Math.Abs(actual[i] - expected[i]);
+                if (roundedToFloat)
+                    error = Math.Max(error - FLOAT_EPSILON * Math.Abs(expected[i]) - float.Epsilon, 0);
+
+                if (error == 0)
+                    continue;
+
+                var ulps = error / (epsilon * magnitude[i] + floor);
+                if (!(ulps <= report.WorstUlps))
+                {
+                    report.WorstUlps = ulps;
+                    report.WorstIndex = i;
+                    report.Expected = expected[i];
+                    report.Actual = actual[i];
+                }
+            }
+
+            return report;
+        }
+
+        /// <summary>
+        /// Compare the output of a plan, with the points at the ends, which use one-sided windows, reported separately
+        /// </summary>
+        /// <param name="reports"></param>
+        /// <param name="path"></param>
+        /// <param name="expected"></param>
+        /// <param name="actual"></param>
+        /// <param name="magnitude">Magnitude of the direct convolution</param>
+        /// <param name="interiorMagnitude">Magnitude of the points with a centered window, which may use the FFT</param>
+        /// <param name="isFloat"></param>
+        /// <param name="isFFT"></param>
+        /// <param name="numPointsLeftRight"></param>
+        private static void AddPlanReports(
+            List<ErrorReport> reports,
+            string path,
+            double[] expected,
+            double[] actual,
+            double[] magnitude,
+            double[] interiorMagnitude,
+            bool isFloat,
+            bool isFFT,
+            int numPointsLeftRight)
+        {
+            var width = 2 * numPointsLeftRight + 1;
+            var interior = Enumerable.Range(numPointsLeftRight, DATA_POINT_COUNT - 2 * numPointsLeftRight);
+            var ends = Enumerable.Range(0, numPointsLeftRight).Concat(Enumerable.Range(DATA_POINT_COUNT - numPointsLeftRight, numPointsLeftRight));
+
+            reports.Add(Compare(path, expected, actual, interiorMagnitude, isFloat, GetBudget(isFloat, isFFT, width), width, interior));
+            reports.Add(Compare(path + ", ends", expected, actual, magnitude, isFloat, isFloat ? width + 1 : END_DOUBLE_ULPS, width, ends));
+        }
+
+        /// <summary>
+        /// Budget for a convolution of width terms
+        /// </summary>
+        private static double GetBudget(bool isFloat, bool isFFT, int width)
+        {
+            if (isFloat)
+                return width + 1;
+
+            return isFFT ? FFT_ULPS : DIRECT_DOUBLE_ULPS;
+        }
+
+        private static IEnumerable<int> AllPoints()
+        {
+            return Enumerable.Range(0, DATA_POINT_COUNT);
+        }
+
+        private static void AssertWithinBudget(List<ErrorReport> reports)
+        {
+            foreach (var report in reports)
+            {
+                Console.WriteLine(report);
+            }
+
+            var failures = reports.Where(report => !report.WithinBudget).ToList();
+            if (failures.Count > 0)
+                Assert.Fail(string.Join(Environment.NewLine, failures));
+        }
+
+        private static bool IsNonFinite(double value)
+        {
+            return double.IsNaN(value) || double.IsInfinity(value);
+        }
+
+        private static double FiniteMagnitude(double value)
+        {
+            return IsNonFinite(value) ? 0 : Math.Abs(value);
+        }
+
+        /// <summary>
+        /// The filters to test: serial, parallel, serial skipping zero runs, and parallel with FFT convolution
+        /// </summary>
+        private static IEnumerable<DataFilter.DataFilter> GetFilters()
+        {
+            yield return new DataFilter.DataFilter { MaxDegreeOfParallelism = 1 };
+            yield return new DataFilter.DataFilter { MaxDegreeOfParallelism = 0 };
+            yield return new DataFilter.DataFilter { MaxDegreeOfParallelism = 1, SkipZeroRuns = true };
+            yield return new DataFilter.DataFilter { MaxDegreeOfParallelism = 0, UseFFTConvolution = true };
+        }
+
+        private static string Describe(DataFilter.DataFilter filter)
+        {
+            if (filter.SkipZeroRuns)
+                return "skipping zero runs";
+
+            if (filter.UseFFTConvolution)
+                return "FFT convolution";
+
+            return filter.MaxDegreeOfParallelism == 1 ? "serial" : "parallel";
+        }
+
+        /// <summary>
+        /// scale * Σ coefficients[j] * data[windowStart + j], summed in double
+        /// </summary>
+        /// <param name="data"></param>
+        /// <param name="windowStart"></param>
+        /// <param name="coefficients"></param>
+        /// <param name="scale"></param>
+        /// <param name="magnitude">scale * Σ |coefficients[j] * data[windowStart + j]|</param>
+        private static double Convolve(double[] data, int windowStart, double[] coefficients, double scale, out double magnitude)
+        {
+            double sum = 0, absoluteSum = 0;
+            for (var j = 0; j < coefficients.Length; j++)
+            {
+                var term = coefficients[j] * data[windowStart + j];
+                sum += term;
+                absoluteSum += Math.Abs(term);
+            }
+
+            magnitude = Math.Abs(scale) * absoluteSum;
+            return sum * scale;
+        }
+
+        /// <summary>
+        /// NRSavGol coefficients for offsets -numPointsLeft through numPointsRight, times derivativeOrder!
+        /// </summary>
+        private static double[] GetNRCoefficients(int numPointsLeft, int numPointsRight, int polynomialDegree, int derivativeOrder)
+        {
+            var numPointsTotal = numPointsLeft + numPointsRight + 1;
+            var c = new double[numPointsTotal + 1];
+            new DataFilter.NRSavGol().savgol(c, numPointsTotal, numPointsLeft, numPointsRight, derivativeOrder, polynomialDegree);
+
+            var factorial = 1.0;
+            for (var i = 2; i <= derivativeOrder; i++)
+                factorial *= i;
+
+            var coefficients = new double[numPointsTotal];
+            for (var offset = -numPointsLeft; offset <= numPointsRight; offset++)
+            {
+                coefficients[offset + numPointsLeft] = c[(numPointsTotal - offset) % numPointsTotal + 1] * factorial;
+            }
+
+            return coefficients;
+        }
+
+        /// <summary>
+        /// The window of the legacy SavitzkyGolayFilter, built from NRSavGol coefficients in the same layout
+        /// </summary>
+        private static double[] GetLegacyCoefficients(int numPointsLeftRight, int polynomialDegree)
+        {
+            var numPointsTotal = 2 * numPointsLeftRight + 1;
+            var c = new double[numPointsTotal + 1];
+            new DataFilter.NRSavGol().savgol(c, numPointsTotal, numPointsLeftRight, numPointsLeftRight, 0, polynomialDegree);
+
+            var n = numPointsLeftRight * 2;
+            var coefficients = new double[n + 1];
+            for (var i = 0; i <= numPointsLeftRight; i++)
+            {
+                coefficients[n / 2 - i] = c[i + 1];
+            }
+
+            for (var i = 1; i <= numPointsLeftRight; i++)
+            {
+                coefficients[n / 2 + i] = c[n - i];
+            }
+
+            return coefficients;
+        }
+
+        /// <summary>
+        /// Savitzky Golay of every point, with the ends fit to the first and last full window, as a plan does
+        /// </summary>
+        private static void GetPlanReference(double[] data, int numPointsLeftRight, int polynomialDegree, int derivativeOrder,
+                                             out double[] expected, out double[] magnitude)
+        {
+            var width = 2 * numPointsLeftRight + 1;
+            var sets = new double[width][];
+            for (var position = 0; position < width; position++)
+            {
+                sets[position] = GetNRCoefficients(position, width - 1 - position, polynomialDegree, derivativeOrder);
+            }
+
+            expected = new double[data.Length];
+            magnitude = new double[data.Length];
+
+            for (var i = 0; i < data.Length; i++)
+            {
+                var windowStart = Math.Min(Math.Max(i - numPointsLeftRight, 0), data.Length - width);
+                expected[i] = Convolve(data, windowStart, sets[i - windowStart], 1, out magnitude[i]);
+            }
+        }
+
+        /// <summary>
+        /// Replica of OverlapSaveConvolution.GetFFTLength
+        /// </summary>
+        private static int GetFFTLength(int kernelLength)
+        {
+            var n = 64;
+            while (n < 8 * kernelLength)
+                n <<= 1;
+
+            return n;
+        }
+
+        /// <summary>
+        /// FFT rounding error spreads over a block, so the magnitude of a point is
+        /// Σ |c| times the largest value within one FFT length of it
+        /// </summary>
+        private static double[] GetFFTMagnitude(double[] data, double[] coefficients, double scale, int fftLength)
+        {
+            return GetNeighborhoodMagnitude(data, Math.Abs(scale) * coefficients.Sum(Math.Abs), fftLength);
+        }
+
+        /// <summary>
+        /// weight times the largest |value| within radius points of each point
+        /// </summary>
+        /// <remarks>NaN and infinity are left out: a finite result must not depend on them</remarks>
+        private static double[] GetNeighborhoodMagnitude(double[] data, double weight, int radius)
+        {
+            var magnitude = new double[data.Length];
+            var window = new LinkedList<int>();
+
+            // Sliding maximum over data[i - radius] through data[i + radius]
+            for (var j = 0; j < data.Length + radius; j++)
+            {
+                if (j < data.Length)
+                {
+                    var value = FiniteMagnitude(data[j]);
+                    while (window.Count > 0 && FiniteMagnitude(data[window.Last.Value]) <= value)
+                        window.RemoveLast();
+
+                    window.AddLast(j);
+                }
+
+                var i = j - radius;
+                if (i < 0)
+                    continue;
+
+                while (window.First.Value < i - radius)
+                    window.RemoveFirst();
+
+                magnitude[i] = weight * FiniteMagnitude(data[window.First.Value]);
+            }
+
+            return magnitude;
+        }
+
+        /// <summary>
+        /// The Butterworth filter by the direct recursion, run forward and then backward for zero phase
+        /// </summary>
+        private static double[] ButterworthReference(double[] data, DataFilter.ButterworthPlan plan)
+        {
+            var forward = ButterworthRecursion(data, plan);
+            Array.Reverse(forward);
+
+            var result = ButterworthRecursion(forward, plan);
+            Array.Reverse(result);
+            return result;
+        }
+
+        /// <summary>
+        /// y(n) = b(0)*x(n) + ... + b(order)*x(n-order) - a(1)*y(n-1) - ... - a(order)*y(n-order)
+        /// </summary>
+        private static double[] ButterworthRecursion(double[] x, DataFilter.ButterworthPlan plan)
+        {
+            var y = new double[x.Length];
+            for (var i = 0; i < x.Length; i++)
+            {
+                var sum = plan.B[0] * x[i];
+                for (var j = 1; j <= DataFilter.ButterworthPlan.FILTER_ORDER && i - j >= 0; j++)
+                {
+                    sum += plan.B[j] * x[i - j];
+                    sum -= plan.A[j] * y[i - j];
+                }
+
+                y[i] = sum;
+            }
+
+            return y;
+        }
+
+        /// <summary>
+        /// Ratio per point by which the impulse response of the filter decays
+        /// </summary>
+        private static double GetButterworthDecay(DataFilter.ButterworthPlan plan)
+        {
+            const int LENGTH = 2001;
+            const int CENTER = LENGTH / 2;
+
+            var impulse = new double[LENGTH];
+            impulse[CENTER] = 1;
+            impulse = ButterworthReference(impulse, plan);
+
+            var peak = impulse.Max(Math.Abs);
+            var decay = 0.0;
+            for (var k = 1; k < CENTER; k++)
+            {
+                var ratio = Math.Max(Math.Abs(impulse[CENTER + k]), Math.Abs(impulse[CENTER - k])) / peak;
+                if (ratio > 0)
+                    decay = Math.Max(decay, Math.Pow(ratio, 1.0 / k));
+            }
+
+            return decay;
+        }
+
+        /// <summary>
+        /// Largest |data[k]| * decay^|i - k| for each point i; the recursion carries each point's rounding error that far
+        /// </summary>
+        private static double[] GetDecayingMagnitude(double[] data, double decay)
+        {
+            var magnitude = new double[data.Length];
+            var carried = 0.0;
+
+            for (var i = 0; i < data.Length; i++)
+            {
+                carried = Math.Max(FiniteMagnitude(data[i]), carried * decay);
+                magnitude[i] = carried;
+            }
+
+            carried = 0;
+            for (var i = data.Length - 1; i >= 0; i--)
+            {
+                carried = Math.Max(FiniteMagnitude(data[i]), carried * decay);
+                magnitude[i] = Math.Max(magnitude[i], carried);
+            }
+
+            return magnitude;
+        }
+
+        /// <summary>
+        /// Test data of the given kind, with about a third of the points in runs of exact zeros
+        /// </summary>
+        /// <param name="inputKind"></param>
+        /// <param name="dataPointCount"></param>
+        /// <param name="randomSeed"></param>
+        /// <param name="forFloat">True to keep the values within float range</param>
+        private static double[] GetData(InputKind inputKind, int dataPointCount, int randomSeed, bool forFloat)
+        {
+            var rand = new Random(randomSeed);
+            var data = new double[dataPointCount];
+
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                switch (inputKind)
+                {
+                    case InputKind.Denormal:
+                        // Mostly denormal, with some of the smallest normal values
+                        var smallest = forFloat ? 1.1754943508222875e-38 : 2.2250738585072014e-308;
+                        data[i] = smallest * (rand.NextDouble() < 0.9 ? rand.NextDouble() : 1 + rand.NextDouble()) * (rand.Next(2) == 0 ? 1 : -1);
+                        break;
+
+                    case InputKind.HugeDynamicRange:
+                        data[i] = Math.Pow(10, -30 + 60 * rand.NextDouble());
+                        break;
+
+                    default:
+                        data[i] = 50 + 10 * (rand.NextDouble() - 0.5);
+                        break;
+                }
+            }
+
+            if (inputKind == InputKind.Random || inputKind == InputKind.NonFinite)
+            {
+                for (var peak = rand.Next(100); peak < dataPointCount; peak += 50 + rand.Next(200))
+                {
+                    var height = 100000 * rand.NextDouble();
+                    for (var i = Math.Max(peak - 30, 0); i < Math.Min(peak + 30, dataPointCount); i++)
+                    {
+                        var u = (i - peak) / 6.0;
+                        data[i] += height * Math.Exp(-u * u / 2);
+                    }
+                }
+            }
+
+            for (var run = rand.Next(500); run < dataPointCount; run += 300 + rand.Next(300))
+            {
+                var runEnd = Math.Min(run + 20 + rand.Next(200), dataPointCount);
+                Array.Clear(data, run, runEnd - run);
+            }
+
+            if (inputKind == InputKind.NonFinite)
+            {
+                var specialValues = new[] { double.NaN, double.PositiveInfinity, double.NegativeInfinity };
+                for (var k = 0; k < 12; k++)
+                {
+                    data[rand.Next(dataPointCount)] = specialValues[k % specialValues.Length];
+                }
+            }
+
+            return data;
+        }
+
+        private static float[] ToFloat(double[] values)
+        {
+            return values.Select(value => (float)value).ToArray();
+        }
+
+        private static double[] ToDouble(float[] values)
+        {
+            return values.Select(value => (double)value).ToArray();
+        }
+    }
+}
@@ -1,4 +1,5 @@
 using System;
+using System.Collections.Generic;
 using NUnit.Framework;
 
 namespace DataFilterTest
@@ -75,5 +76,675 @@ namespace DataFilterTest
             }
 
         }
+
+        [Test]
+        [TestCase(200, 5, 5, 3, 0.5)]
+        [TestCase(150, 3, 6, 2, 1.0)]
+        public void TestSavitzkyGolayDerivatives(
+            int dataPointCount,
+            int numPointsLeft,
+            int numPointsRight,
+            short polynomialDegree,
+            double pointSpacing)
+        {
+            // Savitzky Golay reproduces a polynomial of degree polynomialDegree exactly
+            var cubic = polynomialDegree >= 3 ? 0.01 : 0;
+
+            var dblData = new double[dataPointCount];
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                var x = i * pointSpacing;
+                dblData[i] = 3 + 2 * x - 0.7 * x * x + cubic * x * x * x;
+            }
+
+            var smoothed = new double[dataPointCount];
+            var firstDerivative = new double[dataPointCount];
+            var secondDerivative = new double[dataPointCount];
+
+            var objFilter = new DataFilter.DataFilter();
+            var success = objFilter.SavitzkyGolayDerivatives(
+                dblData, 0, dataPointCount - 1,
+                numPointsLeft, numPointsRight, polynomialDegree,
+                smoothed, firstDerivative, secondDerivative,
+                out var errorMessage, pointSpacing);
+
+            if (!success)
+            {
+                Assert.Fail(errorMessage);
+            }
+
+            // The edge sets fit the ends of the range, so every point is exact
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                var x = i * pointSpacing;
+                Assert.AreEqual(dblData[i], smoothed[i], 1e-8);
+                Assert.AreEqual(2 - 1.4 * x + 3 * cubic * x * x, firstDerivative[i], 1e-8);
+                Assert.AreEqual(-1.4 + 6 * cubic * x, secondDerivative[i], 1e-8);
+            }
+        }
+
+        [Test]
+        [TestCase(4, 4, 2, 0)]
+        [TestCase(0, 6, 4, 1)]
+        [TestCase(7, 2, 3, 2)]
+        public void TestSavitzkyGolayCoefficients(
+            int numPointsLeft,
+            int numPointsRight,
+            int polynomialDegree,
+            int derivativeOrder)
+        {
+            var numPointsTotal = numPointsLeft + numPointsRight + 1;
+            var c = new double[numPointsTotal + 1];
+            new DataFilter.NRSavGol().savgol(c, numPointsTotal, numPointsLeft, numPointsRight, derivativeOrder, polynomialDegree);
+
+            var factorial = 1.0;
+            for (var i = 2; i <= derivativeOrder; i++)
+                factorial *= i;
+
+            var coefficients = DataFilter.SavitzkyGolayCoefficients.GetCoefficients(numPointsLeft, numPointsRight, polynomialDegree, derivativeOrder);
+            var everyPosition = DataFilter.SavitzkyGolayCoefficients.GetCoefficientsForEveryPosition(numPointsTotal, polynomialDegree, derivativeOrder);
+
+            for (var offset = -numPointsLeft; offset <= numPointsRight; offset++)
+            {
+                var expected = c[(numPointsTotal - offset) % numPointsTotal + 1] * factorial;
+                Assert.AreEqual(expected, coefficients[offset + numPointsLeft], 1e-6);
+                Assert.AreEqual(coefficients[offset + numPointsLeft], everyPosition[numPointsLeft][offset + numPointsLeft], 1e-12);
+            }
+        }
+
+        [Test]
+        [TestCase(300, 4, 4, 2, 612.5)]
+        [TestCase(500, 3, 7, 3, 1450.0)]
+        public void TestNonUniformSavitzkyGolay(
+            int dataPointCount,
+            int numPointsLeft,
+            int numPointsRight,
+            short polynomialDegree,
+            double startMz)
+        {
+            // m/z spacing that grows along the spectrum, as on a TOF axis, with some jitter
+            var rand = new Random(17);
+            var xValues = new double[dataPointCount];
+            var dblData = new double[dataPointCount];
+            var x = startMz;
+
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                x += 0.002 + 0.00001 * i + 0.001 * rand.NextDouble();
+                xValues[i] = x;
+
+                var u = x - startMz;
+                dblData[i] = 5 + 40 * u - 9 * u * u + (polynomialDegree >= 3 ? 2 * u * u * u : 0);
+            }
+
+            var expected = (double[])dblData.Clone();
+
+            var objFilter = new DataFilter.DataFilter();
+            var success = objFilter.SavitzkyGolayFilter(
+                dblData, xValues, 0, dataPointCount - 1,
+                numPointsLeft, numPointsRight, polynomialDegree,
+                out var errorMessage);
+
+            if (!success)
+            {
+                Assert.Fail(errorMessage);
+            }
+
+            // A polynomial of degree polynomialDegree is reproduced exactly, whatever the spacing
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                Assert.AreEqual(expected[i], dblData[i], 1e-8);
+            }
+        }
+
+        [Test]
+        [TestCase(400000, 5, 4, 0, 121)]
+        [TestCase(400000, 12, 4, 0, 122)]
+        [TestCase(2200000, 5, 4, 7.5, 123)]
+        public void TestNonUniformParallelTiles(
+            int dataPointCount,
+            int numPointsLeftRight,
+            short polynomialDegree,
+            double windowWidthX,
+            int randomSeed)
+        {
+            // Jittered spacing, with a NaN and an infinity just either side of the tile boundaries
+            var rand = new Random(randomSeed);
+            var xValues = new double[dataPointCount];
+            var dblData = new double[dataPointCount];
+            var x = 500.0;
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                x += 0.5 + rand.NextDouble();
+                xValues[i] = x;
+                dblData[i] = 50 * rand.NextDouble() + (i % 700 < 25 ? 5000 * rand.NextDouble() : 0);
+            }
+
+            dblData[16384 - 3] = double.NaN;
+            dblData[2 * 16384 + 1] = double.PositiveInfinity;
+
+            var serialFilter = new DataFilter.DataFilter { MaxDegreeOfParallelism = 1 };
+            var parallelFilter = new DataFilter.DataFilter { MaxDegreeOfParallelism = 4 };
+
+            var serial = (double[])dblData.Clone();
+            var parallel = (double[])dblData.Clone();
+            string errorMessage;
+
+            if (windowWidthX > 0)
+            {
+                Assert.IsTrue(serialFilter.MovingWindowAverage(serial, xValues, 0, dataPointCount - 1, windowWidthX, out errorMessage), errorMessage);
+                Assert.IsTrue(parallelFilter.MovingWindowAverage(parallel, xValues, 0, dataPointCount - 1, windowWidthX, out errorMessage), errorMessage);
+            }
+            else
+            {
+                Assert.IsTrue(serialFilter.SavitzkyGolayFilter(
+                    serial, xValues, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+                Assert.IsTrue(parallelFilter.SavitzkyGolayFilter(
+                    parallel, xValues, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+            }
+
+            CollectionAssert.AreEqual(serial, parallel);
+        }
+
+        [Test]
+        [TestCase(5000, 5, 2, 9, 0.02, 71)]
+        [TestCase(20000, 3, 4, 5, 0.005, 72)]
+        [TestCase(200000, 40, 4, 25, 0.0002, 73)]
+        public void TestSkipZeroRuns(
+            int dataPointCount,
+            int numPointsLeftRight,
+            short polynomialDegree,
+            int windowWidthPoints,
+            double peakDensity,
+            int randomSeed)
+        {
+            // Thresholded profile data: short peaks separated by runs of exact zeros
+            var rand = new Random(randomSeed);
+            var dblData = new double[dataPointCount];
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                if (rand.NextDouble() >= peakDensity)
+                    continue;
+
+                for (var k = 0; k < 12 && i < dataPointCount; k++, i++)
+                {
+                    dblData[i] = 1000 * rand.NextDouble();
+                }
+            }
+
+            var denseFilter = new DataFilter.DataFilter();
+            var sparseFilter = new DataFilter.DataFilter { SkipZeroRuns = true };
+
+            var dense = (double[])dblData.Clone();
+            var sparse = (double[])dblData.Clone();
+            denseFilter.SavitzkyGolayFilter(dense, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out _);
+            sparseFilter.SavitzkyGolayFilter(sparse, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out _);
+            CollectionAssert.AreEqual(dense, sparse);
+
+            dense = (double[])dblData.Clone();
+            sparse = (double[])dblData.Clone();
+            denseFilter.MovingWindowAverage(dense, 0, dataPointCount - 1, windowWidthPoints, out _);
+            sparseFilter.MovingWindowAverage(sparse, 0, dataPointCount - 1, windowWidthPoints, out _);
+            CollectionAssert.AreEqual(dense, sparse);
+
+            dense = (double[])dblData.Clone();
+            sparse = (double[])dblData.Clone();
+            denseFilter.ButterworthFilter(dense, 0, dataPointCount - 1);
+            sparseFilter.ButterworthFilter(sparse, 0, dataPointCount - 1);
+            CollectionAssert.AreEqual(dense, sparse);
+
+            // The in-place paths on several threads, for each overload, with and without FFT convolution
+            var fltData = Array.ConvertAll(dblData, value => (float)value);
+            var plan = new DataFilter.SavitzkyGolayPlan(numPointsLeftRight, numPointsLeftRight, polynomialDegree);
+            foreach (var useFFT in new[] { false, true })
+            {
+                denseFilter = new DataFilter.DataFilter { UseFFTConvolution = useFFT };
+                sparseFilter = new DataFilter.DataFilter { UseFFTConvolution = useFFT, SkipZeroRuns = true, MaxDegreeOfParallelism = 4 };
+
+                dense = (double[])dblData.Clone();
+                sparse = (double[])dblData.Clone();
+                Assert.IsTrue(denseFilter.SavitzkyGolayFilter(dense, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out var errorMessage), errorMessage);
+                Assert.IsTrue(sparseFilter.SavitzkyGolayFilter(sparse, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+                CollectionAssert.AreEqual(dense, sparse);
+
+                dense = (double[])dblData.Clone();
+                sparse = (double[])dblData.Clone();
+                Assert.IsTrue(denseFilter.SavitzkyGolayFilter(dense, 0, dataPointCount - 1, plan, out errorMessage), errorMessage);
+                Assert.IsTrue(sparseFilter.SavitzkyGolayFilter(sparse, 0, dataPointCount - 1, plan, out errorMessage), errorMessage);
+                CollectionAssert.AreEqual(dense, sparse);
+
+                var denseFloat = (float[])fltData.Clone();
+                var sparseFloat = (float[])fltData.Clone();
+                Assert.IsTrue(denseFilter.SavitzkyGolayFilter(denseFloat, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+                Assert.IsTrue(sparseFilter.SavitzkyGolayFilter(sparseFloat, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+                CollectionAssert.AreEqual(denseFloat, sparseFloat);
+
+                denseFloat = (float[])fltData.Clone();
+                sparseFloat = (float[])fltData.Clone();
+                Assert.IsTrue(denseFilter.SavitzkyGolayFilter(denseFloat, 0, dataPointCount - 1, plan, out errorMessage), errorMessage);
+                Assert.IsTrue(sparseFilter.SavitzkyGolayFilter(sparseFloat, 0, dataPointCount - 1, plan, out errorMessage), errorMessage);
+                CollectionAssert.AreEqual(denseFloat, sparseFloat);
+
+                denseFloat = (float[])fltData.Clone();
+                sparseFloat = (float[])fltData.Clone();
+                Assert.IsTrue(denseFilter.MovingWindowAverage(denseFloat, 0, dataPointCount - 1, windowWidthPoints, out errorMessage), errorMessage);
+                Assert.IsTrue(sparseFilter.MovingWindowAverage(sparseFloat, 0, dataPointCount - 1, windowWidthPoints, out errorMessage), errorMessage);
+                CollectionAssert.AreEqual(denseFloat, sparseFloat);
+            }
+        }
+
+        [Test]
+        [TestCase(10000, 4, 2, 7, 0.02, 81)]
+        [TestCase(30000, 6, 3, 5, 0.002, 82)]
+        public void TestCompressedSpectrum(
+            int dataPointCount,
+            int numPointsLeftRight,
+            int polynomialDegree,
+            int windowWidthPoints,
+            double peakDensity,
+            int randomSeed)
+        {
+            // Thresholded profile data, with a long run of zeros that fills whole blocks
+            var rand = new Random(randomSeed);
+            var data = new float[dataPointCount];
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                if (rand.NextDouble() >= peakDensity || (i > dataPointCount / 3 && i < dataPointCount / 2))
+                    continue;
+
+                for (var k = 0; k < 12 && i < dataPointCount; k++, i++)
+                {
+                    data[i] = (float)(1000 * rand.NextDouble());
+                }
+            }
+
+            var spectrum = DataFilter.CompressedSpectrum.FromArray(data);
+            CollectionAssert.AreEqual(data, spectrum.ToArray());
+            Assert.Less(spectrum.CompressedBytes, dataPointCount * sizeof(float));
+
+            var objFilter = new DataFilter.DataFilter();
+
+            var plan = new DataFilter.SavitzkyGolayPlan(numPointsLeftRight, numPointsLeftRight, polynomialDegree);
+            var dense = (float[])data.Clone();
+            objFilter.SavitzkyGolayFilter(dense, 0, dataPointCount - 1, plan, out _);
+            Assert.IsTrue(objFilter.SavitzkyGolayFilter(spectrum, plan, out var smoothed, out var errorMessage), errorMessage);
+            CollectionAssert.AreEqual(dense, smoothed.ToArray());
+
+            dense = (float[])data.Clone();
+            objFilter.MovingWindowAverage(dense, 0, dataPointCount - 1, windowWidthPoints, out _);
+            Assert.IsTrue(objFilter.MovingWindowAverage(spectrum, windowWidthPoints, out smoothed, out errorMessage), errorMessage);
+            CollectionAssert.AreEqual(dense, smoothed.ToArray());
+
+            Assert.IsFalse(objFilter.SavitzkyGolayFilter(null, plan, out smoothed, out errorMessage));
+            Assert.IsNull(smoothed);
+            Assert.AreEqual("spectrum should not be null", errorMessage);
+
+            Assert.IsFalse(objFilter.MovingWindowAverage(null, windowWidthPoints, out smoothed, out errorMessage));
+            Assert.IsNull(smoothed);
+            Assert.AreEqual("spectrum should not be null", errorMessage);
+
+            var coAdded = DataFilter.CompressedSpectrum.CoAdd(new[] { spectrum, spectrum });
+            var maxValues = new float[(dataPointCount + 9) / 10];
+            var pointCount = coAdded.Decimate(0, dataPointCount, 10, DataFilter.CompressedSpectrum.DecimationMode.Max, maxValues);
+            Assert.AreEqual(maxValues.Length, pointCount);
+
+            for (var group = 0; group < pointCount; group++)
+            {
+                var expected = float.MinValue;
+                for (var i = group * 10; i < Math.Min(group * 10 + 10, dataPointCount); i++)
+                {
+                    expected = Math.Max(expected, data[i] + data[i]);
+                }
+
+                Assert.AreEqual(expected, maxValues[group]);
+            }
+        }
+
+        [Test]
+        [TestCase(5000, 4, 2, 7, 0.25, 91)]
+        [TestCase(20000, 10, 4, 11, 0.6, 92)]
+        public void TestFloatOverloads(
+            int dataPointCount,
+            int numPointsLeftRight,
+            short polynomialDegree,
+            int windowWidthPoints,
+            double samplingFrequency,
+            int randomSeed)
+        {
+            // Peaks on a noisy baseline, rounded to float so that both versions filter the same values
+            var rand = new Random(randomSeed);
+            var sngData = new float[dataPointCount];
+            var dblData = new double[dataPointCount];
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                sngData[i] = (float)(50 * rand.NextDouble() + (i % 500 < 20 ? 5000 * rand.NextDouble() : 0));
+                dblData[i] = sngData[i];
+            }
+
+            var objFilter = new DataFilter.DataFilter();
+
+            var dblSmoothed = (double[])dblData.Clone();
+            var sngSmoothed = (float[])sngData.Clone();
+            Assert.IsTrue(objFilter.SavitzkyGolayFilter(dblSmoothed, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out var errorMessage), errorMessage);
+            Assert.IsTrue(objFilter.SavitzkyGolayFilter(sngSmoothed, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+
+            // Equal points left and right give symmetric coefficients; degree 2 and up are scaled by the intensity correction
+            var coefficients = DataFilter.SavitzkyGolayCoefficients.GetCoefficients(numPointsLeftRight, numPointsLeftRight, polynomialDegree, 0);
+            AssertWithinFloatBound(dblData, dblSmoothed, sngSmoothed, coefficients, polynomialDegree <= 1 ? 1.0 : 1.6, numPointsLeftRight);
+
+            dblSmoothed = (double[])dblData.Clone();
+            sngSmoothed = (float[])sngData.Clone();
+            Assert.IsTrue(objFilter.MovingWindowAverage(dblSmoothed, 0, dataPointCount - 1, windowWidthPoints, out errorMessage), errorMessage);
+            Assert.IsTrue(objFilter.MovingWindowAverage(sngSmoothed, 0, dataPointCount - 1, windowWidthPoints, out errorMessage), errorMessage);
+
+            var weights = new double[windowWidthPoints];
+            for (var j = 0; j < windowWidthPoints; j++)
+            {
+                weights[j] = 1.0 / windowWidthPoints;
+            }
+
+            AssertWithinFloatBound(dblData, dblSmoothed, sngSmoothed, weights, 1.0, windowWidthPoints / 2);
+
+            // Butterworth only rounds its final output
+            var dblFiltered = (double[])dblData.Clone();
+            var sngFiltered = (float[])sngData.Clone();
+            objFilter.ButterworthFilter(dblFiltered, 0, dataPointCount - 1, samplingFrequency);
+            objFilter.ButterworthFilter(sngFiltered, 0, dataPointCount - 1, samplingFrequency);
+
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                Assert.AreEqual((float)dblFiltered[i], sngFiltered[i], "Point " + i);
+            }
+
+            // ButterworthFilter.FilterData matches the original double implementation, rounded to float
+            var expected = LegacyButterworth(
+                dblData,
+                new[] {1.0, -3.4789, 5.0098, -3.6995, 1.3942, -0.2138},
+                new[] {0.0004, 0.0018, 0.0037, 0.0037, 0.0018, 0.0004});
+
+            sngFiltered = (float[])sngData.Clone();
+            new DataFilter.ButterworthFilter().FilterData(sngFiltered, 0, dataPointCount - 1);
+
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                Assert.AreEqual((float)expected[i], sngFiltered[i], "Point " + i);
+            }
+        }
+
+        [Test]
+        [TestCase(200000, 12, 4, 25, 101)]
+        [TestCase(70001, 15, 2, 61, 102)]
+        public void TestParallelTiles(
+            int dataPointCount,
+            int numPointsLeftRight,
+            short polynomialDegree,
+            int windowWidthPoints,
+            int randomSeed)
+        {
+            // Enough points and work for ProcessTiles to split the range; four threads tile even on one processor
+            var rand = new Random(randomSeed);
+            var dblData = new double[dataPointCount];
+            var sngData = new float[dataPointCount];
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                dblData[i] = 50 * rand.NextDouble() + (i % 700 < 25 ? 5000 * rand.NextDouble() : 0);
+                sngData[i] = (float)dblData[i];
+            }
+
+            var serialFilter = new DataFilter.DataFilter { MaxDegreeOfParallelism = 1 };
+            var parallelFilter = new DataFilter.DataFilter { MaxDegreeOfParallelism = 4 };
+
+            var serial = (double[])dblData.Clone();
+            var parallel = (double[])dblData.Clone();
+            Assert.IsTrue(serialFilter.SavitzkyGolayFilter(serial, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out var errorMessage), errorMessage);
+            Assert.IsTrue(parallelFilter.SavitzkyGolayFilter(parallel, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+            CollectionAssert.AreEqual(serial, parallel);
+
+            var sngSerial = (float[])sngData.Clone();
+            var sngParallel = (float[])sngData.Clone();
+            Assert.IsTrue(serialFilter.SavitzkyGolayFilter(sngSerial, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+            Assert.IsTrue(parallelFilter.SavitzkyGolayFilter(sngParallel, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+            CollectionAssert.AreEqual(sngSerial, sngParallel);
+
+            var plan = new DataFilter.SavitzkyGolayPlan(numPointsLeftRight, numPointsLeftRight, polynomialDegree);
+            serial = (double[])dblData.Clone();
+            parallel = (double[])dblData.Clone();
+            Assert.IsTrue(serialFilter.SavitzkyGolayFilter(serial, 0, dataPointCount - 1, plan, out errorMessage), errorMessage);
+            Assert.IsTrue(parallelFilter.SavitzkyGolayFilter(parallel, 0, dataPointCount - 1, plan, out errorMessage), errorMessage);
+            CollectionAssert.AreEqual(serial, parallel);
+
+            serial = (double[])dblData.Clone();
+            parallel = (double[])dblData.Clone();
+            Assert.IsTrue(serialFilter.MovingWindowAverage(serial, 0, dataPointCount - 1, windowWidthPoints, out errorMessage), errorMessage);
+            Assert.IsTrue(parallelFilter.MovingWindowAverage(parallel, 0, dataPointCount - 1, windowWidthPoints, out errorMessage), errorMessage);
+            CollectionAssert.AreEqual(serial, parallel);
+
+            sngSerial = (float[])sngData.Clone();
+            sngParallel = (float[])sngData.Clone();
+            Assert.IsTrue(serialFilter.MovingWindowAverage(sngSerial, 0, dataPointCount - 1, windowWidthPoints, out errorMessage), errorMessage);
+            Assert.IsTrue(parallelFilter.MovingWindowAverage(sngParallel, 0, dataPointCount - 1, windowWidthPoints, out errorMessage), errorMessage);
+            CollectionAssert.AreEqual(sngSerial, sngParallel);
+
+            var serialOutputs = new[] { new double[dataPointCount], new double[dataPointCount], new double[dataPointCount] };
+            var parallelOutputs = new[] { new double[dataPointCount], new double[dataPointCount], new double[dataPointCount] };
+            Assert.IsTrue(serialFilter.SavitzkyGolayDerivatives(
+                dblData, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree,
+                serialOutputs[0], serialOutputs[1], serialOutputs[2], out errorMessage), errorMessage);
+            Assert.IsTrue(parallelFilter.SavitzkyGolayDerivatives(
+                dblData, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree,
+                parallelOutputs[0], parallelOutputs[1], parallelOutputs[2], out errorMessage), errorMessage);
+
+            for (var k = 0; k < serialOutputs.Length; k++)
+            {
+                CollectionAssert.AreEqual(serialOutputs[k], parallelOutputs[k]);
+            }
+
+            // A failure inside a tile is reported with its own message, not the AggregateException that wraps it
+            Assert.IsFalse(serialFilter.MovingWindowAverage((double[])dblData.Clone(), 0, dataPointCount + 100, windowWidthPoints, out var serialError));
+            Assert.IsFalse(parallelFilter.MovingWindowAverage((double[])dblData.Clone(), 0, dataPointCount + 100, windowWidthPoints, out var parallelError));
+            Assert.AreEqual(serialError, parallelError);
+        }
+        [Test]
+        [TestCase(60000, 20, 2, 111)]
+        [TestCase(100000, 40, 4, 112)]
+        public void TestFFTConvolution(
+            int dataPointCount,
+            int numPointsLeftRight,
+            short polynomialDegree,
+            int randomSeed)
+        {
+            var rand = new Random(randomSeed);
+            var dblData = new double[dataPointCount];
+            var sngData = new float[dataPointCount];
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                dblData[i] = 50 * rand.NextDouble() + (i % 700 < 25 ? 5000 * rand.NextDouble() : 0);
+                sngData[i] = (float)dblData[i];
+            }
+
+            var directFilter = new DataFilter.DataFilter();
+            var fftFilter = new DataFilter.DataFilter { MaxDegreeOfParallelism = 1, UseFFTConvolution = true };
+            var parallelFFTFilter = new DataFilter.DataFilter { MaxDegreeOfParallelism = 4, UseFFTConvolution = true };
+
+            var direct = (double[])dblData.Clone();
+            var fft = (double[])dblData.Clone();
+            var parallelFFT = (double[])dblData.Clone();
+            Assert.IsTrue(directFilter.SavitzkyGolayFilter(direct, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out var errorMessage), errorMessage);
+            Assert.IsTrue(fftFilter.SavitzkyGolayFilter(fft, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+            Assert.IsTrue(parallelFFTFilter.SavitzkyGolayFilter(parallelFFT, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+
+            // The FFT differs from direct convolution by rounding only, and points without a full window are left unchanged
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                if (i < numPointsLeftRight || i >= dataPointCount - numPointsLeftRight)
+                    Assert.AreEqual(dblData[i], fft[i], "Point " + i);
+                else
+                    Assert.AreEqual(direct[i], fft[i], 1e-8);
+            }
+
+            // Blocks are laid out from the start of the range, so the tiles give exactly the serial result
+            CollectionAssert.AreEqual(fft, parallelFFT);
+
+            var sngFFT = (float[])sngData.Clone();
+            var sngParallelFFT = (float[])sngData.Clone();
+            Assert.IsTrue(fftFilter.SavitzkyGolayFilter(sngFFT, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+            Assert.IsTrue(parallelFFTFilter.SavitzkyGolayFilter(sngParallelFFT, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out errorMessage), errorMessage);
+            CollectionAssert.AreEqual(sngFFT, sngParallelFFT);
+
+            var plan = new DataFilter.SavitzkyGolayPlan(numPointsLeftRight, numPointsLeftRight, polynomialDegree);
+            fft = (double[])dblData.Clone();
+            parallelFFT = (double[])dblData.Clone();
+            Assert.IsTrue(fftFilter.SavitzkyGolayFilter(fft, 0, dataPointCount - 1, plan, out errorMessage), errorMessage);
+            Assert.IsTrue(parallelFFTFilter.SavitzkyGolayFilter(parallelFFT, 0, dataPointCount - 1, plan, out errorMessage), errorMessage);
+            CollectionAssert.AreEqual(fft, parallelFFT);
+
+            // A NaN would spread through a whole FFT block, so the range is convolved directly
+            dblData[dataPointCount / 2] = double.NaN;
+            direct = (double[])dblData.Clone();
+            fft = (double[])dblData.Clone();
+            directFilter.SavitzkyGolayFilter(direct, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out _);
+            fftFilter.SavitzkyGolayFilter(fft, 0, dataPointCount - 1, numPointsLeftRight, numPointsLeftRight, polynomialDegree, out _);
+            CollectionAssert.AreEqual(direct, fft);
+
+            for (var i = 0; i < dataPointCount; i++)
+            {
+                Assert.AreEqual(Math.Abs(i - dataPointCount / 2) <= numPointsLeftRight, double.IsNaN(fft[i]), "Point " + i);
+            }
+        }
+        [Test]
+        [TestCase(-1, 3, 2, 0, 1.0, false)]
+        [TestCase(3, 3, 7, 0, 1.0, false)]
+        [TestCase(3, 3, -1, 0, 1.0, false)]
+        [TestCase(3, 3, 2, -1, 1.0, false)]
+        [TestCase(3, 3, 2, 0, 0.0, false)]
+        [TestCase(3, 3, 2, 0, double.NaN, false)]
+        [TestCase(3, 3, 2, 0, double.PositiveInfinity, false)]
+        [TestCase(3, 3, 2, 0, double.NegativeInfinity, false)]
+        [TestCase(3, 3, 6, 0, 1.0, true)]
+        [TestCase(4, 2, 3, 1, 0.5, true)]
+        public void TestSavitzkyGolayPlanArguments(
+            int numPointsLeft,
+            int numPointsRight,
+            int polynomialDegree,
+            int derivativeOrder,
+            double pointSpacing,
+            bool valid)
+        {
+            var success = DataFilter.SavitzkyGolayPlan.TryCreate(
+                numPointsLeft, numPointsRight, polynomialDegree, derivativeOrder, pointSpacing, out var plan, out var errorMessage);
+
+            Assert.AreEqual(valid, success, errorMessage);
+
+            if (!valid)
+            {
+                // TryCreate reports what the constructor throws for
+                Assert.IsNull(plan);
+                Assert.IsNotEmpty(errorMessage);
+                Assert.Throws<ArgumentOutOfRangeException>(() =>
+                    new DataFilter.SavitzkyGolayPlan(numPointsLeft, numPointsRight, polynomialDegree, derivativeOrder, pointSpacing));
+                return;
+            }
+
+            var expected = new DataFilter.SavitzkyGolayPlan(numPointsLeft, numPointsRight, polynomialDegree, derivativeOrder, pointSpacing);
+            Assert.IsEmpty(errorMessage);
+            CollectionAssert.AreEqual(expected.Coefficients, plan.Coefficients);
+        }
+        [Test]
+        [TestCase(-0.5, 4)]
+        [TestCase(0.005, 4)]
+        [TestCase(0.01, 0)]
+        [TestCase(0.05, 4)]
+        [TestCase(0.5, 49)]
+        [TestCase(0.75, 74)]
+        [TestCase(0.93, 92)]
+        [TestCase(0.99, 98)]
+        [TestCase(1.0, 94)]
+        [TestCase(2.5, 94)]
+        public void TestButterworthPlans(double samplingFrequency, int coeffIndex)
+        {
+            // Frequencies below 0.01 fall back to the plan for 0.05, and above 0.99 to the plan for 0.95
+            var plan = DataFilter.ButterworthPlan.GetPlan(samplingFrequency);
+            Assert.AreEqual((coeffIndex + 1) / 100.0, plan.SamplingFrequency, 0);
+
+            var tableRow = mButterworthTableRows[coeffIndex];
+            CollectionAssert.AreEqual(tableRow[0], plan.A);
+            CollectionAssert.AreEqual(tableRow[1], plan.B);
+
+            // Filtering with the plan gives exactly the output of the original coefficient tables
+            var rand = new Random(coeffIndex);
+            var dblData = new double[3000];
+            for (var i = 0; i < dblData.Length; i++)
+            {
+                dblData[i] = 50 * rand.NextDouble() + (i % 300 < 15 ? 5000 * rand.NextDouble() : 0);
+            }
+
+            var expected = LegacyButterworth(dblData, tableRow[0], tableRow[1]);
+
+            var objFilter = new DataFilter.DataFilter();
+            Assert.IsTrue(objFilter.ButterworthFilter(dblData, 0, dblData.Length - 1, samplingFrequency));
+            CollectionAssert.AreEqual(expected, dblData);
+        }
+
+        /// <summary>
+        /// Rows of the Butterworth A and B tables as they were in DataFilter before ButterworthPlan, by coefficient index
+        /// </summary>
+        private static readonly Dictionary<int, double[][]> mButterworthTableRows = new Dictionary<int, double[][]>
+        {
+            { 0, new[] { new[] { 1, -4.8983, 9.5985, -9.4053, 4.6085, -0.90333 }, new[] { 0.00000000090929, 0.0000000045464, 0.0000000090929, 0.0000000090929, 0.0000000045464, 0.00000000090929 } } },
+            { 4, new[] { new[] { 1, -4.4918, 8.0941, -7.3121, 3.311, -0.60112 }, new[] { 0.000002341, 0.000011705, 0.00002341, 0.00002341, 0.000011705, 0.000002341 } } },
+            { 49, new[] { new[] { 1, -0.00000000000000046491, 0.63344, -0.00000000000000020438, 0.055728, -3.0935E-18 }, new[] { 0.052786, 0.26393, 0.52786, 0.52786, 0.26393, 0.052786 } } },
+            { 74, new[] { new[] { 1, 2.4744, 2.811, 1.7038, 0.54443, 0.072316 }, new[] { 0.26894, 1.3447, 2.6894, 2.6894, 1.3447, 0.26894 } } },
+            { 92, new[] { new[] { 1, 4.2888, 7.4015, 6.4207, 2.7983, 0.48996 }, new[] { 0.69997, 3.4999, 6.9997, 6.9997, 3.4999, 0.69997 } } },
+            { 94, new[] { new[] { 1, 4.4918, 8.0941, 7.3121, 3.311, 0.60112 }, new[] { 0.77532, 3.8766, 7.7532, 7.7532, 3.8766, 0.77532 } } },
+            { 98, new[] { new[] { 1, 4.8983, 9.5985, 9.4053, 4.6085, 0.90333 }, new[] { 0.95044, 4.7522, 9.5044, 9.5044, 4.7522, 0.95044 } } }
+        };
+        /// <summary>
+        /// Assert that each float result is within (window width + 1) * 6e-8 times the sum of |coefficient * value| over its window
+        /// </summary>
+        private static void AssertWithinFloatBound(double[] input, double[] expected, float[] actual, double[] coefficients, double scale, int numPointsLeft)
+        {
+            for (var i = 0; i < input.Length; i++)
+            {
+                var sum = 0.0;
+                for (var j = 0; j < coefficients.Length; j++)
+                {
+                    var k = i - numPointsLeft + j;
+                    if (k >= 0 && k < input.Length)
+                        sum += Math.Abs(coefficients[j] * scale * input[k]);
+                }
+
+                Assert.LessOrEqual(Math.Abs(actual[i] - expected[i]), (coefficients.Length + 1) * 6e-8 * sum, "Point " + i);
+            }
+        }
+
+        /// <summary>
+        /// The Butterworth filter as first ported: a forward pass, then a pass over the reversed output, all in double
+        /// </summary>
+        private static double[] LegacyButterworth(double[] data, double[] a, double[] b)
+        {
+            var input = (double[])data.Clone();
+
+            for (var pass = 0; pass < 2; pass++)
+            {
+                var output = new double[input.Length];
+                for (var i = 0; i < input.Length; i++)
+                {
+                    output[i] = b[0] * input[i];
+                    for (var j = 1; j < a.Length; j++)
+                    {
+                        if (i - j >= 0)
+                        {
+                            output[i] += b[j] * input[i - j];
+                            output[i] -= a[j] * output[i - j];
+                        }
+                    }
+                }
+
+                Array.Reverse(output);
+                input = output;
+            }
+
+            return input;
+        }
     }
-}
\ No newline at end of file
+}
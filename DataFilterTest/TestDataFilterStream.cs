@@ -0,0 +1,157 @@
+using System;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using DataFilterStream;
+using NUnit.Framework;
+
+namespace DataFilterTest
+{
+    /// <summary>
+    /// Tests of the DataFilterStream number parser and of filtering a file a chunk at a time
+    /// </summary>
+    public class TestDataFilterStream
+    {
+        [Test]
+        [TestCase("0")]
+        [TestCase("-0")]
+        [TestCase("-0.000")]
+        [TestCase("+7.5")]
+        [TestCase(" 42 ")]
+        [TestCase("123.456")]
+        [TestCase("0.000123")]
+        [TestCase("123456.789e3")]
+        [TestCase("4.35E-5")]
+        [TestCase("1e22")]
+        [TestCase("-1e22")]
+        [TestCase("1e-22")]
+        [TestCase("1e23")]
+        [TestCase("1e-23")]
+        [TestCase("9007199254740992")]
+        [TestCase("9007199254740993")]
+        [TestCase("0.1000000000000000055511151231257827")]
+        [TestCase("1.7976931348623157e308")]
+        [TestCase("4.9406564584124654e-324")]
+        [TestCase("NaN")]
+        [TestCase("-Infinity")]
+        public void TestParseNumber(string field)
+        {
+            var expected = double.Parse(field, NumberStyles.Float, CultureInfo.InvariantCulture);
+            Assert.AreEqual(BitConverter.DoubleToInt64Bits(expected), BitConverter.DoubleToInt64Bits(ParseNumber(field)), field);
+        }
+
+        [Test]
+        [TestCase(20000, 131)]
+        public void TestParseNumberRandom(int valueCount, int randomSeed)
+        {
+            // The formats an export is likely to use, which between them hit the fast path and the double.Parse fallback
+            var formats = new[] { "R", "G6", "G17", "F3", "F8", "E10" };
+            var rand = new Random(randomSeed);
+
+            for (var i = 0; i < valueCount; i++)
+            {
+                var value = (rand.NextDouble() - 0.25) * Math.Pow(10, rand.Next(-30, 30));
+                foreach (var format in formats)
+                {
+                    var field = value.ToString(format, CultureInfo.InvariantCulture);
+                    var expected = double.Parse(field, NumberStyles.Float, CultureInfo.InvariantCulture);
+                    Assert.AreEqual(BitConverter.DoubleToInt64Bits(expected), BitConverter.DoubleToInt64Bits(ParseNumber(field)), field);
+                }
+            }
+        }
+
+        [Test]
+        public void TestParseEmptyFields()
+        {
+            Assert.IsTrue(double.IsNaN(ParseNumber(string.Empty)));
+            Assert.IsTrue(double.IsNaN(ParseNumber("   ")));
+
+            var line = Encoding.ASCII.GetBytes("1.5,,  ,-2");
+            var values = new double[4];
+            Assert.AreEqual(4, ColumnTokenizer.ParseLine(line, 0, line.Length, (byte)',', values));
+            Assert.AreEqual(1.5, values[0]);
+            Assert.IsTrue(double.IsNaN(values[1]));
+            Assert.IsTrue(double.IsNaN(values[2]));
+            Assert.AreEqual(-2.0, values[3]);
+        }
+
+        [Test]
+        [TestCase("SG", 50000, 1000, 1, 141)]
+        [TestCase("SG", 30001, 777, 4, 142)]
+        [TestCase("MA", 50000, 1000, 1, 143)]
+        [TestCase("MA", 30001, 333, 4, 144)]
+        public void TestChunkedFile(string filterName, int rowCount, int chunkRows, int threads, int randomSeed)
+        {
+            // Column 1 is passed through and column 2, profile data with runs of zeros, is filtered
+            var rand = new Random(randomSeed);
+            var intensities = new double[rowCount];
+            var text = new StringBuilder();
+            for (var row = 0; row < rowCount; row++)
+            {
+                if (row % 5000 > 1000)
+                    intensities[row] = 1000 * Math.Exp(-Math.Pow((row % 500 - 250) / 20.0, 2)) + rand.NextDouble();
+
+                text.Append((row * 0.01).ToString("G17", CultureInfo.InvariantCulture)).Append('\t');
+                text.Append(intensities[row].ToString("G17", CultureInfo.InvariantCulture)).Append('\n');
+            }
+
+            var inputPath = Path.GetTempFileName();
+            var chunkedPath = Path.GetTempFileName();
+            var wholePath = Path.GetTempFileName();
+
+            try
+            {
+                File.WriteAllText(inputPath, text.ToString());
+
+                StreamFile(inputPath, chunkedPath, filterName, chunkRows, threads, rowCount);
+                StreamFile(inputPath, wholePath, filterName, rowCount, threads, rowCount);
+
+                // Each row sees the same window whether or not the file is split into chunks
+                CollectionAssert.AreEqual(File.ReadAllBytes(wholePath), File.ReadAllBytes(chunkedPath));
+
+                var expected = (double[])intensities.Clone();
+                var objFilter = new DataFilter.DataFilter();
+                if (filterName == "SG")
+                    objFilter.SavitzkyGolayFilter(expected, 0, rowCount - 1, new DataFilter.SavitzkyGolayPlan(6, 6, 4), out _);
+                else
+                    objFilter.MovingWindowAverage(expected, 0, rowCount - 1, 9, out _);
+
+                var lines = File.ReadAllLines(chunkedPath);
+                Assert.AreEqual(rowCount, lines.Length);
+                for (var row = 0; row < rowCount; row++)
+                {
+                    var fields = lines[row].Split('\t');
+                    Assert.AreEqual(row * 0.01, double.Parse(fields[0], CultureInfo.InvariantCulture), 0);
+                    Assert.AreEqual(expected[row], double.Parse(fields[1], CultureInfo.InvariantCulture), 1e-12 * (Math.Abs(expected[row]) + 1));
+                }
+            }
+            finally
+            {
+                File.Delete(inputPath);
+                File.Delete(chunkedPath);
+                File.Delete(wholePath);
+            }
+        }
+
+        private static double ParseNumber(string field)
+        {
+            var bytes = Encoding.ASCII.GetBytes(field);
+            return ColumnTokenizer.ParseNumber(bytes, 0, bytes.Length);
+        }
+
+        private static void StreamFile(string inputPath, string outputPath, string filterName, int chunkRows, int threads, int rowCount)
+        {
+            // ProcessFile is given the paths; the file name here only satisfies TryParse
+            var args = new[]
+            {
+                "input.txt", "/Filter:" + filterName, "/Left:6", "/Right:6", "/Degree:4", "/Width:9", "/Columns:2", "/ChunkRows:" + chunkRows
+            };
+
+            Assert.IsTrue(StreamingOptions.TryParse(args, out var options, out var errorMessage), errorMessage);
+
+            var streamingFilter = new StreamingFilter(options);
+            Assert.IsTrue(streamingFilter.ProcessFile(inputPath, outputPath, threads, out var rowsWritten, out errorMessage), errorMessage);
+            Assert.AreEqual(rowCount, rowsWritten);
+        }
+    }
+}
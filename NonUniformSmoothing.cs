@@ -0,0 +1,403 @@
+using System;
+
+namespace DataFilter
+{
+    /// <summary>
+    /// Smoothing of data whose x values are not evenly spaced, such as m/z from FT or TOF spectra
+    /// </summary>
+    /// <remarks>
+    /// Savitzky Golay fits a least squares polynomial to the actual x values of each window.
+    /// The sums of u^k and u^k * y over the window are updated as it slides, adding the point that
+    /// enters and subtracting the one that leaves, so a point costs O(degree) updates plus a solve of
+    /// degree + 1 normal equations instead of O(window width * degree). u is x relative to the middle
+    /// of a recent window, divided by half that window's x span; the sums are rebuilt about a new
+    /// middle each time the window starts on a multiple of half its width from indexStart, which keeps
+    /// u small and stops the rounding error of the updates from building up. They are also rebuilt when
+    /// a NaN or infinite point leaves the window, since subtracting it cannot take it back out of the sums.
+    ///
+    /// Both filters rebuild their sums at points that depend only on the data and indexStart, and a call
+    /// for first through last starts from the last rebuild before first, so splitting a range into tiles
+    /// gives exactly the result of one call for the whole range.
+    /// </remarks>
+    internal static class NonUniformSmoothing
+    {
+        /// <summary>
+        /// Pivots smaller than this fraction of their starting value mean the x values
+        /// of the window cannot determine a polynomial of the requested degree
+        /// </summary>
+        private const double SINGULAR_PIVOT_RATIO = 1e-10;
+
+        /// <summary>
+        /// Savitzky Golay smoothing of points first through last, each fit to the window of
+        /// numPointsLeft + numPointsRight + 1 points around it
+        /// </summary>
+        /// <param name="x">Must be ascending from indexStart through indexEnd</param>
+        /// <param name="y"></param>
+        /// <param name="output"></param>
+        /// <param name="indexStart">Start of the range the windows may read</param>
+        /// <param name="indexEnd">End of the range the windows may read; must leave room for one full window</param>
+        /// <param name="numPointsLeft"></param>
+        /// <param name="numPointsRight"></param>
+        /// <param name="polynomialDegree"></param>
+        /// <param name="first"></param>
+        /// <param name="last"></param>
+        /// <remarks>
+        /// Points near indexStart or indexEnd use the first or last full window of the range, as SavitzkyGolayPlan does.
+        /// If the x values of a window cannot support polynomialDegree, the highest degree they can support is used
+        /// </remarks>
+        public static void SavitzkyGolay(
+            double[] x,
+            double[] y,
+            double[] output,
+            int indexStart,
+            int indexEnd,
+            int numPointsLeft,
+            int numPointsRight,
+            int polynomialDegree,
+            int first,
+            int last)
+        {
+            var width = numPointsLeft + numPointsRight + 1;
+            var lastWindowStart = indexEnd - width + 1;
+            var rebuildInterval = Math.Max(width / 2, 1);
+
+            var powerSums = new double[2 * polynomialDegree + 1];
+            var weightedSums = new double[polynomialDegree + 1];
+            var matrix = new double[(polynomialDegree + 1) * (polynomialDegree + 1)];
+            var solution = new double[polynomialDegree + 1];
+
+            var windowStart = -1;
+            var origin = 0.0;
+            var inverseScale = 1.0;
+
+            // Last point in the sums that is NaN or infinite
+            var lastNonFinite = -1;
+
+            for (var i = first; i <= last; i++)
+            {
+                var target = Math.Min(Math.Max(i - numPointsLeft, indexStart), lastWindowStart);
+
+                if (windowStart < 0)
+                {
+                    // Start from the last rebuild at or before target, then slide to target as a call from indexStart would
+                    windowStart = target - (target - indexStart) % rebuildInterval;
+                    lastNonFinite = RebuildSums(x, y, windowStart, width, powerSums, weightedSums, out origin, out inverseScale);
+                }
+
+                while (windowStart < target)
+                {
+                    if ((windowStart + 1 - indexStart) % rebuildInterval == 0 || lastNonFinite == windowStart)
+                    {
+                        windowStart++;
+                        lastNonFinite = RebuildSums(x, y, windowStart, width, powerSums, weightedSums, out origin, out inverseScale);
+                        continue;
+                    }
+
+                    if (IsNonFinite(y[windowStart + width]))
+                        lastNonFinite = windowStart + width;
+
+                    SlidePoint(
+                        powerSums, weightedSums,
+                        (x[windowStart] - origin) * inverseScale, y[windowStart],
+                        (x[windowStart + width] - origin) * inverseScale, y[windowStart + width]);
+                    windowStart++;
+                }
+
+                output[i] = EvaluateFit(powerSums, weightedSums, matrix, solution, polynomialDegree, (x[i] - origin) * inverseScale);
+            }
+        }
+
+        /// <summary>
+        /// Sum the width points from windowStart into powerSums and weightedSums, about the middle of the window
+        /// </summary>
+        /// <returns>The last point of the window that is NaN or infinite, or -1 if none</returns>
+        private static int RebuildSums(
+            double[] x,
+            double[] y,
+            int windowStart,
+            int width,
+            double[] powerSums,
+            double[] weightedSums,
+            out double origin,
+            out double inverseScale)
+        {
+            var windowEnd = windowStart + width - 1;
+            origin = (x[windowStart] + x[windowEnd]) / 2;
+            var halfSpan = (x[windowEnd] - x[windowStart]) / 2;
+            inverseScale = halfSpan > 0 ? 1 / halfSpan : 1;
+
+            Array.Clear(powerSums, 0, powerSums.Length);
+            Array.Clear(weightedSums, 0, weightedSums.Length);
+
+            var lastNonFinite = -1;
+            for (var j = windowStart; j <= windowEnd; j++)
+            {
+                AddPoint(powerSums, weightedSums, (x[j] - origin) * inverseScale, y[j]);
+                if (IsNonFinite(y[j]))
+                    lastNonFinite = j;
+            }
+
+            return lastNonFinite;
+        }
+
+        /// <summary>
+        /// Average of the points within halfWidth of each point's x value, for points first through last
+        /// </summary>
+        /// <param name="x">Must be ascending from indexStart through indexEnd</param>
+        /// <param name="y"></param>
+        /// <param name="output"></param>
+        /// <param name="indexStart">Points before indexStart are not averaged in</param>
+        /// <param name="indexEnd">Points after indexEnd are not averaged in</param>
+        /// <param name="halfWidth"></param>
+        /// <param name="first"></param>
+        /// <param name="last"></param>
+        /// <remarks>
+        /// The window sum is carried from point to point, so each point costs the points entering and leaving it.
+        /// It is summed afresh when the start of the window passes a multiple, counted from indexStart, of its
+        /// point count rounded up to a power of 2, so that the rounding error of a large point lasts no more than
+        /// about two windows; and when a NaN or infinite point leaves, since it cannot be subtracted back out
+        /// </remarks>
+        public static void MovingAverage(
+            double[] x,
+            double[] y,
+            double[] output,
+            int indexStart,
+            int indexEnd,
+            double halfWidth,
+            int first,
+            int last)
+        {
+            int low = first, high = first;
+            MoveWindow(x, indexStart, indexEnd, halfWidth, first, ref low, ref high);
+
+            // Walk back to the last point at or before first where a call from indexStart would rebuild the sum
+            var start = first;
+            while (start > indexStart)
+            {
+                int previousLow = low, previousHigh = high;
+                MoveWindow(x, indexStart, indexEnd, halfWidth, start - 1, ref previousLow, ref previousHigh);
+
+                if (IsRebuildPoint(y, indexStart, previousLow, low, high))
+                    break;
+
+                start--;
+                low = previousLow;
+                high = previousHigh;
+            }
+
+            var total = 0.0;
+            for (var j = low; j <= high; j++)
+            {
+                total += y[j];
+            }
+
+            for (var i = start; i <= last; i++)
+            {
+                if (i > start)
+                {
+                    while (high < indexEnd && x[high + 1] <= x[i] + halfWidth)
+                    {
+                        high++;
+                        total += y[high];
+                    }
+
+                    var previousLow = low;
+                    while (x[low] < x[i] - halfWidth)
+                    {
+                        total -= y[low];
+                        low++;
+                    }
+
+                    if (IsRebuildPoint(y, indexStart, previousLow, low, high))
+                    {
+                        total = 0;
+                        for (var j = low; j <= high; j++)
+                        {
+                            total += y[j];
+                        }
+                    }
+                }
+
+                if (i >= first)
+                    output[i] = total / (high - low + 1);
+            }
+        }
+
+        /// <summary>
+        /// Move low and high to the first and last point within halfWidth of x[i]
+        /// </summary>
+        private static void MoveWindow(double[] x, int indexStart, int indexEnd, double halfWidth, int i, ref int low, ref int high)
+        {
+            while (low > indexStart && x[low - 1] >= x[i] - halfWidth)
+            {
+                low--;
+            }
+
+            while (x[low] < x[i] - halfWidth)
+            {
+                low++;
+            }
+
+            while (high < indexEnd && x[high + 1] <= x[i] + halfWidth)
+            {
+                high++;
+            }
+
+            while (x[high] > x[i] + halfWidth)
+            {
+                high--;
+            }
+        }
+
+        /// <summary>
+        /// True if the moving average sum is rebuilt when the window moves from starting at previousLow to low through high
+        /// </summary>
+        private static bool IsRebuildPoint(double[] y, int indexStart, int previousLow, int low, int high)
+        {
+            for (var j = previousLow; j < low; j++)
+            {
+                if (IsNonFinite(y[j]))
+                    return true;
+            }
+
+            var blockSize = 1;
+            while (blockSize < high - low + 1)
+            {
+                blockSize <<= 1;
+            }
+
+            return (low - indexStart) / blockSize != (previousLow - indexStart) / blockSize;
+        }
+
+        private static bool IsNonFinite(double value)
+        {
+            return double.IsNaN(value) || double.IsInfinity(value);
+        }
+
+        private static void AddPoint(double[] powerSums, double[] weightedSums, double u, double y)
+        {
+            var power = 1.0;
+            for (var k = 0; k < weightedSums.Length; k++)
+            {
+                powerSums[k] += power;
+                weightedSums[k] += power * y;
+                power *= u;
+            }
+
+            for (var k = weightedSums.Length; k < powerSums.Length; k++)
+            {
+                powerSums[k] += power;
+                power *= u;
+            }
+        }
+
+        /// <summary>
+        /// Remove the point at uOut and add the one at uIn
+        /// </summary>
+        private static void SlidePoint(double[] powerSums, double[] weightedSums, double uOut, double yOut, double uIn, double yIn)
+        {
+            double powerOut = 1, powerIn = 1;
+            for (var k = 0; k < weightedSums.Length; k++)
+            {
+                powerSums[k] += powerIn - powerOut;
+                weightedSums[k] += powerIn * yIn - powerOut * yOut;
+                powerOut *= uOut;
+                powerIn *= uIn;
+            }
+
+            for (var k = weightedSums.Length; k < powerSums.Length; k++)
+            {
+                powerSums[k] += powerIn - powerOut;
+                powerOut *= uOut;
+                powerIn *= uIn;
+            }
+        }
+
+        /// <summary>
+        /// Solve the normal equations of the fit and evaluate it at u, lowering the degree until they can be solved
+        /// </summary>
+        private static double EvaluateFit(double[] powerSums, double[] weightedSums, double[] matrix, double[] solution, int polynomialDegree, double u)
+        {
+            for (var degree = polynomialDegree; degree > 0; degree--)
+            {
+                if (!SolveNormalEquations(powerSums, weightedSums, matrix, solution, degree))
+                    continue;
+
+                var value = solution[degree];
+                for (var k = degree - 1; k >= 0; k--)
+                {
+                    value = value * u + solution[k];
+                }
+
+                return value;
+            }
+
+            return weightedSums[0] / powerSums[0];
+        }
+
+        /// <summary>
+        /// Solve Σ powerSums[j + k] * a[k] = weightedSums[j], for j, k = 0 through degree, into solution
+        /// </summary>
+        /// <returns>False if the equations are singular</returns>
+        /// <remarks>
+        /// The matrix is a Gram matrix, so it is symmetric positive definite unless the window has fewer than
+        /// degree + 1 distinct x values; an LDL' factorization needs no pivoting and finds that case as a tiny D
+        /// </remarks>
+        private static bool SolveNormalEquations(double[] powerSums, double[] weightedSums, double[] matrix, double[] solution, int degree)
+        {
+            var n = degree + 1;
+
+            // matrix[row * n + col] holds L below the diagonal and D on it
+            for (var col = 0; col < n; col++)
+            {
+                var d = powerSums[2 * col];
+                for (var k = 0; k < col; k++)
+                {
+                    var l = matrix[col * n + k];
+                    d -= l * l * matrix[k * n + k];
+                }
+
+                if (d <= SINGULAR_PIVOT_RATIO * powerSums[2 * col])
+                    return false;
+
+                matrix[col * n + col] = d;
+                var inverseD = 1 / d;
+
+                for (var row = col + 1; row < n; row++)
+                {
+                    var sum = powerSums[row + col];
+                    for (var k = 0; k < col; k++)
+                    {
+                        sum -= matrix[row * n + k] * matrix[col * n + k] * matrix[k * n + k];
+                    }
+
+                    matrix[row * n + col] = sum * inverseD;
+                }
+            }
+
+            for (var row = 0; row < n; row++)
+            {
+                var sum = weightedSums[row];
+                for (var k = 0; k < row; k++)
+                {
+                    sum -= matrix[row * n + k] * solution[k];
+                }
+
+                solution[row] = sum;
+            }
+
+            for (var row = n - 1; row >= 0; row--)
+            {
+                var sum = solution[row] / matrix[row * n + row];
+                for (var k = row + 1; k < n; k++)
+                {
+                    sum -= matrix[k * n + row] * solution[k];
+                }
+
+                solution[row] = sum;
+            }
+
+            return true;
+        }
+    }
+}
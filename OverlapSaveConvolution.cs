@@ -0,0 +1,287 @@
+using System;
+using System.Collections.Generic;
+
+namespace DataFilter
+{
+    /// <summary>
+    /// Overlap-save FFT convolution of real data with a fixed set of real coefficients
+    /// </summary>
+    /// <remarks>
+    /// Two blocks of the input are transformed at once, one in the real part and one in the
+    /// imaginary part; since the coefficients are real the two results stay separate
+    /// </remarks>
+    internal class OverlapSaveConvolution
+    {
+        /// <summary>
+        /// Cost of one FFT butterfly relative to one multiply-add of direct convolution
+        /// </summary>
+        /// <remarks>Measured with SavitzkyGolayFilter on 100,000 points, for FFT lengths of 128 to 4096</remarks>
+        private const double FFT_COST_PER_BUTTERFLY = 1.0;
+
+        /// <summary>
+        /// Narrower kernels always use direct convolution, which keeps the common settings
+        /// on exactly the same arithmetic as before
+        /// </summary>
+        private const int MIN_KERNEL_LENGTH = 32;
+
+        /// <summary>
+        /// Number of points in each FFT
+        /// </summary>
+        public int FFTLength { get; }
+
+        /// <summary>
+        /// Number of coefficients
+        /// </summary>
+        public int KernelLength { get; }
+
+        /// <summary>
+        /// Output points produced by each block
+        /// </summary>
+        public int BlockLength => FFTLength - KernelLength + 1;
+
+        /// <summary>
+        /// Output points produced by each pair of blocks, which share one transform
+        /// </summary>
+        public int PairLength => 2 * BlockLength;
+
+        private readonly double[] mKernelRe;
+        private readonly double[] mKernelIm;
+        private readonly double[] mCos;
+        private readonly double[] mSin;
+        private readonly int[] mBitReverse;
+
+        /// <summary>
+        /// Constructor
+        /// </summary>
+        /// <param name="coefficients"></param>
+        /// <param name="scale">Every output is multiplied by this value</param>
+        public OverlapSaveConvolution(IReadOnlyList<double> coefficients, double scale = 1.0)
+        {
+            KernelLength = coefficients.Count;
+            FFTLength = GetFFTLength(KernelLength);
+
+            var n = FFTLength;
+            mCos = new double[n / 2];
+            mSin = new double[n / 2];
+            for (var i = 0; i < n / 2; i++)
+            {
+                mCos[i] = Math.Cos(2 * Math.PI * i / n);
+                mSin[i] = -Math.Sin(2 * Math.PI * i / n);
+            }
+
+            mBitReverse = new int[n];
+            var bits = 0;
+            while (1 << bits < n)
+                bits++;
+
+            for (var i = 0; i < n; i++)
+            {
+                var reversed = 0;
+                for (var b = 0; b < bits; b++)
+                {
+                    if ((i & (1 << b)) != 0)
+                        reversed |= 1 << (bits - 1 - b);
+                }
+
+                mBitReverse[i] = reversed;
+            }
+
+            // The kernel is the coefficients reversed, so the convolution lines up with a
+            // window read left to right; 1/n for the inverse transform is folded in here
+            mKernelRe = new double[n];
+            mKernelIm = new double[n];
+            for (var k = 0; k < KernelLength; k++)
+            {
+                mKernelRe[k] = coefficients[KernelLength - 1 - k] * scale / n;
+            }
+
+            Transform(mKernelRe, mKernelIm, false);
+        }
+
+        /// <summary>
+        /// FFT length for a kernel: a power of 2 about 8 times longer, so most of each block is output
+        /// </summary>
+        private static int GetFFTLength(int kernelLength)
+        {
+            var n = 64;
+            while (n < 8 * kernelLength)
+                n <<= 1;
+
+            return n;
+        }
+
+        /// <summary>
+        /// True if the FFT path is expected to beat direct convolution
+        /// </summary>
+        /// <param name="pointCount">Number of output points</param>
+        /// <param name="kernelLength">Number of coefficients</param>
+        public static bool IsFasterThanDirect(int pointCount, int kernelLength)
+        {
+            var n = GetFFTLength(kernelLength);
+            if (kernelLength < MIN_KERNEL_LENGTH || pointCount < n)
+                return false;
+
+            var log2N = Math.Log(n, 2);
+
+            // A forward and an inverse FFT of n points per two blocks, plus the n-point spectrum multiply
+            var fftCostPerPoint = (FFT_COST_PER_BUTTERFLY * n * log2N + 2.0 * n) / (2.0 * (n - kernelLength + 1));
+
+            return fftCostPerPoint < kernelLength;
+        }
+
+        /// <summary>
+        /// output[i] = Σ coefficients[j] * data[i - windowOffset + j] * scale, for i = tileStart through tileEnd
+        /// </summary>
+        /// <param name="data">Must hold every point the windows of first through last read</param>
+        /// <param name="first">First output point of the whole range</param>
+        /// <param name="last">Last output point of the whole range</param>
+        /// <param name="windowOffset">Points from the first point of a window to its output point</param>
+        /// <param name="output"></param>
+        /// <param name="tileStart">First point to write, between first and last</param>
+        /// <param name="tileEnd">Last point to write, between tileStart and last</param>
+        /// <remarks>
+        /// Blocks are laid out from first whatever the tile, so each point comes out of the same
+        /// transform, and has the same rounding, however the range is split into tiles
+        /// </remarks>
+        public void Correlate(double[] data, int first, int last, int windowOffset, double[] output, int tileStart, int tileEnd)
+        {
+            var n = FFTLength;
+            var re = new double[n];
+            var im = new double[n];
+            var blockLength = BlockLength;
+            var lastInput = last - windowOffset + KernelLength - 1;
+
+            // Each pair of blocks reads n points starting at pairStart and pairStart + blockLength;
+            // the first KernelLength - 1 points of each result wrap around and are discarded
+            var pairStart = first + (tileStart - first) / (2 * blockLength) * (2 * blockLength);
+            for (; pairStart <= tileEnd; pairStart += 2 * blockLength)
+            {
+                var blockStart = pairStart - windowOffset;
+                for (var k = 0; k < n; k++)
+                {
+                    var p = blockStart + k;
+                    re[k] = p <= lastInput ? data[p] : 0;
+                    p += blockLength;
+                    im[k] = p <= lastInput ? data[p] : 0;
+                }
+
+                Filter(re, im);
+
+                var blockEnd = Math.Min(pairStart + blockLength - 1, tileEnd);
+                for (var i = Math.Max(pairStart, tileStart); i <= blockEnd; i++)
+                {
+                    output[i] = re[KernelLength - 1 + i - pairStart];
+                }
+
+                blockEnd = Math.Min(pairStart + 2 * blockLength - 1, tileEnd);
+                for (var i = Math.Max(pairStart + blockLength, tileStart); i <= blockEnd; i++)
+                {
+                    output[i] = im[KernelLength - 1 + i - pairStart - blockLength];
+                }
+            }
+        }
+
+        /// <summary>
+        /// Float version of Correlate; the transforms are done in double
+        /// </summary>
+        public void Correlate(float[] data, int first, int last, int windowOffset, float[] output, int tileStart, int tileEnd)
+        {
+            var n = FFTLength;
+            var re = new double[n];
+            var im = new double[n];
+            var blockLength = BlockLength;
+            var lastInput = last - windowOffset + KernelLength - 1;
+
+            var pairStart = first + (tileStart - first) / (2 * blockLength) * (2 * blockLength);
+            for (; pairStart <= tileEnd; pairStart += 2 * blockLength)
+            {
+                var blockStart = pairStart - windowOffset;
+                for (var k = 0; k < n; k++)
+                {
+                    var p = blockStart + k;
+                    re[k] = p <= lastInput ? data[p] : 0;
+                    p += blockLength;
+                    im[k] = p <= lastInput ? data[p] : 0;
+                }
+
+                Filter(re, im);
+
+                var blockEnd = Math.Min(pairStart + blockLength - 1, tileEnd);
+                for (var i = Math.Max(pairStart, tileStart); i <= blockEnd; i++)
+                {
+                    output[i] = (float)re[KernelLength - 1 + i - pairStart];
+                }
+
+                blockEnd = Math.Min(pairStart + 2 * blockLength - 1, tileEnd);
+                for (var i = Math.Max(pairStart + blockLength, tileStart); i <= blockEnd; i++)
+                {
+                    output[i] = (float)im[KernelLength - 1 + i - pairStart - blockLength];
+                }
+            }
+        }
+
+        /// <summary>
+        /// Circular convolution of re + i*im with the kernel, in place
+        /// </summary>
+        private void Filter(double[] re, double[] im)
+        {
+            Transform(re, im, false);
+
+            for (var k = 0; k < FFTLength; k++)
+            {
+                var r = re[k] * mKernelRe[k] - im[k] * mKernelIm[k];
+                im[k] = re[k] * mKernelIm[k] + im[k] * mKernelRe[k];
+                re[k] = r;
+            }
+
+            Transform(re, im, true);
+        }
+
+        /// <summary>
+        /// Radix 2 FFT in place; the inverse is not scaled
+        /// </summary>
+        private void Transform(double[] re, double[] im, bool inverse)
+        {
+            var n = FFTLength;
+
+            for (var i = 0; i < n; i++)
+            {
+                var j = mBitReverse[i];
+                if (j <= i)
+                    continue;
+
+                var t = re[i];
+                re[i] = re[j];
+                re[j] = t;
+
+                t = im[i];
+                im[i] = im[j];
+                im[j] = t;
+            }
+
+            var sign = inverse ? -1.0 : 1.0;
+
+            for (var size = 2; size <= n; size <<= 1)
+            {
+                var half = size / 2;
+                var step = n / size;
+                for (var start = 0; start < n; start += size)
+                {
+                    for (var k = 0; k < half; k++)
+                    {
+                        var wr = mCos[k * step];
+                        var wi = sign * mSin[k * step];
+                        var a = start + k;
+                        var b = a + half;
+                        var tr = re[b] * wr - im[b] * wi;
+                        var ti = re[b] * wi + im[b] * wr;
+                        re[b] = re[a] - tr;
+                        im[b] = im[a] - ti;
+                        re[a] += tr;
+                        im[a] += ti;
+                    }
+                }
+            }
+        }
+    }
+}
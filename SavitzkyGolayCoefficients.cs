@@ -0,0 +1,268 @@
+using System;
+
+namespace DataFilter
+{
+    /// <summary>
+    /// Savitzky-Golay coefficients from Gram polynomials
+    /// </summary>
+    /// <remarks>
+    /// The least squares fit of a polynomial of degree m to N evenly spaced points is a sum over the
+    /// Gram polynomials P_0 to P_m, which are orthogonal on those points, so no normal equations need
+    /// to be solved. Each coefficient set costs O(N * m), and the polynomial values at the window
+    /// points are shared by every set of the same window, including the asymmetric sets for the
+    /// edges and any derivative order.
+    ///
+    /// P. A. Gorry, "General least-squares smoothing and differentiation by the convolution
+    /// (Savitzky-Golay) method", Anal. Chem. 62 (1990) 570-573
+    /// </remarks>
+    public static class SavitzkyGolayCoefficients
+    {
+        /// <summary>
+        /// Coefficients for a window of numPointsLeft points, the point itself, and numPointsRight points,
+        /// ordered from the leftmost point of the window to the rightmost
+        /// </summary>
+        /// <param name="numPointsLeft"></param>
+        /// <param name="numPointsRight"></param>
+        /// <param name="polynomialDegree">Must be less than the number of points in the window</param>
+        /// <param name="derivativeOrder">0 to smooth, 1 for the first derivative, etc.</param>
+        /// <param name="pointSpacing">Distance between points; derivatives are divided by pointSpacing^derivativeOrder</param>
+        /// <returns></returns>
+        /// <remarks>Matches NRSavGol.savgol, scaled by derivativeOrder! / pointSpacing^derivativeOrder and unwrapped</remarks>
+        public static double[] GetCoefficients(
+            int numPointsLeft,
+            int numPointsRight,
+            int polynomialDegree,
+            int derivativeOrder = 0,
+            double pointSpacing = 1.0)
+        {
+            if (numPointsLeft < 0 || numPointsRight < 0)
+                throw new ArgumentOutOfRangeException(nameof(numPointsLeft), "numPointsLeft and numPointsRight should be >= 0");
+
+            var numPoints = numPointsLeft + numPointsRight + 1;
+            ValidateArguments(numPoints, polynomialDegree, derivativeOrder, pointSpacing);
+
+            var polynomials = GetGramPolynomials(numPoints, polynomialDegree);
+            var factors = GetNormalizationFactors(numPoints, polynomialDegree);
+
+            return GetCoefficientSet(polynomials, factors, numPointsLeft, derivativeOrder, pointSpacing);
+        }
+
+        /// <summary>
+        /// Coefficients for every point of a window of windowWidth points: set p evaluates the fit
+        /// at point p of the window, so it has p points on its left and windowWidth - 1 - p on its right
+        /// </summary>
+        /// <param name="windowWidth"></param>
+        /// <param name="polynomialDegree">Must be less than windowWidth</param>
+        /// <param name="derivativeOrder">0 to smooth, 1 for the first derivative, etc.</param>
+        /// <param name="pointSpacing">Distance between points; derivatives are divided by pointSpacing^derivativeOrder</param>
+        /// <returns>windowWidth sets, each ordered from the leftmost point of the window to the rightmost</returns>
+        /// <remarks>Covers the points near the ends of the data, where a centered window does not fit</remarks>
+        public static double[][] GetCoefficientsForEveryPosition(
+            int windowWidth,
+            int polynomialDegree,
+            int derivativeOrder = 0,
+            double pointSpacing = 1.0)
+        {
+            ValidateArguments(windowWidth, polynomialDegree, derivativeOrder, pointSpacing);
+
+            var polynomials = GetGramPolynomials(windowWidth, polynomialDegree);
+            var factors = GetNormalizationFactors(windowWidth, polynomialDegree);
+
+            var sets = new double[windowWidth][];
+            for (var position = 0; position < windowWidth; position++)
+            {
+                sets[position] = GetCoefficientSet(polynomials, factors, position, derivativeOrder, pointSpacing);
+            }
+
+            return sets;
+        }
+
+        private static void ValidateArguments(int numPoints, int polynomialDegree, int derivativeOrder, double pointSpacing)
+        {
+            if (!CheckArguments(numPoints, polynomialDegree, derivativeOrder, pointSpacing, out var paramName, out var errorMessage))
+                throw new ArgumentOutOfRangeException(paramName, errorMessage);
+        }
+
+        /// <summary>
+        /// Check the arguments for a window of numPoints points
+        /// </summary>
+        /// <param name="numPoints"></param>
+        /// <param name="polynomialDegree"></param>
+        /// <param name="derivativeOrder"></param>
+        /// <param name="pointSpacing"></param>
+        /// <param name="paramName">The invalid argument</param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if valid, False if not</returns>
+        internal static bool CheckArguments(int numPoints, int polynomialDegree, int derivativeOrder, double pointSpacing, out string paramName, out string errorMessage)
+        {
+            paramName = null;
+            errorMessage = string.Empty;
+
+            if (numPoints < 1)
+            {
+                paramName = nameof(numPoints);
+                errorMessage = "The window must have at least 1 point";
+            }
+            else if (polynomialDegree < 0 || polynomialDegree >= numPoints)
+            {
+                paramName = nameof(polynomialDegree);
+                errorMessage = "polynomialDegree should be >= 0 and less than the number of points in the window";
+            }
+            else if (derivativeOrder < 0)
+            {
+                paramName = nameof(derivativeOrder);
+                errorMessage = "derivativeOrder should be >= 0";
+            }
+            else if (!(pointSpacing > 0) || double.IsInfinity(pointSpacing))
+            {
+                paramName = nameof(pointSpacing);
+                errorMessage = "pointSpacing should be a finite number > 0";
+            }
+
+            return paramName == null;
+        }
+
+        /// <summary>
+        /// Coefficients that evaluate the given derivative of the fit at point position of the window
+        /// </summary>
+        private static double[] GetCoefficientSet(double[][] polynomials, double[] factors, int position, int derivativeOrder, double pointSpacing)
+        {
+            var numPoints = polynomials[0].Length;
+            var polynomialDegree = polynomials.Length - 1;
+            var center = (numPoints - 1) / 2.0;
+
+            var derivatives = GetGramDerivatives(numPoints, polynomialDegree, derivativeOrder, position - center);
+
+            var weights = new double[polynomialDegree + 1];
+            for (var k = 0; k <= polynomialDegree; k++)
+            {
+                weights[k] = factors[k] * derivatives[k] / Math.Pow(pointSpacing, derivativeOrder);
+            }
+
+            var coefficients = new double[numPoints];
+            for (var k = 0; k <= polynomialDegree; k++)
+            {
+                var weight = weights[k];
+                if (weight == 0)
+                    continue;
+
+                var p = polynomials[k];
+                for (var i = 0; i < numPoints; i++)
+                {
+                    coefficients[i] += weight * p[i];
+                }
+            }
+
+            return coefficients;
+        }
+
+        /// <summary>
+        /// P_k(x) for k = 0 through polynomialDegree, at x = i - (numPoints - 1) / 2 for each point i of the window
+        /// </summary>
+        /// <remarks>
+        /// P_k(x) = 2(2k-1) / (k(n-k)) * x * P_k-1(x) - (k-1)(n+k-1) / (k(n-k)) * P_k-2(x), where n = numPoints,
+        /// P_0(x) = 1 and P_-1(x) = 0
+        /// </remarks>
+        private static double[][] GetGramPolynomials(int numPoints, int polynomialDegree)
+        {
+            var center = (numPoints - 1) / 2.0;
+            var polynomials = new double[polynomialDegree + 1][];
+
+            polynomials[0] = new double[numPoints];
+            for (var i = 0; i < numPoints; i++)
+            {
+                polynomials[0][i] = 1;
+            }
+
+            for (var k = 1; k <= polynomialDegree; k++)
+            {
+                GetRecurrenceFactors(numPoints, k, out var alpha, out var beta);
+
+                var previous = polynomials[k - 1];
+                var beforePrevious = k >= 2 ? polynomials[k - 2] : null;
+                var current = new double[numPoints];
+
+                for (var i = 0; i < numPoints; i++)
+                {
+                    current[i] = alpha * (i - center) * previous[i];
+                    if (beforePrevious != null)
+                        current[i] -= beta * beforePrevious[i];
+                }
+
+                polynomials[k] = current;
+            }
+
+            return polynomials;
+        }
+
+        /// <summary>
+        /// The derivativeOrder'th derivative of P_k at x, for k = 0 through polynomialDegree
+        /// </summary>
+        /// <remarks>
+        /// Differentiating the recurrence s times gives
+        /// P_k^(s)(x) = alpha * (x * P_k-1^(s)(x) + s * P_k-1^(s-1)(x)) - beta * P_k-2^(s)(x)
+        /// </remarks>
+        private static double[] GetGramDerivatives(int numPoints, int polynomialDegree, int derivativeOrder, double x)
+        {
+            // values[s][k] is the s'th derivative of P_k at x
+            var values = new double[derivativeOrder + 1][];
+
+            for (var s = 0; s <= derivativeOrder; s++)
+            {
+                var current = new double[polynomialDegree + 1];
+                current[0] = s == 0 ? 1 : 0;
+
+                for (var k = 1; k <= polynomialDegree; k++)
+                {
+                    GetRecurrenceFactors(numPoints, k, out var alpha, out var beta);
+
+                    var value = x * current[k - 1];
+                    if (s > 0)
+                        value += s * values[s - 1][k - 1];
+
+                    value *= alpha;
+                    if (k >= 2)
+                        value -= beta * current[k - 2];
+
+                    current[k] = value;
+                }
+
+                values[s] = current;
+            }
+
+            return values[derivativeOrder];
+        }
+
+        private static void GetRecurrenceFactors(int numPoints, int k, out double alpha, out double beta)
+        {
+            var denominator = (double)k * (numPoints - k);
+            alpha = 2.0 * (2 * k - 1) / denominator;
+            beta = (k - 1.0) * (numPoints + k - 1) / denominator;
+        }
+
+        /// <summary>
+        /// 1 / Σ P_k(x)^2 over the window points, for k = 0 through polynomialDegree
+        /// </summary>
+        /// <remarks>
+        /// Equal to (2k+1) (n-1)(n-2)...(n-k) / ((n+k)(n+k-1)...n), where n = numPoints;
+        /// the factors are paired up so the products stay near 1
+        /// </remarks>
+        private static double[] GetNormalizationFactors(int numPoints, int polynomialDegree)
+        {
+            var factors = new double[polynomialDegree + 1];
+
+            for (var k = 0; k <= polynomialDegree; k++)
+            {
+                var factor = (2.0 * k + 1) / (numPoints + k);
+                for (var j = 1; j <= k; j++)
+                {
+                    factor *= (double)(numPoints - j) / (numPoints + k - j);
+                }
+
+                factors[k] = factor;
+            }
+
+            return factors;
+        }
+    }
+}
@@ -0,0 +1,147 @@
+using System;
+using System.Collections.Generic;
+using System.Collections.ObjectModel;
+
+namespace DataFilter
+{
+    /// <summary>
+    /// Immutable Savitzky Golay coefficients for one window, derivative order, and point spacing,
+    /// including the asymmetric sets for the points near the ends of the range being filtered
+    /// </summary>
+    /// <remarks>
+    /// A point with numPointsLeft points on its left and numPointsRight on its right uses the centered set.
+    /// A point closer to the start of the range is fit to the first WindowWidth points of the range,
+    /// and a point closer to the end to the last WindowWidth points, so every point gets the same
+    /// degree of fit without clamping the window. Plans can be shared by any number of threads.
+    /// </remarks>
+    public sealed class SavitzkyGolayPlan
+    {
+        private readonly double[][] mSets;
+        private readonly float[][] mSetsFloat;
+
+        /// <summary>
+        /// Points on the left of a centered window
+        /// </summary>
+        public int NumPointsLeft { get; }
+
+        /// <summary>
+        /// Points on the right of a centered window
+        /// </summary>
+        public int NumPointsRight { get; }
+
+        /// <summary>
+        /// Degree of the fitted polynomial
+        /// </summary>
+        public int PolynomialDegree { get; }
+
+        /// <summary>
+        /// 0 to smooth, 1 for the first derivative, etc.
+        /// </summary>
+        public int DerivativeOrder { get; }
+
+        /// <summary>
+        /// Distance between points; derivatives are per unit of this distance
+        /// </summary>
+        public double PointSpacing { get; }
+
+        /// <summary>
+        /// Points in each window
+        /// </summary>
+        public int WindowWidth => mSets.Length;
+
+        /// <summary>
+        /// Coefficients of the centered window, ordered from the leftmost point of the window to the rightmost
+        /// </summary>
+        public IReadOnlyList<double> Coefficients { get; }
+
+        /// <summary>
+        /// Constructor
+        /// </summary>
+        /// <param name="numPointsLeft"></param>
+        /// <param name="numPointsRight"></param>
+        /// <param name="polynomialDegree">Must be less than numPointsLeft + numPointsRight + 1</param>
+        /// <param name="derivativeOrder">0 to smooth, 1 for the first derivative, etc.</param>
+        /// <param name="pointSpacing"></param>
+        /// <remarks>Throws ArgumentOutOfRangeException for invalid arguments; TryCreate returns an error message instead</remarks>
+        public SavitzkyGolayPlan(int numPointsLeft, int numPointsRight, int polynomialDegree, int derivativeOrder = 0, double pointSpacing = 1.0)
+        {
+            if (numPointsLeft < 0 || numPointsRight < 0)
+                throw new ArgumentOutOfRangeException(nameof(numPointsLeft), "numPointsLeft and numPointsRight should be >= 0");
+
+            NumPointsLeft = numPointsLeft;
+            NumPointsRight = numPointsRight;
+            PolynomialDegree = polynomialDegree;
+            DerivativeOrder = derivativeOrder;
+            PointSpacing = pointSpacing;
+
+            mSets = SavitzkyGolayCoefficients.GetCoefficientsForEveryPosition(
+                numPointsLeft + numPointsRight + 1, polynomialDegree, derivativeOrder, pointSpacing);
+
+            mSetsFloat = new float[mSets.Length][];
+            for (var position = 0; position < mSets.Length; position++)
+            {
+                var set = mSets[position];
+                var setFloat = new float[set.Length];
+                for (var j = 0; j < set.Length; j++)
+                {
+                    setFloat[j] = (float)set[j];
+                }
+
+                mSetsFloat[position] = setFloat;
+            }
+
+            Coefficients = new ReadOnlyCollection<double>(mSets[numPointsLeft]);
+        }
+
+        /// <summary>
+        /// Create a plan, reporting invalid arguments the way the DataFilter methods do rather than by an exception
+        /// </summary>
+        /// <param name="numPointsLeft"></param>
+        /// <param name="numPointsRight"></param>
+        /// <param name="polynomialDegree">Must be less than numPointsLeft + numPointsRight + 1</param>
+        /// <param name="derivativeOrder">0 to smooth, 1 for the first derivative, etc.</param>
+        /// <param name="pointSpacing"></param>
+        /// <param name="plan">The plan, or null if the arguments are invalid</param>
+        /// <param name="errorMessage"></param>
+        /// <returns>True if success, False if error</returns>
+        public static bool TryCreate(
+            int numPointsLeft,
+            int numPointsRight,
+            int polynomialDegree,
+            int derivativeOrder,
+            double pointSpacing,
+            out SavitzkyGolayPlan plan,
+            out string errorMessage)
+        {
+            plan = null;
+
+            if (numPointsLeft < 0 || numPointsRight < 0)
+            {
+                errorMessage = "numPointsLeft and numPointsRight should be >= 0";
+                return false;
+            }
+
+            if (!SavitzkyGolayCoefficients.CheckArguments(numPointsLeft + numPointsRight + 1, polynomialDegree, derivativeOrder, pointSpacing, out _, out errorMessage))
+                return false;
+
+            plan = new SavitzkyGolayPlan(numPointsLeft, numPointsRight, polynomialDegree, derivativeOrder, pointSpacing);
+            return true;
+        }
+
+        /// <summary>
+        /// Coefficients that evaluate the fit at point position of a window; NumPointsLeft gives the centered set
+        /// </summary>
+        internal double[] GetSet(int position)
+        {
+            return mSets[position];
+        }
+
+        /// <summary>
+        /// Float version of GetSet
+        /// </summary>
+        internal float[] GetSetFloat(int position)
+        {
+            return mSetsFloat[position];
+        }
+    }
+}
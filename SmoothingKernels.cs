@@ -0,0 +1,451 @@
+using System.Collections.Generic;
+
+namespace DataFilter
+{
+    /// <summary>
+    /// Convolution and moving sum kernels, with unrolled versions for the window widths we use most
+    /// </summary>
+    /// <remarks>
+    /// The unrolled kernels keep the coefficients and the points of the current window in locals,
+    /// so each output point loads one new point. They add the terms in the same order as the
+    /// generic kernels, so every kernel gives the same result for a given width
+    /// </remarks>
+    internal static class SmoothingKernels
+    {
+        /// <summary>
+        /// output[i] = scale * Σ c[j] * data[i - windowOffset + j], for i = first through last
+        /// </summary>
+        public delegate void ConvolutionKernel(double[] data, double[] output, int first, int last, int windowOffset, double[] c, double scale);
+
+        /// <summary>
+        /// Float version of ConvolutionKernel
+        /// </summary>
+        public delegate void ConvolutionKernelFloat(float[] data, float[] output, int first, int last, int windowOffset, float[] c, float scale);
+
+        /// <summary>
+        /// output[i] = Σ data[i - windowOffset + j] / width, for j = 0 to width-1 and i = first through last
+        /// </summary>
+        public delegate void MovingAverageKernel(double[] data, double[] output, int first, int last, int windowOffset, int width);
+
+        /// <summary>
+        /// Float version of MovingAverageKernel
+        /// </summary>
+        public delegate void MovingAverageKernelFloat(float[] data, float[] output, int first, int last, int windowOffset, int width);
+
+        // Savitzky Golay 3/3 and 5/5 (any degree), and moving averages of width 5, 7, and 9
+
+        private static readonly Dictionary<int, ConvolutionKernel> mConvolutionKernels = new Dictionary<int, ConvolutionKernel>
+        {
+            { 7, Convolve7 },
+            { 11, Convolve11 }
+        };
+
+        private static readonly Dictionary<int, ConvolutionKernelFloat> mConvolutionKernelsFloat = new Dictionary<int, ConvolutionKernelFloat>
+        {
+            { 7, Convolve7 },
+            { 11, Convolve11 }
+        };
+
+        private static readonly Dictionary<int, MovingAverageKernel> mMovingAverageKernels = new Dictionary<int, MovingAverageKernel>
+        {
+            { 5, MovingAverage5 },
+            { 7, MovingAverage7 },
+            { 9, MovingAverage9 }
+        };
+
+        private static readonly Dictionary<int, MovingAverageKernelFloat> mMovingAverageKernelsFloat = new Dictionary<int, MovingAverageKernelFloat>
+        {
+            { 5, MovingAverage5 },
+            { 7, MovingAverage7 },
+            { 9, MovingAverage9 }
+        };
+
+        /// <summary>
+        /// Kernel for a window of the given number of coefficients
+        /// </summary>
+        public static ConvolutionKernel GetConvolutionKernel(int width)
+        {
+            if (mConvolutionKernels.TryGetValue(width, out var kernel))
+                return kernel;
+
+            return Convolve;
+        }
+
+        /// <summary>
+        /// Float kernel for a window of the given number of coefficients
+        /// </summary>
+        public static ConvolutionKernelFloat GetConvolutionKernelFloat(int width)
+        {
+            if (mConvolutionKernelsFloat.TryGetValue(width, out var kernel))
+                return kernel;
+
+            return Convolve;
+        }
+
+        /// <summary>
+        /// Kernel for a moving average of the given width
+        /// </summary>
+        public static MovingAverageKernel GetMovingAverageKernel(int width)
+        {
+            if (mMovingAverageKernels.TryGetValue(width, out var kernel))
+                return kernel;
+
+            return MovingAverage;
+        }
+
+        /// <summary>
+        /// Float kernel for a moving average of the given width
+        /// </summary>
+        public static MovingAverageKernelFloat GetMovingAverageKernelFloat(int width)
+        {
+            if (mMovingAverageKernelsFloat.TryGetValue(width, out var kernel))
+                return kernel;
+
+            return MovingAverage;
+        }
+
+        private static void Convolve(double[] data, double[] output, int first, int last, int windowOffset, double[] c, double scale)
+        {
+            for (var i = first; i <= last; i++)
+            {
+                var p = i - windowOffset;
+                var total = 0.0;
+                for (var j = 0; j < c.Length; j++)
+                {
+                    total += data[p + j] * c[j];
+                }
+
+                output[i] = total * scale;
+            }
+        }
+
+        private static void Convolve(float[] data, float[] output, int first, int last, int windowOffset, float[] c, float scale)
+        {
+            for (var i = first; i <= last; i++)
+            {
+                var p = i - windowOffset;
+                var total = 0.0f;
+                for (var j = 0; j < c.Length; j++)
+                {
+                    total += data[p + j] * c[j];
+                }
+
+                output[i] = total * scale;
+            }
+        }
+
+        private static void Convolve7(double[] data, double[] output, int first, int last, int windowOffset, double[] c, double scale)
+        {
+            if (last < first)
+                return;
+
+            double c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3], c4 = c[4], c5 = c[5], c6 = c[6];
+
+            var p = first - windowOffset;
+            double y0 = data[p], y1 = data[p + 1], y2 = data[p + 2], y3 = data[p + 3], y4 = data[p + 4], y5 = data[p + 5];
+
+            for (var i = first; i <= last; i++, p++)
+            {
+                var y6 = data[p + 6];
+
+                var total = 0.0;
+                total += y0 * c0;
+                total += y1 * c1;
+                total += y2 * c2;
+                total += y3 * c3;
+                total += y4 * c4;
+                total += y5 * c5;
+                total += y6 * c6;
+                output[i] = total * scale;
+
+                y0 = y1; y1 = y2; y2 = y3; y3 = y4; y4 = y5; y5 = y6;
+            }
+        }
+
+        private static void Convolve7(float[] data, float[] output, int first, int last, int windowOffset, float[] c, float scale)
+        {
+            if (last < first)
+                return;
+
+            float c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3], c4 = c[4], c5 = c[5], c6 = c[6];
+
+            var p = first - windowOffset;
+            float y0 = data[p], y1 = data[p + 1], y2 = data[p + 2], y3 = data[p + 3], y4 = data[p + 4], y5 = data[p + 5];
+
+            for (var i = first; i <= last; i++, p++)
+            {
+                var y6 = data[p + 6];
+
+                var total = 0.0f;
+                total += y0 * c0;
+                total += y1 * c1;
+                total += y2 * c2;
+                total += y3 * c3;
+                total += y4 * c4;
+                total += y5 * c5;
+                total += y6 * c6;
+                output[i] = total * scale;
+
+                y0 = y1; y1 = y2; y2 = y3; y3 = y4; y4 = y5; y5 = y6;
+            }
+        }
+
+        private static void Convolve11(double[] data, double[] output, int first, int last, int windowOffset, double[] c, double scale)
+        {
+            if (last < first)
+                return;
+
+            double c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3], c4 = c[4], c5 = c[5], c6 = c[6], c7 = c[7], c8 = c[8], c9 = c[9], c10 = c[10];
+
+            var p = first - windowOffset;
+            double y0 = data[p], y1 = data[p + 1], y2 = data[p + 2], y3 = data[p + 3], y4 = data[p + 4];
+            double y5 = data[p + 5], y6 = data[p + 6], y7 = data[p + 7], y8 = data[p + 8], y9 = data[p + 9];
+
+            for (var i = first; i <= last; i++, p++)
+            {
+                var y10 = data[p + 10];
+
+                var total = 0.0;
+                total += y0 * c0;
+                total += y1 * c1;
+                total += y2 * c2;
+                total += y3 * c3;
+                total += y4 * c4;
+                total += y5 * c5;
+                total += y6 * c6;
+                total += y7 * c7;
+                total += y8 * c8;
+                total += y9 * c9;
+                total += y10 * c10;
+                output[i] = total * scale;
+
+                y0 = y1; y1 = y2; y2 = y3; y3 = y4; y4 = y5;
+                y5 = y6; y6 = y7; y7 = y8; y8 = y9; y9 = y10;
+            }
+        }
+
+        private static void Convolve11(float[] data, float[] output, int first, int last, int windowOffset, float[] c, float scale)
+        {
+            if (last < first)
+                return;
+
+            float c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3], c4 = c[4], c5 = c[5], c6 = c[6], c7 = c[7], c8 = c[8], c9 = c[9], c10 = c[10];
+
+            var p = first - windowOffset;
+            float y0 = data[p], y1 = data[p + 1], y2 = data[p + 2], y3 = data[p + 3], y4 = data[p + 4];
+            float y5 = data[p + 5], y6 = data[p + 6], y7 = data[p + 7], y8 = data[p + 8], y9 = data[p + 9];
+
+            for (var i = first; i <= last; i++, p++)
+            {
+                var y10 = data[p + 10];
+
+                var total = 0.0f;
+                total += y0 * c0;
+                total += y1 * c1;
+                total += y2 * c2;
+                total += y3 * c3;
+                total += y4 * c4;
+                total += y5 * c5;
+                total += y6 * c6;
+                total += y7 * c7;
+                total += y8 * c8;
+                total += y9 * c9;
+                total += y10 * c10;
+                output[i] = total * scale;
+
+                y0 = y1; y1 = y2; y2 = y3; y3 = y4; y4 = y5;
+                y5 = y6; y6 = y7; y7 = y8; y8 = y9; y9 = y10;
+            }
+        }
+
+        private static void MovingAverage(double[] data, double[] output, int first, int last, int windowOffset, int width)
+        {
+            for (var i = first; i <= last; i++)
+            {
+                var p = i - windowOffset;
+                double total = 0;
+                for (var j = 0; j < width; j++)
+                {
+                    total += data[p + j];
+                }
+
+                output[i] = total / width;
+            }
+        }
+
+        private static void MovingAverage(float[] data, float[] output, int first, int last, int windowOffset, int width)
+        {
+            for (var i = first; i <= last; i++)
+            {
+                var p = i - windowOffset;
+                float total = 0;
+                for (var j = 0; j < width; j++)
+                {
+                    total += data[p + j];
+                }
+
+                output[i] = total / width;
+            }
+        }
+
+        private static void MovingAverage5(double[] data, double[] output, int first, int last, int windowOffset, int width)
+        {
+            if (last < first)
+                return;
+
+            var p = first - windowOffset;
+            double y0 = data[p], y1 = data[p + 1], y2 = data[p + 2], y3 = data[p + 3];
+
+            for (var i = first; i <= last; i++, p++)
+            {
+                var y4 = data[p + 4];
+
+                double total = 0;
+                total += y0;
+                total += y1;
+                total += y2;
+                total += y3;
+                total += y4;
+                output[i] = total / 5;
+
+                y0 = y1; y1 = y2; y2 = y3; y3 = y4;
+            }
+        }
+
+        private static void MovingAverage5(float[] data, float[] output, int first, int last, int windowOffset, int width)
+        {
+            if (last < first)
+                return;
+
+            var p = first - windowOffset;
+            float y0 = data[p], y1 = data[p + 1], y2 = data[p + 2], y3 = data[p + 3];
+
+            for (var i = first; i <= last; i++, p++)
+            {
+                var y4 = data[p + 4];
+
+                float total = 0;
+                total += y0;
+                total += y1;
+                total += y2;
+                total += y3;
+                total += y4;
+                output[i] = total / 5;
+
+                y0 = y1; y1 = y2; y2 = y3; y3 = y4;
+            }
+        }
+
+        private static void MovingAverage7(double[] data, double[] output, int first, int last, int windowOffset, int width)
+        {
+            if (last < first)
+                return;
+
+            var p = first - windowOffset;
+            double y0 = data[p], y1 = data[p + 1], y2 = data[p + 2], y3 = data[p + 3], y4 = data[p + 4], y5 = data[p + 5];
+
+            for (var i = first; i <= last; i++, p++)
+            {
+                var y6 = data[p + 6];
+
+                double total = 0;
+                total += y0;
+                total += y1;
+                total += y2;
+                total += y3;
+                total += y4;
+                total += y5;
+                total += y6;
+                output[i] = total / 7;
+
+                y0 = y1; y1 = y2; y2 = y3; y3 = y4; y4 = y5; y5 = y6;
+            }
+        }
+
+        private static void MovingAverage7(float[] data, float[] output, int first, int last, int windowOffset, int width)
+        {
+            if (last < first)
+                return;
+
+            var p = first - windowOffset;
+            float y0 = data[p], y1 = data[p + 1], y2 = data[p + 2], y3 = data[p + 3], y4 = data[p + 4], y5 = data[p + 5];
+
+            for (var i = first; i <= last; i++, p++)
+            {
+                var y6 = data[p + 6];
+
+                float total = 0;
+                total += y0;
+                total += y1;
+                total += y2;
+                total += y3;
+                total += y4;
+                total += y5;
+                total += y6;
+                output[i] = total / 7;
+
+                y0 = y1; y1 = y2; y2 = y3; y3 = y4; y4 = y5; y5 = y6;
+            }
+        }
+
+        private static void MovingAverage9(double[] data, double[] output, int first, int last, int windowOffset, int width)
+        {
+            if (last < first)
+                return;
+
+            var p = first - windowOffset;
+            double y0 = data[p], y1 = data[p + 1], y2 = data[p + 2], y3 = data[p + 3];
+            double y4 = data[p + 4], y5 = data[p + 5], y6 = data[p + 6], y7 = data[p + 7];
+
+            for (var i = first; i <= last; i++, p++)
+            {
+                var y8 = data[p + 8];
+
+                double total = 0;
+                total += y0;
+                total += y1;
+                total += y2;
+                total += y3;
+                total += y4;
+                total += y5;
+                total += y6;
+                total += y7;
+                total += y8;
+                output[i] = total / 9;
+
+                y0 = y1; y1 = y2; y2 = y3; y3 = y4;
+                y4 = y5; y5 = y6; y6 = y7; y7 = y8;
+            }
+        }
+
+        private static void MovingAverage9(float[] data, float[] output, int first, int last, int windowOffset, int width)
+        {
+            if (last < first)
+                return;
+
+            var p = first - windowOffset;
+            float y0 = data[p], y1 = data[p + 1], y2 = data[p + 2], y3 = data[p + 3];
+            float y4 = data[p + 4], y5 = data[p + 5], y6 = data[p + 6], y7 = data[p + 7];
+
+            for (var i = first; i <= last; i++, p++)
+            {
+                var y8 = data[p + 8];
+
+                float total = 0;
+                total += y0;
+                total += y1;
+                total += y2;
+                total += y3;
+                total += y4;
+                total += y5;
+                total += y6;
+                total += y7;
+                total += y8;
+                output[i] = total / 9;
+
+                y0 = y1; y1 = y2; y2 = y3; y3 = y4;
+                y4 = y5; y5 = y6; y6 = y7; y7 = y8;
+            }
+        }
+    }
+}
@@ -0,0 +1,479 @@
+/************************************************************************
+*                                                                       *
+*                              HUGEALIGN.C                              *
+*                                                                       *
+*		Alignment of a trace to a reference trace.                  *
+*                                                                       *
+*   Finds the slope M and offset B that best map point i of a trace    *
+*   onto point i*M+B of the reference, scoring by the sum of absolute  *
+*   differences of the peak normalized traces.                         *
+*                                                                       *
+*   Both traces are averaged down to a coarse level of no more than    *
+*   ALIGNCOARSE points. There every slope on the 0.05 grid gets its    *
+*   offset from an FFT cross-correlation, two slopes per transform.    *
+*   The best pair is then refined by a pattern search at each finer    *
+*   level, so the full resolution data is only passed a few dozen      *
+*   times.                                                             *
+*                                                                       *
+************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <windows.h>
+#include "icr-2ls.h"
+#include "hugethrd.h"
+#include "hugefft.h"
+
+#define   ALIGNCOARSE    1024       // longest trace at the coarse level
+#define   ALIGNFFT       12288      // >= ALIGNCOARSE / ALIGNMMIN + ALIGNCOARSE
+#define   ALIGNLEVELS    32
+#define   ALIGNMMIN      0.1
+#define   ALIGNMMAX      10.0
+#define   ALIGNMSTEP     0.05
+#define   ALIGNITER      64
+
+typedef struct
+{
+	const float  *d[ALIGNLEVELS];   // d[0] is the trace, d[k] is averaged 2^k times
+	int          n[ALIGNLEVELS];
+	int          Levels;
+	float        Scale;             // 1 / peak
+	double       Area;              // sum of the normalized trace
+	float        *buf;
+}  ALIGNTRACE;
+
+/************************************************************************
+* AlignLevels - Number of halvings to bring both traces to the coarse   *
+*               level                                                   *
+************************************************************************/
+static int AlignLevels(int n1, int n2)
+{
+	int   n,L;
+
+	n = (n1 > n2) ? n1 : n2;
+	for(L=0;(n > ALIGNCOARSE) && (L < ALIGNLEVELS - 1);L++) n = (n + 1) / 2;
+	return(L);
+}
+
+static void AlignPyramidFree(ALIGNTRACE *t)
+{
+	free(t->buf);
+	t->buf = NULL;
+}
+
+/************************************************************************
+* AlignPyramid - Peak, area and averaged copies of a trace              *
+************************************************************************/
+static int AlignPyramid(ALIGNTRACE *t, const float *data, int n, int Levels)
+{
+	float   *p,Max;
+	double  Area;
+	int     i,k,len,total;
+
+	t->buf = NULL;
+	Max = data[0];
+	Area = 0.0;
+	for(i=0;i<n;i++)
+	{
+		if(data[i] > Max) Max = data[i];
+		Area += data[i];
+	}
+	if(Max <= 0.0f) return(HA_WM32_Invalid_Arg);
+	t->Scale = 1.0f / Max;
+	t->Area = Area * t->Scale;
+	if(t->Area <= 0.0) return(HA_WM32_Invalid_Arg);
+	t->d[0] = data;
+	t->n[0] = n;
+	t->Levels = Levels;
+	total = 0;
+	for(len=n,k=1;k<=Levels;k++)
+	{
+		len = (len + 1) / 2;
+		total += len;
+	}
+	if(total == 0) return(0);
+	t->buf = (float *)malloc(total * sizeof(float));
+	if(t->buf == NULL) return(HA_OUTOFMEMORY);
+	p = t->buf;
+	for(k=1;k<=Levels;k++)
+	{
+		len = t->n[k-1];
+		t->n[k] = (len + 1) / 2;
+		for(i=0;i<len/2;i++) p[i] = 0.5f * (t->d[k-1][2*i] + t->d[k-1][2*i+1]);
+		if(len & 1) p[len/2] = t->d[k-1][len-1];
+		t->d[k] = p;
+		p += t->n[k];
+	}
+	return(0);
+}
+
+/************************************************************************
+* AlignErr - Sum of |ref(i*M+B) - trace(i)| at a level, points that map *
+*            outside the reference count |trace(i)|                     *
+************************************************************************/
+static double AlignErr(const ALIGNTRACE *r, const ALIGNTRACE *t, int Level, double M, double B)
+{
+	const float  *d1,*d2;
+	float        s1,s2;
+	double       err;
+	int          i,j,n1,n2;
+
+	d1 = r->d[Level];
+	d2 = t->d[Level];
+	n1 = r->n[Level];
+	n2 = t->n[Level];
+	s1 = r->Scale;
+	s2 = t->Scale;
+	err = 0.0;
+	for(i=0;i<n2;i++)
+	{
+		j = (int)floor(i * M + B + 0.5);
+		if((j >= 0) && (j < n1)) err += fabs(s1 * d1[j] - s2 * d2[i]);
+		else err += fabs(s2 * d2[i]);
+	}
+	return(err);
+}
+
+/************************************************************************
+* Coarse slope grid                                                     *
+*                                                                       *
+* For slope M the reference resampled on the trace's grid is            *
+* G(k) = ref(k*M), and an offset of c trace points is B = c*M. The c   *
+* that minimizes sum (G(i+c) - trace(i))^2 is the c that maximizes     *
+* 2 C(c) - W(c), C the cross-correlation and W the energy of G under   *
+* the trace. Two slopes share each transform, one in the real part     *
+* and one in the imaginary part.                                       *
+************************************************************************/
+typedef struct
+{
+	FFTPLAN           *Plan;
+	const ALIGNTRACE  *r,*t;
+	int               Level;
+	const FCPLX       *Y;            // transform of the trace
+	int               NumM;
+	double            *Err,*B;
+	int               Fail;
+}  ALIGNGRID;
+
+static double AlignM(int m)
+{
+	return(ALIGNMMIN + m * ALIGNMSTEP);
+}
+
+// Resamples the reference at slope M, returns the number of points
+static int AlignResample(const ALIGNTRACE *r, int Level, double M, int Max, float *G, double *pre)
+{
+	const float  *d1;
+	int          k,j,n1;
+
+	d1 = r->d[Level];
+	n1 = r->n[Level];
+	pre[0] = 0.0;
+	for(k=0;k<Max;k++)
+	{
+		j = (int)floor(k * M + 0.5);
+		if(j >= n1) break;
+		G[k] = r->Scale * d1[j];
+		pre[k+1] = pre[k] + (double)G[k] * G[k];
+	}
+	return(k);
+}
+
+// Best offset in trace points from the correlation, in the real or
+// imaginary part of Z
+static int AlignPeak(const FCPLX *Z, int Imag, const double *pre, int nG, int n2)
+{
+	double   v,best,W,C;
+	int      c,lo,hi,idx,bestc;
+
+	best = 0.0;
+	bestc = 0;
+	for(c=-(n2-1);c<nG;c++)
+	{
+		lo = (c > 0) ? c : 0;
+		hi = (c + n2 < nG) ? c + n2 : nG;
+		W = pre[hi] - pre[lo];
+		idx = (c < 0) ? c + ALIGNFFT : c;
+		C = (Imag ? Z[idx].i : Z[idx].r) / (double)ALIGNFFT;
+		v = 2.0 * C - W;
+		if((c == -(n2-1)) || (v > best))
+		{
+			best = v;
+			bestc = c;
+		}
+	}
+	return(bestc);
+}
+
+static void AlignGridTask(void *Arg, int Start, int Stop, int Thread)
+{
+	ALIGNGRID   *ag;
+	FCPLX       *X,*Z;
+	float       *Ga,*Gb;
+	double      *pa,*pb,Ma,Mb,yr,yi,zr,zi;
+	int         p,k,m,n2,na,nb,Max;
+
+	ag = (ALIGNGRID *)Arg;
+	n2 = ag->t->n[ag->Level];
+	Max = ALIGNFFT - n2;
+	X = (FCPLX *)malloc(2 * ALIGNFFT * sizeof(FCPLX));
+	Ga = (float *)malloc(2 * Max * sizeof(float));
+	pa = (double *)malloc(2 * (Max + 1) * sizeof(double));
+	if((X == NULL) || (Ga == NULL) || (pa == NULL))
+	{
+		ag->Fail = 1;
+		free(X);
+		free(Ga);
+		free(pa);
+		return;
+	}
+	Z = X + ALIGNFFT;
+	Gb = Ga + Max;
+	pb = pa + Max + 1;
+	for(p=Start;p<Stop;p++)
+	{
+		m = 2 * p;
+		Ma = AlignM(m);
+		Mb = AlignM((m + 1 < ag->NumM) ? m + 1 : m);
+		na = AlignResample(ag->r, ag->Level, Ma, Max, Ga, pa);
+		nb = AlignResample(ag->r, ag->Level, Mb, Max, Gb, pb);
+		memset(X, 0, ALIGNFFT * sizeof(FCPLX));
+		for(k=0;k<na;k++) X[k].r = Ga[k];
+		for(k=0;k<nb;k++) X[k].i = Gb[k];
+		if(FFTComplex(ag->Plan, Z, X, 1) != 0)
+		{
+			ag->Fail = 1;
+			break;
+		}
+		for(k=0;k<ALIGNFFT;k++)
+		{
+			zr = Z[k].r;
+			zi = Z[k].i;
+			yr = ag->Y[k].r;
+			yi = ag->Y[k].i;
+			X[k].r = (float)(zr * yr + zi * yi);
+			X[k].i = (float)(zi * yr - zr * yi);
+		}
+		if(FFTComplex(ag->Plan, Z, X, -1) != 0)
+		{
+			ag->Fail = 1;
+			break;
+		}
+		ag->B[m] = Ma * AlignPeak(Z, 0, pa, na, n2);
+		ag->Err[m] = AlignErr(ag->r, ag->t, ag->Level, Ma, ag->B[m]);
+		if(m + 1 < ag->NumM)
+		{
+			ag->B[m+1] = Mb * AlignPeak(Z, 1, pb, nb, n2);
+			ag->Err[m+1] = AlignErr(ag->r, ag->t, ag->Level, Mb, ag->B[m+1]);
+		}
+	}
+	free(X);
+	free(Ga);
+	free(pa);
+}
+
+/************************************************************************
+* AlignRefine -                                                         *
+*                                                                       *
+* Pattern search around (M,B) with steps dM and dB. The slope turns    *
+* about the middle of the trace, so a change of M alone keeps the      *
+* middle where it is instead of sliding the whole trace.               *
+************************************************************************/
+static void AlignRefine(const ALIGNTRACE *r, const ALIGNTRACE *t, int Level, double *M, double *B, double *Err, double dM, double dB)
+{
+	static const int  dir[8][2] = {{1,0},{-1,0},{0,1},{0,-1},{1,1},{1,-1},{-1,1},{-1,-1}};
+	double            mid,P,m,p,e,bestM,bestP,best;
+	int               it,i;
+
+	mid = 0.5 * t->n[Level];
+	P = *B + *M * mid;
+	best = *Err;
+	for(it=0;it<ALIGNITER;it++)
+	{
+		bestM = *M;
+		bestP = P;
+		for(i=0;i<8;i++)
+		{
+			m = *M + dir[i][0] * dM;
+			p = P + dir[i][1] * dB;
+			if((m < ALIGNMMIN) || (m > ALIGNMMAX)) continue;
+			e = AlignErr(r, t, Level, m, p - m * mid);
+			if(e < best)
+			{
+				best = e;
+				bestM = m;
+				bestP = p;
+			}
+		}
+		if((bestM == *M) && (bestP == P)) break;
+		*M = bestM;
+		P = bestP;
+	}
+	*B = P - *M * mid;
+	*Err = best;
+}
+
+/************************************************************************
+* AlignTrace - Aligns one trace to the reference pyramid                *
+************************************************************************/
+static int AlignTrace(const ALIGNTRACE *r, FFTPLAN *Plan, const float *data, int n, int NumThreads, float *Mout, float *Bout, float *Score)
+{
+	ALIGNTRACE   t;
+	ALIGNGRID    ag;
+	FCPLX        *X,*Y;
+	double       Err[256],Bg[256],M,B,e,dM,dB;
+	int          i,k,L,iStat;
+
+	L = AlignLevels(r->n[0], n);
+	if(L > r->Levels) return(HA_WM32_Invalid_Arg);
+	iStat = AlignPyramid(&t, data, n, L);
+	if(iStat != 0) return(iStat);
+	// Transform of the coarse trace
+	X = (FCPLX *)malloc(2 * ALIGNFFT * sizeof(FCPLX));
+	if(X == NULL)
+	{
+		AlignPyramidFree(&t);
+		return(HA_OUTOFMEMORY);
+	}
+	Y = X + ALIGNFFT;
+	memset(X, 0, ALIGNFFT * sizeof(FCPLX));
+	for(i=0;i<t.n[L];i++) X[i].r = t.Scale * t.d[L][i];
+	iStat = FFTComplex(Plan, Y, X, 1);
+	if(iStat != 0)
+	{
+		free(X);
+		AlignPyramidFree(&t);
+		return(iStat);
+	}
+	// Every slope on the grid
+	ag.Plan = Plan;
+	ag.r = r;
+	ag.t = &t;
+	ag.Level = L;
+	ag.Y = Y;
+	ag.NumM = (int)floor((ALIGNMMAX - ALIGNMMIN) / ALIGNMSTEP + 0.5) + 1;
+	ag.Err = Err;
+	ag.B = Bg;
+	ag.Fail = 0;
+	HugeParallel(AlignGridTask, &ag, (ag.NumM + 1) / 2, 1, NumThreads);
+	free(X);
+	if(ag.Fail)
+	{
+		AlignPyramidFree(&t);
+		return(HA_OUTOFMEMORY);
+	}
+	for(k=0,i=1;i<ag.NumM;i++) if(Err[i] < Err[k]) k = i;
+	M = AlignM(k);
+	B = Bg[k];
+	e = Err[k];
+	// Down from the grid step to a one point turn of the trace ends,
+	// then the same one point steps at each finer level
+	for(dM=ALIGNMSTEP/2.0;dM*t.n[L]>1.0;dM/=2.0) AlignRefine(r, &t, L, &M, &B, &e, dM, 1.0);
+	AlignRefine(r, &t, L, &M, &B, &e, 1.0 / t.n[L], 1.0);
+	while(L > 0)
+	{
+		L--;
+		B = 2.0 * B + 0.5 * (1.0 - M);
+		e = AlignErr(r, &t, L, M, B);
+		AlignRefine(r, &t, L, &M, &B, &e, 1.0 / t.n[L], 1.0);
+	}
+	for(dB=0.5;dB>=0.25;dB/=2.0) AlignRefine(r, &t, 0, &M, &B, &e, dB / t.n[0], dB);
+	*Mout = (float)M;
+	*Bout = (float)B;
+	*Score = (float)(1.0 - e / t.Area);
+	if(*Score < 0.0f) *Score = 0.0f;
+	AlignPyramidFree(&t);
+	return(0);
+}
+
+/************************************************************************
+* HugeAlign -                                                           *
+*                                                                       *
+* Aligns Num points of lpdata to NumRef points of the reference. Point *
+* i of the data matches point i*M+B of the reference. Score is 1 less  *
+* the mean absolute difference relative to the data area, 0 to 1.      *
+************************************************************************/
+int pascal _export HugeAlign(int *lpref, int NumRef, int *lpdata, int Num, float *M, float *B, float *Score)
+{
+	ALIGNTRACE   r;
+	FFTPLAN      *Plan;
+	int          iStat;
+
+	if((NumRef < 1) || (Num < 1)) return(HA_WM32_Invalid_Arg);
+	Plan = FFTGetPlan(ALIGNFFT);
+	if(Plan == NULL) return(HA_OUTOFMEMORY);
+	iStat = AlignPyramid(&r, (const float *)*lpref, NumRef, AlignLevels(NumRef, Num));
+	if(iStat != 0) return(iStat);
+	iStat = AlignTrace(&r, Plan, (const float *)*lpdata, Num, 0, M, B, Score);
+	AlignPyramidFree(&r);
+	return(iStat);
+}
+
+typedef struct
+{
+	const ALIGNTRACE  *r;
+	FFTPLAN           *Plan;
+	int               *lpdatas;
+	int               *Nums;
+	float             *M,*B,*Score;
+	int               iStat;
+}  ALIGNBATCH;
+
+static void AlignBatchTask(void *Arg, int Start, int Stop, int Thread)
+{
+	ALIGNBATCH  *ab;
+	int         i,iStat;
+
+	ab = (ALIGNBATCH *)Arg;
+	for(i=Start;i<Stop;i++)
+	{
+		iStat = HA_WM32_Invalid_Arg;
+		if(ab->Nums[i] > 0) iStat = AlignTrace(ab->r, ab->Plan, (const float *)ab->lpdatas[i], ab->Nums[i], 1, &ab->M[i], &ab->B[i], &ab->Score[i]);
+		if(iStat != 0)
+		{
+			ab->M[i] = 1.0f;
+			ab->B[i] = 0.0f;
+			ab->Score[i] = -1.0f;
+			ab->iStat = iStat;
+		}
+	}
+}
+
+/************************************************************************
+* HugeAlignBatch -                                                      *
+*                                                                       *
+* Aligns NumRuns traces to one reference, one run per thread. lpdatas  *
+* holds the huge array addresses and Nums the sizes. A run that can't  *
+* be aligned gets M = 1, B = 0 and Score = -1, and its error is        *
+* returned.                                                             *
+************************************************************************/
+int pascal _export HugeAlignBatch(int *lpref, int NumRef, int *lpdatas, int *Nums, int NumRuns, float *M, float *B, float *Score)
+{
+	ALIGNTRACE   r;
+	ALIGNBATCH   ab;
+	int          i,L,Levels,iStat;
+
+	if((NumRef < 1) || (NumRuns < 0)) return(HA_WM32_Invalid_Arg);
+	Levels = 0;
+	for(i=0;i<NumRuns;i++)
+	{
+		L = AlignLevels(NumRef, Nums[i]);
+		if(L > Levels) Levels = L;
+	}
+	ab.Plan = FFTGetPlan(ALIGNFFT);
+	if(ab.Plan == NULL) return(HA_OUTOFMEMORY);
+	iStat = AlignPyramid(&r, (const float *)*lpref, NumRef, Levels);
+	if(iStat != 0) return(iStat);
+	ab.r = &r;
+	ab.lpdatas = lpdatas;
+	ab.Nums = Nums;
+	ab.M = M;
+	ab.B = B;
+	ab.Score = Score;
+	ab.iStat = 0;
+	HugeParallel(AlignBatchTask, &ab, NumRuns, 1, 0);
+	AlignPyramidFree(&r);
+	return(ab.iStat);
+}
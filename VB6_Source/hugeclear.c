@@ -0,0 +1,171 @@
+/************************************************************************
+*                                                                       *
+*                              HUGECLEAR.C                              *
+*                                                                       *
+*		Noise clearing that keeps the peaks of a huge array.        *
+*                                                                       *
+*   Points above a threshold are found four at a time with an SSE2     *
+*   compare, each run of them is widened by Width/2 on both sides, and *
+*   everything between the widened runs is zeroed in bulk.             *
+*                                                                       *
+************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <windows.h>
+#include "icr-2ls.h"
+#include "hugethrd.h"
+#include "hugekern.h"
+#include "hugeview.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define   HUGE_SSE2
+#include <emmintrin.h>
+#endif
+
+typedef struct
+{
+	HUGEVIEW   v;
+	float      Thres;
+	float      Thres2;              // Thres squared, for magnitudes
+}  CLEARSCAN;
+
+static int ClearAbove(const CLEARSCAN *cs, int i)
+{
+	float   *p;
+
+	p = VIEW_PTR(&cs->v, i);
+	if(cs->v.Mag) return((cs->Thres < 0.0f) || (p[0] * p[0] + p[1] * p[1] > cs->Thres2));
+	return(*p > cs->Thres);
+}
+
+/************************************************************************
+* ClearFind - First point from i to to-1 that is above the threshold,  *
+*             or below it when Above is 0. Returns to if there is none. *
+************************************************************************/
+static int ClearFind(const CLEARSCAN *cs, int i, int to, int Above)
+{
+#ifdef HUGE_SSE2
+	__m128   t,a,b,x;
+	float    *p;
+	int      m,flip,k,lim;
+
+	flip = Above ? 0 : 0xF;
+	if(cs->v.Mag && (cs->Thres < 0.0f)) return(Above ? ((i < to) ? i : to) : to);
+	t = _mm_set1_ps(cs->v.Mag ? cs->Thres2 : cs->Thres);
+	// X,Y pairs would read the X after the last Y
+	lim = to;
+	if((cs->v.Stride == 2) && !cs->v.Mag && (lim > cs->v.Num - 1)) lim = cs->v.Num - 1;
+	if((cs->v.Stride == 1) || (cs->v.Stride == 2))
+	{
+		for(;i+4<=lim;i+=4)
+		{
+			p = VIEW_PTR(&cs->v, i);
+			if(cs->v.Stride == 1) x = _mm_loadu_ps(p);
+			else
+			{
+				a = _mm_loadu_ps(p);
+				b = _mm_loadu_ps(p + 4);
+				if(cs->v.Mag)
+				{
+					a = _mm_mul_ps(a, a);
+					b = _mm_mul_ps(b, b);
+					x = _mm_add_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1)));
+				}
+				else x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0));
+			}
+			m = _mm_movemask_ps(_mm_cmpgt_ps(x, t)) ^ flip;
+			if(m)
+			{
+				for(k=0;!(m & (1 << k));k++);
+				return(i + k);
+			}
+		}
+	}
+#endif
+	for(;i<to;i++) if(ClearAbove(cs, i) == Above) return(i);
+	return(to);
+}
+
+// Zeroes points from to to-1
+static void ClearZero(const HUGEVIEW *v, int from, int to)
+{
+	int   i;
+
+	if(from >= to) return;
+	if((v->Stride == 1) && !v->Mag)
+	{
+		KernFill(VIEW_PTR(v, from), to - from, 0.0f);
+		return;
+	}
+	for(i=from;i<to;i++)
+	{
+		VIEW_PTR(v, i)[0] = 0.0f;
+		if(v->Mag) VIEW_PTR(v, i)[1] = 0.0f;
+	}
+}
+
+/************************************************************************
+* HugeClearPeaks -                                                      *
+*                                                                       *
+* Zeroes the plotted channel of a Num point plot, except the peaks     *
+* found between points Start and Stop-1. A peak is a run of points     *
+* above Threshold times the mean of the range, or above 0 when         *
+* Threshold is 0, widened by Width/2 points on each side. Complex data *
+* is tested by magnitude. When Regions is not NULL the first           *
+* MaxRegions kept regions are written to it as start,length pairs.     *
+* Returns the number of regions kept.                                  *
+************************************************************************/
+int pascal _export HugeClearPeaks(int *lpdata, int Type, int Num, int Start, int Stop, float Threshold, int Width, int *Regions, int MaxRegions)
+{
+	CLEARSCAN   cs;
+	double      Sum;
+	int         i,h,p,e,a,b,rs,re,from,n;
+
+	if(ViewOfType(&cs.v, (float *)*lpdata, (Type == 1 || Type == 4) ? Num : 2 * Num, Type, VIEW_DEFAULT) != 0) return(HA_WM32_Invalid_Arg);
+	if((Start < 0) || (Stop > Num) || (Stop <= Start) || (Width < 0)) return(HA_WM32_Invalid_Arg);
+	cs.Thres = 0.0f;
+	if(Threshold != 0.0f)
+	{
+		// Mean of points Start+1 to Stop-1 over Stop-Start, as ClearScopeData had it
+		if((cs.v.Stride == 1) && !cs.v.Mag) Sum = KernSum(VIEW_PTR(&cs.v, Start + 1), Stop - Start - 1);
+		else for(Sum=0.0,i=Start+1;i<Stop;i++) Sum += ViewGet(&cs.v, i);
+		cs.Thres = (float)(Sum / (Stop - Start) * Threshold);
+	}
+	cs.Thres2 = cs.Thres * cs.Thres;
+	h = Width / 2;
+	n = 0;
+	from = Start;
+	rs = re = -1;
+	for(p=Start;;p=e)
+	{
+		p = ClearFind(&cs, p, Stop, 1);
+		e = (p < Stop) ? ClearFind(&cs, p, Stop, 0) : Stop;
+		a = (p - h > Start) ? p - h : Start;
+		b = (e + h < Stop) ? e + h : Stop;
+		if((p < Stop) && (re >= 0) && (a <= re))
+		{
+			if(b > re) re = b;
+			continue;
+		}
+		// The region before this run is complete
+		if(re >= 0)
+		{
+			ClearZero(&cs.v, from, rs);
+			from = re;
+			if(Regions && (n < MaxRegions))
+			{
+				Regions[2*n] = rs;
+				Regions[2*n+1] = re - rs;
+			}
+			n++;
+		}
+		if(p >= Stop) break;
+		rs = a;
+		re = b;
+	}
+	ClearZero(&cs.v, from, Stop);
+	ClearZero(&cs.v, 0, Start);
+	ClearZero(&cs.v, Stop, Num);
+	return(n);
+}
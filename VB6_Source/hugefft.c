@@ -0,0 +1,704 @@
+/************************************************************************
+*                                                                       *
+*                               HUGEFFT.C                               *
+*                                                                       *
+*		Mixed radix FFT for huge arrays.                            *
+*                                                                       *
+*   A complex transform of M points is a recursive decimation in time  *
+*   over the factors of M, radix 4, 2, 3 and 5 first and then any     *
+*   other prime. Each stage keeps its twiddles in one contiguous table *
+*   so the radix 2 and 4 butterflies can run two points at a time with *
+*   SSE2.                                                               *
+*                                                                       *
+*   A real transform of N points is a complex transform of N/2 points  *
+*   followed by a split pass, and matches the layout of realft: F0 and *
+*   F(N/2) in the first two floats, then re,im pairs.                  *
+*                                                                       *
+*   At FFTPARALLEL complex points and up the transform is cut into     *
+*   enough sub transforms to keep every thread busy, then the          *
+*   butterflies of each stage above them and the split pass are shared *
+*   out over the threads.                                              *
+*                                                                       *
+************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <windows.h>
+#include "icr-2ls.h"
+#include "hugethrd.h"
+#include "hugekern.h"
+#include "hugefft.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define   HUGE_SSE2
+#include <emmintrin.h>
+#endif
+
+#define   MAXPLANS      4
+#define   MAXSTAGES     32
+#define   FFTPARALLEL   0x400000    // complex points, 8M real points
+#define   FFTCHUNK      0x4000
+#define   FFTSUBTASKS   4           // sub transforms per thread
+#define   TWOPI         6.28318530717958647692
+#define   FFT_FINDPEAK  0x100       // internal, magnitudes needed for Peak
+
+typedef struct
+{
+	int     p;                  // radix
+	int     m;                  // length of each sub transform
+	FCPLX   *Tw;                // Tw[(q-1)*m + k] = exp(2 pi i q k / (p m))
+	FCPLX   *Root;              // exp(2 pi i t / p), generic radix only
+}  FFTSTAGE;
+
+struct FFTPLAN
+{
+	int        M;
+	int        NumStages;
+	FFTSTAGE   Stage[MAXSTAGES];
+	FCPLX      *Split;          // exp(2 pi i k / 2M), k = 0..M/2
+	int        MaxRadix;        // largest radix over 5, 0 if none
+	unsigned   Used;
+};
+
+static FFTPLAN   *Plans[MAXPLANS];
+static unsigned  PlanClock = 0;
+
+/************************************************************************
+* Plans                                                                 *
+************************************************************************/
+static void FFTPlanFree(FFTPLAN *p)
+{
+	int   s;
+
+	if(p == NULL) return;
+	for(s=0;s<p->NumStages;s++)
+	{
+		free(p->Stage[s].Tw);
+		free(p->Stage[s].Root);
+	}
+	free(p->Split);
+	free(p);
+}
+
+static void FFTRoots(FCPLX *w, int Num, int Step, int Period)
+{
+	double   a;
+	int      k;
+
+	for(k=0;k<Num;k++)
+	{
+		a = TWOPI * fmod((double)k * Step, (double)Period) / (double)Period;
+		w[k].r = (float)cos(a);
+		w[k].i = (float)sin(a);
+	}
+}
+
+static FFTPLAN *FFTPlanBuild(int M)
+{
+	FFTPLAN    *p;
+	FFTSTAGE   *st;
+	int        n,f,q;
+
+	p = (FFTPLAN *)calloc(1, sizeof(FFTPLAN));
+	if(p == NULL) return(NULL);
+	p->M = M;
+	n = M;
+	f = 4;
+	while(n > 1)
+	{
+		while(n % f)
+		{
+			switch(f)
+			{
+				case 4:  f = 2; break;
+				case 2:  f = 3; break;
+				default: f += 2; break;
+			}
+			if(f * f > n) f = n;
+		}
+		st = &p->Stage[p->NumStages++];
+		st->p = f;
+		st->m = n / f;
+		st->Tw = (FCPLX *)malloc((f - 1) * st->m * sizeof(FCPLX));
+		if(st->Tw == NULL)
+		{
+			FFTPlanFree(p);
+			return(NULL);
+		}
+		for(q=1;q<f;q++) FFTRoots(st->Tw + (q - 1) * st->m, st->m, q, n);
+		if(f > 5)
+		{
+			st->Root = (FCPLX *)malloc(f * sizeof(FCPLX));
+			if(st->Root == NULL)
+			{
+				FFTPlanFree(p);
+				return(NULL);
+			}
+			FFTRoots(st->Root, f, 1, f);
+			if(f > p->MaxRadix) p->MaxRadix = f;
+		}
+		n /= f;
+	}
+	p->Split = (FCPLX *)malloc((M / 2 + 1) * sizeof(FCPLX));
+	if(p->Split == NULL)
+	{
+		FFTPlanFree(p);
+		return(NULL);
+	}
+	FFTRoots(p->Split, M / 2 + 1, 1, 2 * M);
+	return(p);
+}
+
+/************************************************************************
+* FFTGetPlan - Cached plan for an M point complex transform             *
+************************************************************************/
+FFTPLAN *FFTGetPlan(int M)
+{
+	int   i,old;
+
+	if(M < 1) return(NULL);
+	old = 0;
+	for(i=0;i<MAXPLANS;i++)
+	{
+		if(Plans[i] && (Plans[i]->M == M))
+		{
+			Plans[i]->Used = ++PlanClock;
+			return(Plans[i]);
+		}
+		if(Plans[i] == NULL) old = i;
+		else if(Plans[old] && (Plans[i]->Used < Plans[old]->Used)) old = i;
+	}
+	FFTPlanFree(Plans[old]);
+	Plans[old] = FFTPlanBuild(M);
+	if(Plans[old]) Plans[old]->Used = ++PlanClock;
+	return(Plans[old]);
+}
+
+/************************************************************************
+* FFTFreePlans -                                                        *
+************************************************************************/
+void FFTFreePlans(void)
+{
+	int   i;
+
+	for(i=0;i<MAXPLANS;i++)
+	{
+		FFTPlanFree(Plans[i]);
+		Plans[i] = NULL;
+	}
+}
+
+/************************************************************************
+* Butterflies                                                           *
+*                                                                       *
+* Each works on points k0..k1-1 of the m point sub transforms held at   *
+* out, out+m, ... Sign is +1 or -1; -1 conjugates every twiddle.       *
+************************************************************************/
+static FCPLX CMul(FCPLX a, FCPLX w, float s)
+{
+	FCPLX   c;
+
+	c.r = a.r * w.r - a.i * w.i * s;
+	c.i = a.i * w.r + a.r * w.i * s;
+	return(c);
+}
+
+#ifdef HUGE_SSE2
+// Two complex products a*w, sv = (-s, s, -s, s)
+static __m128 CMul2(__m128 a, __m128 w, __m128 sv)
+{
+	__m128  wr,wi,as;
+
+	wr = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2,2,0,0));
+	wi = _mm_mul_ps(_mm_shuffle_ps(w, w, _MM_SHUFFLE(3,3,1,1)), sv);
+	as = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2,3,0,1));
+	return(_mm_add_ps(_mm_mul_ps(a, wr), _mm_mul_ps(as, wi)));
+}
+#endif
+
+static void FFTRadix2(FCPLX *out, const FFTSTAGE *st, float s, int k0, int k1)
+{
+	FCPLX   *o1,t;
+	int     k,m;
+
+	m = st->m;
+	o1 = out + m;
+	k = k0;
+#ifdef HUGE_SSE2
+	{
+		__m128  sv,a0,a1;
+
+		sv = _mm_setr_ps(-s, s, -s, s);
+		for(;k+2<=k1;k+=2)
+		{
+			a0 = _mm_loadu_ps(&out[k].r);
+			a1 = CMul2(_mm_loadu_ps(&o1[k].r), _mm_loadu_ps(&st->Tw[k].r), sv);
+			_mm_storeu_ps(&out[k].r, _mm_add_ps(a0, a1));
+			_mm_storeu_ps(&o1[k].r, _mm_sub_ps(a0, a1));
+		}
+	}
+#endif
+	for(;k<k1;k++)
+	{
+		t = CMul(o1[k], st->Tw[k], s);
+		o1[k].r = out[k].r - t.r;
+		o1[k].i = out[k].i - t.i;
+		out[k].r += t.r;
+		out[k].i += t.i;
+	}
+}
+
+static void FFTRadix4(FCPLX *out, const FFTSTAGE *st, float s, int k0, int k1)
+{
+	const FCPLX  *tw1,*tw2,*tw3;
+	FCPLX        *o1,*o2,*o3;
+	FCPLX        a0,a1,a2,a3,s0,s3,s4,s5;
+	int          k,m;
+
+	m = st->m;
+	o1 = out + m;
+	o2 = out + 2 * m;
+	o3 = out + 3 * m;
+	tw1 = st->Tw;
+	tw2 = st->Tw + m;
+	tw3 = st->Tw + 2 * m;
+	k = k0;
+#ifdef HUGE_SSE2
+	{
+		__m128  sv,v0,v1,v2,v3,t0,t1,t3,t4;
+
+		sv = _mm_setr_ps(-s, s, -s, s);
+		for(;k+2<=k1;k+=2)
+		{
+			v0 = _mm_loadu_ps(&out[k].r);
+			v1 = CMul2(_mm_loadu_ps(&o1[k].r), _mm_loadu_ps(&tw1[k].r), sv);
+			v2 = CMul2(_mm_loadu_ps(&o2[k].r), _mm_loadu_ps(&tw2[k].r), sv);
+			v3 = CMul2(_mm_loadu_ps(&o3[k].r), _mm_loadu_ps(&tw3[k].r), sv);
+			t0 = _mm_add_ps(v0, v2);
+			t1 = _mm_sub_ps(v0, v2);
+			t3 = _mm_add_ps(v1, v3);
+			t4 = _mm_sub_ps(v1, v3);
+			t4 = _mm_mul_ps(_mm_shuffle_ps(t4, t4, _MM_SHUFFLE(2,3,0,1)), sv);
+			_mm_storeu_ps(&out[k].r, _mm_add_ps(t0, t3));
+			_mm_storeu_ps(&o2[k].r, _mm_sub_ps(t0, t3));
+			_mm_storeu_ps(&o1[k].r, _mm_add_ps(t1, t4));
+			_mm_storeu_ps(&o3[k].r, _mm_sub_ps(t1, t4));
+		}
+	}
+#endif
+	for(;k<k1;k++)
+	{
+		a0 = out[k];
+		a1 = CMul(o1[k], tw1[k], s);
+		a2 = CMul(o2[k], tw2[k], s);
+		a3 = CMul(o3[k], tw3[k], s);
+		s0.r = a0.r + a2.r;  s0.i = a0.i + a2.i;
+		s5.r = a0.r - a2.r;  s5.i = a0.i - a2.i;
+		s3.r = a1.r + a3.r;  s3.i = a1.i + a3.i;
+		// s4 = i s (a1 - a3)
+		s4.r = -s * (a1.i - a3.i);
+		s4.i =  s * (a1.r - a3.r);
+		out[k].r = s0.r + s3.r;  out[k].i = s0.i + s3.i;
+		o2[k].r  = s0.r - s3.r;  o2[k].i  = s0.i - s3.i;
+		o1[k].r  = s5.r + s4.r;  o1[k].i  = s5.i + s4.i;
+		o3[k].r  = s5.r - s4.r;  o3[k].i  = s5.i - s4.i;
+	}
+}
+
+static void FFTRadix3(FCPLX *out, const FFTSTAGE *st, float s, int k0, int k1)
+{
+	FCPLX   *o1,*o2,a1,a2,b,d;
+	float   h;
+	int     k,m;
+
+	m = st->m;
+	o1 = out + m;
+	o2 = out + 2 * m;
+	h = s * 0.866025403784438647f;
+	for(k=k0;k<k1;k++)
+	{
+		a1 = CMul(o1[k], st->Tw[k], s);
+		a2 = CMul(o2[k], st->Tw[m + k], s);
+		b.r = out[k].r - 0.5f * (a1.r + a2.r);
+		b.i = out[k].i - 0.5f * (a1.i + a2.i);
+		d.r = -h * (a1.i - a2.i);
+		d.i =  h * (a1.r - a2.r);
+		out[k].r += a1.r + a2.r;
+		out[k].i += a1.i + a2.i;
+		o1[k].r = b.r + d.r;  o1[k].i = b.i + d.i;
+		o2[k].r = b.r - d.r;  o2[k].i = b.i - d.i;
+	}
+}
+
+static void FFTRadix5(FCPLX *out, const FFTSTAGE *st, float s, int k0, int k1)
+{
+	FCPLX   *o[5],x[5],s7,s8,s9,s10,c1,c2,d1,d2;
+	float   ar,ai,br,bi;
+	int     k,m,q;
+
+	m = st->m;
+	for(q=0;q<5;q++) o[q] = out + q * m;
+	ar = 0.309016994374947424f;
+	ai = s * 0.951056516295153572f;
+	br = -0.809016994374947424f;
+	bi = s * 0.587785252292473129f;
+	for(k=k0;k<k1;k++)
+	{
+		x[0] = out[k];
+		for(q=1;q<5;q++) x[q] = CMul(o[q][k], st->Tw[(q - 1) * m + k], s);
+		s7.r = x[1].r + x[4].r;   s7.i = x[1].i + x[4].i;
+		s10.r = x[1].r - x[4].r;  s10.i = x[1].i - x[4].i;
+		s8.r = x[2].r + x[3].r;   s8.i = x[2].i + x[3].i;
+		s9.r = x[2].r - x[3].r;   s9.i = x[2].i - x[3].i;
+		c1.r = x[0].r + ar * s7.r + br * s8.r;
+		c1.i = x[0].i + ar * s7.i + br * s8.i;
+		c2.r = x[0].r + br * s7.r + ar * s8.r;
+		c2.i = x[0].i + br * s7.i + ar * s8.i;
+		// d1 = i (ai s10 + bi s9), d2 = i (bi s10 - ai s9)
+		d1.r = -(ai * s10.i + bi * s9.i);
+		d1.i =   ai * s10.r + bi * s9.r;
+		d2.r = -(bi * s10.i - ai * s9.i);
+		d2.i =   bi * s10.r - ai * s9.r;
+		o[0][k].r = x[0].r + s7.r + s8.r;
+		o[0][k].i = x[0].i + s7.i + s8.i;
+		o[1][k].r = c1.r + d1.r;  o[1][k].i = c1.i + d1.i;
+		o[4][k].r = c1.r - d1.r;  o[4][k].i = c1.i - d1.i;
+		o[2][k].r = c2.r + d2.r;  o[2][k].i = c2.i + d2.i;
+		o[3][k].r = c2.r - d2.r;  o[3][k].i = c2.i - d2.i;
+	}
+}
+
+// x is scratch for p points
+static void FFTRadixN(FCPLX *out, const FFTSTAGE *st, float s, int k0, int k1, FCPLX *x)
+{
+	FCPLX   w;
+	double  sr,si;
+	int     k,m,p,q,r,t;
+
+	m = st->m;
+	p = st->p;
+	for(k=k0;k<k1;k++)
+	{
+		x[0] = out[k];
+		for(q=1;q<p;q++) x[q] = CMul(out[q * m + k], st->Tw[(q - 1) * m + k], s);
+		for(r=0;r<p;r++)
+		{
+			sr = si = 0.0;
+			for(q=0,t=0;q<p;q++)
+			{
+				w = st->Root[t];
+				sr += (double)x[q].r * w.r - (double)x[q].i * w.i * s;
+				si += (double)x[q].i * w.r + (double)x[q].r * w.i * s;
+				t += r;
+				if(t >= p) t -= p;
+			}
+			out[r * m + k].r = (float)sr;
+			out[r * m + k].i = (float)si;
+		}
+	}
+}
+
+static void FFTButterfly(FCPLX *out, const FFTSTAGE *st, float s, int k0, int k1, FCPLX *x)
+{
+	switch(st->p)
+	{
+		case 2:  FFTRadix2(out, st, s, k0, k1); break;
+		case 3:  FFTRadix3(out, st, s, k0, k1); break;
+		case 4:  FFTRadix4(out, st, s, k0, k1); break;
+		case 5:  FFTRadix5(out, st, s, k0, k1); break;
+		default: FFTRadixN(out, st, s, k0, k1, x); break;
+	}
+}
+
+/************************************************************************
+* FFTWork - Transform of the points in[0], in[istride], ... into out    *
+*                                                                       *
+* x is scratch for Plan->MaxRadix points.                               *
+************************************************************************/
+static void FFTWork(FCPLX *out, const FCPLX *in, int istride, const FFTPLAN *Plan, int stage, float s, FCPLX *x)
+{
+	const FFTSTAGE  *st;
+	int             j;
+
+	st = &Plan->Stage[stage];
+	if(st->m == 1)
+	{
+		for(j=0;j<st->p;j++) out[j] = in[j * istride];
+	}
+	else
+	{
+		for(j=0;j<st->p;j++)
+			FFTWork(out + j * st->m, in + j * istride, istride * st->p, Plan, stage + 1, s, x);
+	}
+	FFTButterfly(out, st, s, 0, st->m, x);
+}
+
+typedef struct
+{
+	const FFTPLAN  *Plan;
+	FCPLX          *out;
+	const FCPLX    *in;
+	float          *data;
+	FCPLX          *Scratch;        // Plan->MaxRadix points per thread
+	float          s;
+	int            Depth;           // stage of the sub transforms
+	int            Stage;           // stage whose butterflies are shared out
+	int            Flags;
+	float          Peak[MAXTHREADS];
+}  FFTARGS;
+
+static FCPLX *FFTScratch(const FFTARGS *fa, int Thread)
+{
+	return(fa->Scratch ? fa->Scratch + Thread * fa->Plan->MaxRadix : NULL);
+}
+
+// Sub transforms j = Start..Stop-1 at stage Depth. Output j is the block
+// j*m of out; its input starts at j with the digits of j in the radices
+// above it reversed, and steps by the product of those radices.
+static void FFTSubTask(void *Arg, int Start, int Stop, int Thread)
+{
+	FFTARGS          *fa;
+	const FFTSTAGE   *st;
+	int              j,r,d,m,in,w,stride;
+
+	fa = (FFTARGS *)Arg;
+	st = fa->Plan->Stage;
+	m = st[fa->Depth - 1].m;
+	for(stride=1,d=0;d<fa->Depth;d++) stride *= st[d].p;
+	for(j=Start;j<Stop;j++)
+	{
+		for(in=0,w=stride,r=j,d=fa->Depth-1;d>=0;d--)
+		{
+			w /= st[d].p;
+			in += (r % st[d].p) * w;
+			r /= st[d].p;
+		}
+		FFTWork(fa->out + j * m, fa->in + in, stride, fa->Plan, fa->Depth, fa->s, FFTScratch(fa, Thread));
+	}
+}
+
+// Butterflies i = Start..Stop-1 of stage Stage, i = block * m + k
+static void FFTButterflyTask(void *Arg, int Start, int Stop, int Thread)
+{
+	FFTARGS          *fa;
+	const FFTSTAGE   *st;
+	int              i,k0,k1,m;
+
+	fa = (FFTARGS *)Arg;
+	st = &fa->Plan->Stage[fa->Stage];
+	m = st->m;
+	for(i=Start;i<Stop;i+=k1-k0)
+	{
+		k0 = i % m;
+		k1 = (m < k0 + Stop - i) ? m : k0 + Stop - i;
+		FFTButterfly(fa->out + (i / m) * st->p * m, st, fa->s, k0, k1, FFTScratch(fa, Thread));
+	}
+}
+
+/************************************************************************
+* FFTComplex - Out of place, out[k] = sum in[j] exp(Sign 2 pi i jk/M)   *
+*                                                                       *
+* Returns HA_OUTOFMEMORY, before out is touched, if the scratch for a  *
+* radix over 5 cannot be had.                                           *
+************************************************************************/
+int FFTComplex(FFTPLAN *Plan, FCPLX *out, const FCPLX *in, int Sign)
+{
+	FFTARGS    fa;
+	int        nt,P;
+
+	fa.Plan = Plan;
+	fa.out = out;
+	fa.in = in;
+	fa.s = (Sign < 0) ? -1.0f : 1.0f;
+	if(Plan->NumStages == 0)
+	{
+		out[0] = in[0];
+		return(0);
+	}
+	nt = 1;
+	if((Plan->M >= FFTPARALLEL) && (Plan->NumStages >= 2)) nt = HugeNumThreads();
+	if(nt > MAXTHREADS) nt = MAXTHREADS;
+	fa.Scratch = NULL;
+	if(Plan->MaxRadix > 0)
+	{
+		fa.Scratch = (FCPLX *)malloc(nt * Plan->MaxRadix * sizeof(FCPLX));
+		if(fa.Scratch == NULL) return(HA_OUTOFMEMORY);
+	}
+	if(nt < 2)
+	{
+		FFTWork(out, in, 1, Plan, 0, fa.s, fa.Scratch);
+		free(fa.Scratch);
+		return(0);
+	}
+	// Deep enough for FFTSUBTASKS sub transforms per thread, leaving at least one stage below
+	P = 1;
+	fa.Depth = 0;
+	do
+	{
+		P *= Plan->Stage[fa.Depth++].p;
+	}  while((fa.Depth < Plan->NumStages - 1) && (P < FFTSUBTASKS * nt));
+	HugeParallel(FFTSubTask, &fa, P, 1, nt);
+	for(fa.Stage=fa.Depth-1;fa.Stage>=0;fa.Stage--)
+		HugeParallel(FFTButterflyTask, &fa, Plan->M / Plan->Stage[fa.Stage].p, FFTCHUNK, nt);
+	free(fa.Scratch);
+	return(0);
+}
+
+/************************************************************************
+* Real transforms                                                       *
+************************************************************************/
+static void FFTStore(FFTARGS *fa, int k, float re, float im, float *peak)
+{
+	float   mag;
+
+	if(fa->Flags & (FFT_MAGNITUDE | FFT_NORMPEAK | FFT_FINDPEAK))
+	{
+		mag = (float)sqrt((double)re * re + (double)im * im);
+		if(mag > *peak) *peak = mag;
+		if(fa->Flags & FFT_MAGNITUDE)
+		{
+			re = mag;
+			im = 0.0f;
+		}
+	}
+	fa->data[2 * k] = re;
+	fa->data[2 * k + 1] = im;
+}
+
+// Forward split, points k = Start..Stop-1 of the packed spectrum and their mirrors
+static void FFTSplitTask(void *Arg, int Start, int Stop, int Thread)
+{
+	FFTARGS      *fa;
+	const FCPLX  *Z,*w;
+	FCPLX        e,o,t,zk,zc;
+	float        peak;
+	int          k,M;
+
+	fa = (FFTARGS *)Arg;
+	Z = fa->in;
+	w = fa->Plan->Split;
+	M = fa->Plan->M;
+	peak = 0.0f;
+	if(Start == 0)
+	{
+		// F0 and F(N/2) share the first pair
+		FFTStore(fa, 0, Z[0].r + Z[0].i, Z[0].r - Z[0].i, &peak);
+		Start = 1;
+	}
+	for(k=Start;k<Stop;k++)
+	{
+		zk = Z[k];
+		zc.r = Z[M - k].r;
+		zc.i = -Z[M - k].i;
+		e.r = 0.5f * (zk.r + zc.r);
+		e.i = 0.5f * (zk.i + zc.i);
+		// o = (zk - zc) / 2i
+		o.r =  0.5f * (zk.i - zc.i);
+		o.i = -0.5f * (zk.r - zc.r);
+		t.r = w[k].r * o.r - w[k].i * o.i;
+		t.i = w[k].r * o.i + w[k].i * o.r;
+		FFTStore(fa, k, e.r + t.r, e.i + t.i, &peak);
+		if(M - k != k) FFTStore(fa, M - k, e.r - t.r, t.i - e.i, &peak);
+	}
+	fa->Peak[Thread] = peak;
+}
+
+// Inverse split, rebuilds the half length complex input
+static void FFTUnsplitTask(void *Arg, int Start, int Stop, int Thread)
+{
+	FFTARGS      *fa;
+	const FCPLX  *F,*w;
+	FCPLX        *Z,e,o,t,fk,fc;
+	int          k,M;
+
+	fa = (FFTARGS *)Arg;
+	F = (const FCPLX *)fa->data;
+	Z = fa->out;
+	w = fa->Plan->Split;
+	M = fa->Plan->M;
+	if(Start == 0)
+	{
+		Z[0].r = 0.5f * (F[0].r + F[0].i);
+		Z[0].i = 0.5f * (F[0].r - F[0].i);
+		Start = 1;
+	}
+	for(k=Start;k<Stop;k++)
+	{
+		fk = F[k];
+		fc.r = F[M - k].r;
+		fc.i = -F[M - k].i;
+		e.r = 0.5f * (fk.r + fc.r);
+		e.i = 0.5f * (fk.i + fc.i);
+		t.r = 0.5f * (fk.r - fc.r);
+		t.i = 0.5f * (fk.i - fc.i);
+		// o = conj(w) t
+		o.r = w[k].r * t.r + w[k].i * t.i;
+		o.i = w[k].r * t.i - w[k].i * t.r;
+		Z[k].r = e.r - o.i;
+		Z[k].i = e.i + o.r;
+		if(M - k != k)
+		{
+			Z[M - k].r = e.r + o.i;
+			Z[M - k].i = o.r - e.i;
+		}
+	}
+}
+
+/************************************************************************
+* FFTReal -                                                             *
+*                                                                       *
+* In place transform of Num real points, Num even, in the realft       *
+* layout. Sign 1 is the forward transform, -1 the inverse, which        *
+* returns Num/2 times the original data as realft does. Flags apply    *
+* to the forward transform; Peak, if not NULL, gets the largest         *
+* magnitude before any scaling.                                         *
+************************************************************************/
+int FFTReal(float *data, int Num, int Sign, int Flags, float *Peak)
+{
+	FFTPLAN    *Plan;
+	FFTARGS    fa;
+	FCPLX      *buf;
+	float      peak;
+	int        M,nt,i,iStat;
+
+	if((Num < 2) || (Num & 1)) return(HA_WM32_Invalid_Arg);
+	M = Num / 2;
+	Plan = FFTGetPlan(M);
+	if(Plan == NULL) return(HA_OUTOFMEMORY);
+	buf = (FCPLX *)malloc(M * sizeof(FCPLX));
+	if(buf == NULL) return(HA_OUTOFMEMORY);
+	fa.Plan = Plan;
+	fa.data = data;
+	if(Sign >= 0)
+	{
+		iStat = FFTComplex(Plan, buf, (const FCPLX *)data, 1);
+		if(iStat != 0)
+		{
+			free(buf);
+			return(iStat);
+		}
+		fa.in = buf;
+		fa.Flags = Flags;
+		if(Peak) fa.Flags |= FFT_FINDPEAK;
+		nt = HugeParallel(FFTSplitTask, &fa, M / 2 + 1, (M >= FFTPARALLEL) ? FFTCHUNK : M, 0);
+		peak = 0.0f;
+		for(i=0;i<nt;i++) if(fa.Peak[i] > peak) peak = fa.Peak[i];
+		if(Peak) *Peak = peak;
+		if((Flags & FFT_NORMPEAK) && (peak > 0.0f)) KernAffine(data, Num, 1.0f / peak, 0.0f);
+	}
+	else
+	{
+		fa.out = buf;
+		HugeParallel(FFTUnsplitTask, &fa, M / 2 + 1, (M >= FFTPARALLEL) ? FFTCHUNK : M, 0);
+		iStat = FFTComplex(Plan, (FCPLX *)data, buf, -1);
+		if(iStat != 0)
+		{
+			free(buf);
+			return(iStat);
+		}
+	}
+	free(buf);
+	return(0);
+}
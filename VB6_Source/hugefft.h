@@ -0,0 +1,26 @@
+//
+// hugefft.h
+//
+//		FFT engine for ICR-2LS huge arrays. Transforms use the
+//		Numerical Recipes conventions: the forward transform has a
+//		positive exponent and transforms are not normalized.
+//
+//		Plans are cached per size. FFTGetPlan is not thread safe, get
+//		the plan before handing work to other threads.
+//
+
+typedef struct
+{
+	float   r,i;
+}  FCPLX;
+
+typedef struct FFTPLAN  FFTPLAN;
+
+// Flags for FFTReal, forward transforms only
+#define  FFT_MAGNITUDE   1      // store |F| in the real part, 0 in the imaginary
+#define  FFT_NORMPEAK    2      // scale so the largest magnitude is 1
+
+FFTPLAN *FFTGetPlan(int M);
+int      FFTComplex(FFTPLAN *Plan, FCPLX *out, const FCPLX *in, int Sign);
+int      FFTReal(float *data, int Num, int Sign, int Flags, float *Peak);
+void     FFTFreePlans(void);
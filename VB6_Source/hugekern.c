@@ -0,0 +1,332 @@
+/************************************************************************
+*                                                                       *
+*                               HUGEKERN.C                              *
+*                                                                       *
+*		Reduction and transform primitives for huge arrays.         *
+*                                                                       *
+*   Arrays below KERNCHUNK elements per thread run on the calling      *
+*   thread. Reductions keep one partial result per slice and combine   *
+*   them at the end.                                                    *
+*                                                                       *
+************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include "icr-2ls.h"
+#include "hugethrd.h"
+#include "hugekern.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define   HUGE_SSE2
+#include <emmintrin.h>
+#endif
+
+// Smallest number of elements worth handing to another thread
+#define   KERNCHUNK   0x10000
+
+typedef struct
+{
+	float    *x;
+	const float *cx;
+	void     *dst;
+	const void *src;
+	double   *y;
+	float    a,b;
+	int      Offset;
+	float    Min[MAXTHREADS];
+	float    Max[MAXTHREADS];
+	double   Sum[MAXTHREADS];
+}  KERNARGS;
+
+static void KernMinMaxSlice(void *Arg, int Start, int Stop, int Thread)
+{
+	KERNARGS   *ka;
+	const float *x;
+	float      lmin,lmax;
+	int        i;
+
+	ka = (KERNARGS *)Arg;
+	x = ka->cx;
+	i = Start;
+	lmin = lmax = x[Start];
+#ifdef HUGE_SSE2
+	if(Stop - Start >= 8)
+	{
+		__m128  vmin,vmax,v;
+		float   t[4];
+
+		vmin = vmax = _mm_loadu_ps(&x[i]);
+		for(i=Start+4;i+4<=Stop;i+=4)
+		{
+			v = _mm_loadu_ps(&x[i]);
+			vmin = _mm_min_ps(vmin, v);
+			vmax = _mm_max_ps(vmax, v);
+		}
+		_mm_storeu_ps(t, vmin);
+		lmin = t[0];
+		if(t[1] < lmin) lmin = t[1];
+		if(t[2] < lmin) lmin = t[2];
+		if(t[3] < lmin) lmin = t[3];
+		_mm_storeu_ps(t, vmax);
+		lmax = t[0];
+		if(t[1] > lmax) lmax = t[1];
+		if(t[2] > lmax) lmax = t[2];
+		if(t[3] > lmax) lmax = t[3];
+	}
+#endif
+	for(;i<Stop;i++)
+	{
+		if(x[i] > lmax) lmax = x[i];
+		if(x[i] < lmin) lmin = x[i];
+	}
+	ka->Min[Thread] = lmin;
+	ka->Max[Thread] = lmax;
+}
+
+/************************************************************************
+* KernMinMax -                                                          *
+************************************************************************/
+void KernMinMax(const float *x, int n, float *Min, float *Max)
+{
+	KERNARGS   ka;
+	int        i,nt;
+
+	if(n <= 0) return;
+	ka.cx = x;
+	nt = HugeParallel(KernMinMaxSlice, &ka, n, KERNCHUNK, 0);
+	*Min = ka.Min[0];
+	*Max = ka.Max[0];
+	for(i=1;i<nt;i++)
+	{
+		if(ka.Min[i] < *Min) *Min = ka.Min[i];
+		if(ka.Max[i] > *Max) *Max = ka.Max[i];
+	}
+}
+
+static void KernSumSlice(void *Arg, int Start, int Stop, int Thread)
+{
+	KERNARGS   *ka;
+	const float *x;
+	double     s;
+	int        i;
+
+	ka = (KERNARGS *)Arg;
+	x = ka->cx;
+	i = Start;
+	s = 0.0;
+#ifdef HUGE_SSE2
+	{
+		__m128d  s0,s1;
+		__m128   v;
+		double   t[2];
+
+		s0 = s1 = _mm_setzero_pd();
+		for(;i+4<=Stop;i+=4)
+		{
+			v = _mm_loadu_ps(&x[i]);
+			s0 = _mm_add_pd(s0, _mm_cvtps_pd(v));
+			s1 = _mm_add_pd(s1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+		}
+		_mm_storeu_pd(t, _mm_add_pd(s0, s1));
+		s = t[0] + t[1];
+	}
+#endif
+	for(;i<Stop;i++) s += x[i];
+	ka->Sum[Thread] = s;
+}
+
+/************************************************************************
+* KernSum - Sum accumulated in double                                   *
+************************************************************************/
+double KernSum(const float *x, int n)
+{
+	KERNARGS   ka;
+	double     s;
+	int        i,nt;
+
+	if(n <= 0) return(0.0);
+	ka.cx = x;
+	nt = HugeParallel(KernSumSlice, &ka, n, KERNCHUNK, 0);
+	s = 0.0;
+	for(i=0;i<nt;i++) s += ka.Sum[i];
+	return(s);
+}
+
+static void KernAffineSlice(void *Arg, int Start, int Stop, int Thread)
+{
+	KERNARGS   *ka;
+	float      *x;
+	int        i;
+
+	ka = (KERNARGS *)Arg;
+	x = ka->x;
+	i = Start;
+#ifdef HUGE_SSE2
+	{
+		__m128  va,vb;
+
+		va = _mm_set1_ps(ka->a);
+		vb = _mm_set1_ps(ka->b);
+		for(;i+4<=Stop;i+=4)
+			_mm_storeu_ps(&x[i], _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&x[i]), va), vb));
+	}
+#endif
+	for(;i<Stop;i++) x[i] = x[i] * ka->a + ka->b;
+}
+
+/************************************************************************
+* KernAffine - x = x * Scale + Offset                                   *
+************************************************************************/
+void KernAffine(float *x, int n, float Scale, float Offset)
+{
+	KERNARGS   ka;
+
+	ka.x = x;
+	ka.a = Scale;
+	ka.b = Offset;
+	HugeParallel(KernAffineSlice, &ka, n, KERNCHUNK, 0);
+}
+
+static void KernFillSlice(void *Arg, int Start, int Stop, int Thread)
+{
+	KERNARGS      *ka;
+	float         *x;
+	unsigned int  bits;
+	int           i;
+
+	ka = (KERNARGS *)Arg;
+	x = ka->x;
+	// memset only when every bit is 0, so -0.0f is stored as given
+	memcpy(&bits, &ka->a, sizeof(bits));
+	if(bits == 0)
+	{
+		memset(&x[Start], 0, (Stop - Start) * sizeof(float));
+		return;
+	}
+	for(i=Start;i<Stop;i++) x[i] = ka->a;
+}
+
+/************************************************************************
+* KernFill -                                                            *
+************************************************************************/
+void KernFill(float *x, int n, float Val)
+{
+	KERNARGS   ka;
+
+	ka.x = x;
+	ka.a = Val;
+	HugeParallel(KernFillSlice, &ka, n, KERNCHUNK, 0);
+}
+
+static void KernCopySlice(void *Arg, int Start, int Stop, int Thread)
+{
+	KERNARGS   *ka;
+
+	ka = (KERNARGS *)Arg;
+	memcpy((char *)ka->dst + Start, (const char *)ka->src + Start, Stop - Start);
+}
+
+/************************************************************************
+* KernCopy - Byte copy, overlapping ranges are moved on one thread      *
+************************************************************************/
+void KernCopy(void *dst, const void *src, int nBytes)
+{
+	KERNARGS   ka;
+
+	if(nBytes <= 0) return;
+	if(((char *)dst < (const char *)src + nBytes) && ((const char *)src < (char *)dst + nBytes))
+	{
+		memmove(dst, src, nBytes);
+		return;
+	}
+	ka.dst = dst;
+	ka.src = src;
+	HugeParallel(KernCopySlice, &ka, nBytes, KERNCHUNK * sizeof(float), 0);
+}
+
+static void KernToDoubleSlice(void *Arg, int Start, int Stop, int Thread)
+{
+	KERNARGS   *ka;
+	const float *x;
+	double     *y;
+	int        i;
+
+	ka = (KERNARGS *)Arg;
+	x = ka->cx;
+	y = ka->y;
+	i = Start;
+#ifdef HUGE_SSE2
+	for(;i+4<=Stop;i+=4)
+	{
+		__m128  v;
+
+		v = _mm_loadu_ps(&x[i]);
+		_mm_storeu_pd(&y[i], _mm_cvtps_pd(v));
+		_mm_storeu_pd(&y[i+2], _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+	}
+#endif
+	for(;i<Stop;i++) y[i] = x[i];
+}
+
+/************************************************************************
+* KernToDouble -                                                        *
+************************************************************************/
+void KernToDouble(const float *x, double *y, int n)
+{
+	KERNARGS   ka;
+
+	ka.cx = x;
+	ka.y = y;
+	HugeParallel(KernToDoubleSlice, &ka, n, KERNCHUNK, 0);
+}
+
+static void KernShortSlice(void *Arg, int Start, int Stop, int Thread)
+{
+	KERNARGS    *ka;
+	float       *data;
+	short int   *iptr;
+	int         i;
+
+	ka = (KERNARGS *)Arg;
+	data = ka->x + ka->Offset;
+	iptr = (short int *)ka->x + ka->Offset;
+	i = Start;
+#ifdef HUGE_SSE2
+	for(;i+8<=Stop;i+=8)
+	{
+		__m128i  v;
+
+		v = _mm_loadu_si128((__m128i *)&iptr[i]);
+		_mm_storeu_ps(&data[i],   _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)));
+		_mm_storeu_ps(&data[i+4], _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)));
+	}
+#endif
+	for(;i<Stop;i++) data[i] = iptr[i];
+}
+
+/************************************************************************
+* KernShortToFloat -                                                    *
+*                                                                       *
+* Widens n shorts at the start of data into n floats in place. Floats   *
+* (n+1)/2..n-1 land beyond every short not yet read, so that part is    *
+* done in parallel and the rest the same way, halving each time.       *
+************************************************************************/
+void KernShortToFloat(float *data, int n)
+{
+	KERNARGS    ka;
+	short int   *iptr;
+	int         half,i;
+
+	ka.x = data;
+	while(n > KERNCHUNK)
+	{
+		half = (n + 1) / 2;
+		ka.Offset = half;
+		HugeParallel(KernShortSlice, &ka, n - half, KERNCHUNK, 0);
+		n = half;
+	}
+	iptr = (short int *)data;
+	for(i=n-1;i>=0;i--) data[i] = iptr[i];
+}
@@ -0,0 +1,14 @@
+//
+// hugekern.h
+//
+//		Whole array primitives for the ICR-2LS huge array dll.
+//		Each is one pass over memory, split across threads for large
+//		arrays and using SSE2 when the compiler targets it.
+//
+void   KernMinMax(const float *x, int n, float *Min, float *Max);
+double KernSum(const float *x, int n);
+void   KernAffine(float *x, int n, float Scale, float Offset);
+void   KernFill(float *x, int n, float Val);
+void   KernCopy(void *dst, const void *src, int nBytes);
+void   KernToDouble(const float *x, double *y, int n);
+void   KernShortToFloat(float *data, int n);
@@ -0,0 +1,138 @@
+/************************************************************************
+*                                                                       *
+*                               HUGEPREP.C                              *
+*                                                                       *
+*		Transient preparation ahead of the FFT.                     *
+*                                                                       *
+*   Rotation, windowing and zero filling are applied in one pass that  *
+*   reads each point of the transient once and writes the FFT input.  *
+*   When the length changes or the data is rotated the output goes to *
+*   a new huge array that replaces the old one.                        *
+*                                                                       *
+*   Only the ramp windows are applied here. The apodization windows    *
+*   stay with the Window routine so their shapes are unchanged.        *
+*                                                                       *
+************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include "icr-2ls.h"
+#include "hugethrd.h"
+#include "hugeprep.h"
+
+#define   PREPCHUNK      0x10000
+
+typedef struct
+{
+	const float  *src;
+	float        *dst;
+	int          Num;
+	int          Rotate;
+	int          Window;
+	int          Start,Stop,A,B;
+}  PREPARGS;
+
+// Weight of output point i
+static float PrepRamp(const PREPARGS *pa, int i)
+{
+	if(pa->Window == WIN_RAMPHOLD)
+	{
+		if(i <= pa->A) return((pa->A > pa->Start) ? 1.0f - (float)(i - pa->Start) / (float)(pa->A - pa->Start) : 0.0f);
+		if(i < pa->B) return(0.0f);
+		return((pa->Stop > pa->B) ? (float)(i - pa->B) / (float)(pa->Stop - pa->B) : 1.0f);
+	}
+	// WIN_APEX
+	if(i < pa->A) return((float)(i - pa->Start) / (float)(pa->A - pa->Start));
+	return((pa->Stop > pa->A) ? (float)(pa->Stop - i) / (float)(pa->Stop - pa->A) : 1.0f);
+}
+
+// Nearest of the current end and boundary b, when b falls after i
+static int PrepNext(int i, int b, int end)
+{
+	return(((b > i) && (b < end)) ? b : end);
+}
+
+static void PrepSlice(void *Arg, int Start, int Stop, int Thread)
+{
+	PREPARGS     *pa;
+	const float  *src;
+	float        *dst;
+	int          i,s,end;
+
+	pa = (PREPARGS *)Arg;
+	src = pa->src;
+	dst = pa->dst;
+	i = Start;
+	while(i < Stop)
+	{
+		// Each run has one source of weights and does not wrap
+		end = PrepNext(i, pa->Num - pa->Rotate, Stop);
+		end = PrepNext(i, pa->Num, end);
+		end = PrepNext(i, pa->Start, end);
+		end = PrepNext(i, pa->Stop, end);
+		if(i >= pa->Num)
+		{
+			memset(&dst[i], 0, (end - i) * sizeof(float));
+			i = end;
+			continue;
+		}
+		s = i + pa->Rotate;
+		if(s >= pa->Num) s -= pa->Num;
+		if((pa->Window != WIN_NONE) && (i >= pa->Start) && (i < pa->Stop))
+		{
+			for(;i<end;i++,s++) dst[i] = src[s] * PrepRamp(pa, i);
+			continue;
+		}
+		if(dst != src) memcpy(&dst[i], &src[s], (end - i) * sizeof(float));
+		i = end;
+	}
+}
+
+/************************************************************************
+* HugePreFFT -                                                          *
+*                                                                       *
+* Makes the FFT input from Num points of a transient. Point Rotate     *
+* becomes point 0, the window is applied to output points Start to     *
+* Stop-1, which may run on into the zero fill, and the result is zero  *
+* filled to NumOut points. A and B are the corners of the WIN_RAMPHOLD *
+* and WIN_APEX windows. lpdata is replaced by a new huge array when    *
+* NumOut differs from Num or the data is rotated.                      *
+************************************************************************/
+int pascal _export HugePreFFT(int *lpdata, int Num, int NumOut, int Rotate, int Window, int Start, int Stop, int A, int B)
+{
+	PREPARGS   pa;
+	int        newdata,iStat;
+
+	if((Num < 1) || (NumOut < Num)) return(HA_WM32_Invalid_Arg);
+	if((Window != WIN_NONE) && (Window != WIN_RAMPHOLD) && (Window != WIN_APEX)) return(HA_WM32_Invalid_Arg);
+	Rotate %= Num;
+	if(Rotate < 0) Rotate += Num;
+	if(Start < 0) Start = 0;
+	if(Stop > NumOut) Stop = NumOut;
+	if(Stop <= Start) Window = WIN_NONE;
+	if((Window == WIN_APEX) && ((A <= Start) || (A > Stop))) return(HA_WM32_Invalid_Arg);
+	if((Window == WIN_RAMPHOLD) && ((A < Start) || (B < A) || (Stop < B))) return(HA_WM32_Invalid_Arg);
+	pa.src = (const float *)*lpdata;
+	pa.Num = Num;
+	pa.Rotate = Rotate;
+	pa.Window = Window;
+	pa.Start = Start;
+	pa.Stop = Stop;
+	pa.A = A;
+	pa.B = B;
+	if((NumOut == Num) && (Rotate == 0))
+	{
+		pa.dst = (float *)*lpdata;
+		if(Window != WIN_NONE) HugeParallel(PrepSlice, &pa, NumOut, PREPCHUNK, 0);
+		return(0);
+	}
+	iStat = HugeDim(&newdata, sizeof(float), NumOut);
+	if(iStat != 0) return(HA_OUTOFMEMORY);
+	pa.dst = (float *)newdata;
+	HugeParallel(PrepSlice, &pa, NumOut, PREPCHUNK, 0);
+	HugeErase(*lpdata);
+	*lpdata = newdata;
+	return(0);
+}
@@ -0,0 +1,9 @@
+//
+// hugeprep.h
+//
+//		Window codes for HugePreFFT. 1 to 5 are left to the
+//		apodization numbers used by the Window routine.
+//
+#define  WIN_NONE       0
+#define  WIN_RAMPHOLD   6       // ramp down Start..A, zero A..B, ramp up B..Stop
+#define  WIN_APEX       7       // ramp up Start..A, ramp down A..Stop
@@ -0,0 +1,249 @@
+/************************************************************************
+*                                                                       *
+*                              HUGERESAMP.C                             *
+*                                                                       *
+*		Resampling of spectra onto a common X grid.                 *
+*                                                                       *
+*   The grid is walked in increasing X alongside the source, so each   *
+*   grid point costs O(1) instead of a scan of the source. The source  *
+*   X may run either way; a descending source is read through a        *
+*   reversed view. Grid points outside the source take the end value.  *
+*                                                                       *
+************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include <windows.h>
+#include "icr-2ls.h"
+#include "hugethrd.h"
+#include "hugeview.h"
+#include "hugeresamp.h"
+
+#define   RESAMPCHUNK    0x1000
+#define   PI             3.14159265358979323846
+
+#define   XAT(v,i)   (*VIEW_PTR(&(v)->x, i))
+#define   YAT(v,i)   (*VIEW_PTR(&(v)->y, i))
+
+typedef struct
+{
+	HUGEVIEW     x,y;               // source, x increasing
+	const float  *Grid;
+	int          NumGrid;
+	int          Descending;        // grid runs from high to low X
+	float        *Out;
+	int          Method;
+}  RESAMPARGS;
+
+/************************************************************************
+* ResampFind - Last source point at or below q, 0 to Num-2              *
+************************************************************************/
+static int ResampFind(const RESAMPARGS *ra, float q)
+{
+	int   lo,hi,mid;
+
+	lo = 0;
+	hi = ra->x.Num - 2;
+	while(lo < hi)
+	{
+		mid = (lo + hi + 1) / 2;
+		if(XAT(ra, mid) <= q) lo = mid;
+		else hi = mid - 1;
+	}
+	return(lo);
+}
+
+static double ResampSlope(const RESAMPARGS *ra, int i)
+{
+	int   a,b;
+
+	a = (i > 0) ? i - 1 : i;
+	b = (i < ra->x.Num - 1) ? i + 1 : i;
+	if(XAT(ra, b) == XAT(ra, a)) return(0.0);
+	return((YAT(ra, b) - YAT(ra, a)) / ((double)XAT(ra, b) - XAT(ra, a)));
+}
+
+static double ResampSinc(double x)
+{
+	if(fabs(x) < 1e-9) return(1.0);
+	return(sin(PI * x) / (PI * x));
+}
+
+/************************************************************************
+* ResampPoint - Value at q, which lies between source points j and j+1  *
+************************************************************************/
+static float ResampPoint(const RESAMPARGS *ra, int j, float q)
+{
+	double   x0,x1,y0,y1,h,t,t2,t3,u,w,sw,sy;
+	int      k,k0,k1;
+
+	x0 = XAT(ra, j);
+	x1 = XAT(ra, j+1);
+	y0 = YAT(ra, j);
+	y1 = YAT(ra, j+1);
+	h = x1 - x0;
+	if(h <= 0.0) return((float)y1);
+	t = (q - x0) / h;
+	switch(ra->Method)
+	{
+		case RESAMP_CUBIC:
+			t2 = t * t;
+			t3 = t2 * t;
+			return((float)((2.0*t3 - 3.0*t2 + 1.0) * y0 + (t3 - 2.0*t2 + t) * h * ResampSlope(ra, j)
+						+ (-2.0*t3 + 3.0*t2) * y1 + (t3 - t2) * h * ResampSlope(ra, j+1)));
+		case RESAMP_SINC:
+			u = j + t;
+			k0 = j - RESAMP_SINCLOBES + 1;
+			k1 = j + RESAMP_SINCLOBES;
+			if(k0 < 0) k0 = 0;
+			if(k1 > ra->x.Num - 1) k1 = ra->x.Num - 1;
+			sw = sy = 0.0;
+			for(k=k0;k<=k1;k++)
+			{
+				w = ResampSinc(u - k) * ResampSinc((u - k) / RESAMP_SINCLOBES);
+				sw += w;
+				sy += w * YAT(ra, k);
+			}
+			return((sw != 0.0) ? (float)(sy / sw) : (float)y0);
+	}
+	return((float)(y0 + (y1 - y0) * t));
+}
+
+/************************************************************************
+* ResampSlice - Grid points Start..Stop-1 in increasing X               *
+************************************************************************/
+static void ResampSlice(RESAMPARGS *ra, int Start, int Stop)
+{
+	float   q,xlo,xhi;
+	int     k,g,j,n;
+
+	n = ra->x.Num;
+	xlo = XAT(ra, 0);
+	xhi = XAT(ra, n-1);
+	j = -1;
+	for(k=Start;k<Stop;k++)
+	{
+		g = ra->Descending ? ra->NumGrid - 1 - k : k;
+		q = ra->Grid[g];
+		if((n == 1) || (q <= xlo)) ra->Out[g] = YAT(ra, 0);
+		else if(q >= xhi) ra->Out[g] = YAT(ra, n-1);
+		else
+		{
+			if(j < 0) j = ResampFind(ra, q);
+			while((j < n - 2) && (XAT(ra, j+1) < q)) j++;
+			ra->Out[g] = ResampPoint(ra, j, q);
+		}
+	}
+}
+
+static void ResampTask(void *Arg, int Start, int Stop, int Thread)
+{
+	ResampSlice((RESAMPARGS *)Arg, Start, Stop);
+}
+
+// Sets up the source views, reversed if X runs downward
+static int ResampSource(RESAMPARGS *ra, float *X, float *Y, int XStride, int YStride, int Num)
+{
+	if(Num < 1) return(HA_WM32_Invalid_Arg);
+	ViewStrided(&ra->x, X, Num, XStride);
+	ViewStrided(&ra->y, Y, Num, YStride);
+	if(X[0] > *VIEW_PTR(&ra->x, Num-1))
+	{
+		ViewReverse(&ra->x);
+		ViewReverse(&ra->y);
+	}
+	return(0);
+}
+
+/************************************************************************
+* HugeResample -                                                        *
+*                                                                       *
+* Interpolates Num source points X,Y at the NumGrid points of Grid into *
+* Out. X and Grid must each be sorted, in either direction.            *
+************************************************************************/
+int pascal _export HugeResample(float *X, float *Y, int Num, float *Grid, int NumGrid, float *Out, int Method)
+{
+	RESAMPARGS   ra;
+	int          iStat;
+
+	if((NumGrid < 0) || (Method < RESAMP_LINEAR) || (Method > RESAMP_SINC)) return(HA_WM32_Invalid_Arg);
+	iStat = ResampSource(&ra, X, Y, 1, 1, Num);
+	if(iStat != 0) return(iStat);
+	ra.Grid = Grid;
+	ra.NumGrid = NumGrid;
+	ra.Descending = (NumGrid > 1) && (Grid[0] > Grid[NumGrid-1]);
+	ra.Out = Out;
+	ra.Method = Method;
+	HugeParallel(ResampTask, &ra, NumGrid, RESAMPCHUNK, 0);
+	return(0);
+}
+
+typedef struct
+{
+	int          *lpX,*lpY,*Nums;
+	const float  *Grid;
+	int          NumGrid;
+	float        *Out;
+	int          Method;
+	int          iStat;
+}  RESAMPBATCH;
+
+static void ResampBatchTask(void *Arg, int Start, int Stop, int Thread)
+{
+	RESAMPBATCH  *rb;
+	RESAMPARGS   ra;
+	float        *Y;
+	int          i,iStat;
+
+	rb = (RESAMPBATCH *)Arg;
+	for(i=Start;i<Stop;i++)
+	{
+		if(rb->Nums[i] == 0) continue;
+		Y = (float *)rb->lpY[i];
+		if(rb->lpX[i] == 0) iStat = ResampSource(&ra, Y, Y + 1, 2, 2, rb->Nums[i]);
+		else iStat = ResampSource(&ra, (float *)rb->lpX[i], Y, 1, 1, rb->Nums[i]);
+		if(iStat != 0)
+		{
+			rb->iStat = iStat;
+			continue;
+		}
+		ra.Grid = rb->Grid;
+		ra.NumGrid = rb->NumGrid;
+		ra.Descending = (rb->NumGrid > 1) && (rb->Grid[0] > rb->Grid[rb->NumGrid-1]);
+		ra.Out = rb->Out + (size_t)i * rb->NumGrid;
+		ra.Method = rb->Method;
+		ResampSlice(&ra, 0, rb->NumGrid);
+	}
+}
+
+/************************************************************************
+* HugeResampleBatch -                                                   *
+*                                                                       *
+* Resamples NumSpectra spectra onto one grid, a spectrum per thread.    *
+* lpX and lpY hold huge array addresses and Nums the point counts; an  *
+* lpX of 0 means lpY holds X,Y pairs. Row i of the huge array lpOut,    *
+* NumSpectra * NumGrid floats, gets spectrum i; rows with a count of   *
+* 0 are left as they are.                                               *
+************************************************************************/
+int pascal _export HugeResampleBatch(int *lpX, int *lpY, int *Nums, int NumSpectra, float *Grid, int NumGrid, int *lpOut, int Method)
+{
+	RESAMPBATCH   rb;
+
+	if((NumSpectra < 0) || (NumGrid < 0)) return(HA_WM32_Invalid_Arg);
+	if((Method < RESAMP_LINEAR) || (Method > RESAMP_SINC)) return(HA_WM32_Invalid_Arg);
+	// The output size in bytes has to fit an int
+	if((NumGrid > 0) && (NumSpectra > INT_MAX / (int)sizeof(float) / NumGrid)) return(HA_WM32_Invalid_Arg);
+	if(GetUbound(*lpOut) < NumSpectra * NumGrid * (int)sizeof(float)) return(HA_BADARRAY);
+	rb.lpX = lpX;
+	rb.lpY = lpY;
+	rb.Nums = Nums;
+	rb.Grid = Grid;
+	rb.NumGrid = NumGrid;
+	rb.Out = (float *)*lpOut;
+	rb.Method = Method;
+	rb.iStat = 0;
+	HugeParallel(ResampBatchTask, &rb, NumSpectra, 1, 0);
+	return(rb.iStat);
+}
@@ -0,0 +1,9 @@
+//
+// hugeresamp.h
+//
+//		Interpolation methods for HugeResample and HugeResampleBatch.
+//
+#define  RESAMP_LINEAR     0
+#define  RESAMP_CUBIC      1       // cubic Hermite, central difference slopes
+#define  RESAMP_SINC       2       // Lanczos windowed sinc in point index
+#define  RESAMP_SINCLOBES  4
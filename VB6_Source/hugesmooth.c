@@ -0,0 +1,240 @@
+/************************************************************************
+*                                                                       *
+*                              HUGESMOOTH.C                             *
+*                                                                       *
+*		Boxcar and Savitzky-Golay smoothing of huge arrays in place. *
+*                                                                       *
+*   The range is split into one chunk per thread. Before any chunk is  *
+*   written the original points just outside each chunk are saved, and *
+*   inside a chunk the points still needed after they are overwritten  *
+*   are kept in a ring buffer, so no copy of the array is made.        *
+*                                                                       *
+************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <windows.h>
+#include "icr-2ls.h"
+#include "hugethrd.h"
+#include "hugeview.h"
+
+#define   SMOOTHMIN      0x8000     // fewest points per chunk
+
+typedef struct
+{
+	HUGEVIEW       v;               // the range being smoothed
+	int            Left,Right;      // points read before and after each output
+	int            NumChunks;
+	float          *Halo;           // Left + Right saved points per chunk
+	int            Width;
+	const double   *c;              // Savitzky-Golay coefficients, NULL for boxcar
+	int            NumCoef;
+	int            Fail;
+}  SMOOTHARGS;
+
+typedef struct
+{
+	const SMOOTHARGS  *sa;
+	int               a,b;          // chunk is points a..b-1
+	const float       *left,*right;
+	float             *ring;
+	int               mask;
+	int               next;         // next chunk point to load into the ring
+}  SMOOTHCHUNK;
+
+static int ChunkStart(const SMOOTHARGS *sa, int c)
+{
+	return((int)(((double)sa->v.Num * c) / sa->NumChunks));
+}
+
+// Original value of point p, which must be within the reach of the
+// current output point
+static float SmoothOrig(const SMOOTHCHUNK *sc, int p)
+{
+	if(p < sc->a) return(sc->left[p - (sc->a - sc->sa->Left)]);
+	if(p >= sc->b) return(sc->right[p - sc->b]);
+	return(sc->ring[p & sc->mask]);
+}
+
+// Loads the chunk points up to p into the ring before they are written
+static void SmoothLoad(SMOOTHCHUNK *sc, int p)
+{
+	if(p >= sc->b) p = sc->b - 1;
+	for(;sc->next<=p;sc->next++) sc->ring[sc->next & sc->mask] = ViewGet(&sc->sa->v, sc->next);
+}
+
+/************************************************************************
+* Boxcar - point i becomes the mean of points i-Width to i+Width-1,    *
+*          clipped to the range less its last point. A point with no    *
+*          points left in its window is not changed.                    *
+************************************************************************/
+static void SmoothBoxCar(SMOOTHCHUNK *sc)
+{
+	const SMOOTHARGS  *sa;
+	double            sum;
+	int               i,p,lo,hi,nlo,nhi,last;
+
+	sa = sc->sa;
+	last = sa->v.Num - 1;
+	lo = sc->a - sa->Width;
+	hi = sc->a + sa->Width;
+	if(lo < 0) lo = 0;
+	if(hi > last) hi = last;
+	SmoothLoad(sc, hi - 1);
+	sum = 0.0;
+	for(p=lo;p<hi;p++) sum += SmoothOrig(sc, p);
+	for(i=sc->a;i<sc->b;i++)
+	{
+		nlo = i - sa->Width;
+		nhi = i + sa->Width;
+		if(nlo < 0) nlo = 0;
+		if(nhi > last) nhi = last;
+		SmoothLoad(sc, nhi - 1);
+		for(p=hi;p<nhi;p++) sum += SmoothOrig(sc, p);
+		for(p=lo;p<nlo;p++) sum -= SmoothOrig(sc, p);
+		lo = nlo;
+		hi = nhi;
+		SmoothLoad(sc, i);
+		if(hi > lo) ViewSet(&sa->v, i, (float)(sum / (hi - lo)));
+	}
+}
+
+/************************************************************************
+* Savitzky-Golay - points with a full window only                       *
+************************************************************************/
+static void SmoothSavGol(SMOOTHCHUNK *sc)
+{
+	const SMOOTHARGS  *sa;
+	double            sum;
+	int               i,j,ls,le,last;
+
+	sa = sc->sa;
+	last = sa->v.Num - 1;
+	for(i=sc->a;i<sc->b;i++)
+	{
+		ls = i - sa->Width;
+		le = i + sa->Width + 1;
+		if(ls < 0) ls = 0;
+		if(le > last) le = last;
+		SmoothLoad(sc, le - 1);
+		SmoothLoad(sc, i);
+		if(le - ls != sa->NumCoef) continue;
+		sum = 0.0;
+		for(j=0;j<sa->NumCoef;j++) sum += sa->c[j] * SmoothOrig(sc, ls + j);
+		ViewSet(&sa->v, i, (float)sum);
+	}
+}
+
+static void SmoothTask(void *Arg, int Start, int Stop, int Thread)
+{
+	SMOOTHARGS    *sa;
+	SMOOTHCHUNK   sc;
+	int           c,size;
+
+	sa = (SMOOTHARGS *)Arg;
+	for(size=1;size<sa->Left+sa->Right+2;size<<=1);
+	sc.sa = sa;
+	sc.mask = size - 1;
+	sc.ring = (float *)malloc(size * sizeof(float));
+	if(sc.ring == NULL)
+	{
+		sa->Fail = 1;
+		return;
+	}
+	for(c=Start;c<Stop;c++)
+	{
+		sc.a = ChunkStart(sa, c);
+		sc.b = ChunkStart(sa, c + 1);
+		sc.left = sa->Halo + c * (sa->Left + sa->Right);
+		sc.right = sc.left + sa->Left;
+		sc.next = sc.a;
+		if(sa->c) SmoothSavGol(&sc);
+		else SmoothBoxCar(&sc);
+	}
+	free(sc.ring);
+}
+
+/************************************************************************
+* Smooth - Saves the chunk halos, then smooths every chunk              *
+************************************************************************/
+static int Smooth(SMOOTHARGS *sa)
+{
+	int   c,p,a,b,nt;
+	float *h;
+
+	nt = HugeNumThreads();
+	sa->NumChunks = sa->v.Num / SMOOTHMIN;
+	if(sa->NumChunks > nt) sa->NumChunks = nt;
+	if(sa->NumChunks < 1) sa->NumChunks = 1;
+	sa->Halo = (float *)malloc(sa->NumChunks * (sa->Left + sa->Right) * sizeof(float) + sizeof(float));
+	if(sa->Halo == NULL) return(HA_OUTOFMEMORY);
+	for(c=0;c<sa->NumChunks;c++)
+	{
+		a = ChunkStart(sa, c);
+		b = ChunkStart(sa, c + 1);
+		h = sa->Halo + c * (sa->Left + sa->Right);
+		for(p=a-sa->Left;p<a;p++,h++) *h = (p >= 0) ? ViewGet(&sa->v, p) : 0.0f;
+		for(p=b;p<b+sa->Right;p++,h++) *h = (p < sa->v.Num) ? ViewGet(&sa->v, p) : 0.0f;
+	}
+	sa->Fail = 0;
+	HugeParallel(SmoothTask, sa, sa->NumChunks, 1, sa->NumChunks);
+	free(sa->Halo);
+	return(sa->Fail ? HA_OUTOFMEMORY : 0);
+}
+
+// View of points Start..Stop-1 of the plotted channel
+static int SmoothView(SMOOTHARGS *sa, int *lpdata, int Type, int Start, int Stop)
+{
+	HUGEVIEW   all;
+
+	if(ViewOfType(&all, (float *)*lpdata, GetUbound(*lpdata) / sizeof(float), Type, VIEW_DEFAULT) != 0) return(HA_WM32_Invalid_Arg);
+	if((Start < 0) || (Stop <= Start)) return(HA_WM32_Invalid_Arg);
+	ViewSub(&sa->v, &all, Start, Stop - Start);
+	return(0);
+}
+
+/************************************************************************
+* HugeBoxCar -                                                          *
+*                                                                       *
+* Replaces points Start to Stop-1 of the plotted channel with the mean *
+* of the points from Width before to Width-1 after, within the range.  *
+* Type is the plot type; complex data is smoothed as magnitude.        *
+************************************************************************/
+int pascal _export HugeBoxCar(int *lpdata, int Type, int Start, int Stop, int Width)
+{
+	SMOOTHARGS   sa;
+	int          iStat;
+
+	if(Width < 1) return(HA_WM32_Invalid_Arg);
+	iStat = SmoothView(&sa, lpdata, Type, Start, Stop);
+	if(iStat != 0) return(iStat);
+	sa.Width = Width;
+	sa.Left = Width;
+	sa.Right = Width;
+	sa.c = NULL;
+	sa.NumCoef = 0;
+	return(Smooth(&sa));
+}
+
+/************************************************************************
+* HugeSavGol -                                                          *
+*                                                                       *
+* Convolves points Start to Stop-1 of the plotted channel with the     *
+* NumCoef Savitzky-Golay coefficients c, centered on each point. Only  *
+* points whose whole window lies within the range are changed.         *
+************************************************************************/
+int pascal _export HugeSavGol(int *lpdata, int Type, int Start, int Stop, double *c, int NumCoef)
+{
+	SMOOTHARGS   sa;
+	int          iStat;
+
+	if(NumCoef < 1) return(HA_WM32_Invalid_Arg);
+	iStat = SmoothView(&sa, lpdata, Type, Start, Stop);
+	if(iStat != 0) return(iStat);
+	sa.Width = (NumCoef - 1) / 2;
+	sa.Left = sa.Width;
+	sa.Right = sa.Width + 1;
+	sa.c = c;
+	sa.NumCoef = NumCoef;
+	return(Smooth(&sa));
+}
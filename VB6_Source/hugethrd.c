@@ -0,0 +1,113 @@
+/************************************************************************
+*                                                                       *
+*                               HUGETHRD.C                              *
+*                                                                       *
+*		Splits huge array work across worker threads.               *
+*                                                                       *
+************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <windows.h>
+#include <winbase.h>
+#include "icr-2ls.h"
+#include "hugethrd.h"
+
+typedef struct
+{
+	HUGETASK  Task;
+	void      *Arg;
+	int       Start;
+	int       Stop;
+	int       Thread;
+}  HUGESLICE;
+
+// Number of threads to use, 0 = one per processor
+static int   ThreadCount = 0;
+
+static DWORD WINAPI HugeSliceProc(LPVOID lpParam)
+{
+	HUGESLICE   *hs;
+
+	hs = (HUGESLICE *)lpParam;
+	hs->Task(hs->Arg, hs->Start, hs->Stop, hs->Thread);
+	return(0);
+}
+
+/************************************************************************
+* HugeNumThreads - Returns the number of threads to use by default      *
+************************************************************************/
+int HugeNumThreads(void)
+{
+	SYSTEM_INFO   si;
+	int           n;
+
+	n = ThreadCount;
+	if(n <= 0)
+	{
+		GetSystemInfo(&si);
+		n = (int)si.dwNumberOfProcessors;
+	}
+	if(n < 1) n = 1;
+	if(n > MAXTHREADS) n = MAXTHREADS;
+	return(n);
+}
+
+/************************************************************************
+* HugeSetThreads - Sets the number of worker threads, 0 = automatic.    *
+*                  Returns the number that will actually be used.       *
+************************************************************************/
+int pascal _export HugeSetThreads(int Num)
+{
+	if(Num < 0) Num = 0;
+	ThreadCount = Num;
+	return(HugeNumThreads());
+}
+
+/************************************************************************
+* HugeParallel -                                                        *
+*                                                                       *
+* Calls Task over [0,Num) split into one contiguous slice per thread.  *
+* No slice is made smaller than MinChunk, so small jobs run on the     *
+* calling thread. NumThreads <= 0 uses the HugeSetThreads setting.     *
+* Returns the number of slices used.                                    *
+************************************************************************/
+int HugeParallel(HUGETASK Task, void *Arg, int Num, int MinChunk, int NumThreads)
+{
+	HUGESLICE   hs[MAXTHREADS];
+	HANDLE      ht[MAXTHREADS];
+	DWORD       id;
+	int         i,n,started;
+
+	if(Num <= 0) return(0);
+	n = NumThreads;
+	if(n <= 0) n = HugeNumThreads();
+	if(n > MAXTHREADS) n = MAXTHREADS;
+	if(MinChunk < 1) MinChunk = 1;
+	if(n > Num / MinChunk) n = Num / MinChunk;
+	if(n <= 1)
+	{
+		Task(Arg, 0, Num, 0);
+		return(1);
+	}
+	for(i=0;i<n;i++)
+	{
+		hs[i].Task   = Task;
+		hs[i].Arg    = Arg;
+		hs[i].Start  = (int)(((double)Num * i) / n);
+		hs[i].Stop   = (int)(((double)Num * (i+1)) / n);
+		hs[i].Thread = i;
+	}
+	// Slice 0 runs on this thread, the rest get their own
+	started = 0;
+	for(i=1;i<n;i++)
+	{
+		ht[started] = CreateThread(NULL, 0, HugeSliceProc, &hs[i], 0, &id);
+		if(ht[started] == NULL) HugeSliceProc(&hs[i]);
+		else started++;
+	}
+	HugeSliceProc(&hs[0]);
+	if(started > 0) WaitForMultipleObjects(started, ht, TRUE, INFINITE);
+	for(i=0;i<started;i++) CloseHandle(ht[i]);
+	return(n);
+}
@@ -0,0 +1,14 @@
+//
+// hugethrd.h
+//
+//		Work splitting support for the ICR-2LS huge array dll.
+//		A task is called once per thread with a contiguous [Start,Stop)
+//		slice of the index range.
+//
+#define MAXTHREADS   64
+
+typedef void (*HUGETASK)(void *Arg, int Start, int Stop, int Thread);
+
+int  HugeParallel(HUGETASK Task, void *Arg, int Num, int MinChunk, int NumThreads);
+int  HugeNumThreads(void);
+int  pascal _export HugeSetThreads(int Num);
@@ -0,0 +1,206 @@
+/************************************************************************
+*                                                                       *
+*                               HUGEVIEW.C                              *
+*                                                                       *
+*		Strided, reversed and projected views of huge arrays.       *
+*                                                                       *
+*   Time data is one float per point, X,Y data and complex data are    *
+*   interleaved pairs. A view hides the layout so a filter or          *
+*   decimator written against HUGEVIEW works on any channel in place.  *
+*                                                                       *
+************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "hugeview.h"
+
+/************************************************************************
+* ViewStrided -                                                         *
+************************************************************************/
+void ViewStrided(HUGEVIEW *v, float *Base, int Num, int Stride)
+{
+	v->Base = Base;
+	v->Num = (Num < 0) ? 0 : Num;
+	v->Stride = Stride;
+	v->Mag = 0;
+}
+
+/************************************************************************
+* ViewOfType -                                                          *
+*                                                                       *
+* Builds the view of one channel of a plot's data, using the plot     *
+* Type codes; 1 and 4 are time data, 5 is X,Y pairs, anything else is   *
+* complex. NumFloats is the size of the array in floats.               *
+************************************************************************/
+int ViewOfType(HUGEVIEW *v, float *data, int NumFloats, int Type, int Channel)
+{
+	if((Type == 1) || (Type == 4))
+	{
+		if((Channel != VIEW_DEFAULT) && (Channel != VIEW_REAL)) return(-1);
+		ViewStrided(v, data, NumFloats, 1);
+		return(0);
+	}
+	switch(Channel)
+	{
+		case VIEW_REAL:
+			ViewStrided(v, data, NumFloats / 2, 2);
+			break;
+		case VIEW_IMAG:
+			ViewStrided(v, data + 1, NumFloats / 2, 2);
+			break;
+		case VIEW_DEFAULT:
+		case VIEW_MAG:
+			if(Type == 5)
+			{
+				if(Channel == VIEW_MAG) return(-1);
+				ViewStrided(v, data + 1, NumFloats / 2, 2);
+				break;
+			}
+			ViewStrided(v, data, NumFloats / 2, 2);
+			v->Mag = 1;
+			break;
+		default:
+			return(-1);
+	}
+	return(0);
+}
+
+/************************************************************************
+* ViewSub - Elements Start..Start+Num-1 of src, clipped to src          *
+************************************************************************/
+int ViewSub(HUGEVIEW *dst, const HUGEVIEW *src, int Start, int Num)
+{
+	if(Start < 0)
+	{
+		Num += Start;
+		Start = 0;
+	}
+	if(Start > src->Num) Start = src->Num;
+	if(Num > src->Num - Start) Num = src->Num - Start;
+	if(Num < 0) Num = 0;
+	dst->Base = VIEW_PTR(src, Start);
+	dst->Num = Num;
+	dst->Stride = src->Stride;
+	dst->Mag = src->Mag;
+	return(Num);
+}
+
+/************************************************************************
+* ViewReverse -                                                         *
+************************************************************************/
+void ViewReverse(HUGEVIEW *v)
+{
+	if(v->Num > 0) v->Base = VIEW_PTR(v, v->Num - 1);
+	v->Stride = -v->Stride;
+}
+
+/************************************************************************
+* ViewGet -                                                             *
+************************************************************************/
+float ViewGet(const HUGEVIEW *v, int i)
+{
+	float   *p;
+
+	p = VIEW_PTR(v, i);
+	if(v->Mag) return((float)sqrt((double)p[0] * p[0] + (double)p[1] * p[1]));
+	return(*p);
+}
+
+/************************************************************************
+* ViewSet - A magnitude view stores Val as a real value                 *
+************************************************************************/
+void ViewSet(const HUGEVIEW *v, int i, float Val)
+{
+	float   *p;
+
+	p = VIEW_PTR(v, i);
+	p[0] = Val;
+	if(v->Mag) p[1] = 0.0f;
+}
+
+/************************************************************************
+* ViewGather - Copy the view into a contiguous buffer                   *
+************************************************************************/
+void ViewGather(const HUGEVIEW *v, float *dst)
+{
+	float   *p;
+	int     i;
+
+	p = v->Base;
+	if(v->Mag)
+	{
+		for(i=0;i<v->Num;i++,p+=v->Stride)
+			dst[i] = (float)sqrt((double)p[0] * p[0] + (double)p[1] * p[1]);
+		return;
+	}
+	for(i=0;i<v->Num;i++,p+=v->Stride) dst[i] = *p;
+}
+
+/************************************************************************
+* ViewScatter - Copy a contiguous buffer into the view                  *
+************************************************************************/
+void ViewScatter(const HUGEVIEW *v, const float *src)
+{
+	float   *p;
+	int     i;
+
+	p = v->Base;
+	if(v->Mag)
+	{
+		for(i=0;i<v->Num;i++,p+=v->Stride)
+		{
+			p[0] = src[i];
+			p[1] = 0.0f;
+		}
+		return;
+	}
+	for(i=0;i<v->Num;i++,p+=v->Stride) *p = src[i];
+}
+
+/************************************************************************
+* ViewDecimate -                                                        *
+*                                                                       *
+* Reduces each group of Skip elements to one value and widens          *
+* Max and Min to cover the values written. Returns the number written. *
+************************************************************************/
+int ViewDecimate(const HUGEVIEW *v, float *fVals, int Skip, int Mode, float *Max, float *Min)
+{
+	float   lmax,lmin,temp;
+	int     li,j,n,Stop,LastMax = -1;
+
+	if(Skip < 1) Skip = 1;
+	n = 0;
+	for(li=0;li<v->Num;li+=Skip)
+	{
+		Stop = li + Skip;
+		if(Stop > v->Num) Stop = v->Num;
+		lmax = lmin = ViewGet(v, li);
+		if(Mode != DECIM_COMB)
+		{
+			for(j=li+1;j<Stop;j++)
+			{
+				temp = ViewGet(v, j);
+				if(temp > lmax) lmax = temp;
+				if(temp < lmin) lmin = temp;
+			}
+		}
+		switch(Mode)
+		{
+			case DECIM_MIN:
+				fVals[n] = lmin;
+				break;
+			case DECIM_MAXMIN:
+				fVals[n] = LastMax ? lmax : lmin;
+				LastMax = !LastMax;
+				break;
+			default:
+				fVals[n] = lmax;
+				break;
+		}
+		if(fVals[n] > *Max) *Max = fVals[n];
+		if(fVals[n] < *Min) *Min = fVals[n];
+		n++;
+	}
+	return(n);
+}
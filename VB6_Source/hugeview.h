@@ -0,0 +1,41 @@
+//
+// hugeview.h
+//
+//		Typed views over ICR-2LS huge arrays. A view addresses Num
+//		floats from Base, Stride floats apart; a negative stride walks
+//		the data backwards. Magnitude views read |re + i im| from each
+//		interleaved pair. Nothing is copied to build or narrow a view.
+//
+#include <stddef.h>
+
+// Channels, for ViewOfType
+#define  VIEW_DEFAULT   0       // time: value, X,Y: Y, complex: magnitude
+#define  VIEW_REAL      1       // real part, or X of X,Y pairs
+#define  VIEW_IMAG      2       // imaginary part, or Y of X,Y pairs
+#define  VIEW_MAG       3       // magnitude of complex data
+
+// Decimation modes, for ViewDecimate
+#define  DECIM_COMB     0       // first point of each group
+#define  DECIM_MAX      1
+#define  DECIM_MIN      2
+#define  DECIM_MAXMIN   3       // alternate max and min
+
+typedef struct
+{
+	float   *Base;              // element 0
+	int     Num;                // number of elements
+	int     Stride;             // floats between elements
+	int     Mag;                // nonzero, elements are pair magnitudes
+}  HUGEVIEW;
+
+#define  VIEW_PTR(v,i)  ((v)->Base + (ptrdiff_t)(i) * (v)->Stride)
+
+void  ViewStrided(HUGEVIEW *v, float *Base, int Num, int Stride);
+int   ViewOfType(HUGEVIEW *v, float *data, int NumFloats, int Type, int Channel);
+int   ViewSub(HUGEVIEW *dst, const HUGEVIEW *src, int Start, int Num);
+void  ViewReverse(HUGEVIEW *v);
+float ViewGet(const HUGEVIEW *v, int i);
+void  ViewSet(const HUGEVIEW *v, int i, float Val);
+void  ViewGather(const HUGEVIEW *v, float *dst);
+void  ViewScatter(const HUGEVIEW *v, const float *src);
+int   ViewDecimate(const HUGEVIEW *v, float *fVals, int Skip, int Mode, float *Max, float *Min);
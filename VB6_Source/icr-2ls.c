@@ -22,6 +22,10 @@
 #include <dos.h>
 #include "icr-2ls.h"
 #include "matrix.h"
+#include "hugethrd.h"
+#include "hugekern.h"
+#include "hugeview.h"
+#include "hugefft.h"
 
 // Create an array to hold memory handels...
 #define   MAXHANDEL   100
@@ -86,6 +90,8 @@ BOOL WINAPI DllEntryPoint( HINSTANCE hinstDll,
 					 MemHandels[i].handle = MemHandels[i].address = -1;
 				 }
 			 }
+			 MWLatticeFree(-1);
+			 FFTFreePlans();
 			 break;
 	 }
 	 return 1;
@@ -240,12 +246,7 @@ int pascal _export SetHugeEl(int *lpdata,int recsize, int element, BYTE *buffer)
 
 void pascal _export CopyMem(char *src, char *dest, int nCount)
 {
-	int   i;
-
-	for(i=0;i<nCount;i++)
-	{
-		dest[i]=src[i];
-	}
+	KernCopy(dest, src, nCount);
 }
 
 /********************************************************************
@@ -267,11 +268,7 @@ int pascal _export HugeFill(int *lpdata,int recsize, int element,int num, BYTE *
 ********************************************************************/
 int pascal _export HugeZero(int *lpdata,int Num)
 {
-	float   *data;
-	int     i;
-
-	data = (float *)*lpdata;
-	for(i=0;i<Num;i++) data[i] = 0.0;
+	KernFill((float *)*lpdata, Num, 0.0f);
 	return(0);
 }
 
@@ -280,15 +277,14 @@ int pascal _export HugeZero(int *lpdata,int Num)
 ********************************************************************/
 int pascal _export HugeZeroRange(int *lpdata,int Start,int Num)
 {
-	float        *data;
-	int          i;
 	unsigned int li;
 
 	if(Start<0) return(0);
 	if(Num<0) return(0);
-	data = (float *)*lpdata;
 	li=GetUbound(*lpdata)/4;
-	for(i=Start;i<Start+Num;i++) if(i<li) data[i] = 0.0;
+	if((unsigned int)Start >= li) return(0);
+	if((unsigned int)(Start+Num) > li) Num = li - Start;
+	KernFill((float *)*lpdata + Start, Num, 0.0f);
 	return(0);
 }
 
@@ -548,20 +544,35 @@ for(i=0;i<Size;i++) data[i+element]=fVals[i];
 ************************************************************************/
 int pascal _export HugeReverseOrder(int *lpdata, int Num, int Size)
 {
-	BYTE   *ch;
-	BYTE   *chtmp;
-	int    i;
+	BYTE   *lo,*hi,ch;
+	float  *flo,*fhi,temp;
+	int    i,j;
 
-	ch = (BYTE *)*lpdata;
-	chtmp = (BYTE *)calloc(Size,sizeof(BYTE));
-	if(!chtmp) return(-1);
+	if(Size <= 0) return(-1);
+	if(Size == sizeof(float))
+	{
+		// Swap in place from both ends
+		flo = (float *)*lpdata;
+		fhi = flo + Num - 1;
+		for(;flo<fhi;flo++,fhi--)
+		{
+			temp = *flo;
+			*flo = *fhi;
+			*fhi = temp;
+		}
+		return(0);
+	}
 	for(i=0;i<Num/2;i++)
 	{
-		memcpy(chtmp,&ch[i*Size], Size);
-		memcpy(&ch[i*Size],&ch[(Num-i-1)*Size],Size);
-		memcpy(&ch[(Num-i-1)*Size],chtmp,Size);
+		lo = (BYTE *)*lpdata + i*Size;
+		hi = (BYTE *)*lpdata + (Num-i-1)*Size;
+		for(j=0;j<Size;j++)
+		{
+			ch = lo[j];
+			lo[j] = hi[j];
+			hi[j] = ch;
+		}
 	}
-   free(chtmp);
 	return(0);
 }
 /************************************************************************
@@ -717,120 +728,81 @@ int pascal _export HugeSaveFloat(int *lpdata, int Num, int hLoadFile,int pos)
 ************************************************************************/
 int pascal _export HugeExtract(int *lpdata, float *fVals, float *max, float *min, int Start, int Stop, int maxN, int option)
 {
-	float                lmin,lmax;
-	float                temp,temp1,temp2;
-	int                  skip,li;
-	int                  i,j,LastMax = -1;
+	HUGEVIEW             all,v;
+	float                *data;
+	int                  skip,NumFloats,Mode;
 
 	skip = ((Stop-Start)/maxN) + 1L;
-	i = 0;
-	if(option==6)
-	{
-		GetHugeEl(lpdata,sizeof(float),Start*2 -1,(BYTE *)&temp);
-		*min=*max=temp;
-	}
-	if((option==1)||(option==2)||(option==5))
-	{
-		GetHugeEl(lpdata,sizeof(float),Start,(BYTE *)&temp);
-		*min=*max=temp;
-	}
-	if((option==3)||(option==4))
-	{
-		if(GetHugeEl(lpdata,sizeof(float),2L*Start,(BYTE FAR *)&temp)!=0) temp=0.0;
-		if(GetHugeEl(lpdata,sizeof(float),2L*Start+1L,(BYTE FAR *)&temp1)!=0) temp1=0.0;
-		*min=*max=sqrt((double)temp*(double)temp + (double)temp1*(double)temp1);
-	}
-	for(li=Start;li<Stop;li+=skip)
+	data = (float *)*lpdata;
+	NumFloats = GetUbound(*lpdata) / sizeof(float);
+	switch(option)
 	{
-		switch(option)
-		{
-			case 6:
-				GetHugeEl(lpdata,sizeof(float),li*2 + 1,(BYTE *)&temp);
-				lmax  = temp;
-				for(j=0;j<skip;j++)
-				{
-					if(((long)j+li) >= Stop) break;
-					GetHugeEl(lpdata,sizeof(float),(li+j)*2 + 1,(BYTE *)&temp);
-					if(temp > lmax) lmax = temp;
-				}
-				fVals[i] = lmax;
-				break;
-			case 7:
-				GetHugeEl(lpdata,sizeof(float),li*2,(BYTE *)&fVals[i]);
-				break;
-			case 5:
-				GetHugeEl(lpdata,sizeof(float),li,(BYTE *)&temp);
-				lmax  = temp;
-				for(j=0;j<skip;j++)
-				{
-					if(((long)j+li) >= Stop) break;
-					GetHugeEl(lpdata,sizeof(float),li+j,(BYTE *)&temp);
-					if(temp > lmax) lmax = temp;
-				}
-				fVals[i] = lmax;
-				break;
-			case 1:
-				GetHugeEl(lpdata,sizeof(float),li,(BYTE *)&fVals[i]);
-				break;
-			case 2:
-				GetHugeEl(lpdata,sizeof(float),li,(BYTE *)&temp);
-				lmax =lmin = temp;
-				for(j=0;j<skip;j++)
-				{
-					if(((long)j+li) >= Stop) break;
-					GetHugeEl(lpdata,sizeof(float),li+j,(BYTE *)&temp);
-					if(temp > lmax) lmax = temp;
-					if(temp < lmin) lmin = temp;
-				}
-				if(LastMax)
-				{
-					fVals[i] = lmax;
-					LastMax = 0;
-				}
-				else
-				{
-					fVals[i] = lmin;
-					LastMax = -1;
-				}
-				break;
-			case 3:
-				if(GetHugeEl(lpdata,sizeof(float),2L*li,(BYTE FAR *)&temp1)!=0)temp1=0.0;
-				if(GetHugeEl(lpdata,sizeof(float),2L*li+1L,(BYTE FAR *)&temp2)!=0)temp2=0.0;
-				lmax =sqrt((double)temp1*(double)temp1 + (double)temp2*(double)temp2);
-				for(j=0;j<skip;j++)
-				{
-					if(((long)j+li) >= Stop) break;
-					if(GetHugeEl(lpdata,sizeof(float),2L*(li+j),(BYTE FAR *)&temp1)!=0)temp1=0.0;
-					if(GetHugeEl(lpdata,sizeof(float),2L*(li+j)+1L,(BYTE FAR *)&temp2)!=0)temp2=0.0;
-					temp =sqrt((double)temp1*(double)temp1 + (double)temp2*(double)temp2);
-					if(temp > lmax) lmax = temp;
-				}
-				fVals[i] = lmax;
-				break;
-			case 4:
-				if(GetHugeEl(lpdata,sizeof(float),2L*li,(BYTE FAR *)&temp1)!=0)temp1=0.0;
-				if(GetHugeEl(lpdata,sizeof(float),2L*li+1L,(BYTE FAR *)&temp2)!=0)temp2=0.0;
-				lmax =sqrt((double)temp1*(double)temp1 + (double)temp2*(double)temp2);
-				for(j=0;j<skip;j++)
-				{
-					if(((long)j+li) >= Stop) break;
-					if(GetHugeEl(lpdata,sizeof(float),2L*(li+j),(BYTE FAR *)&temp1)!=0)temp1=0.0;
-					if(GetHugeEl(lpdata,sizeof(float),2L*(li+j)+1L,(BYTE FAR *)&temp2)!=0)temp2=0.0;
-					temp =sqrt((double)temp1*(double)temp1 + (double)temp2*(double)temp2);
-					if(temp < lmax) lmax = temp;
-				}
-				fVals[i] = lmax;
-				break;
-			default:
-				break;
-		}
-		if(fVals[i] > *max) *max = fVals[i];
-		if(fVals[i] < *min) *min = fVals[i];
-		i++;
+		case 1:
+			ViewStrided(&all, data, NumFloats, 1);
+			Mode = DECIM_COMB;
+			break;
+		case 2:
+			ViewStrided(&all, data, NumFloats, 1);
+			Mode = DECIM_MAXMIN;
+			break;
+		case 3:
+		case 4:
+			ViewOfType(&all, data, NumFloats, 2, VIEW_MAG);
+			Mode = (option == 3) ? DECIM_MAX : DECIM_MIN;
+			break;
+		case 5:
+			ViewStrided(&all, data, NumFloats, 1);
+			Mode = DECIM_MAX;
+			break;
+		case 6:
+			ViewOfType(&all, data, NumFloats, 5, VIEW_IMAG);
+			Mode = DECIM_MAX;
+			break;
+		case 7:
+			ViewOfType(&all, data, NumFloats, 5, VIEW_REAL);
+			Mode = DECIM_COMB;
+			break;
+		default:
+			return((int)((Stop-Start)/skip));
 	}
+	// The X extract leaves the callers range alone
+	if((ViewSub(&v, &all, Start, Stop - Start) > 0) && (option != 7)) *min = *max = ViewGet(&v, 0);
+	ViewDecimate(&v, fVals, skip, Mode, max, min);
 	return((int)((Stop-Start)/skip));
 }
 
+/************************************************************************
+* HugeViewGet -                                                         *
+*                                                                       *
+* Copies Num points of one channel, from point Start, into fVals.      *
+* Type is the plot type and Channel one of the VIEW_ codes in           *
+* hugeview.h. Returns the number of points copied.                      *
+************************************************************************/
+int pascal _export HugeViewGet(int *lpdata, int Type, int Channel, int Start, int Num, float *fVals)
+{
+	HUGEVIEW   all,v;
+
+	if(ViewOfType(&all, (float *)*lpdata, GetUbound(*lpdata) / sizeof(float), Type, Channel) != 0) return(-1);
+	if(Start < 0) return(-1);
+	ViewSub(&v, &all, Start, Num);
+	ViewGather(&v, fVals);
+	return(v.Num);
+}
+
+/************************************************************************
+* HugeViewPut - Inverse of HugeViewGet                                  *
+************************************************************************/
+int pascal _export HugeViewPut(int *lpdata, int Type, int Channel, int Start, int Num, float *fVals)
+{
+	HUGEVIEW   all,v;
+
+	if(ViewOfType(&all, (float *)*lpdata, GetUbound(*lpdata) / sizeof(float), Type, Channel) != 0) return(-1);
+	if(Start < 0) return(-1);
+	ViewSub(&v, &all, Start, Num);
+	ViewScatter(&v, fVals);
+	return(v.Num);
+}
+
 int pascal _export CurvReg(double *x, double *y, unsigned int n, double *terms, unsigned int nterms, double *mse)
 {
 	 MATRIX *At,*B,*At_Ai_At,*Z,*OUTa;
@@ -893,18 +865,8 @@ int pascal _export CurvReg(double *x, double *y, unsigned int n, double *terms,
 
 int pascal _export Int2Float(int *lpdata, int Num)
 {
-	int                 element;            // element in the huge array
-	int                 i;
-	float               *data;
-	short int           *iptr;
-
-	iptr = (short int *)*lpdata;
-	data = (float *)*lpdata;
-	for(element = (Num-1024L); element >= 0L ; element-=1024)
-	{
-		// Now convert ints to floats
-		for(i = 1023; i>=0;i--) data[i+element] = iptr[i+element];
-	}
+	// Widen the shorts in place, all Num of them
+	KernShortToFloat((float *)*lpdata, Num);
 	return(0);
 }
 
@@ -947,83 +909,6 @@ int FAR pascal _export CubeRoots(double a, double b, double c, double *roots)
 	return(1);
 }
 
-int pascal _export SearchMW(int *C, int *H,int *N, int *O,int *S,double Mass,double MonoMass)
-{
-#define  C1     12.0111069831375
-#define  H1     1.00797557532606
-#define  O1     15.9993703627226
-#define  N1     14.0067248319416
-#define  S1     32.0643887269403
-#define  Cmono  12.0
-#define  Hmono  1.0078246
-#define  Nmono  14.0030732
-#define  Omono  15.9949141
-#define  Smono  31.97207
-int   Cn,Cs,Cr;
-int   Hn,Hs,Hr;
-int   Nn,Ns,Nr;
-int   On,Os,Or;
-int   Sn,Ss,Sr;
-float  Percent;
-double MassError;
-double M,MM,E;
-
-	MassError = Mass;
-	Percent = 0.1;
-	Cr = (long)((float)*C * Percent +.5);
-	Hr = (long)((float)*H * Percent +.5);
-	Nr = (long)((float)*N * Percent +.5);
-	Or = (long)((float)*O * Percent +.5);
-	Sr = (long)((float)*S * Percent +.5);
-	if (Cr > 50)  Cr = 50;
-	if (Hr > 100) Hr = 100;
-	if (Nr > 20)  Hr = 20;
-	if (Or > 20)  Or = 20;
-	if (Sr > 2)   Sr = 2;
-	for(Cn= *C-Cr;Cn<= *C + Cr;Cn++)
-	{
-		for(Hn= *H-Hr;Hn<= *H + Hr;Hn++)
-		{
-			for(Nn= *N-Nr;Nn<= *N + Nr;Nn++)
-			{
-				for(On= *O-Or;On<= *O + Or;On++)
-				{
-					for(Sn= *S-Sr;Sn<= *S + Sr;Sn++)
-					{
-						E = 0.0;
-						if (Mass != 0.0)
-						{
-							M = Cn * C1 + Hn * H1 + Nn * N1 + On * O1 + Sn * S1;
-							E = (M - Mass) * (M - Mass);
-						}
-						if (MonoMass != 0.0)
-						{
-							MM = Cn * Cmono + Hn * Hmono + Nn * Nmono + On * Omono + Sn * Smono;
-							E = E + (MM - MonoMass) * (MM - MonoMass);
-						}
-						E = sqrt(E);
-						if(E < MassError)
-						{
-							Cs = Cn;
-							Hs = Hn;
-							Ns = Nn;
-							Os = On;
-							Ss = Sn;
-							MassError = E;
-						}
-					}
-				}
-			}
-		}
-	}
-	*C = Cs;
-	*H = Hs;
-	*N = Ns;
-	*O = Os;
-	*S = Ss;
-	return(0);
-}
-
 typedef struct
 {
    unsigned int  NumScans;
@@ -1524,72 +1409,226 @@ int pascal _export TSQload(int *lpdata, int Num, int hLoadFile,int pos)
 
 #define   Pie   3.1415926535897932384626433832795
 
-int pascal _export SwiftPhase(int *lpdata, int Num)
+// SwiftPhase works on blocks of points so the running sums can be
+// computed in parallel and the phases handed to SwiftRotate in batches.
+#define   SWIFTBLOCK   4096
+#define   SWIFTBATCH   256
+
+typedef struct
 {
-	double t0,dt,c,b,fval;
-	double energy,phase;
-	int    li;
-	float  *data;
+	float    *data;
+	int      Num;
+	int      NumPoints;
+	double   *Sc,*Sb;       // sum of squares and sum of running sums in each block
+	double   *C0,*B0;       // running sums carried into each block
+	double   t0,dt,energy;
+}  SWIFTSCAN;
 
-	data = (float *)*lpdata;
-	t0 = Num / 4;
-	dt = Num / 2;
-	c = 0.0;
-	b = 0.0;
-	energy = 0.0;
-	for(li = 0; li <Num/2; li++)
+/************************************************************************
+* SwiftRotate -                                                         *
+*                                                                       *
+* data[2i],data[2i+1] = data[2i] * (cos(phase[i]), sin(phase[i]))        *
+*                                                                       *
+* The phase is reduced to [0,2pi) and then to [-pi/4,pi/4] by quadrant; *
+* sin and cos are minimax polynomials there (cephes sinf/cosf          *
+* coefficients). Absolute error of either is below 1.5e-7 for          *
+* |phase| < 1e9, under the rounding of the float result. The turns and *
+* quadrants are rounded by conversion to int rather than floor(), so   *
+* the loop makes no calls and the compiler can vectorise it. The phase *
+* must stay below 2^31 turns.                                           *
+************************************************************************/
+static void SwiftRotate(float *data, const double *phase, int n)
+{
+	double   p,t,q,r,z,s,c,sv,cv;
+	int      i,it,iq;
+
+	for(i=0;i<n;i++)
 	{
-		energy = energy + data[li*2] * data[li*2];
+		p = phase[i];
+		// floor of the turns, the conversion truncates toward 0
+		t = p * (0.5 / Pie);
+		it = (int)t;
+		it -= ((double)it > t);
+		p = p - (2.0 * Pie) * it;
+		// p is now at least 0, so truncation rounds to the nearest quadrant
+		iq = (int)(p * (2.0 / Pie) + 0.5);
+		q = iq;
+		r = (p - q * 1.5707963267341256e+00) - q * 6.0771005065061922e-11;
+		z = r * r;
+		s = r + r * z * (-1.6666654611e-1 + z * (8.3321608736e-3 + z * -1.9515295891e-4));
+		c = 1.0 - 0.5 * z + z * z * (4.166664568298827e-2 + z * (-1.388731625493765e-3 + z * 2.443315711809948e-5));
+		sv = (iq & 1) ? c : s;
+		cv = (iq & 1) ? s : c;
+		if(iq & 2) sv = -sv;
+		if((iq + 1) & 2) cv = -cv;
+		z = data[i*2];
+		data[i*2]   = (float)(z * cv);
+		data[i*2+1] = (float)(z * sv);
 	}
-	for(li=0;li<Num/2;li++)
+}
+
+// First pass, block sums of x*x and of the running sum of x*x
+static void SwiftSums(void *Arg, int Start, int Stop, int Thread)
+{
+	SWIFTSCAN   *ss;
+	double      c,b,x;
+	int         blk,li,le;
+
+	ss = (SWIFTSCAN *)Arg;
+	for(blk=Start;blk<Stop;blk++)
 	{
-		c = c + data[li*2] * data[li*2];
-		b = b + c;
-		if(energy == 0.0)
+		c = b = 0.0;
+		le = (blk + 1) * SWIFTBLOCK;
+		if(le > ss->NumPoints) le = ss->NumPoints;
+		for(li=blk*SWIFTBLOCK;li<le;li++)
 		{
-			phase = 0;
+			x = ss->data[li*2];
+			c = c + x * x;
+			b = b + c;
 		}
-		else
+		ss->Sc[blk] = c;
+		ss->Sb[blk] = b;
+	}
+}
+
+// Second pass, phases from the carried in sums then rotate in batches
+static void SwiftApply(void *Arg, int Start, int Stop, int Thread)
+{
+	SWIFTSCAN   *ss;
+	double      phase[SWIFTBATCH];
+	double      c,b,x;
+	int         blk,li,lj,le,n;
+
+	ss = (SWIFTSCAN *)Arg;
+	for(blk=Start;blk<Stop;blk++)
+	{
+		c = ss->C0[blk];
+		b = ss->B0[blk];
+		le = (blk + 1) * SWIFTBLOCK;
+		if(le > ss->NumPoints) le = ss->NumPoints;
+		for(li=blk*SWIFTBLOCK;li<le;li+=SWIFTBATCH)
 		{
-			phase = 2.0 * Pie * (dt * b / energy + t0 * li) / Num;
+			n = le - li;
+			if(n > SWIFTBATCH) n = SWIFTBATCH;
+			for(lj=0;lj<n;lj++)
+			{
+				x = ss->data[(li+lj)*2];
+				c = c + x * x;
+				b = b + c;
+				if(ss->energy == 0.0) phase[lj] = 0;
+				else phase[lj] = 2.0 * Pie * (ss->dt * b / ss->energy + ss->t0 * (li+lj)) / ss->Num;
+			}
+			SwiftRotate(&ss->data[li*2], phase, n);
 		}
-		fval = data[li*2];
-		data[li*2] = fval * cos(phase);
-		data[li*2+1] = fval * sin(phase);
 	}
-	return(0);
 }
 
-int pascal _export Copy2Double(int *lpdata, double *dVals, int Num)
+/************************************************************************
+* SwiftPhase -                                                          *
+*                                                                       *
+* Applies the quadratic SWIFT phase to the Num/2 real values held in    *
+* the even elements, writing re/im pairs. The running sums are a        *
+* blocked scan: block sums first, carries between blocks, then each     *
+* block is finished independently.                                      *
+************************************************************************/
+int pascal _export SwiftPhase(int *lpdata, int Num)
 {
-	int    li;
-	float  *data;
-
-	data = (float *)*lpdata;
-	for(li = 0; li <Num; li++)
+	SWIFTSCAN   ss;
+	double      *mem;
+	int         blk,NumBlocks;
+
+	ss.data = (float *)*lpdata;
+	ss.Num = Num;
+	ss.NumPoints = Num / 2;
+	ss.t0 = Num / 4;
+	ss.dt = Num / 2;
+	if(ss.NumPoints <= 0) return(0);
+	NumBlocks = (ss.NumPoints + SWIFTBLOCK - 1) / SWIFTBLOCK;
+	mem = (double *)calloc(4 * NumBlocks, sizeof(double));
+	if(!mem) return(HA_OUTOFMEMORY);
+	ss.Sc = mem;
+	ss.Sb = mem + NumBlocks;
+	ss.C0 = mem + 2 * NumBlocks;
+	ss.B0 = mem + 3 * NumBlocks;
+	HugeParallel(SwiftSums, &ss, NumBlocks, 4, 0);
+	ss.energy = 0.0;
+	for(blk=0;blk<NumBlocks;blk++)
 	{
-		dVals[li]=data[li];
+		ss.C0[blk] = ss.energy;
+		ss.B0[blk] = (blk == 0) ? 0.0 : ss.B0[blk-1] + (double)SWIFTBLOCK * ss.C0[blk-1] + ss.Sb[blk-1];
+		ss.energy = ss.energy + ss.Sc[blk];
 	}
+	HugeParallel(SwiftApply, &ss, NumBlocks, 4, 0);
+	free(mem);
+	return(0);
+}
+
+int pascal _export Copy2Double(int *lpdata, double *dVals, int Num)
+{
+	KernToDouble((float *)*lpdata, dVals, Num);
 	return(0);
 }
 
 float pascal _export Normalize(int *lpdata, int Num, float Max)
 {
-	int    li;
 	float  *data,max,min,adj;
 
 	data = (float *)*lpdata;
 	min = max = data[0];
-	for(li = 0; li <Num; li++)
-	{
-		if(data[li] > max) max = data[li];
-		if(data[li] < min) min = data[li];
-	}
+	KernMinMax(data, Num, &min, &max);
 	adj = Max/(max-min);
-	for(li = 0; li <Num; li++)
-	{
-		data[li] = data[li] * adj;
-	}
+	KernAffine(data, Num, adj, 0.0f);
 	return(fabs(max-min));
 }
 
+/************************************************************************
+* HugeMinMax -                                                          *
+************************************************************************/
+int pascal _export HugeMinMax(int *lpdata, int Start, int Num, float *Min, float *Max)
+{
+	if((Start < 0) || (Num <= 0)) return(-1);
+	KernMinMax((float *)*lpdata + Start, Num, Min, Max);
+	return(0);
+}
+
+/************************************************************************
+* HugeMean -                                                            *
+************************************************************************/
+double pascal _export HugeMean(int *lpdata, int Start, int Num)
+{
+	if((Start < 0) || (Num <= 0)) return(0.0);
+	return(KernSum((float *)*lpdata + Start, Num) / (double)Num);
+}
+
+/************************************************************************
+* HugeAffine - data = data * Scale + Offset                             *
+************************************************************************/
+int pascal _export HugeAffine(int *lpdata, int Start, int Num, float Scale, float Offset)
+{
+	if((Start < 0) || (Num <= 0)) return(-1);
+	KernAffine((float *)*lpdata + Start, Num, Scale, Offset);
+	return(0);
+}
+
+/************************************************************************
+* HugeRealFFT -                                                         *
+*                                                                       *
+* Replaces Num real points with their transform, in the layout used by *
+* realft, or transforms back when isign is -1. For the forward          *
+* transform Flags may ask for magnitudes and for the spectrum to be     *
+* scaled to a peak of 1, see hugefft.h; Peak gets the largest           *
+* magnitude found.                                                      *
+************************************************************************/
+int pascal _export HugeRealFFT(int *lpdata, int Num, int isign, int Flags, float *Peak)
+{
+	return(FFTReal((float *)*lpdata, Num, isign, Flags, Peak));
+}
+
+/************************************************************************
+* HugeFFTFree - Release the cached FFT plans                            *
+************************************************************************/
+int pascal _export HugeFFTFree(void)
+{
+	FFTFreePlans();
+	return(0);
+}
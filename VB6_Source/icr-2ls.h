@@ -18,7 +18,31 @@ int  pascal _export HugeLoadSunFloat(int *, int Num, int hLoadFile, int pos, int
 int  pascal _export HugeSaveInt(int *, int Num, int hLoadFile, int pos);
 int  pascal _export HugeSaveFloat(int *, int Num, int hLoadFile, int pos);
 int  pascal _export HugeExtract(int *, float *fVals, float *max, float *min, int Start, int Stop, int maxN, int option);
+int  pascal _export HugeViewGet(int *, int Type, int Channel, int Start, int Num, float *fVals);
+int  pascal _export HugeViewPut(int *, int Type, int Channel, int Start, int Num, float *fVals);
+int  pascal _export HugeRealFFT(int *, int Num, int isign, int Flags, float *Peak);
+int  pascal _export HugeFFTFree(void);
+int  pascal _export HugePreFFT(int *, int Num, int NumOut, int Rotate, int Window, int Start, int Stop, int A, int B);
+int  pascal _export HugeAlign(int *lpref, int NumRef, int *lpdata, int Num, float *M, float *B, float *Score);
+int  pascal _export HugeAlignBatch(int *lpref, int NumRef, int *lpdatas, int *Nums, int NumRuns, float *M, float *B, float *Score);
+int  pascal _export HugeResample(float *X, float *Y, int Num, float *Grid, int NumGrid, float *Out, int Method);
+int  pascal _export HugeResampleBatch(int *lpX, int *lpY, int *Nums, int NumSpectra, float *Grid, int NumGrid, int *lpOut, int Method);
+int  pascal _export HugeBoxCar(int *, int Type, int Start, int Stop, int Width);
+int  pascal _export HugeSavGol(int *, int Type, int Start, int Stop, double *c, int NumCoef);
+int  pascal _export HugeClearPeaks(int *, int Type, int Num, int Start, int Stop, float Threshold, int Width, int *Regions, int MaxRegions);
+int  pascal _export HugeMinMax(int *, int Start, int Num, float *Min, float *Max);
+double pascal _export HugeMean(int *, int Start, int Num);
+int  pascal _export HugeAffine(int *, int Start, int Num, float Scale, float Offset);
 int  pascal _export SearchMW(int *C, int *H,int *N, int *O,int *S,double Mass,double MonoMass);
+int  pascal _export SearchMWList(int *Formula, int *Range, double Mass, double MonoMass, double Ppm, int MaxHits, int *Hits, double *Errors, int NumThreads);
+int  pascal _export HugeSetThreads(int Num);
+int  pascal _export MWLatticeBuild(int *Lo, int *Hi, int Key, int Rules);
+int  pascal _export MWLatticeSave(int Handle, char *FileName);
+int  pascal _export MWLatticeOpen(char *FileName);
+int  pascal _export MWLatticeFree(int Handle);
+int  pascal _export MWLatticeSize(int Handle);
+int  pascal _export MWLatticeQuery(int Handle, double *Mass, double *MonoMass, int Num, double Ppm, int MaxHits, int *Hits, double *Errors, int *NumHits, int NumThreads);
+int  GetUbound(int lpdata);
 #define MAXBLOCKS    8
 #define BLOCKSIZE    (0x800000L)
 
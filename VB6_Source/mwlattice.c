@@ -0,0 +1,417 @@
+/************************************************************************
+*                                                                       *
+*                               MWLATTICE.C                             *
+*                                                                       *
+*		Precomputed formula mass table for batch lookups.           *
+*                                                                       *
+*   Every C,H,N,O,S formula inside an element envelope is listed once,  *
+*   sorted on one of its masses. A query is a binary search for the    *
+*   low edge of its ppm window and a scan to the high edge; the counts *
+*   of each entry are used to recompute exact masses before ranking.  *
+*                                                                       *
+*   Entries are 12 bytes, counts packed into 32 bits and masses held   *
+*   as floats. A table can be saved and later mapped straight from the *
+*   file without being read into memory.                                *
+*                                                                       *
+************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <windows.h>
+#include <winbase.h>
+#include "icr-2ls.h"
+#include "hugethrd.h"
+#include "mwsearch.h"
+
+#define  MAXLATTICE   8
+#define  LATVERSION   1
+
+// Bits given to each element count in a packed entry
+static const int   PackBits[NUMELEMENTS] = { 8, 9, 6, 6, 3 };
+
+typedef struct
+{
+	char           Magic[8];            // "ICRMWLAT"
+	int            Version;
+	int            Key;                 // 0 = sorted on mono mass, 1 = average
+	int            Rules;               // 1 = H <= 2C + N + 2 applied
+	int            Num;                 // number of entries
+	int            Lo[NUMELEMENTS];
+	int            Hi[NUMELEMENTS];
+}  MWLATHEADER;
+
+typedef struct
+{
+	float          Mono;
+	float          Avg;
+	unsigned int   Packed;
+}  MWLATENTRY;
+
+typedef struct
+{
+	MWLATHEADER    *Hdr;
+	MWLATENTRY     *Entry;
+	void           *Mem;                // built in memory, else NULL
+	HANDLE         hFile;               // mapped from a file
+	HANDLE         hMap;
+	void           *View;
+}  MWLATTICE;
+
+static MWLATTICE   Lattices[MAXLATTICE];
+
+static void MWUnpack(unsigned int Packed, int *n)
+{
+	int   i;
+
+	for(i=NUMELEMENTS-1;i>=0;i--)
+	{
+		n[i] = Packed & ((1 << PackBits[i]) - 1);
+		Packed >>= PackBits[i];
+	}
+}
+
+static unsigned int MWPack(const int *n)
+{
+	unsigned int   p;
+	int            i;
+
+	p = 0;
+	for(i=0;i<NUMELEMENTS;i++) p = (p << PackBits[i]) | (unsigned int)n[i];
+	return(p);
+}
+
+static int MWEntryCompareMono(const void *a, const void *b)
+{
+	const MWLATENTRY  *ea = (const MWLATENTRY *)a;
+	const MWLATENTRY  *eb = (const MWLATENTRY *)b;
+
+	if(ea->Mono != eb->Mono) return((ea->Mono < eb->Mono) ? -1 : 1);
+	if(ea->Packed != eb->Packed) return((ea->Packed < eb->Packed) ? -1 : 1);
+	return(0);
+}
+
+static int MWEntryCompareAvg(const void *a, const void *b)
+{
+	const MWLATENTRY  *ea = (const MWLATENTRY *)a;
+	const MWLATENTRY  *eb = (const MWLATENTRY *)b;
+
+	if(ea->Avg != eb->Avg) return((ea->Avg < eb->Avg) ? -1 : 1);
+	if(ea->Packed != eb->Packed) return((ea->Packed < eb->Packed) ? -1 : 1);
+	return(0);
+}
+
+static int MWLatticeSlot(void)
+{
+	int   i;
+
+	for(i=0;i<MAXLATTICE;i++) if(Lattices[i].Hdr == NULL) return(i);
+	return(-1);
+}
+
+static MWLATTICE *MWLatticeGet(int Handle)
+{
+	if((Handle < 1) || (Handle > MAXLATTICE)) return(NULL);
+	if(Lattices[Handle-1].Hdr == NULL) return(NULL);
+	return(&Lattices[Handle-1]);
+}
+
+static int MWRuleOK(const int *n, int Rules)
+{
+	if(Rules & 1) if(n[1] > 2 * n[0] + n[2] + 2) return(0);
+	return(1);
+}
+
+/************************************************************************
+* MWLatticeBuild -                                                      *
+*                                                                       *
+* Lo, Hi   C,H,N,O,S count limits of the envelope                       *
+* Key      0 = sort on monoisotopic mass, 1 = on average mass           *
+* Rules    1 = skip formulas with H > 2C + N + 2                        *
+*                                                                       *
+* Returns a lattice handle > 0, or an HA_ error code.                   *
+************************************************************************/
+int pascal _export MWLatticeBuild(int *Lo, int *Hi, int Key, int Rules)
+{
+	MWLATTICE   *ml;
+	MWLATENTRY  *e;
+	double      Num;
+	int         n[NUMELEMENTS];
+	int         i,k,slot;
+
+	for(i=0;i<NUMELEMENTS;i++)
+	{
+		if((Lo[i] < 0) || (Hi[i] < Lo[i])) return(HA_WM32_Invalid_Arg);
+		if(Hi[i] >= (1 << PackBits[i])) return(HA_WM32_Invalid_Arg);
+	}
+	slot = MWLatticeSlot();
+	if(slot < 0) return(HA_TOMANYARRAYS);
+	Num = 1.0;
+	for(i=0;i<NUMELEMENTS;i++) Num *= (double)(Hi[i] - Lo[i] + 1);
+	if(Num * sizeof(MWLATENTRY) > 0x7FFFFFFF - sizeof(MWLATHEADER)) return(HA_OUTOFMEMORY);
+
+	ml = &Lattices[slot];
+	memset(ml, 0, sizeof(MWLATTICE));
+	ml->Mem = malloc(sizeof(MWLATHEADER) + (size_t)Num * sizeof(MWLATENTRY));
+	if(!ml->Mem) return(HA_OUTOFMEMORY);
+	ml->Hdr = (MWLATHEADER *)ml->Mem;
+	ml->Entry = (MWLATENTRY *)(ml->Hdr + 1);
+	memset(ml->Hdr, 0, sizeof(MWLATHEADER));
+	memcpy(ml->Hdr->Magic, "ICRMWLAT", 8);
+	ml->Hdr->Version = LATVERSION;
+	ml->Hdr->Key = Key ? 1 : 0;
+	ml->Hdr->Rules = Rules;
+	for(i=0;i<NUMELEMENTS;i++)
+	{
+		ml->Hdr->Lo[i] = Lo[i];
+		ml->Hdr->Hi[i] = Hi[i];
+	}
+
+	k = 0;
+	e = ml->Entry;
+	for(n[0]=Lo[0];n[0]<=Hi[0];n[0]++)
+	for(n[1]=Lo[1];n[1]<=Hi[1];n[1]++)
+	for(n[2]=Lo[2];n[2]<=Hi[2];n[2]++)
+	for(n[3]=Lo[3];n[3]<=Hi[3];n[3]++)
+	for(n[4]=Lo[4];n[4]<=Hi[4];n[4]++)
+	{
+		double   a,m;
+
+		if(!MWRuleOK(n, Rules)) continue;
+		a = m = 0.0;
+		for(i=0;i<NUMELEMENTS;i++)
+		{
+			a += n[i] * AvgMass[i];
+			m += n[i] * MonoMasses[i];
+		}
+		e[k].Avg = (float)a;
+		e[k].Mono = (float)m;
+		e[k].Packed = MWPack(n);
+		k++;
+	}
+	ml->Hdr->Num = k;
+	qsort(e, k, sizeof(MWLATENTRY), ml->Hdr->Key ? MWEntryCompareAvg : MWEntryCompareMono);
+	return(slot + 1);
+}
+
+/************************************************************************
+* MWLatticeSave - Writes a lattice to a file that MWLatticeOpen can map *
+************************************************************************/
+int pascal _export MWLatticeSave(int Handle, char *FileName)
+{
+	MWLATTICE   *ml;
+	FILE        *fp;
+	size_t      Size;
+
+	ml = MWLatticeGet(Handle);
+	if(ml == NULL) return(HA_BADARRAY);
+	fp = fopen(FileName, "wb");
+	if(fp == NULL) return(HA_FILEOPENERROR);
+	Size = (size_t)ml->Hdr->Num * sizeof(MWLATENTRY);
+	if((fwrite(ml->Hdr, sizeof(MWLATHEADER), 1, fp) != 1) ||
+		((Size > 0) && (fwrite(ml->Entry, Size, 1, fp) != 1)))
+	{
+		fclose(fp);
+		return(HA_FILEWRITEERROR);
+	}
+	fclose(fp);
+	return(0);
+}
+
+/************************************************************************
+* MWLatticeOpen - Maps a saved lattice read only, returns a handle      *
+************************************************************************/
+int pascal _export MWLatticeOpen(char *FileName)
+{
+	MWLATTICE   *ml;
+	DWORD       SizeHigh,Size;
+	int         slot;
+
+	slot = MWLatticeSlot();
+	if(slot < 0) return(HA_TOMANYARRAYS);
+	ml = &Lattices[slot];
+	memset(ml, 0, sizeof(MWLATTICE));
+	ml->hFile = CreateFile(FileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(ml->hFile == INVALID_HANDLE_VALUE) return(HA_FILEOPENERROR);
+	Size = GetFileSize(ml->hFile, &SizeHigh);
+	if((SizeHigh != 0) || (Size < sizeof(MWLATHEADER))) goto bad;
+	ml->hMap = CreateFileMapping(ml->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(ml->hMap == NULL) goto bad;
+	ml->View = MapViewOfFile(ml->hMap, FILE_MAP_READ, 0, 0, 0);
+	if(ml->View == NULL) goto bad;
+	ml->Hdr = (MWLATHEADER *)ml->View;
+	ml->Entry = (MWLATENTRY *)(ml->Hdr + 1);
+	if((memcmp(ml->Hdr->Magic, "ICRMWLAT", 8) != 0) || (ml->Hdr->Version != LATVERSION) ||
+		(ml->Hdr->Num < 0) ||
+		((double)Size < sizeof(MWLATHEADER) + (double)ml->Hdr->Num * sizeof(MWLATENTRY))) goto bad;
+	return(slot + 1);
+bad:
+	if(ml->View) UnmapViewOfFile(ml->View);
+	if(ml->hMap) CloseHandle(ml->hMap);
+	CloseHandle(ml->hFile);
+	memset(ml, 0, sizeof(MWLATTICE));
+	return(HA_FILEREADERROR);
+}
+
+/************************************************************************
+* MWLatticeFree - Releases a lattice, -1 releases them all              *
+************************************************************************/
+int pascal _export MWLatticeFree(int Handle)
+{
+	MWLATTICE   *ml;
+	int         i;
+
+	if(Handle == -1)
+	{
+		for(i=1;i<=MAXLATTICE;i++) if(MWLatticeGet(i)) MWLatticeFree(i);
+		return(0);
+	}
+	ml = MWLatticeGet(Handle);
+	if(ml == NULL) return(HA_BADARRAY);
+	if(ml->Mem) free(ml->Mem);
+	if(ml->View) UnmapViewOfFile(ml->View);
+	if(ml->hMap) CloseHandle(ml->hMap);
+	if(ml->hFile) CloseHandle(ml->hFile);
+	memset(ml, 0, sizeof(MWLATTICE));
+	return(0);
+}
+
+/************************************************************************
+* MWLatticeSize - Returns the number of formulas in a lattice           *
+************************************************************************/
+int pascal _export MWLatticeSize(int Handle)
+{
+	MWLATTICE   *ml;
+
+	ml = MWLatticeGet(Handle);
+	if(ml == NULL) return(HA_BADARRAY);
+	return(ml->Hdr->Num);
+}
+
+typedef struct
+{
+	MWLATTICE   *ml;
+	double      *Mass;
+	double      *MonoMass;
+	double      Ppm;
+	int         MaxHits;
+	int         *Hits;
+	double      *Errors;
+	int         *NumHits;
+}  MWLATQUERY;
+
+// First entry whose key is not below Key
+static int MWLowerBound(const MWLATENTRY *e, int Num, int KeyAvg, float Key)
+{
+	int   lo,hi,mid;
+
+	lo = 0;
+	hi = Num;
+	while(lo < hi)
+	{
+		mid = lo + (hi - lo) / 2;
+		if((KeyAvg ? e[mid].Avg : e[mid].Mono) < Key) lo = mid + 1;
+		else hi = mid;
+	}
+	return(lo);
+}
+
+static void MWLatticeQuerySlice(void *Arg, int Start, int Stop, int Thread)
+{
+	MWLATQUERY  *q;
+	MWLATENTRY  *e;
+	MWHIT       list[64],hit;
+	double      Mass,MonoMass,Target,Tol,TolA,TolM,a,m;
+	float       Edge;
+	int         KeyAvg,Num,i,j,k,n;
+
+	q = (MWLATQUERY *)Arg;
+	e = q->ml->Entry;
+	Num = q->ml->Hdr->Num;
+	KeyAvg = q->ml->Hdr->Key;
+	for(i=Start;i<Stop;i++)
+	{
+		Mass = q->Mass ? q->Mass[i] : 0.0;
+		MonoMass = q->MonoMass ? q->MonoMass[i] : 0.0;
+		TolA = fabs(Mass) * q->Ppm * 1.0e-6;
+		TolM = fabs(MonoMass) * q->Ppm * 1.0e-6;
+		Target = KeyAvg ? Mass : MonoMass;
+		Tol = KeyAvg ? TolA : TolM;
+		n = 0;
+		if(Target != 0.0)
+		{
+			// widen by a float step so rounding of the stored keys never
+			// drops an entry, exact masses decide below
+			Tol += fabs(Target) * 2.0 * FLT_EPSILON;
+			Edge = (float)(Target + Tol);
+			for(j=MWLowerBound(e, Num, KeyAvg, (float)(Target - Tol));j<Num;j++)
+			{
+				if((KeyAvg ? e[j].Avg : e[j].Mono) > Edge) break;
+				MWUnpack(e[j].Packed, hit.Count);
+				a = m = 0.0;
+				for(k=0;k<NUMELEMENTS;k++)
+				{
+					a += hit.Count[k] * AvgMass[k];
+					m += hit.Count[k] * MonoMasses[k];
+				}
+				hit.Err = 0.0;
+				if(Mass != 0.0)
+				{
+					if(fabs(a - Mass) > TolA) continue;
+					hit.Err = (a - Mass) * (a - Mass);
+				}
+				if(MonoMass != 0.0)
+				{
+					if(fabs(m - MonoMass) > TolM) continue;
+					hit.Err += (m - MonoMass) * (m - MonoMass);
+				}
+				n = MWInsertHit(list, n, q->MaxHits, &hit);
+			}
+		}
+		q->NumHits[i] = n;
+		for(j=0;j<n;j++)
+		{
+			for(k=0;k<NUMELEMENTS;k++) q->Hits[(i*q->MaxHits + j)*NUMELEMENTS + k] = list[j].Count[k];
+			if(q->Errors) q->Errors[i*q->MaxHits + j] = sqrt(list[j].Err);
+		}
+	}
+}
+
+/************************************************************************
+* MWLatticeQuery -                                                      *
+*                                                                       *
+* Handle   lattice from MWLatticeBuild or MWLatticeOpen                 *
+* Mass     Num average masses, NULL or 0.0 = not used                   *
+* MonoMass Num monoisotopic masses, NULL or 0.0 = not used              *
+*          The mass the lattice is sorted on must be given.             *
+* Ppm      window each given mass must fall in                          *
+* MaxHits  hits kept per query, at most 64                              *
+* Hits     returns Num * MaxHits * 5 counts, best match first           *
+* Errors   returns Num * MaxHits combined mass errors, may be NULL      *
+* NumHits  returns the number of hits for each query                    *
+* NumThreads  threads to split the queries over, 0 = default            *
+*                                                                       *
+* Returns 0 or an HA_ error code.                                       *
+************************************************************************/
+int pascal _export MWLatticeQuery(int Handle, double *Mass, double *MonoMass, int Num, double Ppm,
+											 int MaxHits, int *Hits, double *Errors, int *NumHits, int NumThreads)
+{
+	MWLATQUERY  q;
+
+	q.ml = MWLatticeGet(Handle);
+	if(q.ml == NULL) return(HA_BADARRAY);
+	if((MaxHits < 1) || (MaxHits > 64) || (Ppm <= 0.0)) return(HA_WM32_Invalid_Arg);
+	if((Hits == NULL) || (NumHits == NULL)) return(HA_WM32_Invalid_Arg);
+	if((q.ml->Hdr->Key ? Mass : MonoMass) == NULL) return(HA_WM32_Invalid_Arg);
+	q.Mass = Mass;
+	q.MonoMass = MonoMass;
+	q.Ppm = Ppm;
+	q.MaxHits = MaxHits;
+	q.Hits = Hits;
+	q.Errors = Errors;
+	q.NumHits = NumHits;
+	HugeParallel(MWLatticeQuerySlice, &q, Num, 256, NumThreads);
+	return(0);
+}
@@ -0,0 +1,313 @@
+/************************************************************************
+*                                                                       *
+*                               MWSEARCH.C                              *
+*                                                                       *
+*		Elemental composition search.                               *
+*                                                                       *
+*   The search walks C,H,N,O,S in order. At each level the masses of   *
+*   the elements still to be placed are bounded by their range ends,   *
+*   so only counts that can still reach the target within the current  *
+*   tolerance are visited. Errors are compared squared; the square     *
+*   root is only taken for the values handed back to the caller.       *
+*                                                                       *
+************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <windows.h>
+#include "icr-2ls.h"
+#include "hugethrd.h"
+#include "mwsearch.h"
+
+const double  AvgMass[NUMELEMENTS]    = { C1, H1, N1, O1, S1 };
+const double  MonoMasses[NUMELEMENTS] = { Cmono, Hmono, Nmono, Omono, Smono };
+
+// Largest half range searched around each element by default
+static const int   MaxRange[NUMELEMENTS] = { 50, 100, 20, 20, 2 };
+
+// Slack added to the pruning bounds so rounding never drops a candidate
+#define  MWSLACK  1.0e-9
+
+typedef struct
+{
+	int     Lo[NUMELEMENTS];
+	int     Hi[NUMELEMENTS];
+	double  Mass,MonoMass;          // targets, 0.0 = not used
+	double  TolA,TolM;              // allowed deviation of each mass
+	double  Bound;                  // squared error must be below this
+	double  RestLoA[NUMELEMENTS];   // mass of the elements after this one
+	double  RestHiA[NUMELEMENTS];   //    at the low and high range ends
+	double  RestLoM[NUMELEMENTS];
+	double  RestHiM[NUMELEMENTS];
+	int     MaxHits;
+	MWHIT   *Hits[MAXTHREADS];      // one sorted hit list per thread
+	int     NumHits[MAXTHREADS];
+}  MWSEARCH;
+
+/************************************************************************
+* MWDefaultRange - Legacy SearchMW window, 10% of each count            *
+************************************************************************/
+void MWDefaultRange(const int *Formula, int *Range)
+{
+	int   i;
+
+	for(i=0;i<NUMELEMENTS;i++)
+	{
+		Range[i] = (int)((float)Formula[i] * 0.1 + .5);
+		if(Range[i] > MaxRange[i]) Range[i] = MaxRange[i];
+		if(Range[i] < 0) Range[i] = 0;
+	}
+}
+
+/************************************************************************
+* MWHitBefore - Orders hits by error, ties broken on the counts so the  *
+*               result does not depend on how the work was split.       *
+************************************************************************/
+int MWHitBefore(const MWHIT *a, const MWHIT *b)
+{
+	int   i;
+
+	if(a->Err != b->Err) return(a->Err < b->Err);
+	for(i=0;i<NUMELEMENTS;i++)
+	{
+		if(a->Count[i] != b->Count[i]) return(a->Count[i] < b->Count[i]);
+	}
+	return(0);
+}
+
+/************************************************************************
+* MWInsertHit - Inserts into a sorted list of at most MaxHits entries,  *
+*               returns the new length.                                 *
+************************************************************************/
+int MWInsertHit(MWHIT *Hits, int NumHits, int MaxHits, const MWHIT *hit)
+{
+	int   i;
+
+	if(NumHits == MaxHits)
+	{
+		if(!MWHitBefore(hit, &Hits[NumHits-1])) return(NumHits);
+		NumHits--;
+	}
+	for(i=NumHits;i>0;i--)
+	{
+		if(!MWHitBefore(hit, &Hits[i-1])) break;
+		Hits[i] = Hits[i-1];
+	}
+	Hits[i] = *hit;
+	return(NumHits+1);
+}
+
+// Narrows [*lo,*hi] to the counts of element Level that can still reach
+// Target from Partial, given the bounds on the elements that follow.
+static void MWClamp(int *lo, int *hi, double Target, double Tol, double Partial,
+						  double RestLo, double RestHi, double m)
+{
+	double   x;
+
+	x = ceil((Target - Tol - Partial - RestHi) / m - MWSLACK);
+	if(x > *lo) *lo = (x > *hi) ? *hi + 1 : (int)x;
+	x = floor((Target + Tol - Partial - RestLo) / m + MWSLACK);
+	if(x < *hi) *hi = (x < *lo) ? *lo - 1 : (int)x;
+}
+
+static void MWLevel(MWSEARCH *ms, int Thread, int Level, int lo, int hi, int *n, double pa, double pm)
+{
+	MWHIT    hit;
+	MWHIT    *Hits;
+	double   b,da,dm,E;
+	int      i,k;
+
+	Hits = ms->Hits[Thread];
+	for(;;)
+	{
+		// current radius, shrinks once the hit list is full
+		b = ms->Bound;
+		if(ms->NumHits[Thread] == ms->MaxHits) b = Hits[ms->MaxHits-1].Err;
+		b = sqrt(b) * (1.0 + MWSLACK);
+		if(ms->Mass != 0.0)
+			MWClamp(&lo, &hi, ms->Mass, (b < ms->TolA) ? b : ms->TolA, pa,
+					  ms->RestLoA[Level], ms->RestHiA[Level], AvgMass[Level]);
+		if(ms->MonoMass != 0.0)
+			MWClamp(&lo, &hi, ms->MonoMass, (b < ms->TolM) ? b : ms->TolM, pm,
+					  ms->RestLoM[Level], ms->RestHiM[Level], MonoMasses[Level]);
+		if(lo > hi) return;
+		n[Level] = lo;
+		if(Level < NUMELEMENTS-1)
+		{
+			MWLevel(ms, Thread, Level+1, ms->Lo[Level+1], ms->Hi[Level+1], n,
+					  pa + lo * AvgMass[Level], pm + lo * MonoMasses[Level]);
+		}
+		else
+		{
+			E = 0.0;
+			if(ms->Mass != 0.0)
+			{
+				da = pa + lo * AvgMass[Level] - ms->Mass;
+				if(fabs(da) > ms->TolA) goto next;
+				E = da * da;
+			}
+			if(ms->MonoMass != 0.0)
+			{
+				dm = pm + lo * MonoMasses[Level] - ms->MonoMass;
+				if(fabs(dm) > ms->TolM) goto next;
+				E = E + dm * dm;
+			}
+			if(E >= ms->Bound) goto next;
+			for(k=0;k<NUMELEMENTS;k++) hit.Count[k] = n[k];
+			hit.Err = E;
+			ms->NumHits[Thread] = MWInsertHit(Hits, ms->NumHits[Thread], ms->MaxHits, &hit);
+		}
+next:
+		lo++;
+	}
+}
+
+static void MWSearchSlice(void *Arg, int Start, int Stop, int Thread)
+{
+	MWSEARCH   *ms;
+	int        n[NUMELEMENTS];
+
+	ms = (MWSEARCH *)Arg;
+	ms->NumHits[Thread] = 0;
+	MWLevel(ms, Thread, 0, ms->Lo[0] + Start, ms->Lo[0] + Stop - 1, n, 0.0, 0.0);
+}
+
+/************************************************************************
+* MWSearch -                                                            *
+*                                                                       *
+* Finds up to MaxHits formulas within Range of Formula whose squared    *
+* error is below Bound and whose masses are within TolA/TolM. Hits are  *
+* returned best first, the return value is the number found.            *
+************************************************************************/
+static int MWSearch(const int *Formula, const int *Range, double Mass, double MonoMass,
+						  double TolA, double TolM, double Bound, int MaxHits,
+						  MWHIT *Out, int NumThreads)
+{
+	MWSEARCH   ms;
+	MWHIT      *pool;
+	int        i,t,n,nt,num;
+
+	if(MaxHits < 1) return(0);
+	if((Mass == 0.0) && (MonoMass == 0.0)) return(0);
+	for(i=0;i<NUMELEMENTS;i++)
+	{
+		ms.Lo[i] = Formula[i] - Range[i];
+		ms.Hi[i] = Formula[i] + Range[i];
+		if(ms.Lo[i] < 0) ms.Lo[i] = 0;
+		if(ms.Hi[i] < ms.Lo[i]) return(0);
+	}
+	ms.RestLoA[NUMELEMENTS-1] = ms.RestHiA[NUMELEMENTS-1] = 0.0;
+	ms.RestLoM[NUMELEMENTS-1] = ms.RestHiM[NUMELEMENTS-1] = 0.0;
+	for(i=NUMELEMENTS-2;i>=0;i--)
+	{
+		ms.RestLoA[i] = ms.RestLoA[i+1] + ms.Lo[i+1] * AvgMass[i+1];
+		ms.RestHiA[i] = ms.RestHiA[i+1] + ms.Hi[i+1] * AvgMass[i+1];
+		ms.RestLoM[i] = ms.RestLoM[i+1] + ms.Lo[i+1] * MonoMasses[i+1];
+		ms.RestHiM[i] = ms.RestHiM[i+1] + ms.Hi[i+1] * MonoMasses[i+1];
+	}
+	ms.Mass = Mass;
+	ms.MonoMass = MonoMass;
+	ms.TolA = TolA;
+	ms.TolM = TolM;
+	ms.Bound = Bound;
+	ms.MaxHits = MaxHits;
+
+	num = ms.Hi[0] - ms.Lo[0] + 1;
+	nt = NumThreads;
+	if(nt <= 0) nt = HugeNumThreads();
+	if(nt > num) nt = num;
+	if(nt > MAXTHREADS) nt = MAXTHREADS;
+	pool = (MWHIT *)calloc(nt * MaxHits, sizeof(MWHIT));
+	if(!pool) return(HA_OUTOFMEMORY);
+	for(t=0;t<nt;t++)
+	{
+		ms.Hits[t] = &pool[t * MaxHits];
+		ms.NumHits[t] = 0;
+	}
+	nt = HugeParallel(MWSearchSlice, &ms, num, 1, nt);
+
+	// Merge the per thread lists
+	n = 0;
+	for(t=0;t<nt;t++)
+		for(i=0;i<ms.NumHits[t];i++) n = MWInsertHit(Out, n, MaxHits, &ms.Hits[t][i]);
+	free(pool);
+	return(n);
+}
+
+/************************************************************************
+* SearchMW -                                                            *
+*                                                                       *
+* Replaces the formula with the closest one within 10% of each count.   *
+* The formula is left unchanged and -1 returned if nothing is closer    *
+* than the target mass itself.                                          *
+************************************************************************/
+int pascal _export SearchMW(int *C, int *H,int *N, int *O,int *S,double Mass,double MonoMass)
+{
+	int     Formula[NUMELEMENTS],Range[NUMELEMENTS];
+	double  MassError;
+	MWHIT   hit;
+
+	Formula[0] = *C;
+	Formula[1] = *H;
+	Formula[2] = *N;
+	Formula[3] = *O;
+	Formula[4] = *S;
+	MWDefaultRange(Formula, Range);
+	MassError = (Mass != 0.0) ? Mass : MonoMass;
+	if(MWSearch(Formula, Range, Mass, MonoMass, HUGE_VAL, HUGE_VAL,
+					MassError * MassError, 1, &hit, 0) < 1) return(-1);
+	*C = hit.Count[0];
+	*H = hit.Count[1];
+	*N = hit.Count[2];
+	*O = hit.Count[3];
+	*S = hit.Count[4];
+	return(0);
+}
+
+/************************************************************************
+* SearchMWList -                                                        *
+*                                                                       *
+* Formula  C,H,N,O,S counts to search around                            *
+* Range    half range for each element, NULL = SearchMW default         *
+* Mass     target average mass, 0 = not used                            *
+* MonoMass target monoisotopic mass, 0 = not used                       *
+* Ppm      window each used mass must fall in, <= 0 = no window         *
+* MaxHits  size of the Hits and Errors arrays                           *
+* Hits     returns MaxHits * 5 counts, best match first                 *
+* Errors   returns the combined mass error of each hit                  *
+* NumThreads  threads to split the carbon range over, 0 = default       *
+*                                                                       *
+* Returns the number of hits found.                                     *
+************************************************************************/
+int pascal _export SearchMWList(int *Formula, int *Range, double Mass, double MonoMass, double Ppm,
+										  int MaxHits, int *Hits, double *Errors, int NumThreads)
+{
+	int     DefRange[NUMELEMENTS];
+	double  TolA,TolM;
+	MWHIT   *list;
+	int     i,j,n;
+
+	if((Formula == NULL) || (Hits == NULL) || (MaxHits < 1)) return(HA_WM32_Invalid_Arg);
+	if(Range == NULL)
+	{
+		MWDefaultRange(Formula, DefRange);
+		Range = DefRange;
+	}
+	TolA = TolM = HUGE_VAL;
+	if(Ppm > 0.0)
+	{
+		TolA = fabs(Mass) * Ppm * 1.0e-6;
+		TolM = fabs(MonoMass) * Ppm * 1.0e-6;
+	}
+	list = (MWHIT *)calloc(MaxHits, sizeof(MWHIT));
+	if(!list) return(HA_OUTOFMEMORY);
+	n = MWSearch(Formula, Range, Mass, MonoMass, TolA, TolM, HUGE_VAL, MaxHits, list, NumThreads);
+	for(i=0;i<n;i++)
+	{
+		for(j=0;j<NUMELEMENTS;j++) Hits[i*NUMELEMENTS+j] = list[i].Count[j];
+		if(Errors) Errors[i] = sqrt(list[i].Err);
+	}
+	free(list);
+	return(n);
+}
@@ -0,0 +1,31 @@
+//
+// mwsearch.h
+//
+//		Elemental composition search for ICR-2LS.
+//		Formulas are held as counts in C,H,N,O,S order.
+//
+#define  NUMELEMENTS  5
+
+#define  C1     12.0111069831375
+#define  H1     1.00797557532606
+#define  O1     15.9993703627226
+#define  N1     14.0067248319416
+#define  S1     32.0643887269403
+#define  Cmono  12.0
+#define  Hmono  1.0078246
+#define  Nmono  14.0030732
+#define  Omono  15.9949141
+#define  Smono  31.97207
+
+extern const double  AvgMass[NUMELEMENTS];
+extern const double  MonoMasses[NUMELEMENTS];
+
+typedef struct
+{
+	int     Count[NUMELEMENTS];
+	double  Err;                    // squared mass error
+}  MWHIT;
+
+void MWDefaultRange(const int *Formula, int *Range);
+int  MWHitBefore(const MWHIT *a, const MWHIT *b);
+int  MWInsertHit(MWHIT *Hits, int NumHits, int MaxHits, const MWHIT *hit);
@@ -0,0 +1,320 @@
+using System;
+using System.Collections.Generic;
+
+namespace DataFilter
+{
+    /// <summary>
+    /// Finds the points whose filter window holds non-zero data, so that runs of exact zeros,
+    /// as left by thresholding or noise clearing, can be skipped
+    /// </summary>
+    /// <remarks>
+    /// A convolution or average of a window of zeros is exactly +0, whatever the coefficients,
+    /// so writing 0 for those points gives the same result as filtering them
+    /// </remarks>
+    internal static class ZeroRuns
+    {
+        /// <summary>
+        /// Call processRange for each range of points first through last whose window,
+        /// data[i - windowOffset] through data[i - windowOffset + width - 1], holds a non-zero value,
+        /// and zeroRange for the ranges between them
+        /// </summary>
+        /// <param name="data"></param>
+        /// <param name="first"></param>
+        /// <param name="last"></param>
+        /// <param name="windowOffset"></param>
+        /// <param name="width"></param>
+        /// <param name="processRange">Receives the first and last point of a range</param>
+        /// <param name="zeroRange">Receives the first and last point of a range</param>
+        /// <remarks>NaN counts as non-zero</remarks>
+        public static void ForEachNonZeroWindow(
+            double[] data,
+            int first,
+            int last,
+            int windowOffset,
+            int width,
+            Action<int, int> processRange,
+            Action<int, int> zeroRange)
+        {
+            // Point j is in the windows of points j + windowOffset - width + 1 through j + windowOffset
+            var reach = width - 1 - windowOffset;
+            var j = first - windowOffset;
+            var lastData = last + reach;
+            var next = first;
+
+            while (j <= lastData && data[j] == 0)
+            {
+                j++;
+            }
+
+            while (j <= lastData)
+            {
+                var runStart = j;
+                int runEnd;
+
+                while (true)
+                {
+                    while (j <= lastData && data[j] != 0)
+                    {
+                        j++;
+                    }
+
+                    runEnd = j - 1;
+
+                    while (j <= lastData && data[j] == 0)
+                    {
+                        j++;
+                    }
+
+                    // Runs separated by fewer zeros than a window share windows, so they are merged
+                    if (j > lastData || j - runEnd - 1 >= width)
+                        break;
+                }
+
+                var rangeStart = Math.Max(runStart - reach, first);
+                var rangeEnd = Math.Min(runEnd + windowOffset, last);
+
+                if (rangeStart > next)
+                    zeroRange(next, rangeStart - 1);
+
+                processRange(rangeStart, rangeEnd);
+                next = rangeEnd + 1;
+            }
+
+            if (next <= last)
+                zeroRange(next, last);
+        }
+
+        /// <summary>
+        /// Filter points first through last of data into output, computing only the points whose window holds a non-zero value
+        /// and writing 0 for the rest
+        /// </summary>
+        /// <param name="data">data[first - windowOffset] through data[last - windowOffset + width - 1] must exist</param>
+        /// <param name="output">May be data itself, to filter in place</param>
+        /// <param name="first"></param>
+        /// <param name="last"></param>
+        /// <param name="windowOffset"></param>
+        /// <param name="width"></param>
+        /// <param name="alignment">
+        /// Ranges are widened to whole blocks of this many points, counted from first, for a filter whose
+        /// rounding depends on the block a point is computed in; 1 for none
+        /// </param>
+        /// <param name="processTiles">Calls its argument for tiles that cover first through last, as DataFilter.ProcessTiles does</param>
+        /// <param name="filterRange">
+        /// filterRange(input, output, rangeFirst, rangeLast) sets output[i] from input[i - windowOffset] through
+        /// input[i - windowOffset + width - 1], for i = rangeFirst through rangeLast; input ends with the last point read
+        /// </param>
+        /// <remarks>
+        /// Each range is filtered from a copy of the points it reads, and the results are written to output once every
+        /// tile is done, so only the non-zero neighbourhoods are copied rather than the whole array
+        /// </remarks>
+        public static void FilterNonZeroWindows(
+            double[] data,
+            double[] output,
+            int first,
+            int last,
+            int windowOffset,
+            int width,
+            int alignment,
+            Action<Action<int, int>> processTiles,
+            Action<double[], double[], int, int> filterRange)
+        {
+            // Start of each filtered range, and its output from index windowOffset on
+            var results = new List<KeyValuePair<int, double[]>>();
+
+            processTiles((tileStart, tileEnd) =>
+            {
+                // Ranges that share a block once widened are merged, so that no block is filtered twice
+                var ranges = new List<KeyValuePair<int, int>>();
+                ForEachNonZeroWindow(
+                    data, tileStart, tileEnd, windowOffset, width,
+                    (rangeStart, rangeEnd) =>
+                    {
+                        rangeStart = first + (rangeStart - first) / alignment * alignment;
+                        rangeEnd = Math.Min(first + ((rangeEnd - first) / alignment + 1) * alignment - 1, last);
+
+                        if (ranges.Count > 0 && rangeStart <= ranges[ranges.Count - 1].Value)
+                            ranges[ranges.Count - 1] = new KeyValuePair<int, int>(ranges[ranges.Count - 1].Key, rangeEnd);
+                        else
+                            ranges.Add(new KeyValuePair<int, int>(rangeStart, rangeEnd));
+                    },
+                    (rangeStart, rangeEnd) => { });
+
+                var tileResults = new List<KeyValuePair<int, double[]>>();
+                double[] input = null;
+
+                foreach (var range in ranges)
+                {
+                    var count = range.Value - range.Key + 1;
+                    var inputLength = count + width - 1;
+                    if (input == null || input.Length < inputLength)
+                        input = new double[inputLength];
+
+                    Array.Copy(data, range.Key - windowOffset, input, 0, inputLength);
+
+                    var rangeOutput = new double[windowOffset + count];
+                    filterRange(input, rangeOutput, windowOffset, windowOffset + count - 1);
+                    tileResults.Add(new KeyValuePair<int, double[]>(range.Key, rangeOutput));
+                }
+
+                lock (results)
+                {
+                    results.AddRange(tileResults);
+                }
+            });
+
+            // Widened ranges may overlap, but the points they share have the same value in both
+            results.Sort((x, y) => x.Key.CompareTo(y.Key));
+
+            var next = first;
+            foreach (var result in results)
+            {
+                var count = result.Value.Length - windowOffset;
+                if (result.Key > next)
+                    Array.Clear(output, next, result.Key - next);
+
+                Array.Copy(result.Value, windowOffset, output, result.Key, count);
+                next = Math.Max(next, result.Key + count);
+            }
+
+            if (next <= last)
+                Array.Clear(output, next, last - next + 1);
+        }
+
+        /// <summary>
+        /// Float version of ForEachNonZeroWindow
+        /// </summary>
+        public static void ForEachNonZeroWindow(
+            float[] data,
+            int first,
+            int last,
+            int windowOffset,
+            int width,
+            Action<int, int> processRange,
+            Action<int, int> zeroRange)
+        {
+            // Point j is in the windows of points j + windowOffset - width + 1 through j + windowOffset
+            var reach = width - 1 - windowOffset;
+            var j = first - windowOffset;
+            var lastData = last + reach;
+            var next = first;
+
+            while (j <= lastData && data[j] == 0)
+            {
+                j++;
+            }
+
+            while (j <= lastData)
+            {
+                var runStart = j;
+                int runEnd;
+
+                while (true)
+                {
+                    while (j <= lastData && data[j] != 0)
+                    {
+                        j++;
+                    }
+
+                    runEnd = j - 1;
+
+                    while (j <= lastData && data[j] == 0)
+                    {
+                        j++;
+                    }
+
+                    // Runs separated by fewer zeros than a window share windows, so they are merged
+                    if (j > lastData || j - runEnd - 1 >= width)
+                        break;
+                }
+
+                var rangeStart = Math.Max(runStart - reach, first);
+                var rangeEnd = Math.Min(runEnd + windowOffset, last);
+
+                if (rangeStart > next)
+                    zeroRange(next, rangeStart - 1);
+
+                processRange(rangeStart, rangeEnd);
+                next = rangeEnd + 1;
+            }
+
+            if (next <= last)
+                zeroRange(next, last);
+        }
+
+        /// <summary>
+        /// Float version of FilterNonZeroWindows
+        /// </summary>
+        public static void FilterNonZeroWindows(
+            float[] data,
+            float[] output,
+            int first,
+            int last,
+            int windowOffset,
+            int width,
+            int alignment,
+            Action<Action<int, int>> processTiles,
+            Action<float[], float[], int, int> filterRange)
+        {
+            // Start of each filtered range, and its output from index windowOffset on
+            var results = new List<KeyValuePair<int, float[]>>();
+
+            processTiles((tileStart, tileEnd) =>
+            {
+                // Ranges that share a block once widened are merged, so that no block is filtered twice
+                var ranges = new List<KeyValuePair<int, int>>();
+                ForEachNonZeroWindow(
+                    data, tileStart, tileEnd, windowOffset, width,
+                    (rangeStart, rangeEnd) =>
+                    {
+                        rangeStart = first + (rangeStart - first) / alignment * alignment;
+                        rangeEnd = Math.Min(first + ((rangeEnd - first) / alignment + 1) * alignment - 1, last);
+
+                        if (ranges.Count > 0 && rangeStart <= ranges[ranges.Count - 1].Value)
+                            ranges[ranges.Count - 1] = new KeyValuePair<int, int>(ranges[ranges.Count - 1].Key, rangeEnd);
+                        else
+                            ranges.Add(new KeyValuePair<int, int>(rangeStart, rangeEnd));
+                    },
+                    (rangeStart, rangeEnd) => { });
+
+                var tileResults = new List<KeyValuePair<int, float[]>>();
+                float[] input = null;
+
+                foreach (var range in ranges)
+                {
+                    var count = range.Value - range.Key + 1;
+                    var inputLength = count + width - 1;
+                    if (input == null || input.Length < inputLength)
+                        input = new float[inputLength];
+
+                    Array.Copy(data, range.Key - windowOffset, input, 0, inputLength);
+
+                    var rangeOutput = new float[windowOffset + count];
+                    filterRange(input, rangeOutput, windowOffset, windowOffset + count - 1);
+                    tileResults.Add(new KeyValuePair<int, float[]>(range.Key, rangeOutput));
+                }
+
+                lock (results)
+                {
+                    results.AddRange(tileResults);
+                }
+            });
+
+            // Widened ranges may overlap, but the points they share have the same value in both
+            results.Sort((x, y) => x.Key.CompareTo(y.Key));
+
+            var next = first;
+            foreach (var result in results)
+            {
+                var count = result.Value.Length - windowOffset;
+                if (result.Key > next)
+                    Array.Clear(output, next, result.Key - next);
+
+                Array.Copy(result.Value, windowOffset, output, result.Key, count);
+                next = Math.Max(next, result.Key + count);
+            }
+
+            if (next <= last)
+                Array.Clear(output, next, last - next + 1);
+        }
+    }
+}